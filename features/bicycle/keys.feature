@@ -0,0 +1,27 @@
+@routing @bicycle @keys
+Feature: Bike - Objects without any of the keys of the profile
+
+    Background:
+        Given the profile "bicycle"
+
+    Scenario: Bike - Ways need one of the way keys
+        Then routability should be
+            | highway | route | man_made | railway  | amenity | public_transport | bridge  | leisure | forw | backw |
+            | (nil)   |       |          |          |         |                  |         |         |      |       |
+            | (nil)   |       |          |          |         |                  |         | track   |      |       |
+            | primary |       |          |          |         |                  |         |         | x    | x     |
+            | (nil)   | ferry |          |          |         |                  |         |         | x    | x     |
+            | (nil)   |       | pier     |          |         |                  |         |         | x    | x     |
+            | (nil)   |       |          | platform |         |                  |         |         | x    | x     |
+            | (nil)   |       |          |          | parking |                  |         |         | x    | x     |
+            | (nil)   |       |          |          |         | platform         |         |         | x    | x     |
+            | (nil)   |       |          |          |         |                  | movable |         | x    | x     |
+
+    Scenario: Bike - Nodes need one of the node keys to be barriers
+        Then routability should be
+            | node/barrier | node/bicycle | node/vehicle | node/access | node/foot | forw |
+            |              |              |              |             | no        | x    |
+            | wall         |              |              |             |           |      |
+            |              | no           |              |             |           |      |
+            |              |              | no           |             |           |      |
+            |              |              |              | no          |           |      |
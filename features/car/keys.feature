@@ -0,0 +1,25 @@
+@routing @car @keys
+Feature: Car - Objects without any of the keys of the profile
+
+    Background:
+        Given the profile "car"
+
+    Scenario: Car - Ways need one of the way keys
+        Then routability should be
+            | highway | route | bridge  | amenity | building | forw | backw |
+            | (nil)   |       |         |         |          |      |       |
+            | (nil)   |       |         | parking |          |      |       |
+            | (nil)   |       |         |         | yes      |      |       |
+            | primary |       |         |         |          | x    | x     |
+            | (nil)   | ferry |         |         |          | x    | x     |
+            | (nil)   |       | movable |         |          | x    | x     |
+
+    Scenario: Car - Nodes need one of the node keys to be barriers
+        Then routability should be
+            | node/barrier | node/motorcar | node/motor_vehicle | node/vehicle | node/access | node/bicycle | forw |
+            |              |               |                    |              |             | no           | x    |
+            | wall         |               |                    |              |             |              |      |
+            |              | no            |                    |              |             |              |      |
+            |              |               | no                 |              |             |              |      |
+            |              |               |                    | no           |             |              |      |
+            |              |               |                    |              | no          |              |      |
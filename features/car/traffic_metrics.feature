@@ -0,0 +1,48 @@
+@routing @speed @traffic
+Feature: Traffic - named metrics
+
+    Background: Use a metric with slow speeds on the direct road
+        Given the node locations
+            | node | lat        | lon      |
+            | a    | 0.1        | 0.1      |
+            | b    | .05        | 0.1      |
+            | c    | 0.0        | 0.1      |
+            | d    | .05        | .03      |
+        And the ways
+            | nodes | highway |
+            | ab    | primary |
+            | bc    | primary |
+            | ad    | primary |
+            | dc    | primary |
+        And the speed file "slow.csv"
+        """
+        1,2,1
+        2,1,1
+        2,3,1
+        3,2,1
+        """
+        And the profile "testbot"
+        And the extract extra arguments "--generate-edge-lookup"
+        And the metric "slow" contracted with "--segment-speed-file slow.csv"
+        And data is loaded directly
+
+    Scenario: Routing with the default metric
+        When I route I should get
+            | from | to | route    | speed   |
+            | a    | b  | ab,ab    | 36 km/h |
+            | a    | c  | ab,bc,bc | 36 km/h |
+
+    Scenario: Routing with a named metric
+        Given the query options
+            | metric | slow |
+        When I route I should get
+            | from | to | route    |
+            | a    | b  | ab,ab    |
+            | a    | c  | ad,dc,dc |
+
+    Scenario: Routing with an unknown metric
+        Given the query options
+            | metric | fast |
+        When I route I should get
+            | from | to | route | status | message             |
+            | a    | b  |       | 400    | Unknown metric fast |
@@ -45,3 +45,92 @@ Feature: Traffic - speeds
             | g    | b  | ab,ab    | 27 km/h |
             | a    | g  | ab,ab    | 27 km/h |
 
+
+    Scenario: Weighting based on speed delta file
+        Given the profile "testbot"
+        Given the extract extra arguments "--generate-edge-lookup"
+        Given the contract extra arguments "--segment-speed-delta-file speeds.csv"
+        And I route I should get
+            | from | to | route    | speed   |
+            | a    | b  | ab,ab    | 27 km/h |
+            | a    | c  | ab,bc,bc | 27 km/h |
+            | b    | c  | bc,bc    | 27 km/h |
+            | a    | d  | ad,ad    | 27 km/h |
+            | d    | c  | dc,dc    | 36 km/h |
+            | g    | b  | ab,ab    | 27 km/h |
+            | a    | g  | ab,ab    | 27 km/h |
+
+
+    Scenario: Weighting based on successive speed delta files
+        Given the profile "testbot"
+        And the speed file "first.csv"
+        """
+        1,2,27
+        2,1,27
+        """
+        And the speed file "second.csv"
+        """
+        1,2,18
+        2,3,18
+        3,2,18
+        """
+        And the extract extra arguments "--generate-edge-lookup"
+        And the data has been extracted
+        When I run "osrm-contract --segment-speed-delta-file first.csv {extracted_base}.osrm"
+        Then it should exit with code 0
+        And stdout should contain "Building segment index"
+        And stdout should contain "Applied 2 segment speeds to 2 segments"
+        When I run "osrm-contract --segment-speed-delta-file second.csv {extracted_base}.osrm"
+        Then it should exit with code 0
+        And stdout should not contain "Building segment index"
+        And stdout should contain "Applied 3 segment speeds to 3 segments"
+        And the extracted data should have 1 segment from datasource 1
+        And the extracted data should have 3 segments from datasource 2
+        And the datasource names of the extracted data should be
+        """
+        lua profile
+        first.csv
+        second.csv
+        """
+        # the first file again overrides a - b and keeps its data source
+        Given the contract extra arguments "--segment-speed-delta-file first.csv"
+        And I route I should get
+            | from | to | route | speed   |
+            | a    | b  | ab,ab | 27 km/h |
+            | b    | a  | ab,ab | 27 km/h |
+            | b    | c  | bc,bc | 18 km/h |
+            | c    | b  | bc,bc | 18 km/h |
+            | d    | c  | dc,dc | 36 km/h |
+        And the contracted data should have 2 segments from datasource 1
+        And the contracted data should have 2 segments from datasource 2
+        And the datasource names of the contracted data should be
+        """
+        lua profile
+        first.csv
+        second.csv
+        """
+
+    Scenario: Rebuilding the segment index for a new extract with the same counts
+        Given the profile "testbot"
+        And the speed file "first.csv"
+        """
+        1,2,27
+        2,1,27
+        """
+        And the extract extra arguments "--generate-edge-lookup"
+        And the data has been extracted
+        When I run "osrm-contract --segment-speed-delta-file first.csv {extracted_base}.osrm"
+        Then it should exit with code 0
+        And stdout should contain "Building segment index"
+        Given the data has been extracted again with the node locations
+            | node | lat | lon |
+            | b    | .06 | 0.1 |
+        When I run "osrm-contract --segment-speed-delta-file first.csv {extracted_base}.osrm"
+        Then it should exit with code 0
+        And stdout should contain "Building segment index"
+        And stdout should contain "Applied 2 segment speeds to 2 segments"
+        Given the contract extra arguments "--segment-speed-delta-file first.csv"
+        And I route I should get
+            | from | to | route | speed   |
+            | a    | b  | ab,ab | 27 km/h |
+            | b    | a  | ab,ab | 27 km/h |
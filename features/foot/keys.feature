@@ -0,0 +1,25 @@
+@routing @foot @keys
+Feature: Foot - Objects without any of the keys of the profile
+
+    Background:
+        Given the profile "foot"
+
+    Scenario: Foot - Ways need one of the way keys
+        Then routability should be
+            | highway | leisure | route | railway  | amenity | public_transport | bridge  | forw | backw |
+            | (nil)   |         |       |          |         |                  |         |      |       |
+            | (nil)   |         |       |          |         |                  | movable |      |       |
+            | primary |         |       |          |         |                  |         | x    | x     |
+            | (nil)   | track   |       |          |         |                  |         | x    | x     |
+            | (nil)   |         | ferry |          |         |                  |         | x    | x     |
+            | (nil)   |         |       | platform |         |                  |         | x    | x     |
+            | (nil)   |         |       |          | parking |                  |         | x    | x     |
+            | (nil)   |         |       |          |         | platform         |         | x    | x     |
+
+    Scenario: Foot - Nodes need one of the node keys to be barriers
+        Then routability should be
+            | node/barrier | node/foot | node/access | node/bicycle | forw |
+            |              |           |             | no           | x    |
+            | wall         |           |             |              |      |
+            |              | no        |             |              |      |
+            |              |           | no          |              |      |
@@ -1,4 +1,5 @@
 var util = require('util');
+var assert = require('assert');
 var path = require('path');
 var fs = require('fs');
 var d3 = require('d3-queue');
@@ -17,6 +18,10 @@ module.exports = function () {
         this.setContractArgs(args, callback);
     });
 
+    this.Given(/^the metric "([^"]*)" contracted with "(.*?)"$/, (name, args, callback) => {
+        this.setMetric(name, args, callback);
+    });
+
     this.Given(/^a grid size of (\d+) meters$/, (meters, callback) => {
         this.setGridSize(meters);
         callback();
@@ -235,6 +240,33 @@ module.exports = function () {
         fs.writeFile(path.resolve(this.TEST_FOLDER, 'speeds.csv'), data, callback);
     });
 
+    this.Given(/^the speed file "([^"]*)"$/, (file, data, callback) => {
+        fs.writeFile(path.resolve(this.TEST_FOLDER, file), data, callback);
+    });
+
+    this.Then(/^the datasource names of the (extracted|contracted) data should be$/, (stage, data, callback) => {
+        var base = stage === 'extracted' ? this.osmData.extractedFile : this.osmData.contractedFile;
+        fs.readFile(util.format('%s.osrm.datasource_names', base), 'utf8', (err, names) => {
+            if (err) return callback(err);
+            assert.equal(names.trim(), data.trim());
+            callback();
+        });
+    });
+
+    this.Then(/^the (extracted|contracted) data should have (\d+) segments? from datasource (\d+)$/, (stage, count, datasource, callback) => {
+        var base = stage === 'extracted' ? this.osmData.extractedFile : this.osmData.contractedFile;
+        fs.readFile(util.format('%s.osrm.datasource_indexes', base), (err, indexes) => {
+            if (err) return callback(err);
+            // a 64 bit count followed by one byte per segment
+            var segments = 0;
+            for (var i = 8; i < indexes.length; ++i) {
+                if (indexes[i] === parseInt(datasource)) ++segments;
+            }
+            assert.equal(segments, parseInt(count));
+            callback();
+        });
+    });
+
     this.Given(/^the turn penalty file$/, (data, callback) => {
         fs.writeFile(path.resolve(this.TEST_FOLDER, 'penalties.csv'), data, callback);
     });
@@ -255,6 +287,13 @@ module.exports = function () {
         });
     });
 
+    this.Given(/^the data has been extracted again with the node locations$/, (table, callback) => {
+        this.reextractWithNodeLocations(table, (err) => {
+            if (err) this.processError = err;
+            callback();
+        });
+    });
+
     this.Given(/^the data has been contracted$/, (callback) => {
         this.reprocess((err) => {
             if (err) this.processError = err;
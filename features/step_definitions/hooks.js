@@ -6,6 +6,7 @@ module.exports = function () {
 
         this.loadMethod = this.DEFAULT_LOAD_METHOD;
         this.queryParams = {};
+        this.metrics = {};
         var d = new Date();
         this.scenarioTime = util.format('%d-%d-%dT%s:%s:%sZ', d.getFullYear(), d.getMonth()+1, d.getDate(), d.getHours(), d.getMinutes(), d.getSeconds());
         this.resetData();
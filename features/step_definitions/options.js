@@ -33,6 +33,10 @@ module.exports = function () {
         assert.ok(this.stdout.indexOf(str) > -1);
     });
 
+    this.Then(/^stdout should not contain "(.*?)"$/, (str) => {
+        assert.ok(this.stdout.indexOf(str) === -1);
+    });
+
     this.Then(/^stderr should contain "(.*?)"$/, (str) => {
         assert.ok(this.stderr.indexOf(str) > -1);
     });
@@ -91,6 +91,13 @@ module.exports = function () {
         this.fingerprintContract = this.hashString(this.binContractHash);
     };
 
+    this.profileFile = () => {
+        var plugin = path.resolve(this.BIN_PATH,
+            util.format('%sosrm_%s_profile%s', this.PLUGIN_PREFIX, this.profile, this.PLUGIN_EXTENSION));
+        if (this.PROFILE_PLUGINS && fs.existsSync(plugin)) return plugin;
+        return path.resolve(this.PROFILES_PATH, this.profile + '.lua');
+    };
+
     this.setProfile = (profile, cb) => {
         var lastProfile = this.profile;
         if (profile !== lastProfile) {
@@ -115,4 +122,10 @@ module.exports = function () {
         this.forceContract = true;
         callback();
     };
+
+    this.setMetric = (name, args, callback) => {
+        this.metrics[name] = args;
+        this.forceContract = true;
+        callback();
+    };
 };
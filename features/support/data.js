@@ -194,8 +194,8 @@ module.exports = function () {
     this.extractData = (callback) => {
         this.logPreprocessInfo();
         this.log(util.format('== Extracting %s.osm...', this.osmData.osmFile), 'preprocess');
-        var cmd = util.format('%s%s/osrm-extract %s.osm %s --profile %s/%s.lua >>%s 2>&1',
-            this.LOAD_LIBRARIES, this.BIN_PATH, this.osmData.osmFile, this.extractArgs || '', this.PROFILES_PATH, this.profile, this.PREPROCESS_LOG_FILE);
+        var cmd = util.format('%s%s/osrm-extract %s.osm %s --profile %s >>%s 2>&1',
+            this.LOAD_LIBRARIES, this.BIN_PATH, this.osmData.osmFile, this.extractArgs || '', this.profileFile(), this.PREPROCESS_LOG_FILE);
         this.log(cmd);
         process.chdir(this.TEST_FOLDER);
         exec(cmd, (err) => {
@@ -289,13 +289,58 @@ module.exports = function () {
         });
     };
 
+    this.contractMetric = (name, args, callback) => {
+        this.log(util.format('== Contracting metric %s of %s.osm...', name, this.osmData.extractedFile), 'preprocess');
+        var cmd = util.format('%s%s/osrm-contract --metric %s %s %s.osrm >>%s 2>&1',
+            this.LOAD_LIBRARIES, this.BIN_PATH, name, args, this.osmData.extractedFile, this.PREPROCESS_LOG_FILE);
+        this.log(cmd);
+        process.chdir(this.TEST_FOLDER);
+        exec(cmd, (err) => {
+            process.chdir('../');
+            if (err) {
+                this.log(util.format('*** Exited with code %d', err.code), 'preprocess');
+                return callback(this.ContractError(err.code, util.format('osrm-contract --metric %s exited with code %d', name, err.code)));
+            }
+
+            var renameIfExists = (file, cb) => {
+                var from = [this.osmData.extractedFile, 'osrm', name, file].join('.');
+                fs.stat(from, (doesNotExistErr, exists) => {
+                    if (!exists) return cb();
+                    fs.rename(from, [this.osmData.contractedFile, 'osrm', name, file].join('.'), (err) => {
+                        if (err) return cb(this.FileError(null, 'failed to rename metric file after contracting'));
+                        cb();
+                    });
+                });
+            };
+
+            var q = d3.queue();
+
+            ['hsgr','core','level','landmarks','segment_weights','datasource_names','datasource_indexes'].forEach((file) => {
+                q.defer(renameIfExists, file);
+            });
+
+            q.awaitAll(callback);
+        });
+    };
+
+    this.contractMetrics = (callback) => {
+        var q = d3.queue(1);
+        Object.keys(this.metrics).forEach((name) => {
+            q.defer(this.contractMetric, name, this.metrics[name]);
+        });
+        q.awaitAll((err) => callback(err));
+    };
+
     var noop = (cb) => cb();
 
     this.reprocess = (callback) => {
         this.writeAndExtract((e) => {
             if (e) return callback(e);
             this.isContracted((isContracted) => {
-                var contractFn = (isContracted && !this.forceContract) ? noop : this.contractData;
+                // named metrics are contracted first, contracting the default metric moves the
+                // shared .geometry file away from the extracted data
+                var contractAll = (cb) => this.contractMetrics((e) => e ? cb(e) : this.contractData(cb));
+                var contractFn = (isContracted && !this.forceContract) ? noop : contractAll;
                 if (isContracted) this.log('Already contracted ' + this.osmData.contractedFile, 'preprocess');
                 contractFn((e) => {
                     this.forceContract = false;
@@ -323,6 +368,35 @@ module.exports = function () {
         });
     };
 
+    // Moves nodes and extracts the data again. osrm-extract writes next to its input, so extracting
+    // the changed file in place keeps the segment index that was built for the earlier extract.
+    this.reextractWithNodeLocations = (table, callback) => {
+        var previousFile = this.osmData.extractedFile;
+
+        table.hashes().forEach((row) => {
+            var node = this.findNodeByName(row.node);
+            if (!node) throw new Error(util.format('*** unknown node %s', row.node));
+            node.lon = row.lon;
+            node.lat = row.lat;
+        });
+
+        this.forceExtract = true;
+        this.writeAndExtract((e) => {
+            if (e) return callback(e);
+            var from = util.format('%s.osrm.segment_index', previousFile),
+                to = util.format('%s.osrm.segment_index', this.osmData.extractedFile);
+            fs.stat(from, (doesNotExistErr) => {
+                if (doesNotExistErr) return callback();
+                this.log(util.format('Copying %s to %s', from, to), 'preprocess');
+                fs.createReadStream(from)
+                    .pipe(fs.createWriteStream(to)
+                        .on('finish', () => callback())
+                    )
+                    .on('error', () => callback(this.FileError(null, 'failed to copy the segment index')));
+            });
+        });
+    };
+
     this.reprocessAndLoadData = (callback) => {
         this.reprocess(() => {
             this.OSRMLoader.load(util.format('%s.osrm', this.osmData.contractedFile), callback);
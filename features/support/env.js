@@ -22,6 +22,9 @@ module.exports = function () {
         this.PROFILES_PATH = path.resolve(this.ROOT_FOLDER, 'profiles');
         this.FIXTURES_PATH = path.resolve(this.ROOT_FOLDER, 'unit_tests/fixtures');
         this.BIN_PATH = path.resolve(this.ROOT_FOLDER, 'build');
+        // With OSRM_PROFILE_PLUGINS set, profiles that have a plugin library in the build folder
+        // (e.g. libosrm_car_profile.so for car) are run with the plugin instead of the lua script
+        this.PROFILE_PLUGINS = !!process.env.OSRM_PROFILE_PLUGINS;
         this.DEFAULT_INPUT_FORMAT = 'osm';
         this.DEFAULT_ORIGIN = [1,1];
         this.DEFAULT_LOAD_METHOD = 'datastore';
@@ -37,10 +40,14 @@ module.exports = function () {
         if (process.platform.match(/indows.*/)) {
             this.TERMSIGNAL = 9;
             this.EXE = '.exe';
+            this.PLUGIN_PREFIX = '';
+            this.PLUGIN_EXTENSION = '.dll';
             this.QQ = '"';
         } else {
             this.TERMSIGNAL = 'SIGTERM';
             this.EXE = '';
+            this.PLUGIN_PREFIX = 'lib';
+            this.PLUGIN_EXTENSION = '.so';
             this.QQ = '';
         }
 
@@ -26,7 +26,7 @@ module.exports = function () {
     };
 
     this.hashProfile = (cb) => {
-        this.hashOfFiles(path.resolve(this.PROFILES_PATH, this.profile + '.lua'), cb);
+        this.hashOfFiles(this.profileFile(), cb);
     };
 
     this.hashString = (str) => {
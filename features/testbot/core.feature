@@ -0,0 +1,41 @@
+@routing @testbot @core
+Feature: Testbot - routing on the uncontracted core
+
+    Background:
+        Given the profile "testbot"
+        Given the node map
+            | a | 1 | b |   | c |   | x |
+            |   |   |   |   |   |   | y |
+            | d | 3 | e | 2 | f |   |   |
+
+        And the ways
+            | nodes | oneway |
+            | abc   | no     |
+            | def   | yes    |
+            | ad    | no     |
+            | cf    | no     |
+            | xy    | no     |
+
+    Scenario: Routing with a core and landmarks
+        Given the contract extra arguments "--core 0.5"
+
+        When I route I should get
+            | from | to | route                  | distance  |
+            | 1    | c  | abc,abc                | 300m +-1  |
+            | 3    | 2  | def,def                | 200m +-1  |
+            | 2    | 3  | def,cf,abc,ad,def,def  | 1000m +-1 |
+            | 1    | 2  | abc,ad,def,def         | 600m +-1  |
+            | x    | y  | xy,xy                  | 100m +-1  |
+            | 1    | x  |                        |           |
+
+    Scenario: Routing with a core and without landmarks
+        Given the contract extra arguments "--core 0.5 --core-landmarks 0"
+
+        When I route I should get
+            | from | to | route                  | distance  |
+            | 1    | c  | abc,abc                | 300m +-1  |
+            | 3    | 2  | def,def                | 200m +-1  |
+            | 2    | 3  | def,cf,abc,ad,def,def  | 1000m +-1 |
+            | 1    | 2  | abc,ad,def,def         | 600m +-1  |
+            | x    | y  | xy,xy                  | 100m +-1  |
+            | 1    | x  |                        |           |
@@ -65,7 +65,14 @@ class Contractor
                        std::vector<EdgeWeight> &&node_weights,
                        std::vector<bool> &is_core_node,
                        std::vector<float> &inout_node_levels) const;
+    void CustomizeGraph(const unsigned max_edge_id,
+                        const util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+                        util::DeallocatingVector<QueryEdge> &contracted_edge_list,
+                        const std::vector<float> &node_levels) const;
     void WriteCoreNodeMarker(std::vector<bool> &&is_core_node) const;
+    void ReadCoreNodeMarker(std::vector<bool> &is_core_node) const;
+    void WriteCoreLandmarks(const std::vector<bool> &is_core_node,
+                            const util::DeallocatingVector<QueryEdge> &contracted_edge_list) const;
     void WriteNodeLevels(std::vector<float> &&node_levels) const;
     void ReadNodeLevels(std::vector<float> &contraction_order) const;
     std::size_t
@@ -78,6 +85,8 @@ class Contractor
   private:
     ContractorConfig config;
 
+    void ApplySegmentSpeedDeltas() const;
+
     std::size_t
     LoadEdgeExpandedGraph(const std::string &edge_based_graph_path,
                           util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
@@ -89,6 +98,7 @@ class Contractor
                           const std::string &geometry_filename,
                           const std::string &datasource_names_filename,
                           const std::string &datasource_indexes_filename,
+                          const std::string &segment_weights_filename,
                           const std::string &rtree_leaf_filename);
 };
 }
@@ -31,6 +31,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/filesystem/path.hpp>
 
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -39,22 +40,34 @@ namespace contractor
 
 struct ContractorConfig
 {
-    ContractorConfig() : requested_num_threads(0) {}
+    ContractorConfig()
+        : use_customization(false), use_lazy_priority_updates(false), requested_num_threads(0),
+          core_landmarks(16), flush_stages(1)
+    {
+    }
 
     // Infer the output names from the path of the .osrm file
     void UseDefaultOutputNames()
     {
-        level_output_path = osrm_input_path.string() + ".level";
-        core_output_path = osrm_input_path.string() + ".core";
-        graph_output_path = osrm_input_path.string() + ".hsgr";
+        // Named metrics share the extracted data but get their own hierarchy and weights
+        const auto metric_path = metric_name.empty()
+                                     ? osrm_input_path.string()
+                                     : osrm_input_path.string() + "." + metric_name;
+        level_output_path = metric_path + ".level";
+        core_output_path = metric_path + ".core";
+        landmarks_output_path = metric_path + ".landmarks";
+        graph_output_path = metric_path + ".hsgr";
         edge_based_graph_path = osrm_input_path.string() + ".ebg";
         edge_segment_lookup_path = osrm_input_path.string() + ".edge_segment_lookup";
         edge_penalty_path = osrm_input_path.string() + ".edge_penalties";
         node_based_graph_path = osrm_input_path.string() + ".nodes";
         geometry_path = osrm_input_path.string() + ".geometry";
         rtree_leaf_path = osrm_input_path.string() + ".fileIndex";
-        datasource_names_path = osrm_input_path.string() + ".datasource_names";
-        datasource_indexes_path = osrm_input_path.string() + ".datasource_indexes";
+        datasource_names_path = metric_path + ".datasource_names";
+        datasource_indexes_path = metric_path + ".datasource_indexes";
+        segment_weights_path = metric_name.empty() ? "" : metric_path + ".segment_weights";
+        edge_data_path = osrm_input_path.string() + ".edges";
+        segment_index_path = osrm_input_path.string() + ".segment_index";
     }
 
     boost::filesystem::path config_file_path;
@@ -62,6 +75,7 @@ struct ContractorConfig
 
     std::string level_output_path;
     std::string core_output_path;
+    std::string landmarks_output_path;
     std::string graph_output_path;
     std::string edge_based_graph_path;
 
@@ -71,6 +85,12 @@ struct ContractorConfig
     std::string geometry_path;
     std::string rtree_leaf_path;
     bool use_cached_priority;
+    // Keep the contraction order of the .level file and only compute the weights of a
+    // hierarchy that contains all shortcuts of that order
+    bool use_customization;
+    // Recompute node priorities only for candidates of the next independent set instead of
+    // for all neighbours of the contracted nodes
+    bool use_lazy_priority_updates;
 
     unsigned requested_num_threads;
 
@@ -80,10 +100,29 @@ struct ContractorConfig
     //(e.g. 0.8 contracts 80 percent of the hierarchy, leaving a core of 20%)
     double core_factor;
 
+    // Number of landmarks for the A* search on the core, only used with a core_factor below 1
+    unsigned core_landmarks;
+
+    // Number of times the contracted part of the graph is moved to external memory and the
+    // remaining graph is renumbered. More stages lower the peak memory usage.
+    unsigned flush_stages;
+
     std::vector<std::string> segment_speed_lookup_paths;
     std::vector<std::string> turn_penalty_lookup_paths;
     std::string datasource_indexes_path;
     std::string datasource_names_path;
+
+    // Speed files that only list the segments that changed since the last update. They are
+    // applied in place to the .geometry and .ebg files through the .segment_index file. A full
+    // --segment-speed-file update only rewrites the .geometry file, deltas refuse such datasets.
+    std::vector<std::string> segment_speed_delta_paths;
+    std::string edge_data_path;
+    std::string segment_index_path;
+
+    // Name of the metric to build, empty for the default metric. The updated segment weights
+    // of a named metric go to its own file instead of replacing the shared .geometry file.
+    std::string metric_name;
+    std::string segment_weights_path;
 };
 }
 }
@@ -0,0 +1,350 @@
+#ifndef OSRM_CONTRACTOR_CONTRACTOR_GRAPH_HPP
+#define OSRM_CONTRACTOR_CONTRACTOR_GRAPH_HPP
+
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+/*
+ * Adjacency of the graph during contraction.
+ *
+ * Every node owns a contiguous block of edges in one flat array, and the size of the block is
+ * stored with the node. Scanning the edges of a node therefore touches only neighbouring cache
+ * lines and never probes the next slot to find the end of a block. A block that runs out of
+ * space moves to the end of the array with 50% headroom. The shortcuts of a contraction round
+ * are inserted in bulk: all blocks that need to grow are moved in one pass, and then every node
+ * gets its new edges in parallel.
+ */
+template <typename EdgeDataT> class ContractorGraph
+{
+  public:
+    using EdgeData = EdgeDataT;
+    using NodeIterator = NodeID;
+    using EdgeIterator = EdgeID;
+    using EdgeRange = util::range<EdgeIterator>;
+
+    class InputEdge
+    {
+      public:
+        NodeIterator source;
+        NodeIterator target;
+        EdgeDataT data;
+
+        InputEdge()
+            : source(std::numeric_limits<NodeIterator>::max()),
+              target(std::numeric_limits<NodeIterator>::max())
+        {
+        }
+
+        template <typename... Ts>
+        InputEdge(NodeIterator source, NodeIterator target, Ts &&... data)
+            : source(source), target(target), data(std::forward<Ts>(data)...)
+        {
+        }
+
+        bool operator<(const InputEdge &rhs) const
+        {
+            return std::tie(source, target) < std::tie(rhs.source, rhs.target);
+        }
+    };
+
+    // Constructs the graph from a list of edges sorted by source node id
+    template <class ContainerT>
+    ContractorGraph(const NodeIterator number_of_nodes, const ContainerT &graph)
+        : node_array(number_of_nodes), number_of_edges(graph.size()), number_of_unused_edges(0)
+    {
+        edge_list.resize(graph.size());
+        for (const auto edge : util::irange<std::size_t>(0UL, graph.size()))
+        {
+            BOOST_ASSERT(edge == 0 || graph[edge - 1].source <= graph[edge].source);
+            BOOST_ASSERT(graph[edge].target < number_of_nodes);
+            ++node_array[graph[edge].source].edges;
+            edge_list[edge].target = graph[edge].target;
+            edge_list[edge].data = graph[edge].data;
+        }
+
+        EdgeIterator position = 0;
+        for (auto &node : node_array)
+        {
+            node.first_edge = position;
+            node.capacity = node.edges;
+            position += node.edges;
+        }
+    }
+
+    unsigned GetNumberOfNodes() const { return node_array.size(); }
+
+    unsigned GetNumberOfEdges() const { return number_of_edges; }
+
+    NodeIterator GetTarget(const EdgeIterator edge) const { return edge_list[edge].target; }
+
+    EdgeDataT &GetEdgeData(const EdgeIterator edge) { return edge_list[edge].data; }
+
+    const EdgeDataT &GetEdgeData(const EdgeIterator edge) const { return edge_list[edge].data; }
+
+    EdgeRange GetAdjacentEdgeRange(const NodeIterator node) const
+    {
+        return util::irange(node_array[node].first_edge,
+                            node_array[node].first_edge + node_array[node].edges);
+    }
+
+    // Returns the first edge (from, to) or SPECIAL_EDGEID
+    EdgeIterator FindEdge(const NodeIterator from, const NodeIterator to) const
+    {
+        for (const auto edge : GetAdjacentEdgeRange(from))
+        {
+            if (edge_list[edge].target == to)
+            {
+                return edge;
+            }
+        }
+        return SPECIAL_EDGEID;
+    }
+
+    // Removes all edges (source, target). Safe to call in parallel for different sources.
+    unsigned DeleteEdgesTo(const NodeIterator source, const NodeIterator target)
+    {
+        Node &node = node_array[source];
+        const auto begin = edge_list.begin() + node.first_edge;
+        const auto end = begin + node.edges;
+        const auto new_end = std::remove_if(
+            begin, end, [target](const Edge &edge) { return edge.target == target; });
+
+        const unsigned deleted = std::distance(new_end, end);
+        node.edges -= deleted;
+        number_of_edges -= deleted;
+        return deleted;
+    }
+
+    // Inserts a list of edges sorted by source. A new edge that has the same target and
+    // directions as an existing shortcut, but a smaller distance, replaces that shortcut.
+    // Returns the number of edges that were added, replacements are not counted.
+    unsigned InsertEdges(const std::vector<InputEdge> &edges)
+    {
+        if (edges.empty())
+        {
+            return 0;
+        }
+        const unsigned number_of_edges_before = number_of_edges;
+        BOOST_ASSERT(std::is_sorted(edges.begin(), edges.end()));
+
+        std::vector<std::size_t> group_begin;
+        for (const auto index : util::irange<std::size_t>(0UL, edges.size()))
+        {
+            if (index == 0 || edges[index - 1].source != edges[index].source)
+            {
+                group_begin.push_back(index);
+            }
+        }
+        group_begin.push_back(edges.size());
+        const auto number_of_groups = group_begin.size() - 1;
+
+        if (number_of_unused_edges > edge_list.size() / 2)
+        {
+            Compact();
+        }
+
+        // Give every block that can not take all of its new edges a new place at the end
+        std::vector<std::pair<NodeIterator, EdgeIterator>> moved_blocks;
+        std::size_t new_size = edge_list.size();
+        for (const auto group : util::irange<std::size_t>(0UL, number_of_groups))
+        {
+            const auto source = edges[group_begin[group]].source;
+            Node &node = node_array[source];
+            const unsigned required = node.edges + (group_begin[group + 1] - group_begin[group]);
+            if (required > node.capacity)
+            {
+                moved_blocks.emplace_back(source, node.first_edge);
+                number_of_unused_edges += node.capacity;
+                node.first_edge = new_size;
+                node.capacity = required + required / 2;
+                new_size += node.capacity;
+            }
+        }
+        edge_list.resize(new_size);
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, moved_blocks.size()),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    const Node &node = node_array[moved_blocks[index].first];
+                    const auto old_begin = edge_list.begin() + moved_blocks[index].second;
+                    std::copy(old_begin, old_begin + node.edges,
+                              edge_list.begin() + node.first_edge);
+                }
+            });
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, number_of_groups),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto group = range.begin(); group != range.end(); ++group)
+                {
+                    Node &node = node_array[edges[group_begin[group]].source];
+                    unsigned inserted = 0;
+                    for (auto index = group_begin[group]; index != group_begin[group + 1];
+                         ++index)
+                    {
+                        const InputEdge &edge = edges[index];
+                        const auto current_edge = FindEdge(edge.source, edge.target);
+                        if (current_edge != SPECIAL_EDGEID)
+                        {
+                            EdgeDataT &current_data = edge_list[current_edge].data;
+                            if (current_data.shortcut &&
+                                edge.data.forward == current_data.forward &&
+                                edge.data.backward == current_data.backward &&
+                                edge.data.distance < current_data.distance)
+                            {
+                                // found a duplicate edge with smaller weight, update it.
+                                current_data = edge.data;
+                                continue;
+                            }
+                        }
+                        BOOST_ASSERT(node.edges < node.capacity);
+                        Edge &new_edge = edge_list[node.first_edge + node.edges];
+                        new_edge.target = edge.target;
+                        new_edge.data = edge.data;
+                        ++node.edges;
+                        ++inserted;
+                    }
+                    number_of_edges += inserted;
+                }
+            });
+        return number_of_edges - number_of_edges_before;
+    }
+
+    // Keeps only the nodes with a new id and renumbers them. All remaining edges have to point
+    // to kept nodes. The kept blocks are closed up in place, ordered by their position in the
+    // edge array, so a block is never overwritten before it has been moved. Only the final
+    // shrink copies the remaining edges once, the graph is never held twice.
+    void Renumber(const std::vector<NodeIterator> &new_node_ids,
+                  const NodeIterator number_of_new_nodes)
+    {
+        BOOST_ASSERT(new_node_ids.size() == node_array.size());
+
+        std::vector<NodeIterator> kept_nodes;
+        kept_nodes.reserve(number_of_new_nodes);
+        for (const auto node : util::irange<NodeIterator>(0, node_array.size()))
+        {
+            if (new_node_ids[node] != SPECIAL_NODEID)
+            {
+                kept_nodes.push_back(node);
+            }
+        }
+        BOOST_ASSERT(kept_nodes.size() == number_of_new_nodes);
+        std::sort(kept_nodes.begin(),
+                  kept_nodes.end(),
+                  [this](const NodeIterator lhs, const NodeIterator rhs) {
+                      return node_array[lhs].first_edge < node_array[rhs].first_edge;
+                  });
+
+        std::vector<Node> new_node_array(number_of_new_nodes);
+        EdgeIterator position = 0;
+        for (const auto node : kept_nodes)
+        {
+            const Node &old_node = node_array[node];
+            BOOST_ASSERT(position <= old_node.first_edge);
+            const auto begin = edge_list.begin() + old_node.first_edge;
+            std::move(begin, begin + old_node.edges, edge_list.begin() + position);
+
+            Node &new_node = new_node_array[new_node_ids[node]];
+            new_node.first_edge = position;
+            new_node.edges = old_node.edges;
+            new_node.capacity = old_node.edges;
+            position += old_node.edges;
+        }
+        node_array.swap(new_node_array);
+        new_node_array.clear();
+        new_node_array.shrink_to_fit();
+        edge_list.resize(position);
+        edge_list.shrink_to_fit();
+        number_of_edges = position;
+        number_of_unused_edges = 0;
+
+        // Keep the order of a graph that was constructed from edges sorted by (source, target)
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, node_array.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              for (auto node = range.begin(); node != range.end(); ++node)
+                              {
+                                  const auto begin =
+                                      edge_list.begin() + node_array[node].first_edge;
+                                  const auto end = begin + node_array[node].edges;
+                                  std::for_each(begin, end, [&](Edge &edge) {
+                                      BOOST_ASSERT(new_node_ids[edge.target] != SPECIAL_NODEID);
+                                      edge.target = new_node_ids[edge.target];
+                                  });
+                                  std::sort(begin, end, [](const Edge &lhs, const Edge &rhs) {
+                                      return lhs.target < rhs.target;
+                                  });
+                              }
+                          });
+    }
+
+  private:
+    struct Node
+    {
+        Node() : first_edge(0), edges(0), capacity(0) {}
+
+        EdgeIterator first_edge;
+        unsigned edges;
+        unsigned capacity;
+    };
+
+    struct Edge
+    {
+        NodeIterator target;
+        EdgeDataT data;
+    };
+
+    // Closes the gaps that moved blocks left behind
+    void Compact()
+    {
+        std::vector<EdgeIterator> new_first_edge(node_array.size());
+        EdgeIterator position = 0;
+        for (const auto node : util::irange<std::size_t>(0UL, node_array.size()))
+        {
+            new_first_edge[node] = position;
+            position += node_array[node].capacity;
+        }
+
+        std::vector<Edge> new_edge_list(position);
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, node_array.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              for (auto node = range.begin(); node != range.end(); ++node)
+                              {
+                                  const auto begin =
+                                      edge_list.begin() + node_array[node].first_edge;
+                                  std::copy(begin, begin + node_array[node].edges,
+                                            new_edge_list.begin() + new_first_edge[node]);
+                                  node_array[node].first_edge = new_first_edge[node];
+                              }
+                          });
+        edge_list.swap(new_edge_list);
+        number_of_unused_edges = 0;
+    }
+
+    std::vector<Node> node_array;
+    std::vector<Edge> edge_list;
+    std::atomic<unsigned> number_of_edges;
+    std::size_t number_of_unused_edges;
+};
+}
+}
+
+#endif // OSRM_CONTRACTOR_CONTRACTOR_GRAPH_HPP
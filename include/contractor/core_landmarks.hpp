@@ -0,0 +1,285 @@
+#ifndef OSRM_CONTRACTOR_CORE_LANDMARKS_HPP
+#define OSRM_CONTRACTOR_CORE_LANDMARKS_HPP
+
+#include "contractor/query_edge.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/exception.hpp"
+#include "util/integer_range.hpp"
+#include "util/simple_logger.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+/*
+ * Landmarks for the A* search on the uncontracted core of the hierarchy.
+ *
+ * The landmarks are picked one after another as the core node that is farthest away from all
+ * landmarks picked so far. For every core node the distances from and to all landmarks are
+ * stored, which gives lower bounds on the distance between any two core nodes by the triangle
+ * inequality.
+ *
+ * File layout (.landmarks):
+ *   uint32 number of landmarks K, uint32 number of nodes N
+ *   NodeID landmarks[K]
+ *   uint32 core bits[N / 32 + 1], uint32 number of core nodes before each word[N / 32 + 1]
+ *   EdgeWeight distances[number of core nodes][2 * K], for every core node in id order first
+ *   the distances from the K landmarks, then the distances to the K landmarks
+ * Unreachable pairs are stored as INVALID_EDGE_WEIGHT.
+ */
+class CoreLandmarks
+{
+  public:
+    CoreLandmarks(const std::vector<bool> &is_core_node,
+                  const util::DeallocatingVector<QueryEdge> &contracted_edge_list)
+        : number_of_nodes(is_core_node.size())
+    {
+        const auto number_of_words = number_of_nodes / 32 + 1;
+        core_bits.resize(number_of_words, 0);
+        core_ranks.resize(number_of_words, 0);
+        core_rank_of_node.resize(number_of_nodes, SPECIAL_NODEID);
+
+        std::uint32_t rank = 0;
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            if (node % 32 == 0)
+            {
+                core_ranks[node / 32] = rank;
+            }
+            if (is_core_node[node])
+            {
+                core_bits[node / 32] |= 1u << (node % 32);
+                core_rank_of_node[node] = rank++;
+                core_nodes.push_back(node);
+            }
+        }
+        if (number_of_nodes % 32 == 0)
+        {
+            core_ranks.back() = rank;
+        }
+
+        if (core_nodes.empty())
+        {
+            return;
+        }
+
+        // An edge between two core nodes can be used in either direction that is flagged
+        std::vector<Arc> forward_arcs;
+        std::vector<Arc> backward_arcs;
+        for (const auto &edge : contracted_edge_list)
+        {
+            const auto source = core_rank_of_node[edge.source];
+            const auto target = core_rank_of_node[edge.target];
+            if (source == SPECIAL_NODEID || target == SPECIAL_NODEID || source == target)
+            {
+                continue;
+            }
+            if (edge.data.forward)
+            {
+                forward_arcs.push_back(Arc{source, target, edge.data.distance});
+                backward_arcs.push_back(Arc{target, source, edge.data.distance});
+            }
+            if (edge.data.backward)
+            {
+                forward_arcs.push_back(Arc{target, source, edge.data.distance});
+                backward_arcs.push_back(Arc{source, target, edge.data.distance});
+            }
+        }
+        forward_graph = BuildGraph(forward_arcs);
+        backward_graph = BuildGraph(backward_arcs);
+    }
+
+    NodeID GetNumberOfCoreNodes() const { return core_nodes.size(); }
+
+    void Compute(const unsigned requested_landmarks)
+    {
+        const auto number_of_core_nodes = GetNumberOfCoreNodes();
+        const auto number_of_landmarks =
+            static_cast<unsigned>(std::min<std::size_t>(requested_landmarks, number_of_core_nodes));
+
+        landmarks.clear();
+        std::vector<std::vector<EdgeWeight>> from_landmark;
+        if (number_of_landmarks > 0)
+        {
+            // Start with the node that is farthest away from an arbitrary core node. Nodes that
+            // no landmark reaches count as the farthest ones, so that the landmarks cover all
+            // components of the core even if the first node reaches none of the others.
+            auto min_distance = Dijkstra(forward_graph, 0);
+            while (landmarks.size() < number_of_landmarks)
+            {
+                NodeID farthest = 0;
+                EdgeWeight farthest_distance = -1;
+                for (const auto rank : util::irange<NodeID>(0, number_of_core_nodes))
+                {
+                    if (min_distance[rank] > farthest_distance)
+                    {
+                        farthest = rank;
+                        farthest_distance = min_distance[rank];
+                    }
+                }
+                if (farthest_distance <= 0)
+                {
+                    // every node already is a landmark or at distance 0 from one
+                    break;
+                }
+                landmarks.push_back(farthest);
+
+                from_landmark.push_back(Dijkstra(forward_graph, farthest));
+                for (const auto rank : util::irange<NodeID>(0, number_of_core_nodes))
+                {
+                    min_distance[rank] = std::min(min_distance[rank], from_landmark.back()[rank]);
+                }
+            }
+        }
+
+        std::vector<std::vector<EdgeWeight>> to_landmark(landmarks.size());
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, landmarks.size(), 1),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  to_landmark[index] =
+                                      Dijkstra(backward_graph, landmarks[index]);
+                              }
+                          });
+
+        const auto number_of_found_landmarks = static_cast<unsigned>(landmarks.size());
+        if (number_of_found_landmarks == 0)
+        {
+            distances.clear();
+            return;
+        }
+        distances.resize(static_cast<std::size_t>(number_of_core_nodes) * 2 *
+                         number_of_found_landmarks);
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_core_nodes),
+                          [&](const tbb::blocked_range<NodeID> &range) {
+                              for (auto rank = range.begin(); rank != range.end(); ++rank)
+                              {
+                                  auto *row = &distances[static_cast<std::size_t>(rank) * 2 *
+                                                         number_of_found_landmarks];
+                                  for (const auto index :
+                                       util::irange(0u, number_of_found_landmarks))
+                                  {
+                                      row[index] = from_landmark[index][rank];
+                                      row[number_of_found_landmarks + index] =
+                                          to_landmark[index][rank];
+                                  }
+                              }
+                          });
+    }
+
+    void Write(const std::string &path) const
+    {
+        boost::filesystem::ofstream output_stream(path, std::ios::binary);
+        if (!output_stream)
+        {
+            throw util::exception("Could not open " + path + " for writing.");
+        }
+
+        const std::uint32_t number_of_landmarks = landmarks.size();
+        const std::uint32_t number_of_nodes_in_file = number_of_nodes;
+        output_stream.write((char *)&number_of_landmarks, sizeof(std::uint32_t));
+        output_stream.write((char *)&number_of_nodes_in_file, sizeof(std::uint32_t));
+        for (const auto rank : landmarks)
+        {
+            const NodeID node = core_nodes[rank];
+            output_stream.write((char *)&node, sizeof(NodeID));
+        }
+        output_stream.write((char *)core_bits.data(), sizeof(std::uint32_t) * core_bits.size());
+        output_stream.write((char *)core_ranks.data(), sizeof(std::uint32_t) * core_ranks.size());
+        output_stream.write((char *)distances.data(), sizeof(EdgeWeight) * distances.size());
+    }
+
+  private:
+    struct Arc
+    {
+        NodeID source;
+        NodeID target;
+        EdgeWeight weight;
+    };
+
+    struct Graph
+    {
+        std::vector<std::size_t> first_arc;
+        std::vector<std::pair<NodeID, EdgeWeight>> arcs;
+    };
+
+    Graph BuildGraph(std::vector<Arc> &arcs) const
+    {
+        std::sort(arcs.begin(), arcs.end(),
+                  [](const Arc &lhs, const Arc &rhs) { return lhs.source < rhs.source; });
+
+        Graph graph;
+        graph.first_arc.resize(GetNumberOfCoreNodes() + 1, 0);
+        graph.arcs.reserve(arcs.size());
+        for (const auto &arc : arcs)
+        {
+            ++graph.first_arc[arc.source + 1];
+            graph.arcs.emplace_back(arc.target, arc.weight);
+        }
+        std::partial_sum(graph.first_arc.begin(), graph.first_arc.end(), graph.first_arc.begin());
+        return graph;
+    }
+
+    std::vector<EdgeWeight> Dijkstra(const Graph &graph, const NodeID source) const
+    {
+        using QueueEntry = std::pair<EdgeWeight, NodeID>;
+        std::vector<EdgeWeight> distance(GetNumberOfCoreNodes(), INVALID_EDGE_WEIGHT);
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+        distance[source] = 0;
+        queue.emplace(0, source);
+        while (!queue.empty())
+        {
+            const auto entry = queue.top();
+            queue.pop();
+            if (entry.first > distance[entry.second])
+            {
+                continue;
+            }
+            for (auto arc = graph.first_arc[entry.second]; arc < graph.first_arc[entry.second + 1];
+                 ++arc)
+            {
+                const auto target = graph.arcs[arc].first;
+                const auto new_distance = entry.first + graph.arcs[arc].second;
+                if (new_distance < distance[target])
+                {
+                    distance[target] = new_distance;
+                    queue.emplace(new_distance, target);
+                }
+            }
+        }
+        return distance;
+    }
+
+    NodeID number_of_nodes;
+    std::vector<std::uint32_t> core_bits;
+    std::vector<std::uint32_t> core_ranks;
+    std::vector<NodeID> core_rank_of_node;
+    std::vector<NodeID> core_nodes;
+    Graph forward_graph;
+    Graph backward_graph;
+    // core ranks of the landmarks
+    std::vector<NodeID> landmarks;
+    std::vector<EdgeWeight> distances;
+};
+}
+}
+
+#endif // OSRM_CONTRACTOR_CORE_LANDMARKS_HPP
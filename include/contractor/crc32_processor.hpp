@@ -1,110 +1,162 @@
 #ifndef ITERATOR_BASED_CRC32_H
 #define ITERATOR_BASED_CRC32_H
 
-#if defined(__x86_64__) && !defined(__MINGW64__)
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__MINGW64__)
 #include <cpuid.h>
+#include <nmmintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <nmmintrin.h>
 #endif
 
-#include <boost/crc.hpp> // for boost::crc_32_type
+#include "util/integer_range.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
+#include <vector>
 
 namespace osrm
 {
 namespace contractor
 {
 
-class IteratorbasedCRC32
+// All checksums are CRC-32C (Castagnoli) without initial value and final xor, which is what the
+// SSE4.2 crc32 instruction computes.
+namespace detail
 {
-  public:
-    bool UsingHardware() const { return use_hardware_implementation; }
-
-    IteratorbasedCRC32() : crc(0) { use_hardware_implementation = DetectHardwareSupport(); }
+const constexpr std::uint32_t CRC32C_POLYNOMIAL = 0x82F63B78; // reflected
 
-    template <class Iterator> unsigned operator()(Iterator iter, const Iterator end)
+// Tables for processing eight bytes per step ("slice-by-8")
+struct SliceBy8Tables
+{
+    SliceBy8Tables()
     {
-        unsigned crc = 0;
-        while (iter != end)
+        for (std::uint32_t byte = 0; byte < 256; ++byte)
         {
-            using value_type = typename std::iterator_traits<Iterator>::value_type;
-            const char *data = reinterpret_cast<const char *>(&(*iter));
-
-            if (use_hardware_implementation)
+            std::uint32_t crc = byte;
+            for (int bit = 0; bit < 8; ++bit)
             {
-                crc = ComputeInHardware(data, sizeof(value_type));
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLYNOMIAL : 0);
             }
-            else
+            table[0][byte] = crc;
+        }
+        for (std::uint32_t byte = 0; byte < 256; ++byte)
+        {
+            for (int slice = 1; slice < 8; ++slice)
             {
-                crc = ComputeInSoftware(data, sizeof(value_type));
+                const auto previous = table[slice - 1][byte];
+                table[slice][byte] = (previous >> 8) ^ table[0][previous & 0xff];
             }
-            ++iter;
         }
-        return crc;
     }
 
-  private:
-    bool DetectHardwareSupport() const
-    {
-        static const int sse42_bit = 0x00100000;
-        const unsigned ecx = cpuid();
-        const bool sse42_found = (ecx & sse42_bit) != 0;
-        return sse42_found;
-    }
+    std::uint32_t table[8][256];
+};
 
-    unsigned ComputeInSoftware(const char *str, unsigned len)
+inline std::uint32_t ComputeInSoftware(std::uint32_t crc, const char *data, std::size_t length)
+{
+    static const SliceBy8Tables tables;
+    const auto &table = tables.table;
+
+    // the words are read in little endian order like all other OSRM data
+    while (length >= 8)
     {
-        crc_processor.process_bytes(str, len);
-        return crc_processor.checksum();
+        std::uint32_t low, high;
+        std::memcpy(&low, data, sizeof(low));
+        std::memcpy(&high, data + sizeof(low), sizeof(high));
+        low ^= crc;
+        crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^ table[5][(low >> 16) & 0xff] ^
+              table[4][low >> 24] ^ table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^
+              table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+        data += 8;
+        length -= 8;
     }
-
-    // adapted from http://byteworm.com/2010/10/13/crc32/
-    unsigned ComputeInHardware(const char *str, unsigned len)
+    while (length--)
     {
-#if defined(__x86_64__)
-        unsigned q = len / sizeof(unsigned);
-        unsigned r = len % sizeof(unsigned);
-        unsigned *p = (unsigned *)str;
-
-        // crc=0;
-        while (q--)
-        {
-            __asm__ __volatile__(".byte 0xf2, 0xf, 0x38, 0xf1, 0xf1;"
-                                 : "=S"(crc)
-                                 : "0"(crc), "c"(*p));
-            ++p;
-        }
-
-        str = reinterpret_cast<char *>(p);
-        while (r--)
-        {
-            __asm__ __volatile__(".byte 0xf2, 0xf, 0x38, 0xf1, 0xf1;"
-                                 : "=S"(crc)
-                                 : "0"(crc), "c"(*str));
-            ++str;
-        }
-#endif
-        return crc;
+        crc = table[0][(crc ^ static_cast<unsigned char>(*data++)) & 0xff] ^ (crc >> 8);
     }
+    return crc;
+}
 
-    inline unsigned cpuid() const
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__MINGW64__)
+__attribute__((target("sse4.2")))
+#endif
+inline std::uint32_t ComputeInHardware(std::uint32_t crc, const char *data, std::size_t length)
+{
+#if (defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__MINGW64__)) || \
+    (defined(_MSC_VER) && defined(_M_X64))
+    std::uint64_t crc64 = crc;
+    while (length >= 8)
     {
-        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
-        // on X64 this calls hardware cpuid(.) instr. otherwise a dummy impl.
-        __get_cpuid(1, &eax, &ebx, &ecx, &edx);
-        return ecx;
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        length -= 8;
     }
-
-#if defined(__MINGW64__) || defined(_MSC_VER) || !defined(__x86_64__)
-    inline void
-    __get_cpuid(int param, unsigned *eax, unsigned *ebx, unsigned *ecx, unsigned *edx) const
+    crc = static_cast<std::uint32_t>(crc64);
+    while (length--)
     {
-        *ecx = 0;
+        crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*data++));
     }
+    return crc;
+#else
+    return ComputeInSoftware(crc, data, length);
 #endif
+}
 
-    boost::crc_optimal<32, 0x1EDC6F41, 0x0, 0x0, true, true> crc_processor;
-    unsigned crc;
-    bool use_hardware_implementation;
+inline bool DetectHardwareSupport()
+{
+    static const unsigned sse42_bit = 0x00100000;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__MINGW64__)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & sse42_bit) != 0;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    int info[4];
+    __cpuid(info, 1);
+    return (static_cast<unsigned>(info[2]) & sse42_bit) != 0;
+#else
+    return false;
+#endif
+}
+
+inline bool UseHardware()
+{
+    static const bool use_hardware = DetectHardwareSupport();
+    return use_hardware;
+}
+}
+
+// Continues the checksum crc with length bytes, using the crc32 instruction if the CPU has it
+inline unsigned ComputeCRC32(const unsigned crc, const void *data, const std::size_t length)
+{
+    const auto bytes = static_cast<const char *>(data);
+    return detail::UseHardware() ? detail::ComputeInHardware(crc, bytes, length)
+                                 : detail::ComputeInSoftware(crc, bytes, length);
+}
+
+class IteratorbasedCRC32
+{
+  public:
+    bool UsingHardware() const { return detail::UseHardware(); }
+
+    template <class Iterator> unsigned operator()(Iterator iter, const Iterator end)
+    {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        unsigned crc = 0;
+        while (iter != end)
+        {
+            crc = ComputeCRC32(crc, &(*iter), sizeof(value_type));
+            ++iter;
+        }
+        return crc;
+    }
 };
 
 struct RangebasedCRC32
@@ -119,6 +171,119 @@ struct RangebasedCRC32
   private:
     IteratorbasedCRC32 crc32;
 };
+
+namespace detail
+{
+inline std::uint32_t gf2MatrixTimes(const std::uint32_t *matrix, std::uint32_t vector)
+{
+    std::uint32_t sum = 0;
+    while (vector)
+    {
+        if (vector & 1)
+        {
+            sum ^= *matrix;
+        }
+        vector >>= 1;
+        ++matrix;
+    }
+    return sum;
+}
+
+inline void gf2MatrixSquare(std::uint32_t *square, const std::uint32_t *matrix)
+{
+    for (int n = 0; n < 32; ++n)
+    {
+        square[n] = gf2MatrixTimes(matrix, matrix[n]);
+    }
+}
+}
+
+// Returns the checksum of the concatenation of two blocks from the checksums of the blocks.
+// Appending zero bytes is a linear operator on the checksum, so the first checksum is multiplied
+// by that operator raised to the length of the second block (see zlib's crc32_combine).
+inline unsigned
+CombineCRC32(unsigned first_crc, const unsigned second_crc, std::size_t second_length)
+{
+    if (second_length == 0)
+    {
+        return first_crc ^ second_crc;
+    }
+
+    std::uint32_t even[32]; // operator for an even number of zero bits
+    std::uint32_t odd[32];  // operator for an odd number of zero bits
+
+    // one zero bit
+    odd[0] = detail::CRC32C_POLYNOMIAL;
+    std::uint32_t row = 1;
+    for (int n = 1; n < 32; ++n)
+    {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    detail::gf2MatrixSquare(even, odd); // two zero bits
+    detail::gf2MatrixSquare(odd, even); // four zero bits
+
+    // the first squaring gives the operator for one zero byte
+    do
+    {
+        detail::gf2MatrixSquare(even, odd);
+        if (second_length & 1)
+        {
+            first_crc = detail::gf2MatrixTimes(even, first_crc);
+        }
+        second_length >>= 1;
+        if (second_length == 0)
+        {
+            break;
+        }
+
+        detail::gf2MatrixSquare(odd, even);
+        if (second_length & 1)
+        {
+            first_crc = detail::gf2MatrixTimes(odd, first_crc);
+        }
+        second_length >>= 1;
+    } while (second_length != 0);
+
+    return first_crc ^ second_crc;
+}
+
+// Computes the checksum of a contiguous block of memory in parallel. The block is split into
+// chunks of a fixed size whose checksums are combined in order, so the result is the same as the
+// one of a single pass and does not depend on the number of threads.
+inline unsigned ParallelCRC32(const void *data, const std::size_t number_of_bytes)
+{
+    const constexpr std::size_t CHUNK_SIZE = 1 << 20; // bytes
+
+    const auto bytes = static_cast<const char *>(data);
+    const std::size_t number_of_chunks = (number_of_bytes + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    std::vector<unsigned> chunk_crcs(number_of_chunks);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_chunks),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto chunk = range.begin(); chunk != range.end(); ++chunk)
+                          {
+                              const auto begin = chunk * CHUNK_SIZE;
+                              const auto end = std::min(number_of_bytes, begin + CHUNK_SIZE);
+                              chunk_crcs[chunk] = ComputeCRC32(0, bytes + begin, end - begin);
+                          }
+                      });
+
+    unsigned crc = 0;
+    for (const auto chunk : util::irange<std::size_t>(0, number_of_chunks))
+    {
+        const auto begin = chunk * CHUNK_SIZE;
+        const auto end = std::min(number_of_bytes, begin + CHUNK_SIZE);
+        crc = CombineCRC32(crc, chunk_crcs[chunk], end - begin);
+    }
+    return crc;
+}
+
+template <typename T> unsigned ParallelCRC32(const std::vector<T> &elements)
+{
+    return ParallelCRC32(elements.data(), elements.size() * sizeof(T));
+}
 }
 }
 
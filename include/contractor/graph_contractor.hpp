@@ -1,24 +1,23 @@
 #ifndef GRAPH_CONTRACTOR_HPP
 #define GRAPH_CONTRACTOR_HPP
 
-#include "util/binary_heap.hpp"
-#include "util/deallocating_vector.hpp"
-#include "util/dynamic_graph.hpp"
-#include "util/percent.hpp"
+#include "contractor/contractor_graph.hpp"
 #include "contractor/query_edge.hpp"
-#include "util/xor_fast_hash.hpp"
-#include "util/xor_fast_hash_storage.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/external_vector.hpp"
 #include "util/integer_range.hpp"
+#include "util/percent.hpp"
 #include "util/simple_logger.hpp"
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
+#include "util/witness_heap.hpp"
+#include "util/xor_fast_hash.hpp"
 
 #include <boost/assert.hpp>
 
-#include <stxxl/vector>
-
 #include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_scan.h>
 #include <tbb/parallel_sort.h>
 
 #include <algorithm>
@@ -31,6 +30,18 @@ namespace osrm
 namespace contractor
 {
 
+// What happened in one round of contraction, i.e. for one independent node set
+struct ContractionRoundStats
+{
+    unsigned level;
+    NodeID remaining_nodes;
+    NodeID contracted_nodes;
+    // edges added to the graph, every shortcut is stored at both of its nodes
+    std::size_t shortcut_edges;
+    std::size_t priority_updates;
+    double seconds;
+};
+
 class GraphContractor
 {
   private:
@@ -54,12 +65,16 @@ class GraphContractor
         }
         unsigned distance;
         unsigned id;
+        // all bit fields share one type, otherwise MSVC starts a new word for the flags and the
+        // struct takes 16 instead of 12 bytes
         unsigned originalEdges : 28;
-        bool shortcut : 1;
-        bool forward : 1;
-        bool backward : 1;
-        bool is_original_via_node_ID : 1;
-    } data;
+        unsigned shortcut : 1;
+        unsigned forward : 1;
+        unsigned backward : 1;
+        unsigned is_original_via_node_ID : 1;
+    };
+    static_assert(sizeof(ContractorEdgeData) == 12,
+                  "ContractorEdgeData should have the same size with all compilers");
 
     struct ContractorHeapData
     {
@@ -70,15 +85,8 @@ class GraphContractor
         bool target = false;
     };
 
-    using ContractorGraph = util::DynamicGraph<ContractorEdgeData>;
-    //    using ContractorHeap = util::BinaryHeap<NodeID, NodeID, int, ContractorHeapData,
-    //    ArrayStorage<NodeID, NodeID>
-    //    >;
-    using ContractorHeap = util::BinaryHeap<NodeID,
-                                            NodeID,
-                                            int,
-                                            ContractorHeapData,
-                                            util::XORFastHashStorage<NodeID, NodeID>>;
+    using ContractorGraph = contractor::ContractorGraph<ContractorEdgeData>;
+    using ContractorHeap = util::WitnessHeap<NodeID, int, ContractorHeapData>;
     using ContractorEdge = ContractorGraph::InputEdge;
 
     struct ContractorThreadData
@@ -86,7 +94,7 @@ class GraphContractor
         ContractorHeap heap;
         std::vector<ContractorEdge> inserted_edges;
         std::vector<NodeID> neighbours;
-        explicit ContractorThreadData(NodeID nodes) : heap(nodes) {}
+        std::size_t priority_updates = 0;
     };
 
     using NodeDepth = int;
@@ -111,23 +119,60 @@ class GraphContractor
         bool is_independent : 1;
     };
 
-    struct ThreadDataContainer
+    // Parallel prefix sum over the nodes that are not independent
+    class DependentNodesScan
     {
-        explicit ThreadDataContainer(int number_of_nodes) : number_of_nodes(number_of_nodes) {}
+      public:
+        DependentNodesScan(const std::vector<RemainingNodeData> &remaining_nodes,
+                           std::vector<std::size_t> &dependent_before)
+            : sum(0), remaining_nodes(remaining_nodes), dependent_before(dependent_before)
+        {
+        }
+
+        DependentNodesScan(DependentNodesScan &other, tbb::split)
+            : sum(0), remaining_nodes(other.remaining_nodes),
+              dependent_before(other.dependent_before)
+        {
+        }
+
+        template <typename Tag>
+        void operator()(const tbb::blocked_range<std::size_t> &range, Tag)
+        {
+            for (auto index = range.begin(); index != range.end(); ++index)
+            {
+                if (Tag::is_final_scan())
+                {
+                    dependent_before[index] = sum;
+                }
+                sum += remaining_nodes[index].is_independent ? 0 : 1;
+            }
+        }
+
+        void reverse_join(DependentNodesScan &left) { sum += left.sum; }
+
+        void assign(DependentNodesScan &other) { sum = other.sum; }
+
+        std::size_t sum;
+
+      private:
+        const std::vector<RemainingNodeData> &remaining_nodes;
+        std::vector<std::size_t> &dependent_before;
+    };
 
+    struct ThreadDataContainer
+    {
         inline ContractorThreadData *GetThreadData()
         {
             bool exists = false;
             auto &ref = data.local(exists);
             if (!exists)
             {
-                ref = std::make_shared<ContractorThreadData>(number_of_nodes);
+                ref = std::make_shared<ContractorThreadData>();
             }
 
             return ref.get();
         }
 
-        int number_of_nodes;
         using EnumerableThreadData =
             tbb::enumerable_thread_specific<std::shared_ptr<ContractorThreadData>>;
         EnumerableThreadData data;
@@ -250,7 +295,15 @@ class GraphContractor
         util::SimpleLogger().Write() << "contractor finished initalization";
     }
 
-    void Run(double core_factor = 1.0)
+    // With lazy priority updates the neighbours of contracted nodes are only marked, and their
+    // priorities are recomputed once they become candidates for an independent set.
+    //
+    // Every flush moves the edges of contracted nodes to external memory and renumbers the
+    // remaining graph. The first flush happens at 65% of the contracted nodes and every further
+    // stage once 35% of the nodes of the previous one are left.
+    void Run(double core_factor = 1.0,
+             bool lazy_priority_updates = false,
+             unsigned flush_stages = 1)
     {
         // for the preperation we can use a big grain size, which is much faster (probably cache)
         const constexpr size_t InitGrainSize = 100000;
@@ -258,7 +311,6 @@ class GraphContractor
         // auto_partitioner will automatically increase the blocksize if we have
         // a lot of data. It is *important* for the last loop iterations
         // (which have a very small dataset) that it is devisible.
-        const constexpr size_t IndependentGrainSize = 1;
         const constexpr size_t ContractGrainSize = 1;
         const constexpr size_t NeighboursGrainSize = 1;
         const constexpr size_t DeleteGrainSize = 1;
@@ -266,12 +318,15 @@ class GraphContractor
         const NodeID number_of_nodes = contractor_graph->GetNumberOfNodes();
         util::Percent p(number_of_nodes);
 
-        ThreadDataContainer thread_data_list(number_of_nodes);
+        ThreadDataContainer thread_data_list;
 
         NodeID number_of_contracted_nodes = 0;
         std::vector<NodeDepth> node_depth;
         std::vector<float> node_priorities;
+        // priorities that have to be recomputed before the node can be contracted
+        std::vector<char> is_dirty;
         is_core_node.resize(number_of_nodes, false);
+        round_stats.clear();
 
         std::vector<RemainingNodeData> remaining_nodes(number_of_nodes);
         // initialize priorities in parallel
@@ -296,6 +351,10 @@ class GraphContractor
             node_depth.resize(number_of_nodes, 0);
             node_priorities.resize(number_of_nodes);
             node_levels.resize(number_of_nodes);
+            if (lazy_priority_updates)
+            {
+                is_dirty.resize(number_of_nodes, false);
+            }
 
             std::cout << "initializing elimination PQ ..." << std::flush;
             tbb::parallel_for(tbb::blocked_range<int>(0, number_of_nodes, PQGrainSize),
@@ -317,16 +376,18 @@ class GraphContractor
 
         unsigned current_level = 0;
         bool flushed_contractor = false;
+        unsigned number_of_flushes = 0;
+        // Every flush happens once 35% of the nodes of the previous flush are left
+        double remaining_fraction_at_flush = 0.35;
         while (number_of_nodes > 2 &&
                number_of_contracted_nodes < static_cast<NodeID>(number_of_nodes * core_factor))
         {
-            if (!flushed_contractor && (number_of_contracted_nodes >
-                                        static_cast<NodeID>(number_of_nodes * 0.65 * core_factor)))
+            TIMER_START(round);
+            if (number_of_flushes < flush_stages &&
+                (number_of_contracted_nodes >
+                 static_cast<NodeID>(number_of_nodes * (1 - remaining_fraction_at_flush) *
+                                     core_factor)))
             {
-                util::DeallocatingVector<ContractorEdge>
-                    new_edge_set; // this one is not explicitely
-                                  // cleared since it goes out of
-                                  // scope anywa
                 std::cout << " [flush " << number_of_contracted_nodes << " nodes] " << std::flush;
 
                 // Delete old heap data to free memory that we need for the coming operations
@@ -335,12 +396,21 @@ class GraphContractor
                 // Create new priority array
                 std::vector<float> new_node_priority(remaining_nodes.size());
                 std::vector<EdgeWeight> new_node_weights(remaining_nodes.size());
-                // this map gives the old IDs from the new ones, necessary to get a consistent graph
-                // at the end of contraction
-                orig_node_id_from_new_node_id_map.resize(remaining_nodes.size());
-                // this map gives the new IDs from the old ones, necessary to remap targets from the
-                // remaining graph
-                std::vector<NodeID> new_node_id_from_orig_id_map(number_of_nodes, SPECIAL_NODEID);
+                std::vector<NodeDepth> new_node_depth(node_depth.empty() ? 0
+                                                                         : remaining_nodes.size());
+                std::vector<char> new_is_dirty(is_dirty.empty() ? 0 : remaining_nodes.size());
+                // this map gives the original IDs from the new ones, necessary to get a
+                // consistent graph at the end of contraction
+                std::vector<NodeID> new_orig_node_id_map(remaining_nodes.size());
+                // this map gives the new IDs from the current ones, necessary to remap targets
+                // from the remaining graph
+                std::vector<NodeID> new_node_id_from_current_id_map(
+                    contractor_graph->GetNumberOfNodes(), SPECIAL_NODEID);
+                const auto to_orig_node_id = [this](const NodeID node) {
+                    return orig_node_id_from_new_node_id_map.empty()
+                               ? node
+                               : orig_node_id_from_new_node_id_map[node];
+                };
 
                 for (const auto new_node_id : util::irange<std::size_t>(0UL, remaining_nodes.size()))
                 {
@@ -349,6 +419,14 @@ class GraphContractor
                     new_node_priority[new_node_id] = node_priorities[node.id];
                     BOOST_ASSERT(node_weights.size() > node.id);
                     new_node_weights[new_node_id] = node_weights[node.id];
+                    if (!new_node_depth.empty())
+                    {
+                        new_node_depth[new_node_id] = node_depth[node.id];
+                    }
+                    if (!new_is_dirty.empty())
+                    {
+                        new_is_dirty[new_node_id] = is_dirty[node.id];
+                    }
                 }
 
                 // build forward and backward renumbering map and remap ids in remaining_nodes
@@ -356,8 +434,8 @@ class GraphContractor
                 {
                     auto &node = remaining_nodes[new_node_id];
                     // create renumbering maps in both directions
-                    orig_node_id_from_new_node_id_map[new_node_id] = node.id;
-                    new_node_id_from_orig_id_map[node.id] = new_node_id;
+                    new_orig_node_id_map[new_node_id] = to_orig_node_id(node.id);
+                    new_node_id_from_current_id_map[node.id] = new_node_id;
                     node.id = new_node_id;
                 }
                 // walk over all nodes
@@ -369,30 +447,35 @@ class GraphContractor
                         ContractorGraph::EdgeData &data =
                             contractor_graph->GetEdgeData(current_edge);
                         const NodeID target = contractor_graph->GetTarget(current_edge);
-                        if (SPECIAL_NODEID == new_node_id_from_orig_id_map[source])
+                        // shortcuts of earlier stages already store original middle nodes
+                        if (!data.is_original_via_node_ID)
+                        {
+                            data.id = to_orig_node_id(data.id);
+                            data.is_original_via_node_ID = true;
+                        }
+                        if (SPECIAL_NODEID == new_node_id_from_current_id_map[source])
                         {
-                            external_edge_list.push_back({source, target, data});
+                            external_edge_list.push_back(
+                                {to_orig_node_id(source), to_orig_node_id(target), data});
                         }
                         else
                         {
-                            // node is not yet contracted.
-                            // add (renumbered) outgoing edges to new util::DynamicGraph.
-                            ContractorEdge new_edge = {new_node_id_from_orig_id_map[source],
-                                                       new_node_id_from_orig_id_map[target], data};
-
-                            new_edge.data.is_original_via_node_ID = true;
-                            BOOST_ASSERT_MSG(SPECIAL_NODEID != new_node_id_from_orig_id_map[source],
-                                             "new source id not resolveable");
-                            BOOST_ASSERT_MSG(SPECIAL_NODEID != new_node_id_from_orig_id_map[target],
+                            BOOST_ASSERT_MSG(SPECIAL_NODEID !=
+                                                 new_node_id_from_current_id_map[target],
                                              "new target id not resolveable");
-                            new_edge_set.push_back(new_edge);
                         }
                     }
                 }
 
+                // The edges of contracted nodes are in external memory now. The remaining
+                // graph is renumbered in place, so the old and the new graph never coexist.
+                contractor_graph->Renumber(new_node_id_from_current_id_map,
+                                           remaining_nodes.size());
+
                 // Delete map from old NodeIDs to new ones.
-                new_node_id_from_orig_id_map.clear();
-                new_node_id_from_orig_id_map.shrink_to_fit();
+                new_node_id_from_current_id_map.clear();
+                new_node_id_from_current_id_map.shrink_to_fit();
+                orig_node_id_from_new_node_id_map.swap(new_orig_node_id_map);
 
                 // Replace old priorities array by new one
                 node_priorities.swap(new_node_priority);
@@ -403,45 +486,45 @@ class GraphContractor
                 new_node_priority.shrink_to_fit();
 
                 node_weights.swap(new_node_weights);
-                // old Graph is removed
-                contractor_graph.reset();
+                node_depth.swap(new_node_depth);
+                is_dirty.swap(new_is_dirty);
 
-                // create new graph
-                tbb::parallel_sort(new_edge_set.begin(), new_edge_set.end());
-                contractor_graph =
-                    std::make_shared<ContractorGraph>(remaining_nodes.size(), new_edge_set);
-
-                new_edge_set.clear();
                 flushed_contractor = true;
-
-                // INFO: MAKE SURE THIS IS THE LAST OPERATION OF THE FLUSH!
-                // reinitialize heaps and ThreadData objects with appropriate size
-                thread_data_list.number_of_nodes = contractor_graph->GetNumberOfNodes();
+                ++number_of_flushes;
+                remaining_fraction_at_flush *= 0.35;
             }
 
-            tbb::parallel_for(
-                tbb::blocked_range<std::size_t>(0, remaining_nodes.size(), IndependentGrainSize),
-                [this, &node_priorities, &remaining_nodes,
-                 &thread_data_list](const tbb::blocked_range<std::size_t> &range)
-                {
-                    ContractorThreadData *data = thread_data_list.GetThreadData();
-                    // determine independent node set
-                    for (auto i = range.begin(), end = range.end(); i != end; ++i)
-                    {
-                        const NodeID node = remaining_nodes[i].id;
-                        remaining_nodes[i].is_independent =
-                            this->IsNodeIndependent(node_priorities, data, node);
-                    }
-                });
+            const NodeID number_of_remaining_nodes = remaining_nodes.size();
+            FindIndependentNodes(node_priorities, remaining_nodes, thread_data_list);
 
-            // sort all remaining nodes to the beginning of the sequence
-            const auto begin_independent_nodes = stable_partition(
-                remaining_nodes.begin(), remaining_nodes.end(), [](RemainingNodeData node_data)
-                {
-                    return !node_data.is_independent;
-                });
-            auto begin_independent_nodes_idx =
-                std::distance(remaining_nodes.begin(), begin_independent_nodes);
+            if (!is_dirty.empty())
+            {
+                // Only the local minima of the outdated priorities are evaluated again. They are
+                // more than two hops apart, so their simulated contractions do not interfere.
+                tbb::parallel_for(
+                    tbb::blocked_range<std::size_t>(0, remaining_nodes.size(),
+                                                    NeighboursGrainSize),
+                    [this, &node_priorities, &node_depth, &is_dirty, &remaining_nodes,
+                     &thread_data_list](const tbb::blocked_range<std::size_t> &range) {
+                        ContractorThreadData *data = thread_data_list.GetThreadData();
+                        for (auto i = range.begin(), end = range.end(); i != end; ++i)
+                        {
+                            const NodeID node = remaining_nodes[i].id;
+                            if (remaining_nodes[i].is_independent && is_dirty[node])
+                            {
+                                node_priorities[node] =
+                                    this->EvaluateNodePriority(data, node_depth[node], node);
+                                is_dirty[node] = false;
+                                ++data->priority_updates;
+                            }
+                        }
+                    });
+
+                // keep the candidates that are still local minima
+                FindIndependentNodes(node_priorities, remaining_nodes, thread_data_list, true);
+            }
+
+            const auto begin_independent_nodes_idx = PartitionIndependentNodes(remaining_nodes);
             auto end_independent_nodes_idx = remaining_nodes.size();
 
             if (!use_cached_node_priorities)
@@ -504,42 +587,34 @@ class GraphContractor
                     }
                 });
 
-            // make sure we really sort each block
-            tbb::parallel_for(
-                thread_data_list.data.range(),
-                [&](const ThreadDataContainer::EnumerableThreadData::range_type &range)
-                {
-                    for (auto &data : range)
-                        tbb::parallel_sort(data->inserted_edges.begin(),
-                                           data->inserted_edges.end());
-                });
-
-            // insert new edges
+            // insert new edges, all edges of a source are handled by one task
+            std::vector<ContractorEdge> inserted_edges;
             for (auto &data : thread_data_list.data)
             {
-                for (const ContractorEdge &edge : data->inserted_edges)
-                {
-                    const EdgeID current_edge_ID =
-                        contractor_graph->FindEdge(edge.source, edge.target);
-                    if (current_edge_ID < contractor_graph->EndEdges(edge.source))
-                    {
-                        ContractorGraph::EdgeData &current_data =
-                            contractor_graph->GetEdgeData(current_edge_ID);
-                        if (current_data.shortcut && edge.data.forward == current_data.forward &&
-                            edge.data.backward == current_data.backward &&
-                            edge.data.distance < current_data.distance)
-                        {
-                            // found a duplicate edge with smaller weight, update it.
-                            current_data = edge.data;
-                            continue;
-                        }
-                    }
-                    contractor_graph->InsertEdge(edge.source, edge.target, edge.data);
-                }
+                inserted_edges.insert(inserted_edges.end(), data->inserted_edges.begin(),
+                                      data->inserted_edges.end());
                 data->inserted_edges.clear();
             }
+            tbb::parallel_sort(inserted_edges.begin(), inserted_edges.end());
+            const std::size_t shortcut_edges = contractor_graph->InsertEdges(inserted_edges);
 
-            if (!use_cached_node_priorities)
+            if (!is_dirty.empty())
+            {
+                tbb::parallel_for(
+                    tbb::blocked_range<std::size_t>(begin_independent_nodes_idx,
+                                                    end_independent_nodes_idx,
+                                                    NeighboursGrainSize),
+                    [this, &node_depth, &is_dirty,
+                     &remaining_nodes](const tbb::blocked_range<std::size_t> &range) {
+                        for (auto position = range.begin(), end = range.end(); position != end;
+                             ++position)
+                        {
+                            const NodeID x = remaining_nodes[position].id;
+                            this->MarkNodeNeighbours(is_dirty, node_depth, x);
+                        }
+                    });
+            }
+            else if (!use_cached_node_priorities)
             {
                 tbb::parallel_for(
                     tbb::blocked_range<int>(begin_independent_nodes_idx, end_independent_nodes_idx,
@@ -557,10 +632,23 @@ class GraphContractor
                     });
             }
 
+            std::size_t priority_updates = 0;
+            for (auto &data : thread_data_list.data)
+            {
+                priority_updates += data->priority_updates;
+                data->priority_updates = 0;
+            }
+
             // remove contracted nodes from the pool
             number_of_contracted_nodes += end_independent_nodes_idx - begin_independent_nodes_idx;
             remaining_nodes.resize(begin_independent_nodes_idx);
 
+            TIMER_STOP(round);
+            round_stats.push_back(
+                {current_level, number_of_remaining_nodes,
+                 static_cast<NodeID>(end_independent_nodes_idx - begin_independent_nodes_idx),
+                 shortcut_edges, priority_updates, TIMER_SEC(round)});
+
             p.PrintStatus(number_of_contracted_nodes);
             ++current_level;
         }
@@ -617,6 +705,11 @@ class GraphContractor
         out_node_levels.swap(node_levels);
     }
 
+    inline void GetRoundStats(std::vector<ContractionRoundStats> &out_round_stats)
+    {
+        out_round_stats.swap(round_stats);
+    }
+
     template <class Edge> inline void GetEdges(util::DeallocatingVector<Edge> &edges)
     {
         util::Percent p(contractor_graph->GetNumberOfNodes());
@@ -695,15 +788,16 @@ class GraphContractor
             const int to_distance = distance + data.distance;
 
             // New Node discovered -> Add to Heap + Node Info Storage
-            if (!heap.WasInserted(to))
+            auto *const entry = heap.Find(to);
+            if (entry == nullptr)
             {
                 heap.Insert(to, to_distance, ContractorHeapData{current_hop, false});
             }
             // Found a shorter Path -> Update distance
-            else if (to_distance < heap.GetKey(to))
+            else if (to_distance < entry->weight)
             {
-                heap.DecreaseKey(to, to_distance);
-                heap.GetData(to).hop = current_hop;
+                heap.DecreaseKey(*entry, to_distance);
+                entry->data.hop = current_hop;
             }
         }
     }
@@ -1004,9 +1098,83 @@ class GraphContractor
         {
             priorities[u] = EvaluateNodePriority(data, node_depth[u], u);
         }
+        data->priority_updates += neighbours.size();
         return true;
     }
 
+    // Lazy version of UpdateNodeNeighbours, the priorities are only marked as outdated
+    inline void MarkNodeNeighbours(std::vector<char> &is_dirty,
+                                   std::vector<NodeDepth> &node_depth,
+                                   const NodeID node)
+    {
+        for (auto e : contractor_graph->GetAdjacentEdgeRange(node))
+        {
+            const NodeID u = contractor_graph->GetTarget(e);
+            if (u == node)
+            {
+                continue;
+            }
+            node_depth[u] = std::max(node_depth[node] + 1, node_depth[u]);
+            is_dirty[u] = true;
+        }
+    }
+
+    // Marks the nodes that have the smallest priority within two hops. With only_candidates
+    // set, nodes that are not marked yet are skipped.
+    inline void FindIndependentNodes(const std::vector<float> &priorities,
+                                     std::vector<RemainingNodeData> &remaining_nodes,
+                                     ThreadDataContainer &thread_data_list,
+                                     const bool only_candidates = false) const
+    {
+        const constexpr size_t IndependentGrainSize = 1;
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, remaining_nodes.size(), IndependentGrainSize),
+            [this, &priorities, &remaining_nodes, &thread_data_list,
+             only_candidates](const tbb::blocked_range<std::size_t> &range) {
+                ContractorThreadData *data = thread_data_list.GetThreadData();
+                for (auto i = range.begin(), end = range.end(); i != end; ++i)
+                {
+                    if (only_candidates && !remaining_nodes[i].is_independent)
+                    {
+                        continue;
+                    }
+                    const NodeID node = remaining_nodes[i].id;
+                    remaining_nodes[i].is_independent =
+                        this->IsNodeIndependent(priorities, data, node);
+                }
+            });
+    }
+
+    // Moves the independent nodes to the end while keeping the order of both parts, and
+    // returns the index of the first independent node. Unlike std::stable_partition this runs
+    // in parallel: every node gets its new position from a prefix sum.
+    inline std::size_t
+    PartitionIndependentNodes(std::vector<RemainingNodeData> &remaining_nodes) const
+    {
+        const constexpr size_t PartitionGrainSize = 4096;
+        std::vector<std::size_t> dependent_before(remaining_nodes.size());
+        DependentNodesScan scan(remaining_nodes, dependent_before);
+        tbb::parallel_scan(
+            tbb::blocked_range<std::size_t>(0, remaining_nodes.size(), PartitionGrainSize), scan);
+        const std::size_t number_of_dependent_nodes = scan.sum;
+
+        std::vector<RemainingNodeData> partitioned_nodes(remaining_nodes.size());
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, remaining_nodes.size(), PartitionGrainSize),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto i = range.begin(), end = range.end(); i != end; ++i)
+                {
+                    const auto position =
+                        remaining_nodes[i].is_independent
+                            ? number_of_dependent_nodes + (i - dependent_before[i])
+                            : dependent_before[i];
+                    partitioned_nodes[position] = remaining_nodes[i];
+                }
+            });
+        remaining_nodes.swap(partitioned_nodes);
+        return number_of_dependent_nodes;
+    }
+
     inline bool IsNodeIndependent(const std::vector<float> &priorities,
                                   ContractorThreadData *const data,
                                   NodeID node) const
@@ -1086,7 +1254,7 @@ class GraphContractor
     }
 
     std::shared_ptr<ContractorGraph> contractor_graph;
-    stxxl::vector<QueryEdge> external_edge_list;
+    util::ExternalVector<QueryEdge> external_edge_list;
     std::vector<NodeID> orig_node_id_from_new_node_id_map;
     std::vector<float> node_levels;
 
@@ -1097,6 +1265,7 @@ class GraphContractor
     // self-loops are added.
     std::vector<EdgeWeight> node_weights;
     std::vector<bool> is_core_node;
+    std::vector<ContractionRoundStats> round_stats;
     util::XORFastHash<> fast_hash;
 };
 }
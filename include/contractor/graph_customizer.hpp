@@ -0,0 +1,350 @@
+#ifndef GRAPH_CUSTOMIZER_HPP
+#define GRAPH_CUSTOMIZER_HPP
+
+#include "contractor/query_edge.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/exception.hpp"
+#include "util/integer_range.hpp"
+#include "util/simple_logger.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+/**
+ * Builds a hierarchy whose shortcuts do not depend on the edge weights and computes their
+ * weights for a given metric (customizable contraction hierarchies, Dibbelt, Strasser, Wagner).
+ *
+ * The topology is derived from a fixed contraction order: every node gets a shortcut between
+ * each pair of its higher ranked neighbours, without any witness search. A shortcut (x, y) can
+ * then only be needed for paths through lower triangles {v, x, y}, so processing the nodes
+ * bottom-up yields exact weights. Nodes whose lower neighbours are all done are independent and
+ * are customized in parallel.
+ */
+class GraphCustomizer
+{
+    struct ArcData
+    {
+        EdgeWeight weight;
+        // original edge id or middle node of a shortcut
+        NodeID id;
+        bool shortcut;
+    };
+
+  public:
+    // The order is given by the contraction levels of a previous contraction, ties are broken
+    // by node id. Only the endpoints of the input edges are used.
+    template <class ContainerT>
+    GraphCustomizer(const NodeID number_of_nodes,
+                    const std::vector<float> &node_levels,
+                    const ContainerT &input_edge_list)
+        : rank(number_of_nodes)
+    {
+        if (node_levels.size() != number_of_nodes)
+        {
+            throw util::exception(
+                "Node levels do not match the graph, run a contraction without customization first");
+        }
+
+        std::vector<NodeID> order(number_of_nodes);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&node_levels](const NodeID lhs, const NodeID rhs) {
+            return node_levels[lhs] < node_levels[rhs] ||
+                   (node_levels[lhs] == node_levels[rhs] && lhs < rhs);
+        });
+        for (const auto position : util::irange<NodeID>(0, number_of_nodes))
+        {
+            rank[order[position]] = position;
+        }
+
+        BuildTopology(order, input_edge_list);
+    }
+
+    std::size_t GetNumberOfArcs() const { return arc_head.size(); }
+
+    // Recomputes all weights from the given edges
+    template <class ContainerT> void Customize(const ContainerT &input_edge_list)
+    {
+        const ArcData no_arc{INVALID_EDGE_WEIGHT, SPECIAL_NODEID, false};
+        std::fill(upward_data.begin(), upward_data.end(), no_arc);
+        std::fill(downward_data.begin(), downward_data.end(), no_arc);
+        std::fill(loop_data.begin(), loop_data.end(), no_arc);
+
+        for (const auto &edge : input_edge_list)
+        {
+            // remove eigenloops
+            if (edge.source == edge.target)
+            {
+                continue;
+            }
+            const bool source_is_lower = rank[edge.source] < rank[edge.target];
+            const NodeID lower = source_is_lower ? edge.source : edge.target;
+            const NodeID higher = source_is_lower ? edge.target : edge.source;
+            const auto arc = FindArc(lower, higher);
+            BOOST_ASSERT(arc != SPECIAL_EDGEID);
+
+            const ArcData original{std::max<EdgeWeight>(edge.weight, 1), edge.edge_id, false};
+            if (source_is_lower ? edge.forward : edge.backward)
+            {
+                Improve(upward_data[arc], original);
+            }
+            if (source_is_lower ? edge.backward : edge.forward)
+            {
+                Improve(downward_data[arc], original);
+            }
+        }
+
+        for (const auto level : util::irange<std::size_t>(0UL, level_begin.size() - 1))
+        {
+            tbb::parallel_for(level_begin[level], level_begin[level + 1],
+                              [this](const std::size_t position) {
+                                  CustomizeNode(nodes_by_level[position]);
+                              });
+        }
+    }
+
+    // Edges are stored at their lower ranked node, like the edges of a contracted graph
+    template <class Edge> void GetEdges(util::DeallocatingVector<Edge> &edges) const
+    {
+        const auto make_edge = [](const NodeID source, const NodeID target, const ArcData &data,
+                                  const bool forward, const bool backward) {
+            Edge edge;
+            edge.source = source;
+            edge.target = target;
+            edge.data.distance = data.weight;
+            edge.data.id = data.id;
+            edge.data.shortcut = data.shortcut;
+            edge.data.forward = forward;
+            edge.data.backward = backward;
+            return edge;
+        };
+
+        for (const auto node : util::irange<NodeID>(0, rank.size()))
+        {
+            for (const auto arc : util::irange(first_arc[node], first_arc[node + 1]))
+            {
+                const auto &upward = upward_data[arc];
+                const auto &downward = downward_data[arc];
+                const bool has_upward = upward.weight != INVALID_EDGE_WEIGHT;
+                const bool has_downward = downward.weight != INVALID_EDGE_WEIGHT;
+                if (has_upward && has_downward && upward.weight == downward.weight &&
+                    upward.id == downward.id && upward.shortcut == downward.shortcut)
+                {
+                    edges.push_back(make_edge(node, arc_head[arc], upward, true, true));
+                    continue;
+                }
+                if (has_upward)
+                {
+                    edges.push_back(make_edge(node, arc_head[arc], upward, true, false));
+                }
+                if (has_downward)
+                {
+                    edges.push_back(make_edge(node, arc_head[arc], downward, false, true));
+                }
+            }
+            if (loop_data[node].weight != INVALID_EDGE_WEIGHT)
+            {
+                edges.push_back(make_edge(node, node, loop_data[node], true, true));
+            }
+        }
+    }
+
+  private:
+    template <class ContainerT>
+    void BuildTopology(const std::vector<NodeID> &order, const ContainerT &input_edge_list)
+    {
+        const NodeID number_of_nodes = rank.size();
+        std::vector<std::vector<NodeID>> higher_neighbours(number_of_nodes);
+        for (const auto &edge : input_edge_list)
+        {
+            if (edge.source == edge.target)
+            {
+                continue;
+            }
+            if (rank[edge.source] < rank[edge.target])
+            {
+                higher_neighbours[edge.source].push_back(edge.target);
+            }
+            else
+            {
+                higher_neighbours[edge.target].push_back(edge.source);
+            }
+        }
+
+        // Eliminating a node connects all of its higher neighbours. It is enough to pass them
+        // on to the lowest of them, which passes them on when it is eliminated itself.
+        const auto by_rank = [this](const NodeID lhs, const NodeID rhs) {
+            return rank[lhs] < rank[rhs];
+        };
+        for (const auto node : order)
+        {
+            auto &neighbours = higher_neighbours[node];
+            std::sort(neighbours.begin(), neighbours.end(), by_rank);
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+            if (neighbours.size() > 1)
+            {
+                auto &parent_neighbours = higher_neighbours[neighbours.front()];
+                parent_neighbours.insert(parent_neighbours.end(), neighbours.begin() + 1,
+                                         neighbours.end());
+            }
+        }
+
+        first_arc.resize(number_of_nodes + 1, 0);
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            first_arc[node + 1] = first_arc[node] + higher_neighbours[node].size();
+        }
+        arc_head.resize(first_arc.back());
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            auto &neighbours = higher_neighbours[node];
+            // sorted by id for FindArc
+            std::sort(neighbours.begin(), neighbours.end());
+            std::copy(neighbours.begin(), neighbours.end(), arc_head.begin() + first_arc[node]);
+            std::vector<NodeID>().swap(neighbours);
+        }
+        upward_data.resize(arc_head.size());
+        downward_data.resize(arc_head.size());
+        loop_data.resize(number_of_nodes);
+
+        // the arcs reaching every node from below
+        first_lower_arc.resize(number_of_nodes + 1, 0);
+        for (const auto head : arc_head)
+        {
+            ++first_lower_arc[head + 1];
+        }
+        std::partial_sum(first_lower_arc.begin(), first_lower_arc.end(), first_lower_arc.begin());
+        lower_arc.resize(arc_head.size());
+        lower_arc_tail.resize(arc_head.size());
+        std::vector<EdgeID> lower_arc_position(first_lower_arc.begin(), first_lower_arc.end() - 1);
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            for (const auto arc : util::irange(first_arc[node], first_arc[node + 1]))
+            {
+                const auto position = lower_arc_position[arc_head[arc]]++;
+                lower_arc[position] = arc;
+                lower_arc_tail[position] = node;
+            }
+        }
+
+        // A node can be customized as soon as all nodes below it are done
+        std::vector<std::size_t> node_level(number_of_nodes, 0);
+        std::size_t number_of_levels = 0;
+        for (const auto node : order)
+        {
+            number_of_levels = std::max(number_of_levels, node_level[node] + 1);
+            for (const auto arc : util::irange(first_arc[node], first_arc[node + 1]))
+            {
+                node_level[arc_head[arc]] =
+                    std::max(node_level[arc_head[arc]], node_level[node] + 1);
+            }
+        }
+        level_begin.resize(number_of_levels + 1, 0);
+        for (const auto level : node_level)
+        {
+            ++level_begin[level + 1];
+        }
+        std::partial_sum(level_begin.begin(), level_begin.end(), level_begin.begin());
+        nodes_by_level.resize(number_of_nodes);
+        std::vector<std::size_t> level_position(level_begin.begin(), level_begin.end() - 1);
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            nodes_by_level[level_position[node_level[node]]++] = node;
+        }
+
+        util::SimpleLogger().Write() << "customizable hierarchy has " << arc_head.size()
+                                     << " arcs in " << number_of_levels << " levels";
+    }
+
+    EdgeID FindArc(const NodeID lower, const NodeID higher) const
+    {
+        const auto begin = arc_head.begin() + first_arc[lower];
+        const auto end = arc_head.begin() + first_arc[lower + 1];
+        const auto iter = std::lower_bound(begin, end, higher);
+        if (iter == end || *iter != higher)
+        {
+            return SPECIAL_EDGEID;
+        }
+        return static_cast<EdgeID>(iter - arc_head.begin());
+    }
+
+    static void Improve(ArcData &data, const ArcData &candidate)
+    {
+        if (candidate.weight < data.weight)
+        {
+            data = candidate;
+        }
+    }
+
+    static void Relax(ArcData &data, const EdgeWeight first, const EdgeWeight second, NodeID middle)
+    {
+        if (first != INVALID_EDGE_WEIGHT && second != INVALID_EDGE_WEIGHT)
+        {
+            Improve(data, ArcData{first + second, middle, true});
+        }
+    }
+
+    // Relaxes all lower triangles of the arcs leaving node. Only writes the arcs of node and
+    // only reads arcs of nodes on lower levels.
+    void CustomizeNode(const NodeID node)
+    {
+        for (const auto position : util::irange(first_lower_arc[node], first_lower_arc[node + 1]))
+        {
+            const auto middle_arc = lower_arc[position];
+            const auto middle = lower_arc_tail[position];
+            // node -> middle and middle -> node
+            const auto to_middle = downward_data[middle_arc].weight;
+            const auto from_middle = upward_data[middle_arc].weight;
+
+            for (const auto arc : util::irange(first_arc[middle], first_arc[middle + 1]))
+            {
+                const auto head = arc_head[arc];
+                if (head == node)
+                {
+                    Relax(loop_data[node], to_middle, from_middle, middle);
+                    continue;
+                }
+                if (rank[head] < rank[node])
+                {
+                    continue;
+                }
+                const auto shortcut = FindArc(node, head);
+                BOOST_ASSERT(shortcut != SPECIAL_EDGEID);
+                Relax(upward_data[shortcut], to_middle, upward_data[arc].weight, middle);
+                Relax(downward_data[shortcut], downward_data[arc].weight, from_middle, middle);
+            }
+        }
+    }
+
+    std::vector<NodeID> rank;
+
+    // upward arcs, stored at their lower node
+    std::vector<EdgeID> first_arc;
+    std::vector<NodeID> arc_head;
+    std::vector<ArcData> upward_data;
+    std::vector<ArcData> downward_data;
+    std::vector<ArcData> loop_data;
+
+    // the same arcs, grouped by their higher node
+    std::vector<EdgeID> first_lower_arc;
+    std::vector<EdgeID> lower_arc;
+    std::vector<NodeID> lower_arc_tail;
+
+    std::vector<std::size_t> level_begin;
+    std::vector<NodeID> nodes_by_level;
+};
+}
+}
+
+#endif // GRAPH_CUSTOMIZER_HPP
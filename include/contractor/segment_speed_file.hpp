@@ -0,0 +1,190 @@
+#ifndef OSRM_CONTRACTOR_SEGMENT_SPEED_FILE_HPP
+#define OSRM_CONTRACTOR_SEGMENT_SPEED_FILE_HPP
+
+#include "util/exception.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/spirit/include/qi.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+// Binary segment speed files are written by osrm-convert-speeds. The header is followed by
+// fixed-width records sorted by segment, so a file can be mapped and merged with other sorted
+// segment lists without parsing a single line.
+const constexpr char SEGMENT_SPEED_FILE_MAGIC[8] = {'O', 'S', 'R', 'M', 'S', 'P', 'D', '1'};
+
+struct SegmentSpeedFileHeader
+{
+    char magic[8];
+    std::uint64_t number_of_records;
+};
+
+struct SegmentSpeedRecord
+{
+    OSMNodeID from;
+    OSMNodeID to;
+    std::uint32_t speed;
+    std::uint32_t reserved;
+
+    bool operator<(const SegmentSpeedRecord &other) const
+    {
+        return std::tie(from, to) < std::tie(other.from, other.to);
+    }
+};
+
+static_assert(sizeof(SegmentSpeedRecord) == 24, "segment speed files need fixed-width records");
+
+inline bool isSegmentSpeedFile(const std::string &filename)
+{
+    std::ifstream speed_file{filename, std::ios::binary};
+    char magic[sizeof(SEGMENT_SPEED_FILE_MAGIC)];
+    return speed_file.read(magic, sizeof(magic)) &&
+           std::equal(magic, magic + sizeof(magic), SEGMENT_SPEED_FILE_MAGIC);
+}
+
+// Reads a nodeA,nodeB,speed CSV file in the order of its lines
+inline std::vector<SegmentSpeedRecord> readSegmentSpeedsFromCSV(const std::string &filename)
+{
+    std::ifstream segment_speed_file{filename, std::ios::binary};
+    if (!segment_speed_file)
+        throw util::exception{"Unable to open segment speed file " + filename};
+
+    std::vector<SegmentSpeedRecord> records;
+
+    std::uint64_t from_node_id{};
+    std::uint64_t to_node_id{};
+    unsigned speed{};
+
+    for (std::string line; std::getline(segment_speed_file, line);)
+    {
+        using namespace boost::spirit::qi;
+
+        auto it = begin(line);
+        const auto last = end(line);
+
+        // The ulong_long -> uint64_t will likely break on 32bit platforms
+        const auto ok = parse(it, last,                                          //
+                              (ulong_long >> ',' >> ulong_long >> ',' >> uint_), //
+                              from_node_id, to_node_id, speed);                  //
+
+        if (!ok || it != last)
+            throw util::exception{"Segment speed file " + filename + " malformed"};
+
+        records.push_back(
+            SegmentSpeedRecord{OSMNodeID(from_node_id), OSMNodeID(to_node_id), speed, 0});
+    }
+
+    return records;
+}
+
+// Sorts the records by segment. Like in the CSV files, the last record of a segment wins.
+inline void sortSegmentSpeeds(std::vector<SegmentSpeedRecord> &records)
+{
+    std::stable_sort(records.begin(), records.end());
+
+    auto output = records.begin();
+    for (auto run = records.begin(); run != records.end();)
+    {
+        const auto run_end = std::upper_bound(run, records.end(), *run);
+        *output++ = *(run_end - 1);
+        run = run_end;
+    }
+    records.erase(output, records.end());
+}
+
+// Calls apply(entry, record) for every entry of a segment that has a speed record. Entries and
+// records are both sorted by segment, so every record only searches the entries behind the
+// last match. Several entries can belong to the same segment.
+template <typename EntryIterator, typename ApplyT>
+void mergeSegmentSpeeds(EntryIterator entry,
+                        const EntryIterator entries_end,
+                        const SegmentSpeedRecord *record,
+                        const SegmentSpeedRecord *const last,
+                        ApplyT apply)
+{
+    using EntryT = typename std::iterator_traits<EntryIterator>::value_type;
+    for (; record != last; ++record)
+    {
+        entry = std::lower_bound(entry, entries_end, *record,
+                                 [](const EntryT &lhs, const SegmentSpeedRecord &rhs) {
+                                     return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+                                 });
+        for (; entry != entries_end && entry->from == record->from && entry->to == record->to;
+             ++entry)
+        {
+            apply(*entry, *record);
+        }
+    }
+}
+
+inline void writeSegmentSpeedFile(const std::string &filename,
+                                  const std::vector<SegmentSpeedRecord> &sorted_records)
+{
+    std::ofstream speed_file{filename, std::ios::binary};
+    if (!speed_file)
+        throw util::exception{"Failed to open " + filename + " for writing"};
+
+    SegmentSpeedFileHeader header;
+    std::copy(SEGMENT_SPEED_FILE_MAGIC, SEGMENT_SPEED_FILE_MAGIC + sizeof(header.magic),
+              header.magic);
+    header.number_of_records = sorted_records.size();
+
+    speed_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    speed_file.write(reinterpret_cast<const char *>(sorted_records.data()),
+                     sorted_records.size() * sizeof(SegmentSpeedRecord));
+}
+
+// Read-only mapping of a binary segment speed file
+class SegmentSpeedFile
+{
+  public:
+    explicit SegmentSpeedFile(const std::string &filename)
+        : mapping{filename.c_str(), boost::interprocess::read_only},
+          region{mapping, boost::interprocess::read_only}
+    {
+        const auto data = static_cast<const char *>(region.get_address());
+        SegmentSpeedFileHeader header;
+        if (region.get_size() < sizeof(header))
+            throw util::exception{"Segment speed file " + filename + " malformed"};
+        std::memcpy(&header, data, sizeof(header));
+
+        // compared by division, a corrupt record count must not overflow the size check
+        const auto max_records = (region.get_size() - sizeof(header)) / sizeof(SegmentSpeedRecord);
+        if (!std::equal(header.magic, header.magic + sizeof(header.magic),
+                        SEGMENT_SPEED_FILE_MAGIC) ||
+            header.number_of_records > max_records)
+            throw util::exception{"Segment speed file " + filename + " malformed"};
+
+        first = reinterpret_cast<const SegmentSpeedRecord *>(data + sizeof(header));
+        last = first + header.number_of_records;
+        region.advise(boost::interprocess::mapped_region::advice_sequential);
+    }
+
+    const SegmentSpeedRecord *begin() const { return first; }
+    const SegmentSpeedRecord *end() const { return last; }
+    std::size_t size() const { return last - first; }
+
+  private:
+    boost::interprocess::file_mapping mapping;
+    boost::interprocess::mapped_region region;
+    const SegmentSpeedRecord *first;
+    const SegmentSpeedRecord *last;
+};
+}
+}
+
+#endif // OSRM_CONTRACTOR_SEGMENT_SPEED_FILE_HPP
@@ -34,8 +34,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/optional.hpp>
 
+#include <string>
 #include <vector>
 #include <algorithm>
+#include <utility>
 
 namespace osrm
 {
@@ -55,6 +57,7 @@ namespace api
  *              optional per coordinate
  *  - bearings: limits the search for segments in the road network to given bearing(s) in degree
  *              towards true north in clockwise direction, optional per coordinate
+ *  - metric: name of the metric to route with, empty for the default metric
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -65,6 +68,18 @@ struct BaseParameters
     std::vector<boost::optional<Hint>> hints;
     std::vector<boost::optional<double>> radiuses;
     std::vector<boost::optional<Bearing>> bearings;
+    std::string metric;
+
+    explicit BaseParameters(std::vector<util::Coordinate> coordinates_ = {},
+                            std::vector<boost::optional<Hint>> hints_ = {},
+                            std::vector<boost::optional<double>> radiuses_ = {},
+                            std::vector<boost::optional<Bearing>> bearings_ = {},
+                            std::string metric_ = {})
+        : coordinates(std::move(coordinates_)), hints(std::move(hints_)),
+          radiuses(std::move(radiuses_)), bearings(std::move(bearings_)),
+          metric(std::move(metric_))
+    {
+    }
 
     // FIXME add validation for invalid bearing values
     bool IsValid() const
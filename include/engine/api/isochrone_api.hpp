@@ -0,0 +1,62 @@
+#ifndef ENGINE_API_ISOCHRONE_API_HPP
+#define ENGINE_API_ISOCHRONE_API_HPP
+
+#include "engine/api/base_api.hpp"
+#include "engine/api/isochrone_parameters.hpp"
+
+#include "engine/api/json_factory.hpp"
+#include "engine/phantom_node.hpp"
+
+#include "util/coordinate.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/assert.hpp>
+
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+
+class IsochroneAPI final : public BaseAPI
+{
+  public:
+    IsochroneAPI(const datafacade::BaseDataFacade &facade_, const IsochroneParameters &parameters_)
+        : BaseAPI(facade_, parameters_), parameters(parameters_)
+    {
+    }
+
+    void MakeResponse(const PhantomNode &source,
+                      const std::vector<util::Coordinate> &locations,
+                      const std::vector<EdgeWeight> &durations,
+                      util::json::Object &response) const
+    {
+        BOOST_ASSERT(locations.size() == durations.size());
+
+        util::json::Array json_locations;
+        util::json::Array json_durations;
+        json_locations.values.reserve(locations.size());
+        json_durations.values.reserve(durations.size());
+        for (const auto index : util::irange<std::size_t>(0UL, locations.size()))
+        {
+            json_locations.values.push_back(json::detail::coordinateToLonLat(locations[index]));
+            json_durations.values.push_back(util::json::Number(durations[index] / 10.));
+        }
+
+        response.values["source"] = MakeWaypoint(source);
+        response.values["locations"] = std::move(json_locations);
+        response.values["durations"] = std::move(json_durations);
+        response.values["code"] = "Ok";
+    }
+
+    const IsochroneParameters &parameters;
+};
+
+} // ns api
+} // ns engine
+} // ns osrm
+
+#endif
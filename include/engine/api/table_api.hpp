@@ -19,6 +19,7 @@
 
 #include <boost/range/algorithm/transform.hpp>
 
+#include <cmath>
 #include <iterator>
 
 namespace osrm
@@ -37,6 +38,7 @@ class TableAPI final : public BaseAPI
     }
 
     virtual void MakeResponse(const std::vector<EdgeWeight> &durations,
+                              const std::vector<double> &distances,
                               const std::vector<PhantomNode> &phantoms,
                               util::json::Object &response) const
     {
@@ -65,8 +67,16 @@ class TableAPI final : public BaseAPI
             response.values["destinations"] = MakeWaypoints(phantoms, parameters.destinations);
         }
 
-        response.values["durations"] =
-            MakeTable(durations, number_of_sources, number_of_destinations);
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            response.values["durations"] =
+                MakeTable(durations, number_of_sources, number_of_destinations);
+        }
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            response.values["distances"] =
+                MakeDistanceTable(distances, durations, number_of_sources, number_of_destinations);
+        }
         response.values["code"] = "Ok";
     }
 
@@ -125,6 +135,36 @@ class TableAPI final : public BaseAPI
         return json_table;
     }
 
+    // Unreachable entries are marked by their duration
+    virtual util::json::Array MakeDistanceTable(const std::vector<double> &distances,
+                                                const std::vector<EdgeWeight> &durations,
+                                                std::size_t number_of_rows,
+                                                std::size_t number_of_columns) const
+    {
+        BOOST_ASSERT(distances.size() == durations.size());
+        util::json::Array json_table;
+        for (const auto row : util::irange<std::size_t>(0UL, number_of_rows))
+        {
+            util::json::Array json_row;
+            json_row.values.reserve(number_of_columns);
+            for (const auto column : util::irange<std::size_t>(0UL, number_of_columns))
+            {
+                const auto index = row * number_of_columns + column;
+                if (durations[index] == INVALID_EDGE_WEIGHT)
+                {
+                    json_row.values.push_back(util::json::Null());
+                }
+                else
+                {
+                    json_row.values.push_back(
+                        util::json::Number(std::round(distances[index] * 10) / 10.));
+                }
+            }
+            json_table.values.push_back(std::move(json_row));
+        }
+        return json_table;
+    }
+
     const TableParameters &parameters;
 };
 
@@ -51,14 +51,24 @@ namespace api
  *             use all coordinates as sources
  *  - destinations: indices into coordinates indicating destinations for the Table service, no
  *                  destinations means use all coordinates as destinations
+ *  - annotations: which tables to compute, Duration (default), Distance or both
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
  */
 struct TableParameters : public BaseParameters
 {
+    enum class AnnotationsType
+    {
+        None = 0,
+        Duration = 0x01,
+        Distance = 0x02,
+        All = Duration | Distance
+    };
+
     std::vector<std::size_t> sources;
     std::vector<std::size_t> destinations;
+    AnnotationsType annotations = AnnotationsType::Duration;
 
     TableParameters() = default;
     template <typename... Args>
@@ -75,6 +85,9 @@ struct TableParameters : public BaseParameters
         if (!BaseParameters::IsValid())
             return false;
 
+        if (annotations == AnnotationsType::None)
+            return false;
+
         // Distance Table makes only sense with 2+ coodinates
         if (coordinates.size() < 2)
             return false;
@@ -103,6 +116,18 @@ struct TableParameters : public BaseParameters
         return true;
     }
 };
+
+inline TableParameters::AnnotationsType operator|(TableParameters::AnnotationsType lhs,
+                                                  TableParameters::AnnotationsType rhs)
+{
+    return static_cast<TableParameters::AnnotationsType>(static_cast<unsigned>(lhs) |
+                                                         static_cast<unsigned>(rhs));
+}
+
+inline bool operator&(TableParameters::AnnotationsType lhs, TableParameters::AnnotationsType rhs)
+{
+    return (static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs)) != 0;
+}
 }
 }
 }
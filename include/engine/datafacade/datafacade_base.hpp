@@ -144,6 +144,13 @@ class BaseDataFacade
 
     virtual std::size_t GetCoreSize() const = 0;
 
+    // Number of landmarks of the A* search on the core, 0 if there are none
+    virtual unsigned GetNumberOfLandmarks() const = 0;
+
+    // Distances from all landmarks to a core node followed by the distances from the node to all
+    // landmarks, nullptr for nodes outside of the core
+    virtual const EdgeWeight *GetLandmarkDistances(const NodeID id) const = 0;
+
     virtual std::string GetTimestamp() const = 0;
 
     virtual bool GetContinueStraightDefault() const = 0;
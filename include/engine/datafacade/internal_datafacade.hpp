@@ -17,6 +17,7 @@
 #include "storage/storage_config.hpp"
 #include "util/graph_loader.hpp"
 #include "util/io.hpp"
+#include "util/landmark_table.hpp"
 #include "util/range_table.hpp"
 #include "util/rectangle.hpp"
 #include "util/shared_memory_vector_wrapper.hpp"
@@ -56,14 +57,16 @@ namespace datafacade
 class InternalDataFacade final : public BaseDataFacade
 {
 
+  public:
+    using RTreeLeaf = BaseDataFacade::RTreeLeaf;
+    using InternalRTree =
+        util::StaticRTree<RTreeLeaf, util::ShM<util::Coordinate, false>::vector, false>;
+    using InternalGeospatialQuery = GeospatialQuery<InternalRTree, BaseDataFacade>;
+
   private:
     using super = BaseDataFacade;
     using QueryGraph = util::StaticGraph<typename super::EdgeData>;
     using InputEdge = QueryGraph::InputEdge;
-    using RTreeLeaf = super::RTreeLeaf;
-    using InternalRTree =
-        util::StaticRTree<RTreeLeaf, util::ShM<util::Coordinate, false>::vector, false>;
-    using InternalGeospatialQuery = GeospatialQuery<InternalRTree, BaseDataFacade>;
 
     InternalDataFacade() {}
 
@@ -81,6 +84,7 @@ class InternalDataFacade final : public BaseDataFacade
     util::ShM<unsigned, false>::vector m_geometry_indices;
     util::ShM<extractor::CompressedEdgeContainer::CompressedEdge, false>::vector m_geometry_list;
     util::ShM<bool, false>::vector m_is_core_node;
+    util::LandmarkTable<false> m_landmark_table;
     util::ShM<unsigned, false>::vector m_segment_weights;
     util::ShM<uint8_t, false>::vector m_datasource_list;
     util::ShM<std::string, false>::vector m_datasource_names;
@@ -363,6 +367,8 @@ class InternalDataFacade final : public BaseDataFacade
 
         util::SimpleLogger().Write() << "loading core information";
         LoadCoreInformation(config.core_data_path);
+        m_landmark_table =
+            util::readLandmarkTable(config.landmarks_data_path, m_query_graph->GetNumberOfNodes());
 
         util::SimpleLogger().Write() << "loading geometries";
         LoadGeometries(config.geometries_path);
@@ -386,6 +392,16 @@ class InternalDataFacade final : public BaseDataFacade
         LoadIntersectionClasses(config.intersection_class_path);
     }
 
+    // Geospatial queries on the r-tree of this dataset, the phantom nodes take their weights
+    // from the given facade. Used by named metrics that share the r-tree.
+    std::unique_ptr<InternalGeospatialQuery>
+    MakeGeospatialQuery(BaseDataFacade &weight_facade) const
+    {
+        BOOST_ASSERT(m_static_rtree.get());
+        return std::unique_ptr<InternalGeospatialQuery>(
+            new InternalGeospatialQuery(*m_static_rtree, m_coordinate_list, weight_facade));
+    }
+
     // search graph access
     unsigned GetNumberOfNodes() const override final { return m_query_graph->GetNumberOfNodes(); }
 
@@ -594,6 +610,16 @@ class InternalDataFacade final : public BaseDataFacade
 
     virtual std::size_t GetCoreSize() const override final { return m_is_core_node.size(); }
 
+    virtual unsigned GetNumberOfLandmarks() const override final
+    {
+        return m_landmark_table.GetNumberOfLandmarks();
+    }
+
+    virtual const EdgeWeight *GetLandmarkDistances(const NodeID id) const override final
+    {
+        return m_landmark_table.GetDistances(id);
+    }
+
     virtual bool IsCoreNode(const NodeID id) const override final
     {
         if (m_is_core_node.size() > 0)
@@ -0,0 +1,441 @@
+#ifndef METRIC_DATAFACADE_HPP
+#define METRIC_DATAFACADE_HPP
+
+// implements a named metric on top of the data of an internal data facade
+
+#include "engine/datafacade/datafacade_base.hpp"
+#include "engine/datafacade/internal_datafacade.hpp"
+
+#include "storage/storage_config.hpp"
+#include "util/exception.hpp"
+#include "util/graph_loader.hpp"
+#include "util/landmark_table.hpp"
+#include "util/shared_memory_vector_wrapper.hpp"
+#include "util/simple_logger.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/path.hpp>
+
+namespace osrm
+{
+namespace engine
+{
+namespace datafacade
+{
+
+/**
+ * A metric built with osrm-contract --metric.
+ *
+ * Owns the hierarchy, the segment weights and the datasources of the metric. Everything that
+ * does not depend on the weights (coordinates, geometry, names, guidance data and the r-tree) is
+ * read from the facade of the default metric, so it is kept in memory only once.
+ */
+class MetricDataFacade final : public BaseDataFacade
+{
+  private:
+    using super = BaseDataFacade;
+    using QueryGraph = util::StaticGraph<typename super::EdgeData>;
+    using GeospatialQuery = InternalDataFacade::InternalGeospatialQuery;
+
+    const InternalDataFacade &base;
+
+    unsigned m_check_sum;
+    std::unique_ptr<QueryGraph> m_query_graph;
+    std::unique_ptr<GeospatialQuery> m_geospatial_query;
+
+    util::ShM<bool, false>::vector m_is_core_node;
+    util::LandmarkTable<false> m_landmark_table;
+    util::ShM<unsigned, false>::vector m_weight_indices;
+    util::ShM<EdgeWeight, false>::vector m_segment_weights;
+    util::ShM<uint8_t, false>::vector m_datasource_list;
+    util::ShM<std::string, false>::vector m_datasource_names;
+
+    void LoadGraph(const boost::filesystem::path &hsgr_path)
+    {
+        util::ShM<QueryGraph::NodeArrayEntry, false>::vector node_list;
+        util::ShM<QueryGraph::EdgeArrayEntry, false>::vector edge_list;
+
+        util::SimpleLogger().Write() << "loading graph from " << hsgr_path.string();
+
+        const auto number_of_nodes =
+            readHSGRFromStream(hsgr_path, node_list, edge_list, &m_check_sum);
+        if (number_of_nodes != base.GetNumberOfNodes())
+        {
+            throw util::exception(hsgr_path.string() + " was built from a different dataset");
+        }
+
+        m_query_graph = std::unique_ptr<QueryGraph>(new QueryGraph(node_list, edge_list));
+        util::SimpleLogger().Write() << "Data checksum is " << m_check_sum;
+    }
+
+    void LoadCoreInformation(const boost::filesystem::path &core_data_file)
+    {
+        boost::filesystem::ifstream core_stream(core_data_file, std::ios::binary);
+        unsigned number_of_markers = 0;
+        core_stream.read((char *)&number_of_markers, sizeof(unsigned));
+
+        std::vector<char> unpacked_core_markers(number_of_markers);
+        core_stream.read((char *)unpacked_core_markers.data(), sizeof(char) * number_of_markers);
+
+        m_is_core_node.resize(number_of_markers);
+        for (auto i = 0u; i < number_of_markers; ++i)
+        {
+            BOOST_ASSERT(unpacked_core_markers[i] == 0 || unpacked_core_markers[i] == 1);
+            m_is_core_node[i] = unpacked_core_markers[i] == 1;
+        }
+    }
+
+    void LoadSegmentWeights(const boost::filesystem::path &segment_weights_file)
+    {
+        boost::filesystem::ifstream weights_stream(segment_weights_file, std::ios::binary);
+        if (!weights_stream)
+        {
+            throw util::exception("Could not open " + segment_weights_file.string() +
+                                  " for reading!");
+        }
+
+        unsigned number_of_indices = 0;
+        weights_stream.read((char *)&number_of_indices, sizeof(unsigned));
+        m_weight_indices.resize(number_of_indices);
+        if (number_of_indices > 0)
+        {
+            weights_stream.read((char *)&(m_weight_indices[0]),
+                                number_of_indices * sizeof(unsigned));
+        }
+
+        unsigned number_of_segments = 0;
+        weights_stream.read((char *)&number_of_segments, sizeof(unsigned));
+        BOOST_ASSERT(m_weight_indices.empty() || m_weight_indices.back() == number_of_segments);
+        m_segment_weights.resize(number_of_segments);
+        if (number_of_segments > 0)
+        {
+            weights_stream.read((char *)&(m_segment_weights[0]),
+                                number_of_segments * sizeof(EdgeWeight));
+        }
+    }
+
+    void LoadDatasourceInfo(const boost::filesystem::path &datasource_names_file,
+                            const boost::filesystem::path &datasource_indexes_file)
+    {
+        boost::filesystem::ifstream datasources_stream(datasource_indexes_file, std::ios::binary);
+        if (!datasources_stream)
+        {
+            throw util::exception("Could not open " + datasource_indexes_file.string() +
+                                  " for reading!");
+        }
+
+        std::size_t number_of_datasources = 0;
+        datasources_stream.read(reinterpret_cast<char *>(&number_of_datasources),
+                                sizeof(std::size_t));
+        if (number_of_datasources > 0)
+        {
+            m_datasource_list.resize(number_of_datasources);
+            datasources_stream.read(reinterpret_cast<char *>(&(m_datasource_list[0])),
+                                    number_of_datasources * sizeof(uint8_t));
+        }
+
+        boost::filesystem::ifstream datasourcenames_stream(datasource_names_file, std::ios::binary);
+        if (!datasourcenames_stream)
+        {
+            throw util::exception("Could not open " + datasource_names_file.string() +
+                                  " for reading!");
+        }
+        std::string name;
+        while (std::getline(datasourcenames_stream, name))
+        {
+            m_datasource_names.push_back(std::move(name));
+        }
+    }
+
+  public:
+    MetricDataFacade(const InternalDataFacade &base, const storage::MetricStorageConfig &config)
+        : base(base)
+    {
+        util::SimpleLogger().Write() << "loading graph data of metric " << config.name;
+        LoadGraph(config.hsgr_data_path);
+
+        util::SimpleLogger().Write() << "loading core information";
+        LoadCoreInformation(config.core_data_path);
+        m_landmark_table =
+            util::readLandmarkTable(config.landmarks_data_path, m_query_graph->GetNumberOfNodes());
+
+        util::SimpleLogger().Write() << "loading segment weights";
+        LoadSegmentWeights(config.segment_weights_path);
+
+        util::SimpleLogger().Write() << "loading datasource info";
+        LoadDatasourceInfo(config.datasource_names_path, config.datasource_indexes_path);
+
+        m_geospatial_query = base.MakeGeospatialQuery(*this);
+    }
+
+    // search graph access
+    unsigned GetNumberOfNodes() const override final { return m_query_graph->GetNumberOfNodes(); }
+
+    unsigned GetNumberOfEdges() const override final { return m_query_graph->GetNumberOfEdges(); }
+
+    unsigned GetOutDegree(const NodeID n) const override final
+    {
+        return m_query_graph->GetOutDegree(n);
+    }
+
+    NodeID GetTarget(const EdgeID e) const override final { return m_query_graph->GetTarget(e); }
+
+    EdgeData &GetEdgeData(const EdgeID e) const override final
+    {
+        return m_query_graph->GetEdgeData(e);
+    }
+
+    EdgeID BeginEdges(const NodeID n) const override final { return m_query_graph->BeginEdges(n); }
+
+    EdgeID EndEdges(const NodeID n) const override final { return m_query_graph->EndEdges(n); }
+
+    EdgeRange GetAdjacentEdgeRange(const NodeID node) const override final
+    {
+        return m_query_graph->GetAdjacentEdgeRange(node);
+    }
+
+    // searches for a specific edge
+    EdgeID FindEdge(const NodeID from, const NodeID to) const override final
+    {
+        return m_query_graph->FindEdge(from, to);
+    }
+
+    EdgeID FindEdgeInEitherDirection(const NodeID from, const NodeID to) const override final
+    {
+        return m_query_graph->FindEdgeInEitherDirection(from, to);
+    }
+
+    EdgeID
+    FindEdgeIndicateIfReverse(const NodeID from, const NodeID to, bool &result) const override final
+    {
+        return m_query_graph->FindEdgeIndicateIfReverse(from, to, result);
+    }
+
+    // node and edge information access
+    util::Coordinate GetCoordinateOfNode(const unsigned id) const override final
+    {
+        return base.GetCoordinateOfNode(id);
+    }
+
+    extractor::guidance::TurnInstruction
+    GetTurnInstructionForEdgeID(const unsigned id) const override final
+    {
+        return base.GetTurnInstructionForEdgeID(id);
+    }
+
+    extractor::TravelMode GetTravelModeForEdgeID(const unsigned id) const override final
+    {
+        return base.GetTravelModeForEdgeID(id);
+    }
+
+    std::vector<RTreeLeaf> GetEdgesInBox(const util::Coordinate south_west,
+                                         const util::Coordinate north_east) const override final
+    {
+        return base.GetEdgesInBox(south_west, north_east);
+    }
+
+    // phantom nodes are computed on the shared r-tree with the weights of this metric
+    std::vector<PhantomNodeWithDistance>
+    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
+                               const float max_distance) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodesInRange(input_coordinate, max_distance);
+    }
+
+    std::vector<PhantomNodeWithDistance>
+    NearestPhantomNodesInRange(const util::Coordinate input_coordinate,
+                               const float max_distance,
+                               const int bearing,
+                               const int bearing_range) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodesInRange(input_coordinate, max_distance,
+                                                              bearing, bearing_range);
+    }
+
+    std::vector<PhantomNodeWithDistance>
+    NearestPhantomNodes(const util::Coordinate input_coordinate,
+                        const unsigned max_results) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodes(input_coordinate, max_results);
+    }
+
+    std::vector<PhantomNodeWithDistance>
+    NearestPhantomNodes(const util::Coordinate input_coordinate,
+                        const unsigned max_results,
+                        const double max_distance) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodes(input_coordinate, max_results, max_distance);
+    }
+
+    std::vector<PhantomNodeWithDistance>
+    NearestPhantomNodes(const util::Coordinate input_coordinate,
+                        const unsigned max_results,
+                        const int bearing,
+                        const int bearing_range) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodes(input_coordinate, max_results, bearing,
+                                                       bearing_range);
+    }
+
+    std::vector<PhantomNodeWithDistance>
+    NearestPhantomNodes(const util::Coordinate input_coordinate,
+                        const unsigned max_results,
+                        const double max_distance,
+                        const int bearing,
+                        const int bearing_range) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodes(input_coordinate, max_results, max_distance,
+                                                       bearing, bearing_range);
+    }
+
+    std::pair<PhantomNode, PhantomNode> NearestPhantomNodeWithAlternativeFromBigComponent(
+        const util::Coordinate input_coordinate, const double max_distance) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodeWithAlternativeFromBigComponent(
+            input_coordinate, max_distance);
+    }
+
+    std::pair<PhantomNode, PhantomNode> NearestPhantomNodeWithAlternativeFromBigComponent(
+        const util::Coordinate input_coordinate) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodeWithAlternativeFromBigComponent(
+            input_coordinate);
+    }
+
+    std::pair<PhantomNode, PhantomNode>
+    NearestPhantomNodeWithAlternativeFromBigComponent(const util::Coordinate input_coordinate,
+                                                      const double max_distance,
+                                                      const int bearing,
+                                                      const int bearing_range) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodeWithAlternativeFromBigComponent(
+            input_coordinate, max_distance, bearing, bearing_range);
+    }
+
+    std::pair<PhantomNode, PhantomNode>
+    NearestPhantomNodeWithAlternativeFromBigComponent(const util::Coordinate input_coordinate,
+                                                      const int bearing,
+                                                      const int bearing_range) const override final
+    {
+        return m_geospatial_query->NearestPhantomNodeWithAlternativeFromBigComponent(
+            input_coordinate, bearing, bearing_range);
+    }
+
+    // hints encode phantom weights, so they are only valid for the metric that created them
+    unsigned GetCheckSum() const override final { return m_check_sum; }
+
+    unsigned GetNameIndexFromEdgeID(const unsigned id) const override final
+    {
+        return base.GetNameIndexFromEdgeID(id);
+    }
+
+    std::string GetNameForID(const unsigned name_id) const override final
+    {
+        return base.GetNameForID(name_id);
+    }
+
+    unsigned GetGeometryIndexForEdgeID(const unsigned id) const override final
+    {
+        return base.GetGeometryIndexForEdgeID(id);
+    }
+
+    std::size_t GetCoreSize() const override final { return m_is_core_node.size(); }
+
+    unsigned GetNumberOfLandmarks() const override final
+    {
+        return m_landmark_table.GetNumberOfLandmarks();
+    }
+
+    const EdgeWeight *GetLandmarkDistances(const NodeID id) const override final
+    {
+        return m_landmark_table.GetDistances(id);
+    }
+
+    bool IsCoreNode(const NodeID id) const override final
+    {
+        return m_is_core_node.size() > 0 && m_is_core_node[id];
+    }
+
+    void GetUncompressedGeometry(const EdgeID id,
+                                 std::vector<NodeID> &result_nodes) const override final
+    {
+        base.GetUncompressedGeometry(id, result_nodes);
+    }
+
+    void GetUncompressedWeights(const EdgeID id,
+                                std::vector<EdgeWeight> &result_weights) const override final
+    {
+        const unsigned begin = m_weight_indices.at(id);
+        const unsigned end = m_weight_indices.at(id + 1);
+
+        result_weights.assign(m_segment_weights.begin() + begin,
+                              m_segment_weights.begin() + end);
+    }
+
+    void GetUncompressedDatasources(const EdgeID id,
+                                    std::vector<uint8_t> &result_datasources) const override final
+    {
+        const unsigned begin = m_weight_indices.at(id);
+        const unsigned end = m_weight_indices.at(id + 1);
+
+        // If there was no datasource info, return an array of 0's.
+        if (m_datasource_list.empty())
+        {
+            result_datasources.assign(end - begin, 0);
+        }
+        else
+        {
+            result_datasources.assign(m_datasource_list.begin() + begin,
+                                      m_datasource_list.begin() + end);
+        }
+    }
+
+    std::string GetDatasourceName(const uint8_t datasource_name_id) const override final
+    {
+        BOOST_ASSERT(m_datasource_names.size() > datasource_name_id);
+        return m_datasource_names[datasource_name_id];
+    }
+
+    std::string GetTimestamp() const override final { return base.GetTimestamp(); }
+
+    bool GetContinueStraightDefault() const override final
+    {
+        return base.GetContinueStraightDefault();
+    }
+
+    BearingClassID GetBearingClassID(const NodeID nid) const override final
+    {
+        return base.GetBearingClassID(nid);
+    }
+
+    util::guidance::BearingClass
+    GetBearingClass(const BearingClassID bearing_class_id) const override final
+    {
+        return base.GetBearingClass(bearing_class_id);
+    }
+
+    EntryClassID GetEntryClassID(const EdgeID eid) const override final
+    {
+        return base.GetEntryClassID(eid);
+    }
+
+    util::guidance::EntryClass GetEntryClass(const EntryClassID entry_class_id) const override final
+    {
+        return base.GetEntryClass(entry_class_id);
+    }
+};
+}
+}
+}
+
+#endif // METRIC_DATAFACADE_HPP
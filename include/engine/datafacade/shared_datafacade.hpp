@@ -14,6 +14,7 @@
 #include "util/guidance/entry_class.hpp"
 
 #include "engine/geospatial_query.hpp"
+#include "util/landmark_table.hpp"
 #include "util/make_unique.hpp"
 #include "util/range_table.hpp"
 #include "util/rectangle.hpp"
@@ -23,6 +24,7 @@
 #include "util/typedefs.hpp"
 
 #include <cstddef>
+#include <cstdint>
 
 #include <algorithm>
 #include <iterator>
@@ -85,6 +87,7 @@ class SharedDataFacade final : public BaseDataFacade
     util::ShM<unsigned, true>::vector m_geometry_indices;
     util::ShM<extractor::CompressedEdgeContainer::CompressedEdge, true>::vector m_geometry_list;
     util::ShM<bool, true>::vector m_is_core_node;
+    util::LandmarkTable<true> m_landmark_table;
     util::ShM<uint8_t, true>::vector m_datasource_list;
 
     util::ShM<char, true>::vector m_datasource_name_data;
@@ -239,6 +242,29 @@ class SharedDataFacade final : public BaseDataFacade
         m_is_core_node = std::move(is_core_node);
     }
 
+    void LoadLandmarks()
+    {
+        auto core_bits_ptr = data_layout->GetBlockPtr<std::uint32_t>(
+            shared_memory, storage::SharedDataLayout::LANDMARK_CORE_BITS);
+        util::ShM<std::uint32_t, true>::vector core_bits(
+            core_bits_ptr, data_layout->num_entries[storage::SharedDataLayout::LANDMARK_CORE_BITS]);
+
+        auto core_ranks_ptr = data_layout->GetBlockPtr<std::uint32_t>(
+            shared_memory, storage::SharedDataLayout::LANDMARK_CORE_RANKS);
+        util::ShM<std::uint32_t, true>::vector core_ranks(
+            core_ranks_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::LANDMARK_CORE_RANKS]);
+
+        auto distances_ptr = data_layout->GetBlockPtr<EdgeWeight>(
+            shared_memory, storage::SharedDataLayout::LANDMARK_DISTANCES);
+        util::ShM<EdgeWeight, true>::vector distances(
+            distances_ptr, data_layout->num_entries[storage::SharedDataLayout::LANDMARK_DISTANCES]);
+
+        m_landmark_table = util::LandmarkTable<true>(
+            data_layout->num_entries[storage::SharedDataLayout::LANDMARK_LIST],
+            std::move(core_bits), std::move(core_ranks), std::move(distances));
+    }
+
     void LoadGeometries()
     {
         auto geometries_index_ptr = data_layout->GetBlockPtr<unsigned>(
@@ -404,6 +430,7 @@ class SharedDataFacade final : public BaseDataFacade
                 LoadViaNodeList();
                 LoadNames();
                 LoadCoreInformation();
+                LoadLandmarks();
                 LoadProfileProperties();
                 LoadRTree();
                 LoadIntersectionClasses();
@@ -667,6 +694,16 @@ class SharedDataFacade final : public BaseDataFacade
 
     virtual std::size_t GetCoreSize() const override final { return m_is_core_node.size(); }
 
+    virtual unsigned GetNumberOfLandmarks() const override final
+    {
+        return m_landmark_table.GetNumberOfLandmarks();
+    }
+
+    virtual const EdgeWeight *GetLandmarkDistances(const NodeID id) const override final
+    {
+        return m_landmark_table.GetDistances(id);
+    }
+
     // Returns the data source ids that were used to supply the edge
     // weights.
     virtual void
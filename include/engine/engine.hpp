@@ -8,6 +8,7 @@
 #include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -32,6 +33,7 @@ struct NearestParameters;
 struct TripParameters;
 struct MatchParameters;
 struct TileParameters;
+struct IsochroneParameters;
 }
 namespace plugins
 {
@@ -41,6 +43,7 @@ class NearestPlugin;
 class TripPlugin;
 class MatchPlugin;
 class TilePlugin;
+class IsochronePlugin;
 }
 // End fwd decls
 
@@ -69,18 +72,22 @@ class Engine final
     Status Trip(const api::TripParameters &parameters, util::json::Object &result);
     Status Match(const api::MatchParameters &parameters, util::json::Object &result);
     Status Tile(const api::TileParameters &parameters, std::string &result);
+    Status Isochrone(const api::IsochroneParameters &parameters, util::json::Object &result);
 
   private:
-    std::unique_ptr<EngineLock> lock;
+    // The plugins answering the queries of one metric
+    struct MetricPlugins;
+
+    // Returns nullptr if there is no metric with this name, the default metric has no name
+    MetricPlugins *GetMetricPlugins(const std::string &metric) const;
 
-    std::unique_ptr<plugins::ViaRoutePlugin> route_plugin;
-    std::unique_ptr<plugins::TablePlugin> table_plugin;
-    std::unique_ptr<plugins::NearestPlugin> nearest_plugin;
-    std::unique_ptr<plugins::TripPlugin> trip_plugin;
-    std::unique_ptr<plugins::MatchPlugin> match_plugin;
-    std::unique_ptr<plugins::TilePlugin> tile_plugin;
+    std::unique_ptr<EngineLock> lock;
 
     std::unique_ptr<datafacade::BaseDataFacade> query_data_facade;
+    // named metrics share the data of query_data_facade
+    std::vector<std::unique_ptr<datafacade::BaseDataFacade>> metric_data_facades;
+
+    std::unordered_map<std::string, std::unique_ptr<MetricPlugins>> metric_plugins;
 };
 }
 }
@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/filesystem/path.hpp>
 
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -54,6 +55,9 @@ namespace engine
  *
  * In addition, shared memory can be used for datasets loaded with osrm-datastore.
  *
+ * Named metrics built with osrm-contract --metric can be loaded next to the default metric,
+ * requests select them with their metric parameter. They are only supported without shared memory.
+ *
  * \see OSRM, StorageConfig
  */
 struct EngineConfig final
@@ -61,6 +65,7 @@ struct EngineConfig final
     bool IsValid() const;
 
     storage::StorageConfig storage_config;
+    std::vector<storage::MetricStorageConfig> metric_configs;
     int max_locations_trip = -1;
     int max_locations_viaroute = -1;
     int max_locations_distance_table = -1;
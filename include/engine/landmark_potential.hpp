@@ -0,0 +1,193 @@
+#ifndef OSRM_ENGINE_LANDMARK_POTENTIAL_HPP
+#define OSRM_ENGINE_LANDMARK_POTENTIAL_HPP
+
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+/*
+ * Potentials for a bidirectional A* search on the core that uses the landmark distances of the
+ * facade (ALT).
+ *
+ * The search starts at several core nodes with different offsets, so the bounds are taken to
+ * the closest source and target: h_t(v) is a lower bound on min(d(v, t) + offset(t)) and h_s(v)
+ * a lower bound on min(offset(s) + d(s, v)). Both are maximums of triangle inequality bounds,
+ * which keeps them consistent. The forward search uses (h_t - h_s) / 2 and the reverse search
+ * the negated value, so the keys of both heaps still add up to the length of a path and the
+ * termination criterion of the plain bidirectional search does not change.
+ *
+ * Nodes that can reach no target (or be reached from no source) according to the landmark
+ * distances get INVALID_EDGE_WEIGHT and need not be searched at all.
+ */
+template <class DataFacadeT> class LandmarkPotential
+{
+    using EntryPoints = std::vector<std::pair<NodeID, EdgeWeight>>;
+    static const constexpr std::int64_t INVALID_BOUND = std::numeric_limits<std::int64_t>::max();
+
+  public:
+    LandmarkPotential(const DataFacadeT &facade,
+                      const EntryPoints &sources,
+                      const EntryPoints &targets)
+        : facade(facade),
+          number_of_landmarks(sources.empty() || targets.empty() ? 0
+                                                                 : facade.GetNumberOfLandmarks()),
+          bounds(number_of_landmarks)
+    {
+        for (const auto landmark : util::irange(0u, number_of_landmarks))
+        {
+            bounds[landmark] = Bounds{INVALID_BOUND, std::numeric_limits<std::int64_t>::min(),
+                                      std::numeric_limits<std::int64_t>::min(), INVALID_BOUND};
+        }
+
+        for (const auto &target : targets)
+        {
+            const auto *row = facade.GetLandmarkDistances(target.first);
+            BOOST_ASSERT(row != nullptr);
+            for (const auto landmark : util::irange(0u, number_of_landmarks))
+            {
+                Bounds &bound = bounds[landmark];
+                const EdgeWeight from_landmark = row[landmark];
+                const EdgeWeight to_landmark = row[number_of_landmarks + landmark];
+                if (from_landmark != INVALID_EDGE_WEIGHT)
+                {
+                    bound.target_from_landmark =
+                        std::min(bound.target_from_landmark,
+                                 std::int64_t{from_landmark} + target.second);
+                }
+                if (to_landmark == INVALID_EDGE_WEIGHT ||
+                    bound.target_to_landmark == INVALID_BOUND)
+                {
+                    bound.target_to_landmark = INVALID_BOUND;
+                }
+                else
+                {
+                    bound.target_to_landmark = std::max(
+                        bound.target_to_landmark, std::int64_t{to_landmark} - target.second);
+                }
+            }
+        }
+
+        for (const auto &source : sources)
+        {
+            const auto *row = facade.GetLandmarkDistances(source.first);
+            BOOST_ASSERT(row != nullptr);
+            for (const auto landmark : util::irange(0u, number_of_landmarks))
+            {
+                Bounds &bound = bounds[landmark];
+                const EdgeWeight from_landmark = row[landmark];
+                const EdgeWeight to_landmark = row[number_of_landmarks + landmark];
+                if (from_landmark == INVALID_EDGE_WEIGHT ||
+                    bound.source_from_landmark == INVALID_BOUND)
+                {
+                    bound.source_from_landmark = INVALID_BOUND;
+                }
+                else
+                {
+                    bound.source_from_landmark = std::max(
+                        bound.source_from_landmark, std::int64_t{from_landmark} - source.second);
+                }
+                if (to_landmark != INVALID_EDGE_WEIGHT)
+                {
+                    bound.source_to_landmark = std::min(
+                        bound.source_to_landmark, std::int64_t{to_landmark} + source.second);
+                }
+            }
+        }
+    }
+
+    // Potential of a node in the forward search
+    EdgeWeight Forward(const NodeID node) const
+    {
+        const auto potential = Evaluate(node);
+        return potential == INVALID_BOUND ? INVALID_EDGE_WEIGHT
+                                          : static_cast<EdgeWeight>(potential);
+    }
+
+    // Potential of a node in the reverse search
+    EdgeWeight Reverse(const NodeID node) const
+    {
+        const auto potential = Evaluate(node);
+        return potential == INVALID_BOUND ? INVALID_EDGE_WEIGHT
+                                          : static_cast<EdgeWeight>(-potential);
+    }
+
+  private:
+    struct Bounds
+    {
+        // min(d(L, t) + offset(t)), gives h_t(v) >= bound - d(L, v)
+        std::int64_t target_from_landmark;
+        // max(d(t, L) - offset(t)) if all targets reach L, gives h_t(v) >= d(v, L) - bound
+        std::int64_t target_to_landmark;
+        // max(d(L, s) - offset(s)) if L reaches all sources, gives h_s(v) >= d(L, v) - bound
+        std::int64_t source_from_landmark;
+        // min(d(s, L) + offset(s)), gives h_s(v) >= bound - d(v, L)
+        std::int64_t source_to_landmark;
+    };
+
+    // Returns floor((h_t - h_s) / 2), rounding down keeps the reduced edge weights non-negative
+    std::int64_t Evaluate(const NodeID node) const
+    {
+        const auto *row =
+            number_of_landmarks > 0 ? facade.GetLandmarkDistances(node) : nullptr;
+        BOOST_ASSERT(number_of_landmarks == 0 || row != nullptr);
+
+        std::int64_t to_target = 0;
+        std::int64_t from_source = 0;
+        for (const auto landmark : util::irange(0u, number_of_landmarks))
+        {
+            const Bounds &bound = bounds[landmark];
+            const EdgeWeight from_landmark = row[landmark];
+            const EdgeWeight to_landmark = row[number_of_landmarks + landmark];
+
+            if (bound.target_to_landmark != INVALID_BOUND)
+            {
+                if (to_landmark == INVALID_EDGE_WEIGHT)
+                {
+                    // every target reaches the landmark, but this node does not
+                    return INVALID_BOUND;
+                }
+                to_target = std::max(to_target, to_landmark - bound.target_to_landmark);
+            }
+            if (bound.source_from_landmark != INVALID_BOUND)
+            {
+                if (from_landmark == INVALID_EDGE_WEIGHT)
+                {
+                    // the landmark reaches every source, but not this node
+                    return INVALID_BOUND;
+                }
+                from_source = std::max(from_source, from_landmark - bound.source_from_landmark);
+            }
+            if (from_landmark != INVALID_EDGE_WEIGHT && bound.target_from_landmark != INVALID_BOUND)
+            {
+                to_target = std::max(to_target, bound.target_from_landmark - from_landmark);
+            }
+            if (to_landmark != INVALID_EDGE_WEIGHT && bound.source_to_landmark != INVALID_BOUND)
+            {
+                from_source = std::max(from_source, bound.source_to_landmark - to_landmark);
+            }
+        }
+
+        const auto difference = to_target - from_source;
+        return difference >= 0 ? difference / 2 : -((1 - difference) / 2);
+    }
+
+    const DataFacadeT &facade;
+    unsigned number_of_landmarks;
+    std::vector<Bounds> bounds;
+};
+}
+}
+
+#endif // OSRM_ENGINE_LANDMARK_POTENTIAL_HPP
@@ -0,0 +1,48 @@
+#ifndef ISOCHRONE_HPP
+#define ISOCHRONE_HPP
+
+#include "engine/plugins/plugin_base.hpp"
+
+#include "engine/api/isochrone_parameters.hpp"
+#include "engine/routing_algorithms/one_to_many.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/json_container.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+class IsochronePlugin final : public BasePlugin
+{
+  public:
+    explicit IsochronePlugin(datafacade::BaseDataFacade &facade);
+
+    Status HandleRequest(const api::IsochroneParameters &params, util::json::Object &result);
+
+  private:
+    // Packed geometry of the segment every node of the graph represents, computed once per dataset
+    struct NodeGeometries
+    {
+        unsigned checksum;
+        std::vector<unsigned> geometry_ids;
+    };
+
+    std::shared_ptr<const NodeGeometries> GetNodeGeometries();
+
+    SearchEngineData heaps;
+    routing_algorithms::OneToManyRouting<datafacade::BaseDataFacade> one_to_many;
+    std::mutex node_geometries_mutex;
+    std::shared_ptr<const NodeGeometries> node_geometries;
+};
+}
+}
+}
+
+#endif // ISOCHRONE_HPP
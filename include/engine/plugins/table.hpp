@@ -5,6 +5,7 @@
 
 #include "engine/api/table_parameters.hpp"
 #include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/routing_algorithms/one_to_many.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/json_container.hpp"
 
@@ -26,6 +27,7 @@ class TablePlugin final : public BasePlugin
   private:
     SearchEngineData heaps;
     routing_algorithms::ManyToManyRouting<datafacade::BaseDataFacade> distance_table;
+    routing_algorithms::OneToManyRouting<datafacade::BaseDataFacade> one_to_many_table;
     int max_locations_distance_table;
 };
 }
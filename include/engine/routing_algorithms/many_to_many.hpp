@@ -3,10 +3,16 @@
 
 #include "engine/routing_algorithms/routing_base.hpp"
 #include "engine/search_engine_data.hpp"
+#include "util/coordinate.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/integer_range.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
 
+#include <cstdint>
+
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <unordered_map>
@@ -31,8 +37,9 @@ class ManyToManyRouting final
     {
         unsigned target_id; // essentially a row in the distance matrix
         EdgeWeight distance;
-        NodeBucket(const unsigned target_id, const EdgeWeight distance)
-            : target_id(target_id), distance(distance)
+        NodeID parent; // next node on the path to the target
+        NodeBucket(const unsigned target_id, const EdgeWeight distance, const NodeID parent)
+            : target_id(target_id), distance(distance), parent(parent)
         {
         }
     };
@@ -40,6 +47,25 @@ class ManyToManyRouting final
     // FIXME This should be replaced by an std::unordered_multimap, though this needs benchmarking
     using SearchSpaceWithBuckets = std::unordered_map<NodeID, std::vector<NodeBucket>>;
 
+    // Node at which the best path of a table entry was found
+    struct MiddleNode
+    {
+        NodeID node;
+        bool uses_loop;
+    };
+
+    // Length in meters of the unpacked geometry of a packed edge. The geometry of an original
+    // edge does not contain the start of its first segment, so consecutive edges are joined by
+    // the distance between the last coordinate of one and the first coordinate of the next.
+    struct PackedEdgeLength
+    {
+        util::Coordinate first;
+        util::Coordinate last;
+        double length;
+    };
+
+    using PackedEdgeLengths = std::unordered_map<std::uint64_t, PackedEdgeLength>;
+
   public:
     ManyToManyRouting(DataFacadeT *facade, SearchEngineData &engine_working_data)
         : super(facade), engine_working_data(engine_working_data)
@@ -49,6 +75,25 @@ class ManyToManyRouting final
     std::vector<EdgeWeight> operator()(const std::vector<PhantomNode> &phantom_nodes,
                                        const std::vector<std::size_t> &source_indices,
                                        const std::vector<std::size_t> &target_indices) const
+    {
+        return ComputeTable(phantom_nodes, source_indices, target_indices, nullptr);
+    }
+
+    // Additionally computes the length in meters of every path of the table. The lengths of
+    // unpacked edges are cached for the request since the paths share most of their edges.
+    std::vector<EdgeWeight> operator()(const std::vector<PhantomNode> &phantom_nodes,
+                                       const std::vector<std::size_t> &source_indices,
+                                       const std::vector<std::size_t> &target_indices,
+                                       std::vector<double> &distance_table) const
+    {
+        return ComputeTable(phantom_nodes, source_indices, target_indices, &distance_table);
+    }
+
+  private:
+    std::vector<EdgeWeight> ComputeTable(const std::vector<PhantomNode> &phantom_nodes,
+                                         const std::vector<std::size_t> &source_indices,
+                                         const std::vector<std::size_t> &target_indices,
+                                         std::vector<double> *distance_table) const
     {
         const auto number_of_sources =
             source_indices.empty() ? phantom_nodes.size() : source_indices.size();
@@ -65,6 +110,16 @@ class ManyToManyRouting final
 
         SearchSpaceWithBuckets search_space_with_buckets;
 
+        std::vector<MiddleNode> middle_nodes(number_of_targets);
+        const MiddleNode no_middle_node{SPECIAL_NODEID, false};
+        std::vector<const PhantomNode *> target_phantoms;
+        PackedEdgeLengths packed_edge_lengths;
+        if (distance_table)
+        {
+            distance_table->assign(number_of_entries, 0.);
+            target_phantoms.reserve(number_of_targets);
+        }
+
         unsigned column_idx = 0;
         const auto search_target_phantom = [&](const PhantomNode &phantom)
         {
@@ -89,6 +144,10 @@ class ManyToManyRouting final
             {
                 BackwardRoutingStep(column_idx, query_heap, search_space_with_buckets);
             }
+            if (distance_table)
+            {
+                target_phantoms.push_back(&phantom);
+            }
             ++column_idx;
         };
 
@@ -112,11 +171,28 @@ class ManyToManyRouting final
                                   phantom.reverse_segment_id.id);
             }
 
+            std::fill(middle_nodes.begin(), middle_nodes.end(), no_middle_node);
+
             // explore search space
             while (!query_heap.Empty())
             {
                 ForwardRoutingStep(row_idx, number_of_targets, query_heap,
-                                   search_space_with_buckets, result_table);
+                                   search_space_with_buckets, result_table, middle_nodes);
+            }
+
+            if (distance_table)
+            {
+                for (const auto column : util::irange<std::size_t>(0UL, number_of_targets))
+                {
+                    if (middle_nodes[column].node == SPECIAL_NODEID)
+                    {
+                        continue;
+                    }
+                    const auto packed_path = RetrievePackedTablePath(
+                        query_heap, search_space_with_buckets, column, middle_nodes[column]);
+                    (*distance_table)[row_idx * number_of_targets + column] = GetPathLength(
+                        phantom, *target_phantoms[column], packed_path, packed_edge_lengths);
+                }
             }
             ++row_idx;
         };
@@ -160,7 +236,8 @@ class ManyToManyRouting final
                             const unsigned number_of_targets,
                             QueryHeap &query_heap,
                             const SearchSpaceWithBuckets &search_space_with_buckets,
-                            std::vector<EdgeWeight> &result_table) const
+                            std::vector<EdgeWeight> &result_table,
+                            std::vector<MiddleNode> &middle_nodes) const
     {
         const NodeID node = query_heap.DeleteMin();
         const int source_distance = query_heap.GetKey(node);
@@ -183,14 +260,17 @@ class ManyToManyRouting final
                 {
                     const EdgeWeight loop_weight = super::GetLoopWeight(node);
                     const int new_distance_with_loop = new_distance + loop_weight;
-                    if (loop_weight != INVALID_EDGE_WEIGHT && new_distance_with_loop >= 0)
+                    if (loop_weight != INVALID_EDGE_WEIGHT && new_distance_with_loop >= 0 &&
+                        new_distance_with_loop < current_distance)
                     {
-                        current_distance = std::min(current_distance, new_distance_with_loop);
+                        current_distance = new_distance_with_loop;
+                        middle_nodes[column_idx] = MiddleNode{node, true};
                     }
                 }
                 else if (new_distance < current_distance)
                 {
-                    result_table[row_idx * number_of_targets + column_idx] = new_distance;
+                    current_distance = new_distance;
+                    middle_nodes[column_idx] = MiddleNode{node, false};
                 }
             }
         }
@@ -209,7 +289,8 @@ class ManyToManyRouting final
         const int target_distance = query_heap.GetKey(node);
 
         // store settled nodes in search space bucket
-        search_space_with_buckets[node].emplace_back(column_idx, target_distance);
+        search_space_with_buckets[node].emplace_back(column_idx, target_distance,
+                                                     query_heap.GetData(node).parent);
 
         if (StallAtNode<false>(node, target_distance, query_heap))
         {
@@ -219,6 +300,209 @@ class ManyToManyRouting final
         RelaxOutgoingEdges<false>(node, target_distance, query_heap);
     }
 
+    // Packed path from the source to the target of a table entry, the source part is stored in
+    // the heap of the current forward search and the target part in the buckets.
+    std::vector<NodeID>
+    RetrievePackedTablePath(const QueryHeap &query_heap,
+                            const SearchSpaceWithBuckets &search_space_with_buckets,
+                            const unsigned column_idx,
+                            const MiddleNode &middle_node) const
+    {
+        std::vector<NodeID> packed_path;
+        NodeID node = middle_node.node;
+        packed_path.push_back(node);
+        while (node != query_heap.GetData(node).parent)
+        {
+            node = query_heap.GetData(node).parent;
+            packed_path.push_back(node);
+        }
+        std::reverse(packed_path.begin(), packed_path.end());
+
+        if (middle_node.uses_loop)
+        {
+            packed_path.push_back(middle_node.node);
+        }
+
+        node = middle_node.node;
+        while (true)
+        {
+            // the target searches run in column order, so every bucket list is sorted by column
+            const auto &bucket_list = search_space_with_buckets.find(node)->second;
+            const auto bucket = std::lower_bound(
+                bucket_list.begin(), bucket_list.end(), column_idx,
+                [](const NodeBucket &lhs, const unsigned rhs) { return lhs.target_id < rhs; });
+            BOOST_ASSERT(bucket != bucket_list.end() && bucket->target_id == column_idx);
+            if (bucket->parent == node)
+            {
+                break;
+            }
+            node = bucket->parent;
+            packed_path.push_back(node);
+        }
+
+        return packed_path;
+    }
+
+    // Sums up the same coordinates that the route service uses for the geometry of a leg
+    double GetPathLength(const PhantomNode &source_phantom,
+                         const PhantomNode &target_phantom,
+                         const std::vector<NodeID> &packed_path,
+                         PackedEdgeLengths &packed_edge_lengths) const
+    {
+        BOOST_ASSERT(!packed_path.empty());
+        const bool start_traversed_in_reverse =
+            (packed_path.front() != source_phantom.forward_segment_id.id);
+        const bool target_traversed_in_reverse =
+            (packed_path.back() != target_phantom.forward_segment_id.id);
+
+        std::vector<NodeID> source_geometry;
+        super::facade->GetUncompressedGeometry(start_traversed_in_reverse
+                                                   ? source_phantom.reverse_packed_geometry_id
+                                                   : source_phantom.forward_packed_geometry_id,
+                                               source_geometry);
+        std::vector<NodeID> target_geometry;
+        super::facade->GetUncompressedGeometry(target_traversed_in_reverse
+                                                   ? target_phantom.reverse_packed_geometry_id
+                                                   : target_phantom.forward_packed_geometry_id,
+                                               target_geometry);
+
+        const std::size_t start_index =
+            start_traversed_in_reverse
+                ? source_geometry.size() - source_phantom.fwd_segment_position - 1
+                : source_phantom.fwd_segment_position;
+        const std::size_t end_index =
+            target_traversed_in_reverse
+                ? target_geometry.size() - target_phantom.fwd_segment_position - 1
+                : target_phantom.fwd_segment_position;
+
+        double length = 0.;
+        util::Coordinate current_coordinate = source_phantom.location;
+        const auto append = [&](const util::Coordinate coordinate) {
+            length += util::coordinate_calculation::haversineDistance(current_coordinate,
+                                                                      coordinate);
+            current_coordinate = coordinate;
+        };
+
+        if (packed_path.size() > 1)
+        {
+            // the unpacked edges contain the whole first segment, the part before the source
+            // is removed again
+            auto path_length = GetPackedEdgeLength(packed_path[0], packed_path[1],
+                                                   packed_edge_lengths);
+            for (const auto index : util::irange<std::size_t>(2UL, packed_path.size()))
+            {
+                const auto edge_length = GetPackedEdgeLength(packed_path[index - 1],
+                                                             packed_path[index],
+                                                             packed_edge_lengths);
+                path_length.length += util::coordinate_calculation::haversineDistance(
+                                          path_length.last, edge_length.first) +
+                                      edge_length.length;
+                path_length.last = edge_length.last;
+            }
+
+            append(super::facade->GetCoordinateOfNode(source_geometry[start_index]));
+            length += path_length.length;
+            for (const auto index : util::irange<std::size_t>(0UL, start_index))
+            {
+                length -= util::coordinate_calculation::haversineDistance(
+                    super::facade->GetCoordinateOfNode(source_geometry[index]),
+                    super::facade->GetCoordinateOfNode(source_geometry[index + 1]));
+            }
+            current_coordinate = path_length.last;
+
+            for (const auto index : util::irange<std::size_t>(0UL, end_index))
+            {
+                append(super::facade->GetCoordinateOfNode(target_geometry[index]));
+            }
+        }
+        else
+        {
+            // source and target are on the same segment
+            for (std::size_t index = start_index; index < end_index; ++index)
+            {
+                append(super::facade->GetCoordinateOfNode(target_geometry[index]));
+            }
+        }
+        append(target_phantom.location);
+
+        return length;
+    }
+
+    PackedEdgeLength GetPackedEdgeLength(const NodeID from,
+                                         const NodeID to,
+                                         PackedEdgeLengths &packed_edge_lengths) const
+    {
+        const std::uint64_t key = (static_cast<std::uint64_t>(from) << 32) | to;
+        const auto cached_length = packed_edge_lengths.find(key);
+        if (cached_length != packed_edge_lengths.end())
+        {
+            return cached_length->second;
+        }
+
+        // same choice of edge as in UnpackPath
+        EdgeID smaller_edge_id = SPECIAL_EDGEID;
+        EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
+        for (const auto edge_id : super::facade->GetAdjacentEdgeRange(from))
+        {
+            const auto &data = super::facade->GetEdgeData(edge_id);
+            if (super::facade->GetTarget(edge_id) == to && data.distance < edge_weight &&
+                data.forward)
+            {
+                smaller_edge_id = edge_id;
+                edge_weight = data.distance;
+            }
+        }
+        if (SPECIAL_EDGEID == smaller_edge_id)
+        {
+            for (const auto edge_id : super::facade->GetAdjacentEdgeRange(to))
+            {
+                const auto &data = super::facade->GetEdgeData(edge_id);
+                if (super::facade->GetTarget(edge_id) == from && data.distance < edge_weight &&
+                    data.backward)
+                {
+                    smaller_edge_id = edge_id;
+                    edge_weight = data.distance;
+                }
+            }
+        }
+        BOOST_ASSERT_MSG(edge_weight != INVALID_EDGE_WEIGHT, "edge id invalid");
+
+        const auto &data = super::facade->GetEdgeData(smaller_edge_id);
+        PackedEdgeLength edge_length;
+        if (data.shortcut)
+        {
+            const auto first_half = GetPackedEdgeLength(from, data.id, packed_edge_lengths);
+            const auto second_half = GetPackedEdgeLength(data.id, to, packed_edge_lengths);
+            edge_length.first = first_half.first;
+            edge_length.last = second_half.last;
+            edge_length.length = first_half.length +
+                                 util::coordinate_calculation::haversineDistance(
+                                     first_half.last, second_half.first) +
+                                 second_half.length;
+        }
+        else
+        {
+            std::vector<NodeID> geometry;
+            super::facade->GetUncompressedGeometry(
+                super::facade->GetGeometryIndexForEdgeID(data.id), geometry);
+            BOOST_ASSERT(geometry.size() > 0);
+
+            edge_length.first = super::facade->GetCoordinateOfNode(geometry.front());
+            edge_length.last = edge_length.first;
+            edge_length.length = 0.;
+            for (const auto index : util::irange<std::size_t>(1UL, geometry.size()))
+            {
+                const auto coordinate = super::facade->GetCoordinateOfNode(geometry[index]);
+                edge_length.length +=
+                    util::coordinate_calculation::haversineDistance(edge_length.last, coordinate);
+                edge_length.last = coordinate;
+            }
+        }
+
+        packed_edge_lengths.emplace(key, edge_length);
+        return edge_length;
+    }
+
     template <bool forward_direction>
     inline void
     RelaxOutgoingEdges(const NodeID node, const EdgeWeight distance, QueryHeap &query_heap) const
@@ -0,0 +1,506 @@
+#ifndef ONE_TO_MANY_ROUTING_HPP
+#define ONE_TO_MANY_ROUTING_HPP
+
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+// Computes the durations from one source to every node of the graph with PHAST [1]:
+// an upward search from the source is followed by a single linear sweep over all nodes
+// in top-down order of the hierarchy that relaxes the downward edges.
+//
+// Every edge of the contracted graph is stored at the node that was contracted first, so all
+// edges of a node point upwards. This only holds for a fully contracted graph, the core of a
+// partially contracted graph is not a DAG.
+template <class DataFacadeT>
+class OneToManyRouting final
+    : public BasicRoutingInterface<DataFacadeT, OneToManyRouting<DataFacadeT>>
+{
+    using super = BasicRoutingInterface<DataFacadeT, OneToManyRouting<DataFacadeT>>;
+    using QueryHeap = SearchEngineData::QueryHeap;
+    SearchEngineData &engine_working_data;
+
+    // Nodes in the order of the downward sweep. Every node is placed after all nodes it has
+    // edges to. Only depends on the topology of the hierarchy, so it is computed once per dataset.
+    struct SweepOrder
+    {
+        unsigned checksum;
+        std::vector<NodeID> nodes;
+        // position of every node in nodes
+        std::vector<NodeID> positions;
+    };
+
+    // The part of the hierarchy that can reach a set of targets, in sweep order. Every
+    // downward edge is stored at the node it points to, ids are positions in nodes.
+    struct TargetSubgraph
+    {
+        struct Edge
+        {
+            NodeID from;
+            EdgeWeight weight;
+        };
+
+        std::vector<NodeID> nodes;
+        std::unordered_map<NodeID, NodeID> local_ids;
+        std::vector<std::size_t> first_edge;
+        std::vector<Edge> edges;
+    };
+
+    // Number of sources that share one sweep, eight 32 bit distances fill an AVX register
+    static constexpr std::size_t SOURCES_PER_SWEEP = 8;
+    // Marks unreached nodes in the sweep of the table search. Adding an edge weight to it can
+    // not overflow and it never propagates since it is the initial value of every node.
+    static constexpr EdgeWeight UNREACHED_WEIGHT = std::numeric_limits<EdgeWeight>::max() / 2;
+
+    mutable std::mutex sweep_order_mutex;
+    mutable std::shared_ptr<const SweepOrder> sweep_order;
+
+    // for the table entries the sweep can not compute, see UpdateTableEntry
+    ManyToManyRouting<DataFacadeT> many_to_many;
+
+  public:
+    OneToManyRouting(DataFacadeT *facade, SearchEngineData &engine_working_data)
+        : super(facade), engine_working_data(engine_working_data),
+          many_to_many(facade, engine_working_data)
+    {
+    }
+
+    // Returns the duration from the source to the start of every node of the graph or
+    // INVALID_EDGE_WEIGHT if the node is not reachable. Like the heap keys of the other
+    // routing algorithms the durations are relative to the position of the source on its segment.
+    std::vector<EdgeWeight> operator()(const PhantomNode &source) const
+    {
+        const auto order = GetSweepOrder();
+        const auto number_of_nodes = super::facade->GetNumberOfNodes();
+
+        std::vector<EdgeWeight> distances(number_of_nodes, INVALID_EDGE_WEIGHT);
+
+        engine_working_data.InitializeOrClearFirstThreadLocalStorage(number_of_nodes);
+        UpwardSearch(source, [&](const NodeID node, const EdgeWeight distance) {
+            distances[node] = distance;
+        });
+
+        // downward sweep, all nodes an edge points to are settled before the node itself
+        for (const NodeID node : order->nodes)
+        {
+            EdgeWeight distance = distances[node];
+            for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+            {
+                const auto &data = super::facade->GetEdgeData(edge);
+                if (!data.backward)
+                {
+                    continue;
+                }
+                const EdgeWeight from_distance = distances[super::facade->GetTarget(edge)];
+                if (from_distance != INVALID_EDGE_WEIGHT)
+                {
+                    distance = std::min(distance, from_distance + data.distance);
+                }
+            }
+            distances[node] = distance;
+        }
+
+        return distances;
+    }
+
+    // Computes a distance table like ManyToManyRouting with RPHAST [2]: the part of the
+    // hierarchy that can reach one of the targets is extracted once, after that every source
+    // only needs an upward search and a linear sweep over this subgraph. The sweep is done for
+    // SOURCES_PER_SWEEP sources at once so the inner loop can be vectorized.
+    std::vector<EdgeWeight> operator()(const std::vector<PhantomNode> &phantom_nodes,
+                                       const std::vector<std::size_t> &source_indices,
+                                       const std::vector<std::size_t> &target_indices) const
+    {
+        const auto number_of_sources =
+            source_indices.empty() ? phantom_nodes.size() : source_indices.size();
+        const auto number_of_targets =
+            target_indices.empty() ? phantom_nodes.size() : target_indices.size();
+        std::vector<EdgeWeight> result_table(number_of_sources * number_of_targets,
+                                             std::numeric_limits<EdgeWeight>::max());
+
+        const auto source_phantom = [&](const std::size_t row) -> const PhantomNode & {
+            return phantom_nodes[source_indices.empty() ? row : source_indices[row]];
+        };
+        const auto target_phantom = [&](const std::size_t column) -> const PhantomNode & {
+            return phantom_nodes[target_indices.empty() ? column : target_indices[column]];
+        };
+
+        std::vector<NodeID> target_nodes;
+        target_nodes.reserve(2 * number_of_targets);
+        for (const auto column : util::irange<std::size_t>(0UL, number_of_targets))
+        {
+            const auto &phantom = target_phantom(column);
+            if (phantom.forward_segment_id.enabled)
+            {
+                target_nodes.push_back(phantom.forward_segment_id.id);
+            }
+            if (phantom.reverse_segment_id.enabled)
+            {
+                target_nodes.push_back(phantom.reverse_segment_id.id);
+            }
+        }
+        const auto subgraph = SelectTargets(target_nodes);
+        const auto number_of_subgraph_nodes = subgraph.nodes.size();
+
+        engine_working_data.InitializeOrClearFirstThreadLocalStorage(
+            super::facade->GetNumberOfNodes());
+
+        // distances of all sources of a block are interleaved per node
+        std::vector<EdgeWeight> distances(number_of_subgraph_nodes * SOURCES_PER_SWEEP);
+        // entries of sources and targets on one segment that the sweep can not compute
+        std::vector<std::pair<std::size_t, std::size_t>> same_segment_entries;
+
+        for (std::size_t first_row = 0; first_row < number_of_sources;
+             first_row += SOURCES_PER_SWEEP)
+        {
+            const auto rows_in_block = std::min(SOURCES_PER_SWEEP, number_of_sources - first_row);
+
+            std::fill(distances.begin(), distances.end(), UNREACHED_WEIGHT);
+            for (const auto lane : util::irange<std::size_t>(0UL, rows_in_block))
+            {
+                UpwardSearch(source_phantom(first_row + lane),
+                             [&](const NodeID node, const EdgeWeight distance) {
+                                 const auto local_node = subgraph.local_ids.find(node);
+                                 if (local_node != subgraph.local_ids.end())
+                                 {
+                                     distances[local_node->second * SOURCES_PER_SWEEP + lane] =
+                                         distance;
+                                 }
+                             });
+            }
+
+            for (const auto local_node :
+                 util::irange<std::size_t>(0UL, number_of_subgraph_nodes))
+            {
+                EdgeWeight *node_distances = &distances[local_node * SOURCES_PER_SWEEP];
+                for (const auto edge : util::irange<std::size_t>(subgraph.first_edge[local_node],
+                                                                 subgraph.first_edge[local_node + 1]))
+                {
+                    const auto &subgraph_edge = subgraph.edges[edge];
+                    const EdgeWeight *from_distances =
+                        &distances[subgraph_edge.from * SOURCES_PER_SWEEP];
+                    for (std::size_t lane = 0; lane < SOURCES_PER_SWEEP; ++lane)
+                    {
+                        node_distances[lane] = std::min(
+                            node_distances[lane], from_distances[lane] + subgraph_edge.weight);
+                    }
+                }
+            }
+
+            for (const auto lane : util::irange<std::size_t>(0UL, rows_in_block))
+            {
+                const auto row = first_row + lane;
+                for (const auto column : util::irange<std::size_t>(0UL, number_of_targets))
+                {
+                    const auto &phantom = target_phantom(column);
+                    auto &current_distance = result_table[row * number_of_targets + column];
+                    bool is_complete = true;
+                    if (phantom.forward_segment_id.enabled)
+                    {
+                        is_complete &= UpdateTableEntry(phantom.forward_segment_id.id,
+                                                        phantom.GetForwardWeightPlusOffset(), lane,
+                                                        subgraph, distances, current_distance);
+                    }
+                    if (phantom.reverse_segment_id.enabled)
+                    {
+                        is_complete &= UpdateTableEntry(phantom.reverse_segment_id.id,
+                                                        phantom.GetReverseWeightPlusOffset(), lane,
+                                                        subgraph, distances, current_distance);
+                    }
+                    if (!is_complete)
+                    {
+                        same_segment_entries.emplace_back(row, column);
+                    }
+                }
+            }
+        }
+
+        // These entries are rare, each one is computed like the table service without RPHAST
+        for (const auto &entry : same_segment_entries)
+        {
+            const std::vector<PhantomNode> entry_phantoms = {source_phantom(entry.first),
+                                                             target_phantom(entry.second)};
+            result_table[entry.first * number_of_targets + entry.second] =
+                many_to_many(entry_phantoms, {0}, {1}).front();
+        }
+
+        return result_table;
+    }
+
+  private:
+    // Runs a search without stalling from the source on the upward edges and reports the
+    // exact distance of every node in the search space
+    template <typename SettleCallback>
+    void UpwardSearch(const PhantomNode &source, SettleCallback &&settle) const
+    {
+        QueryHeap &query_heap = *(engine_working_data.forward_heap_1);
+        query_heap.Clear();
+
+        if (source.forward_segment_id.enabled)
+        {
+            query_heap.Insert(source.forward_segment_id.id, -source.GetForwardWeightPlusOffset(),
+                              source.forward_segment_id.id);
+        }
+        if (source.reverse_segment_id.enabled)
+        {
+            query_heap.Insert(source.reverse_segment_id.id, -source.GetReverseWeightPlusOffset(),
+                              source.reverse_segment_id.id);
+        }
+
+        while (!query_heap.Empty())
+        {
+            const NodeID node = query_heap.DeleteMin();
+            const EdgeWeight distance = query_heap.GetKey(node);
+            settle(node, distance);
+            RelaxOutgoingEdges(node, distance, query_heap);
+        }
+    }
+
+    inline void
+    RelaxOutgoingEdges(const NodeID node, const EdgeWeight distance, QueryHeap &query_heap) const
+    {
+        for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+        {
+            const auto &data = super::facade->GetEdgeData(edge);
+            if (!data.forward)
+            {
+                continue;
+            }
+            const NodeID to = super::facade->GetTarget(edge);
+            const int edge_weight = data.distance;
+            BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
+            const int to_distance = distance + edge_weight;
+
+            // New Node discovered -> Add to Heap + Node Info Storage
+            if (!query_heap.WasInserted(to))
+            {
+                query_heap.Insert(to, to_distance, node);
+            }
+            // Found a shorter Path -> Update distance
+            else if (to_distance < query_heap.GetKey(to))
+            {
+                query_heap.GetData(to).parent = node;
+                query_heap.DecreaseKey(to, to_distance);
+            }
+        }
+    }
+
+    std::shared_ptr<const SweepOrder> GetSweepOrder() const
+    {
+        const auto checksum = super::facade->GetCheckSum();
+
+        std::lock_guard<std::mutex> lock(sweep_order_mutex);
+        if (!sweep_order || sweep_order->checksum != checksum ||
+            sweep_order->nodes.size() != super::facade->GetNumberOfNodes())
+        {
+            sweep_order = ComputeSweepOrder(checksum);
+        }
+        return sweep_order;
+    }
+
+    // Sorts the nodes by their depth in the hierarchy: the nodes without upward edges have
+    // depth zero, every other node is one deeper than the deepest node it has an edge to.
+    std::shared_ptr<const SweepOrder> ComputeSweepOrder(const unsigned checksum) const
+    {
+        const auto number_of_nodes = super::facade->GetNumberOfNodes();
+        const constexpr std::uint32_t UNKNOWN_DEPTH = std::numeric_limits<std::uint32_t>::max();
+        const constexpr std::uint32_t IN_PROGRESS = UNKNOWN_DEPTH - 1;
+
+        std::vector<std::uint32_t> depth(number_of_nodes, UNKNOWN_DEPTH);
+        std::uint32_t max_depth = 0;
+
+        // iterative depth first search, a node is finished once all nodes it points to are
+        std::vector<std::pair<NodeID, EdgeID>> stack;
+        for (const auto root : util::irange<NodeID>(0, number_of_nodes))
+        {
+            if (depth[root] != UNKNOWN_DEPTH)
+            {
+                continue;
+            }
+            depth[root] = IN_PROGRESS;
+            stack.emplace_back(root, super::facade->BeginEdges(root));
+            while (!stack.empty())
+            {
+                const NodeID node = stack.back().first;
+                const EdgeID edge = stack.back().second;
+                if (edge != super::facade->EndEdges(node))
+                {
+                    ++stack.back().second;
+                    const NodeID target = super::facade->GetTarget(edge);
+                    if (depth[target] == UNKNOWN_DEPTH)
+                    {
+                        depth[target] = IN_PROGRESS;
+                        stack.emplace_back(target, super::facade->BeginEdges(target));
+                    }
+                    continue;
+                }
+
+                std::uint32_t node_depth = 0;
+                for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+                {
+                    const NodeID target = super::facade->GetTarget(edge);
+                    if (target != node)
+                    {
+                        BOOST_ASSERT_MSG(depth[target] < IN_PROGRESS,
+                                         "hierarchy is not acyclic, graph has a core");
+                        node_depth = std::max(node_depth, depth[target] + 1);
+                    }
+                }
+                depth[node] = node_depth;
+                max_depth = std::max(max_depth, node_depth);
+                stack.pop_back();
+            }
+        }
+
+        // counting sort by depth, keeps the nodes of one depth in id order
+        std::vector<NodeID> offsets(max_depth + 2, 0);
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            ++offsets[depth[node] + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        auto order = std::make_shared<SweepOrder>();
+        order->checksum = checksum;
+        order->nodes.resize(number_of_nodes);
+        order->positions.resize(number_of_nodes);
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            order->positions[node] = offsets[depth[node]]++;
+            order->nodes[order->positions[node]] = node;
+        }
+
+        return order;
+    }
+
+    // Collects all nodes that reach one of the targets on a downward path: the targets and
+    // everything above them that is reachable on reversed downward edges.
+    TargetSubgraph SelectTargets(const std::vector<NodeID> &targets) const
+    {
+        const auto order = GetSweepOrder();
+
+        TargetSubgraph subgraph;
+        std::vector<NodeID> stack;
+        for (const NodeID target : targets)
+        {
+            if (subgraph.local_ids.emplace(target, SPECIAL_NODEID).second)
+            {
+                subgraph.nodes.push_back(target);
+                stack.push_back(target);
+            }
+        }
+        while (!stack.empty())
+        {
+            const NodeID node = stack.back();
+            stack.pop_back();
+            for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+            {
+                if (!super::facade->GetEdgeData(edge).backward)
+                {
+                    continue;
+                }
+                const NodeID from = super::facade->GetTarget(edge);
+                if (subgraph.local_ids.emplace(from, SPECIAL_NODEID).second)
+                {
+                    subgraph.nodes.push_back(from);
+                    stack.push_back(from);
+                }
+            }
+        }
+
+        std::sort(subgraph.nodes.begin(), subgraph.nodes.end(),
+                  [&order](const NodeID lhs, const NodeID rhs) {
+                      return order->positions[lhs] < order->positions[rhs];
+                  });
+        for (const auto local_node : util::irange<std::size_t>(0UL, subgraph.nodes.size()))
+        {
+            subgraph.local_ids[subgraph.nodes[local_node]] = local_node;
+        }
+
+        subgraph.first_edge.reserve(subgraph.nodes.size() + 1);
+        for (const NodeID node : subgraph.nodes)
+        {
+            subgraph.first_edge.push_back(subgraph.edges.size());
+            for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+            {
+                const auto &data = super::facade->GetEdgeData(edge);
+                if (!data.backward)
+                {
+                    continue;
+                }
+                const NodeID from = super::facade->GetTarget(edge);
+                BOOST_ASSERT(subgraph.local_ids.count(from) > 0);
+                subgraph.edges.push_back({subgraph.local_ids[from], data.distance});
+            }
+        }
+        subgraph.first_edge.push_back(subgraph.edges.size());
+
+        return subgraph;
+    }
+
+    // Returns false if the entry needs another search. A negative distance means that the source
+    // lies behind the target on the same segment. The sweep only keeps the shortest distance of
+    // every node, which is this invalid one, so the paths around the block that ManyToManyRouting
+    // finds over other middle nodes are lost.
+    bool UpdateTableEntry(const NodeID node,
+                          const EdgeWeight target_weight,
+                          const std::size_t lane,
+                          const TargetSubgraph &subgraph,
+                          const std::vector<EdgeWeight> &distances,
+                          EdgeWeight &current_distance) const
+    {
+        const auto local_node = subgraph.local_ids.find(node);
+        BOOST_ASSERT(local_node != subgraph.local_ids.end());
+        const EdgeWeight source_distance =
+            distances[local_node->second * SOURCES_PER_SWEEP + lane];
+        if (source_distance >= UNREACHED_WEIGHT)
+        {
+            return true;
+        }
+
+        const EdgeWeight new_distance = source_distance + target_weight;
+        if (new_distance < 0)
+        {
+            return false;
+        }
+        current_distance = std::min(current_distance, new_distance);
+        return true;
+    }
+};
+
+//[1] "PHAST: Hardware-Accelerated Shortest Path Trees"; D. Delling, A. Goldberg, A. Nowatzyk,
+// R. Werneck; 2011; IPDPS
+//[2] "Faster Batched Shortest Paths in Road Networks"; D. Delling, A. Goldberg, R. Werneck;
+// 2011; ATMOS
+
+template <class DataFacadeT>
+constexpr std::size_t OneToManyRouting<DataFacadeT>::SOURCES_PER_SWEEP;
+template <class DataFacadeT>
+constexpr EdgeWeight OneToManyRouting<DataFacadeT>::UNREACHED_WEIGHT;
+}
+}
+}
+
+#endif // ONE_TO_MANY_ROUTING_HPP
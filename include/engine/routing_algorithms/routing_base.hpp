@@ -2,6 +2,7 @@
 #define ROUTING_BASE_HPP
 
 #include "engine/internal_route_result.hpp"
+#include "engine/landmark_potential.hpp"
 #include "engine/search_engine_data.hpp"
 #include "extractor/guidance/turn_instruction.hpp"
 #include "util/coordinate_calculation.hpp"
@@ -27,6 +28,12 @@ namespace engine
 namespace routing_algorithms
 {
 
+// Potential of a plain Dijkstra search
+struct ZeroPotential
+{
+    EdgeWeight operator()(const NodeID /*node*/) const { return 0; }
+};
+
 template <class DataFacadeT, class Derived> class BasicRoutingInterface
 {
   private:
@@ -70,7 +77,13 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
     (d, z) with weight 100, (c, z) with weight 0 corresponding.
     Since we are dealing with a graph that contains _negative_ edges,
     we need to add an offset to the termination criterion.
+
+    With a potential the keys are the distances plus the potential of the node (A*). The
+    potential must not make any reduced edge weight negative, and nodes with a potential of
+    INVALID_EDGE_WEIGHT are not inserted. Stalling compares plain distances and can not be
+    combined with a potential.
     */
+    template <typename PotentialT = ZeroPotential>
     void RoutingStep(SearchEngineData::QueryHeap &forward_heap,
                      SearchEngineData::QueryHeap &reverse_heap,
                      NodeID &middle_node_id,
@@ -79,7 +92,8 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                      const bool forward_direction,
                      const bool stalling,
                      const bool force_loop_forward,
-                     const bool force_loop_reverse) const
+                     const bool force_loop_reverse,
+                     const PotentialT &potential = PotentialT()) const
     {
         const NodeID node = forward_heap.DeleteMin();
         const std::int32_t distance = forward_heap.GetKey(node);
@@ -158,6 +172,7 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
             }
         }
 
+        const EdgeWeight node_potential = potential(node);
         for (const auto edge : facade->GetAdjacentEdgeRange(node))
         {
             const EdgeData &data = facade->GetEdgeData(edge);
@@ -169,7 +184,12 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                 const EdgeWeight edge_weight = data.distance;
 
                 BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-                const int to_distance = distance + edge_weight;
+                const EdgeWeight to_potential = potential(to);
+                if (to_potential == INVALID_EDGE_WEIGHT)
+                {
+                    continue;
+                }
+                const int to_distance = distance + edge_weight + to_potential - node_potential;
 
                 // New Node discovered -> Add to Heap + Node Info Storage
                 if (!forward_heap.WasInserted(to))
@@ -573,6 +593,67 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
         }
     }
 
+    // Bidirectional search on the core from the entry points that SearchWithCore found. The keys
+    // of both heaps include the potential of the node, which is zero for a plain Dijkstra.
+    template <typename ForwardPotentialT, typename ReversePotentialT>
+    void CoreSearch(SearchEngineData::QueryHeap &forward_core_heap,
+                    SearchEngineData::QueryHeap &reverse_core_heap,
+                    const std::vector<std::pair<NodeID, EdgeWeight>> &forward_entry_points,
+                    const std::vector<std::pair<NodeID, EdgeWeight>> &reverse_entry_points,
+                    NodeID &middle,
+                    int &distance,
+                    const bool force_loop_forward,
+                    const bool force_loop_reverse,
+                    const ForwardPotentialT &forward_potential,
+                    const ReversePotentialT &reverse_potential) const
+    {
+        forward_core_heap.Clear();
+        reverse_core_heap.Clear();
+        for (const auto &p : forward_entry_points)
+        {
+            const EdgeWeight potential = forward_potential(p.first);
+            if (potential != INVALID_EDGE_WEIGHT)
+            {
+                forward_core_heap.Insert(p.first, p.second + potential, p.first);
+            }
+        }
+        for (const auto &p : reverse_entry_points)
+        {
+            const EdgeWeight potential = reverse_potential(p.first);
+            if (potential != INVALID_EDGE_WEIGHT)
+            {
+                reverse_core_heap.Insert(p.first, p.second + potential, p.first);
+            }
+        }
+
+        // get offset to account for offsets on phantom nodes on compressed edges. The keys in the
+        // heaps include the potentials, so the offset is taken from the plain entry weights.
+        int min_core_edge_offset = 0;
+        for (const auto &p : forward_entry_points)
+        {
+            min_core_edge_offset = std::min(min_core_edge_offset, p.second);
+        }
+        for (const auto &p : reverse_entry_points)
+        {
+            min_core_edge_offset = std::min(min_core_edge_offset, p.second);
+        }
+        BOOST_ASSERT(min_core_edge_offset <= 0);
+
+        // run two-target Dijkstra routing step on core with termination criterion
+        const constexpr bool STALLING_DISABLED = false;
+        while (0 < forward_core_heap.Size() && 0 < reverse_core_heap.Size() &&
+               distance > (forward_core_heap.MinKey() + reverse_core_heap.MinKey()))
+        {
+            RoutingStep(forward_core_heap, reverse_core_heap, middle, distance,
+                        min_core_edge_offset, true, STALLING_DISABLED, force_loop_forward,
+                        force_loop_reverse, forward_potential);
+
+            RoutingStep(reverse_core_heap, forward_core_heap, middle, distance,
+                        min_core_edge_offset, false, STALLING_DISABLED, force_loop_reverse,
+                        force_loop_forward, reverse_potential);
+        }
+    }
+
     // assumes that heaps are already setup correctly.
     // A forced loop might be necessary, if source and target are on the same segment.
     // If this is the case and the offsets of the respective direction are larger for the source
@@ -637,61 +718,45 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
             }
         }
         // TODO check if unordered_set might be faster
-        // sort by id and increasing by distance
+        // sort by id and increasing by distance, keep the shortest distance of every node
         auto entry_point_comparator = [](const std::pair<NodeID, EdgeWeight> &lhs,
                                          const std::pair<NodeID, EdgeWeight> &rhs) {
             return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
         };
+        auto same_entry_point = [](const std::pair<NodeID, EdgeWeight> &lhs,
+                                   const std::pair<NodeID, EdgeWeight> &rhs) {
+            return lhs.first == rhs.first;
+        };
         std::sort(forward_entry_points.begin(), forward_entry_points.end(), entry_point_comparator);
         std::sort(reverse_entry_points.begin(), reverse_entry_points.end(), entry_point_comparator);
-
-        NodeID last_id = SPECIAL_NODEID;
-        forward_core_heap.Clear();
-        reverse_core_heap.Clear();
-        for (const auto &p : forward_entry_points)
-        {
-            if (p.first == last_id)
-            {
-                continue;
-            }
-            forward_core_heap.Insert(p.first, p.second, p.first);
-            last_id = p.first;
+        forward_entry_points.erase(std::unique(forward_entry_points.begin(),
+                                               forward_entry_points.end(), same_entry_point),
+                                   forward_entry_points.end());
+        reverse_entry_points.erase(std::unique(reverse_entry_points.begin(),
+                                               reverse_entry_points.end(), same_entry_point),
+                                   reverse_entry_points.end());
+
+        // A forced loop rejects meetings at the entry points, which breaks the termination
+        // argument of the A* search. Such loops are rare, so they use the plain search.
+        if (facade->GetNumberOfLandmarks() > 0 && !force_loop_forward && !force_loop_reverse)
+        {
+            const LandmarkPotential<DataFacadeT> landmark_potential(
+                *facade, forward_entry_points, reverse_entry_points);
+            CoreSearch(forward_core_heap, reverse_core_heap, forward_entry_points,
+                       reverse_entry_points, middle, distance, force_loop_forward,
+                       force_loop_reverse,
+                       [&landmark_potential](const NodeID node) {
+                           return landmark_potential.Forward(node);
+                       },
+                       [&landmark_potential](const NodeID node) {
+                           return landmark_potential.Reverse(node);
+                       });
         }
-        last_id = SPECIAL_NODEID;
-        for (const auto &p : reverse_entry_points)
-        {
-            if (p.first == last_id)
-            {
-                continue;
-            }
-            reverse_core_heap.Insert(p.first, p.second, p.first);
-            last_id = p.first;
-        }
-
-        // get offset to account for offsets on phantom nodes on compressed edges
-        int min_core_edge_offset = 0;
-        if (forward_core_heap.Size() > 0)
-        {
-            min_core_edge_offset = std::min(min_core_edge_offset, forward_core_heap.MinKey());
-        }
-        if (reverse_core_heap.Size() > 0 && reverse_core_heap.MinKey() < 0)
-        {
-            min_core_edge_offset = std::min(min_core_edge_offset, reverse_core_heap.MinKey());
-        }
-        BOOST_ASSERT(min_core_edge_offset <= 0);
-
-        // run two-target Dijkstra routing step on core with termination criterion
-        const constexpr bool STALLING_DISABLED = false;
-        while (0 < forward_core_heap.Size() && 0 < reverse_core_heap.Size() &&
-               distance > (forward_core_heap.MinKey() + reverse_core_heap.MinKey()))
+        else
         {
-            RoutingStep(forward_core_heap, reverse_core_heap, middle, distance,
-                        min_core_edge_offset, true, STALLING_DISABLED, force_loop_forward,
-                        force_loop_reverse);
-
-            RoutingStep(reverse_core_heap, forward_core_heap, middle, distance,
-                        min_core_edge_offset, false, STALLING_DISABLED, force_loop_reverse,
-                        force_loop_forward);
+            CoreSearch(forward_core_heap, reverse_core_heap, forward_entry_points,
+                       reverse_entry_points, middle, distance, force_loop_forward,
+                       force_loop_reverse, ZeroPotential(), ZeroPotential());
         }
 
         // No path found for both target nodes?
@@ -4,6 +4,8 @@
 #include "extractor/travel_mode.hpp"
 #include "util/typedefs.hpp"
 
+#include <cstdint>
+
 namespace osrm
 {
 namespace extractor
@@ -33,6 +35,23 @@ struct EdgeBasedEdge
     bool backward : 1;
 };
 
+// Follows the fingerprint at the start of the .ebg file, the edges follow the header
+struct EdgeBasedGraphHeader
+{
+    // "OSRMEBG" and the version of the layout. Files without this header start with the number
+    // of edges, which never matches.
+    static const constexpr std::uint64_t CURRENT_MAGIC = 0x4f53524d45424702;
+
+    std::uint64_t magic;
+    std::uint64_t number_of_edges;
+    std::uint64_t max_edge_id;
+    // Identifies the extract. osrm-extract writes a new one on every run, weight updates keep it.
+    std::uint64_t extract_id;
+    // Set by osrm-contract once a --segment-speed-file update changed the weights in the
+    // .geometry file. Those updates are not written back into the edges of this file.
+    std::uint64_t stale_edge_weights;
+};
+
 // Impl.
 
 inline EdgeBasedEdge::EdgeBasedEdge()
@@ -42,6 +42,8 @@ namespace osrm
 namespace extractor
 {
 
+class ProfilePlugin;
+
 class EdgeBasedGraphFactory
 {
   public:
@@ -57,8 +59,11 @@ class EdgeBasedGraphFactory
                                    ProfileProperties profile_properties,
                                    const util::NameTable &name_table);
 
+    // The turn penalties and name suffixes come from the profile plugin if there is one,
+    // otherwise from the lua profile
     void Run(const std::string &original_edge_data_filename,
              lua_State *lua_state,
+             const ProfilePlugin *profile_plugin,
              const std::string &edge_segment_lookup_filename,
              const std::string &edge_penalty_filename,
              const bool generate_edge_lookup);
@@ -88,7 +93,8 @@ class EdgeBasedGraphFactory
                                           const NodeID w,
                                           const double angle) const;
 
-    std::int32_t GetTurnPenalty(double angle, lua_State *lua_state) const;
+    std::int32_t
+    GetTurnPenalty(double angle, lua_State *lua_state, const ProfilePlugin *profile_plugin) const;
 
   private:
     using EdgeData = util::NodeBasedDynamicGraph::EdgeData;
@@ -123,6 +129,7 @@ class EdgeBasedGraphFactory
     void GenerateEdgeExpandedNodes();
     void GenerateEdgeExpandedEdges(const std::string &original_edge_data_filename,
                                    lua_State *lua_state,
+                                   const ProfilePlugin *profile_plugin,
                                    const std::string &edge_segment_lookup_filename,
                                    const std::string &edge_fixed_penalties_filename,
                                    const bool generate_edge_lookup);
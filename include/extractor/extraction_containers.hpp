@@ -5,9 +5,14 @@
 #include "extractor/first_and_last_segment_of_way.hpp"
 #include "extractor/scripting_environment.hpp"
 #include "extractor/external_memory_node.hpp"
+#include "extractor/node_index.hpp"
+#include "extractor/profile_plugin.hpp"
 #include "extractor/restriction.hpp"
+#include "util/external_vector.hpp"
 
-#include <stxxl/vector>
+#include <boost/optional/optional.hpp>
+
+#include <memory>
 #include <unordered_map>
 
 namespace osrm
@@ -16,45 +21,43 @@ namespace extractor
 {
 
 /**
- * Uses external memory containers from stxxl to store all the data that
- * is collected by the extractor callbacks.
+ * Uses external memory containers from stxxl (or plain vectors in builds
+ * without stxxl) to store all the data that is collected by the extractor callbacks.
  *
  * The data is the filtered, aggregated and finally written to disk.
  */
 class ExtractionContainers
 {
-#ifndef _MSC_VER
-    constexpr static unsigned stxxl_memory =
-        ((sizeof(std::size_t) == 4) ? std::numeric_limits<int>::max()
-                                    : std::numeric_limits<unsigned>::max());
-#else
-    const static unsigned stxxl_memory = ((sizeof(std::size_t) == 4) ? INT_MAX : UINT_MAX);
-#endif
     void PrepareNodes();
     void PrepareRestrictions();
-    void PrepareEdges(lua_State *segment_state);
+    void PrepareEdges(lua_State *segment_state, const ProfilePlugin *profile_plugin);
 
     void WriteNodes(std::ofstream &file_out_stream) const;
     void WriteRestrictions(const std::string &restrictions_file_name) const;
     void WriteEdges(std::ofstream &file_out_stream) const;
     void WriteNames(const std::string &names_file_name) const;
 
+    // Looks a node up in the node index
+    boost::optional<ExternalMemoryNode> FindNode(const OSMNodeID node_id) const;
+
   public:
-    using STXXLNodeIDVector = stxxl::vector<OSMNodeID>;
-    using STXXLNodeVector = stxxl::vector<ExternalMemoryNode>;
-    using STXXLEdgeVector = stxxl::vector<InternalExtractorEdge>;
-    using STXXLRestrictionsVector = stxxl::vector<InputRestrictionContainer>;
-    using STXXLWayIDStartEndVector = stxxl::vector<FirstAndLastSegmentOfWay>;
+    using STXXLNodeIDVector = util::ExternalVector<OSMNodeID>;
+    using STXXLNodeVector = util::ExternalVector<ExternalMemoryNode>;
+    using STXXLEdgeVector = util::ExternalVector<InternalExtractorEdge>;
+    using STXXLRestrictionsVector = util::ExternalVector<InputRestrictionContainer>;
+    using STXXLWayIDStartEndVector = util::ExternalVector<FirstAndLastSegmentOfWay>;
 
     STXXLNodeIDVector used_node_id_list;
     STXXLNodeVector all_nodes_list;
     STXXLEdgeVector all_edges_list;
-    stxxl::vector<char> name_char_data;
-    stxxl::vector<unsigned> name_lengths;
+    util::ExternalVector<char> name_char_data;
+    util::ExternalVector<unsigned> name_lengths;
     STXXLRestrictionsVector restrictions_list;
     STXXLWayIDStartEndVector way_start_end_id_list;
     std::unordered_map<OSMNodeID, NodeID> external_to_internal_node_id_map;
     unsigned max_internal_node_id;
+    // If set, nodes are looked up in this index instead of being merged with sorted lists
+    std::unique_ptr<NodeIndex> node_index;
 
     ExtractionContainers();
 
@@ -63,7 +66,8 @@ class ExtractionContainers
     void PrepareData(const std::string &output_file_name,
                      const std::string &restrictions_file_name,
                      const std::string &names_file_name,
-                     lua_State *segment_state);
+                     lua_State *segment_state,
+                     const ProfilePlugin *profile_plugin);
 };
 }
 }
@@ -0,0 +1,107 @@
+#ifndef OSRM_EXTRACTOR_EXTRACTION_STATE_HPP
+#define OSRM_EXTRACTOR_EXTRACTION_STATE_HPP
+
+#include "extractor/extraction_node.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/guidance/classification_data.hpp"
+#include "extractor/restriction.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <osmium/memory/buffer.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace osmium
+{
+class Node;
+class Way;
+class Relation;
+}
+
+namespace osrm
+{
+namespace extractor
+{
+
+class ExtractorCallbacks;
+struct ExternalMemoryNode;
+
+/**
+ * The .osrm.state file keeps everything the extractor took from the input file: all nodes, the
+ * profile results of all routable ways and all turn restrictions, together with their OSM ids.
+ * It lets osrm-extract --apply-changes update an extract from OSM change files without reading
+ * the input file again and without calling the profile for objects that did not change.
+ *
+ * The file starts with the util::FingerPrint of osrm-extract and a CRC-32 of the profile, which
+ * for lua profiles includes all scripts in the folder of the profile and its subfolders. So it is
+ * only read by the same build with the same profile and libraries. A sequence of records in input
+ * order follows, each starting with a uint8 record type:
+ *  node: ExternalMemoryNode
+ *  way: OSMWayID, RoadClassificationData, double forward speed, backward speed and duration,
+ *       uint8 roundabout, is_access_restricted, is_startpoint, forward and backward mode,
+ *       uint32 name length, name, uint32 number of nodes, OSMNodeID nodes[]
+ *  restriction: uint64 OSM relation id, InputRestrictionContainer
+ */
+class ExtractionStateWriter
+{
+  public:
+    ExtractionStateWriter(const std::string &path, const std::string &profile_path);
+
+    void WriteNode(const ExternalMemoryNode &node);
+    void WriteWay(const OSMWayID way_id,
+                  const std::vector<OSMNodeID> &node_ids,
+                  const guidance::RoadClassificationData &road_classification,
+                  const ExtractionWay &parsed_way);
+    void WriteRestriction(const std::uint64_t relation_id,
+                          const InputRestrictionContainer &restriction);
+
+  private:
+    boost::filesystem::ofstream state_stream;
+};
+
+/**
+ * Latest versions of the objects of one or more OSM change files together with their profile
+ * results. Deleted objects are kept without a version, so they hide the old ones in the state.
+ */
+class ExtractionChanges
+{
+  public:
+    ExtractionChanges();
+
+    // warning: caller needs to take care of synchronization!
+    void AddNode(const osmium::Node &node, const ExtractionNode &result_node);
+    void AddWay(const osmium::Way &way, const ExtractionWay &result_way);
+    void AddRelation(const osmium::Relation &relation,
+                     const boost::optional<InputRestrictionContainer> &restriction);
+
+    // Passes the unchanged objects of the state file and the new versions of the changed objects
+    // to the callbacks, ordered like an input file sorted by type and id that contains the changes.
+    // Throws if the state file was written by another build or with another profile.
+    void Apply(const std::string &state_path,
+               const std::string &profile_path,
+               ExtractorCallbacks &callbacks) const;
+
+  private:
+    // offset of the copy of the object in the buffer, or DELETED
+    template <typename ResultT> struct Change
+    {
+        std::size_t offset;
+        ResultT result;
+    };
+    static const constexpr std::size_t DELETED = static_cast<std::size_t>(-1);
+
+    osmium::memory::Buffer buffer;
+    std::map<OSMNodeID, Change<ExtractionNode>> nodes;
+    std::map<OSMWayID, Change<ExtractionWay>> ways;
+    std::map<std::uint64_t, boost::optional<InputRestrictionContainer>> restrictions;
+};
+}
+}
+
+#endif // OSRM_EXTRACTOR_EXTRACTION_STATE_HPP
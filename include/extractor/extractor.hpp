@@ -44,6 +44,7 @@ namespace extractor
 {
 
 struct ProfileProperties;
+class ProfilePlugin;
 
 class Extractor
 {
@@ -56,6 +57,7 @@ class Extractor
 
     std::pair<std::size_t, std::size_t>
     BuildEdgeExpandedGraph(lua_State *lua_state,
+                           const ProfilePlugin *profile_plugin,
                            const ProfileProperties &profile_properties,
                            std::vector<QueryNode> &internal_to_external_node_map,
                            std::vector<EdgeBasedNode> &node_based_edge_list,
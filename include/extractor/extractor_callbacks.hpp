@@ -1,11 +1,15 @@
 #ifndef EXTRACTOR_CALLBACKS_HPP
 #define EXTRACTOR_CALLBACKS_HPP
 
+#include "extractor/guidance/classification_data.hpp"
 #include "util/typedefs.hpp"
 #include <boost/optional/optional_fwd.hpp>
 
+#include <tbb/concurrent_unordered_map.h>
+
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace osmium
 {
@@ -19,6 +23,8 @@ namespace extractor
 {
 
 class ExtractionContainers;
+class ExtractionStateWriter;
+struct ExternalMemoryNode;
 struct InputRestrictionContainer;
 struct ExtractionNode;
 struct ExtractionWay;
@@ -29,16 +35,31 @@ struct ExtractionWay;
  *
  * It mediates between the multi-threaded extraction process and the external memory containers.
  * Thus the synchronization is handled inside of the extractor.
+ *
+ * If a state writer is given, all objects that are used for routing are also written to the
+ * .osrm.state file, see ExtractionStateWriter.
  */
 class ExtractorCallbacks
 {
   private:
-    // used to deduplicate street names: actually maps to name ids
-    std::unordered_map<std::string, NodeID> string_map;
+    // used to deduplicate street names: actually maps to name ids. Only ProcessWay inserts,
+    // lookups are safe from any thread at the same time.
+    tbb::concurrent_unordered_map<std::string, unsigned> string_map;
     ExtractionContainers &external_memory;
+    ExtractionStateWriter *state_writer;
+
+    // Splits a way into edges, the node ids are taken from the range [first_node_id, last_node_id)
+    template <typename NodeIDIterator>
+    void ProcessWayNodes(const OSMWayID way_id,
+                         const NodeIDIterator first_node_id,
+                         const NodeIDIterator last_node_id,
+                         const guidance::RoadClassificationData &road_classification,
+                         const ExtractionWay &parsed_way,
+                         unsigned name_id);
 
   public:
-    explicit ExtractorCallbacks(ExtractionContainers &extraction_containers);
+    explicit ExtractorCallbacks(ExtractionContainers &extraction_containers,
+                                ExtractionStateWriter *state_writer = nullptr);
 
     ExtractorCallbacks(const ExtractorCallbacks &) = delete;
     ExtractorCallbacks &operator=(const ExtractorCallbacks &) = delete;
@@ -47,10 +68,28 @@ class ExtractorCallbacks
     void ProcessNode(const osmium::Node &current_node, const ExtractionNode &result_node);
 
     // warning: caller needs to take care of synchronization!
-    void ProcessRestriction(const boost::optional<InputRestrictionContainer> &restriction);
+    void ProcessNode(const ExternalMemoryNode &node);
+
+    // warning: caller needs to take care of synchronization!
+    void ProcessRestriction(const std::uint64_t relation_id,
+                            const boost::optional<InputRestrictionContainer> &restriction);
+
+    // Returns the id of a name that an earlier way added, or INVALID_NAMEID. Can be called
+    // from any thread, also while ProcessWay runs. Since ids never change, the result can be
+    // passed to ProcessWay to skip the lookup there.
+    unsigned GetNameID(const std::string &name) const;
+
+    // warning: caller needs to take care of synchronization!
+    void ProcessWay(const osmium::Way &current_way,
+                    const ExtractionWay &result_way,
+                    const unsigned name_id = INVALID_NAMEID);
 
     // warning: caller needs to take care of synchronization!
-    void ProcessWay(const osmium::Way &current_way, const ExtractionWay &result_way);
+    void ProcessWay(const OSMWayID way_id,
+                    const std::vector<OSMNodeID> &node_ids,
+                    const guidance::RoadClassificationData &road_classification,
+                    const ExtractionWay &parsed_way,
+                    const unsigned name_id = INVALID_NAMEID);
 };
 }
 }
@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string>
 #include <array>
+#include <vector>
 
 namespace osrm
 {
@@ -40,7 +41,7 @@ namespace extractor
 
 struct ExtractorConfig
 {
-    ExtractorConfig() noexcept : requested_num_threads(0) {}
+    ExtractorConfig() noexcept : requested_num_threads(0), keep_state(false) {}
     void UseDefaultOutputNames()
     {
         std::string basepath = input_path.string();
@@ -73,6 +74,7 @@ struct ExtractorConfig
         edge_based_node_weights_output_path = basepath + ".osrm.enw";
         profile_properties_output_path = basepath + ".osrm.properties";
         intersection_class_data_output_path = basepath  + ".osrm.icd";
+        state_file_name = basepath + ".osrm.state";
     }
 
     boost::filesystem::path config_file_path;
@@ -99,6 +101,15 @@ struct ExtractorConfig
     bool generate_edge_lookup;
     std::string edge_penalty_path;
     std::string edge_segment_lookup_path;
+
+    // write .osrm.state to allow updating the extract from OSM change files
+    bool keep_state;
+    std::string state_file_name;
+    // OSM change files that are applied to .osrm.state instead of reading the input file
+    std::vector<boost::filesystem::path> change_paths;
+
+    // "dense" or "sparse" look nodes up in a NodeIndex, otherwise sorted lists are merged
+    std::string node_index;
 };
 }
 }
@@ -0,0 +1,68 @@
+#ifndef OSRM_EXTRACTOR_NODE_INDEX_HPP
+#define OSRM_EXTRACTOR_NODE_INDEX_HPP
+
+#include "util/exception.hpp"
+#include "util/make_unique.hpp"
+
+#include <osmium/index/map.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/dense_mmap_array.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Position of every node in ExtractionContainers::all_nodes_list by its OSM id. With an index
+ * the extractor looks up the nodes of the edges directly. It does not need to sort the nodes and
+ * the edges by OSM id for merge joins with the nodes.
+ *
+ * The index types are osmium's index maps:
+ *  dense:  DenseMmapArray, an array indexed by OSM id in anonymous mmap memory. It needs 8 bytes
+ *          per id up to the largest node id, which makes it the choice for planet extracts.
+ *  sparse: SparseMemArray, 16 bytes per node in a vector of (id, position) pairs that is sorted
+ *          once all nodes are read. Lookups are binary searches. Best for smaller extracts.
+ *
+ * The index stores the position plus one. The dense arrays return 0 for ids that were never set.
+ *
+ * Builds with ENABLE_STXXL do not support node indexes: all_nodes_list is an stxxl::vector there,
+ * and every lookup by position would be a random access to external memory.
+ */
+using NodeIndex = osmium::index::map::Map<osmium::unsigned_object_id_type, std::size_t>;
+
+inline bool isNodeIndexType(const std::string &type) { return type == "dense" || type == "sparse"; }
+
+inline std::unique_ptr<NodeIndex> makeNodeIndex(const std::string &type)
+{
+#ifdef ENABLE_STXXL
+    throw util::exception("Node index " + type + " needs a build with -DENABLE_STXXL=OFF");
+#else
+    if (type == "dense")
+    {
+#ifdef OSMIUM_HAS_INDEX_MAP_DENSE_MMAP_ARRAY
+        return util::make_unique<osmium::index::map::DenseMmapArray<
+            osmium::unsigned_object_id_type, std::size_t>>();
+#else
+        return util::make_unique<
+            osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, std::size_t>>();
+#endif
+    }
+    if (type == "sparse")
+    {
+        return util::make_unique<
+            osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, std::size_t>>();
+    }
+    throw util::exception("Unknown node index type " + type);
+#endif
+}
+}
+}
+
+#endif // OSRM_EXTRACTOR_NODE_INDEX_HPP
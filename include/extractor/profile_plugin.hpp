@@ -0,0 +1,100 @@
+#ifndef OSRM_EXTRACTOR_PROFILE_PLUGIN_HPP
+#define OSRM_EXTRACTOR_PROFILE_PLUGIN_HPP
+
+#include "extractor/extraction_node.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/internal_extractor_edge.hpp"
+#include "extractor/profile_properties.hpp"
+#include "util/coordinate.hpp"
+
+#include <string>
+#include <vector>
+
+namespace osmium
+{
+class Node;
+class Way;
+}
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * A profile written in C++ and compiled into a shared library, as an alternative to a lua
+ * profile. osrm-extract loads it if the profile path ends in .so, .dylib or .dll.
+ *
+ * Every function corresponds to a function or setting of a lua profile. The optional ones
+ * default to what osrm-extract does if a lua profile does not define them.
+ *
+ * The extractor calls the functions of one plugin object concurrently from all threads, they
+ * must not modify state that is shared between calls.
+ *
+ * A plugin is built against the headers of the osrm-extract it is loaded into, register it
+ * with OSRM_REGISTER_PROFILE_PLUGIN. See src/profiles/car.cpp for a port of car.lua.
+ */
+class ProfilePlugin
+{
+  public:
+    virtual ~ProfilePlugin() = default;
+
+    // the properties a lua profile sets on the global properties object
+    virtual ProfileProperties GetProperties() const = 0;
+
+    // get_name_suffix_list
+    virtual std::vector<std::string> GetNameSuffixList() const { return {}; }
+    // get_exceptions
+    virtual std::vector<std::string> GetRestrictionExceptions() const { return {}; }
+    // get_node_keys and get_way_keys, empty lists pass all objects to the plugin
+    virtual std::vector<std::string> GetNodeKeys() const { return {}; }
+    virtual std::vector<std::string> GetWayKeys() const { return {}; }
+
+    // node_function
+    virtual void ProcessNode(const osmium::Node &node, ExtractionNode &result) const = 0;
+    // way_function
+    virtual void ProcessWay(const osmium::Way &way, ExtractionWay &result) const = 0;
+
+    // turn_function, the angle is 0 for going straight and positive for right turns
+    virtual bool HasTurnFunction() const { return false; }
+    virtual double GetTurnPenalty(const double /*angle*/) const { return 0; }
+
+    // segment_function
+    virtual bool HasSegmentFunction() const { return false; }
+    virtual void ProcessSegment(const util::Coordinate & /*source*/,
+                                const util::Coordinate & /*target*/,
+                                const double /*distance*/,
+                                InternalExtractorEdge::WeightData & /*weight_data*/) const
+    {
+    }
+};
+
+// Changes whenever ProfilePlugin or the result structs change
+const constexpr unsigned PROFILE_PLUGIN_API_VERSION = 1;
+}
+}
+
+#ifdef _WIN32
+#define OSRM_PROFILE_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define OSRM_PROFILE_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+// Defines the entry points osrm-extract looks up in the shared library of a plugin
+#define OSRM_REGISTER_PROFILE_PLUGIN(PluginT)                                                    \
+    extern "C" OSRM_PROFILE_PLUGIN_EXPORT unsigned osrm_profile_plugin_api_version()             \
+    {                                                                                            \
+        return osrm::extractor::PROFILE_PLUGIN_API_VERSION;                                      \
+    }                                                                                            \
+    extern "C" OSRM_PROFILE_PLUGIN_EXPORT osrm::extractor::ProfilePlugin *                       \
+    osrm_create_profile_plugin()                                                                 \
+    {                                                                                            \
+        return new PluginT();                                                                    \
+    }                                                                                            \
+    extern "C" OSRM_PROFILE_PLUGIN_EXPORT void osrm_destroy_profile_plugin(                      \
+        osrm::extractor::ProfilePlugin *plugin)                                                  \
+    {                                                                                            \
+        delete plugin;                                                                           \
+    }
+
+#endif // OSRM_EXTRACTOR_PROFILE_PLUGIN_HPP
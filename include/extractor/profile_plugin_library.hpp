@@ -0,0 +1,46 @@
+#ifndef OSRM_EXTRACTOR_PROFILE_PLUGIN_LIBRARY_HPP
+#define OSRM_EXTRACTOR_PROFILE_PLUGIN_LIBRARY_HPP
+
+#include "extractor/profile_plugin.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <memory>
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Loads the shared library of a profile plugin and creates the plugin. The library stays
+ * loaded until the plugin is destroyed.
+ *
+ * Throws a util::exception if the library cannot be loaded, lacks the entry points of
+ * OSRM_REGISTER_PROFILE_PLUGIN or was built for a different PROFILE_PLUGIN_API_VERSION.
+ */
+class ProfilePluginLibrary
+{
+  public:
+    explicit ProfilePluginLibrary(const boost::filesystem::path &library_path);
+    ~ProfilePluginLibrary();
+
+    ProfilePluginLibrary(const ProfilePluginLibrary &) = delete;
+    ProfilePluginLibrary &operator=(const ProfilePluginLibrary &) = delete;
+
+    const ProfilePlugin &GetPlugin() const { return *plugin; }
+
+    // True for paths of shared libraries, all other profiles are lua scripts
+    static bool IsPluginPath(const boost::filesystem::path &profile_path);
+
+  private:
+    void *LoadSymbol(const char *name) const;
+
+    boost::filesystem::path library_path;
+    void *handle;
+    std::unique_ptr<ProfilePlugin, void (*)(ProfilePlugin *)> plugin;
+};
+}
+}
+
+#endif // OSRM_EXTRACTOR_PROFILE_PLUGIN_LIBRARY_HPP
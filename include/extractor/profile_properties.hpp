@@ -11,7 +11,8 @@ namespace extractor
 struct ProfileProperties
 {
     ProfileProperties()
-        : traffic_signal_penalty(0), u_turn_penalty(0), continue_straight_at_waypoint(true), use_turn_restrictions(false)
+        : traffic_signal_penalty(0), u_turn_penalty(0), continue_straight_at_waypoint(true), use_turn_restrictions(false),
+          use_tag_tables(false)
     {
     }
 
@@ -41,6 +42,8 @@ struct ProfileProperties
     int u_turn_penalty;
     bool continue_straight_at_waypoint;
     bool use_turn_restrictions;
+    //! pass the tags to node_function and way_function as a lua table
+    bool use_tag_tables;
 };
 }
 }
@@ -0,0 +1,54 @@
+#ifndef PROFILE_TAG_FILTER_HPP
+#define PROFILE_TAG_FILTER_HPP
+
+#include <string>
+#include <vector>
+
+struct lua_State;
+namespace osmium
+{
+class Node;
+class Way;
+class TagList;
+}
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Decides which nodes and ways have to be passed to the profile.
+ *
+ * A profile can list the tag keys its ```node_function``` and ```way_function``` depend on in
+ * the functions ```get_node_keys``` and ```get_way_keys```. Objects that have none of these
+ * keys get the default result without a call into lua. Most nodes of a planet have no tags at
+ * all, so this saves most of the lua calls of an extract.
+ * Profiles without these functions get all objects passed.
+ *
+ * Profile plugins pass their keys to the second constructor, empty lists pass all objects.
+ */
+class ProfileTagFilter
+{
+  public:
+    explicit ProfileTagFilter(lua_State *lua_state);
+    ProfileTagFilter(std::vector<std::string> node_keys, std::vector<std::string> way_keys);
+
+    bool IsRelevant(const osmium::Node &node) const;
+    bool IsRelevant(const osmium::Way &way) const;
+
+  private:
+    static bool ReadKeys(lua_State *lua_state,
+                         const char *function_name,
+                         std::vector<std::string> &keys);
+    static bool HasAnyKey(const osmium::TagList &tags, const std::vector<std::string> &keys);
+
+    std::vector<std::string> node_keys;
+    std::vector<std::string> way_keys;
+    bool filter_nodes;
+    bool filter_ways;
+};
+}
+}
+
+#endif /* PROFILE_TAG_FILTER_HPP */
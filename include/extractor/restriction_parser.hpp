@@ -43,6 +43,8 @@ class RestrictionParser
 {
   public:
     RestrictionParser(lua_State *lua_state, const ProfileProperties& properties);
+    RestrictionParser(const ProfileProperties &properties,
+                      std::vector<std::string> restriction_exceptions);
     boost::optional<InputRestrictionContainer> TryParse(const osmium::Relation &relation) const;
 
   private:
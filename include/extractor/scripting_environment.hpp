@@ -12,12 +12,21 @@
 #include <tbb/enumerable_thread_specific.h>
 
 struct lua_State;
+namespace osmium
+{
+class Node;
+class TagList;
+class Way;
+}
 
 namespace osrm
 {
 namespace extractor
 {
 
+struct ExtractionNode;
+struct ExtractionWay;
+
 /**
  * Creates a lua context and binds osmium way, node and relation objects and
  * ExtractionWay and ExtractionNode to lua objects.
@@ -42,6 +51,14 @@ class ScriptingEnvironment
 
     Context &GetContex();
 
+    // Call node_function and way_function of the profile in the context
+    static void ProcessNode(Context &context, const osmium::Node &node, ExtractionNode &result);
+    static void ProcessWay(Context &context, const osmium::Way &way, ExtractionWay &result);
+
+    // A lua table with all tags of an object for profiles that set properties.use_tag_tables.
+    // Keys that are not set read as "", like with get_value_by_key(key).
+    static luabind::object GetTagTable(lua_State *state, const osmium::TagList &tags);
+
   private:
     void InitContext(Context &context);
     std::mutex init_mutex;
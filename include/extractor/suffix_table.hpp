@@ -3,6 +3,7 @@
 
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 struct lua_State;
 
@@ -17,6 +18,7 @@ class SuffixTable final
 {
   public:
     SuffixTable(lua_State *lua_state);
+    explicit SuffixTable(std::vector<std::string> suffixes);
 
     // check whether a string is part of the know suffix list
     bool isSuffix(const std::string &possible_suffix) const;
@@ -44,6 +44,7 @@ using engine::api::NearestParameters;
 using engine::api::TripParameters;
 using engine::api::MatchParameters;
 using engine::api::TileParameters;
+using engine::api::IsochroneParameters;
 
 /**
  * Represents a Open Source Routing Machine with access to its services.
@@ -56,6 +57,7 @@ using engine::api::TileParameters;
  *  - Trip: shortest round trip between coordinates
  *  - Match: snaps noisy coordinate traces to the road network
  *  - Tile: vector tiles with internal graph representation
+ *  - Isochrone: locations reachable from a coordinate within a duration
  *
  *  All services take service-specific parameters, fill a JSON object, and return a status code.
  */
@@ -130,6 +132,15 @@ class OSRM final
      */
     Status Tile(const TileParameters &parameters, std::string &result);
 
+    /**
+     * Isochrone: locations reachable from a coordinate within a duration
+     *
+     * \param parameters isochrone query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, IsochroneParameters and json::Object
+     */
+    Status Isochrone(const IsochroneParameters &parameters, json::Object &result);
+
   private:
     std::unique_ptr<engine::Engine> engine_;
 };
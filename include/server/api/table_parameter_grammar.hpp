@@ -25,6 +25,7 @@ template <typename Iterator = std::string::iterator,
 struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Signature>
 {
     using BaseGrammar = BaseParametersGrammar<Iterator, Signature>;
+    using AnnotationsType = engine::api::TableParameters::AnnotationsType;
 
     TableParametersGrammar() : BaseGrammar(root_rule)
     {
@@ -47,7 +48,26 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
             > (qi::lit("all") | (size_t_ % ';')[ph::bind(&engine::api::TableParameters::sources, qi::_r1) = qi::_1])
             ;
 
-        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1);
+        const auto set_annotations = [](engine::api::TableParameters &parameters,
+                                        const std::vector<AnnotationsType> &annotations) {
+            parameters.annotations = AnnotationsType::None;
+            for (const auto annotation : annotations)
+            {
+                parameters.annotations = parameters.annotations | annotation;
+            }
+        };
+
+        annotations_type.add
+            ("duration", AnnotationsType::Duration)
+            ("distance", AnnotationsType::Distance)
+            ;
+
+        annotations_rule
+            = qi::lit("annotations=")
+            > (annotations_type % ',')[ph::bind(set_annotations, qi::_r1, qi::_1)]
+            ;
+
+        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1) | annotations_rule(qi::_r1);
 
         root_rule
             = BaseGrammar::query_rule(qi::_r1) > -qi::lit(".json")
@@ -60,7 +80,9 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
     qi::rule<Iterator, Signature> table_rule;
     qi::rule<Iterator, Signature> sources_rule;
     qi::rule<Iterator, Signature> destinations_rule;
+    qi::rule<Iterator, Signature> annotations_rule;
     qi::rule<Iterator, std::size_t()> size_t_;
+    qi::symbols<char, AnnotationsType> annotations_type;
 };
 }
 }
@@ -48,6 +48,10 @@ struct SharedDataLayout
         BEARING_BLOCKS,
         BEARING_VALUES,
         ENTRY_CLASS,
+        LANDMARK_LIST,
+        LANDMARK_CORE_BITS,
+        LANDMARK_CORE_RANKS,
+        LANDMARK_DISTANCES,
         NUM_BLOCKS
     };
 
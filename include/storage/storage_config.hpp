@@ -30,6 +30,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/filesystem/path.hpp>
 
+#include <string>
+
 namespace osrm
 {
 namespace storage
@@ -58,6 +60,8 @@ struct StorageConfig final
     boost::filesystem::path nodes_data_path;
     boost::filesystem::path edges_data_path;
     boost::filesystem::path core_data_path;
+    // optional, only written for hierarchies with a core
+    boost::filesystem::path landmarks_data_path;
     boost::filesystem::path geometries_path;
     boost::filesystem::path timestamp_path;
     boost::filesystem::path datasource_names_path;
@@ -66,6 +70,34 @@ struct StorageConfig final
     boost::filesystem::path properties_path;
     boost::filesystem::path intersection_class_path;
 };
+
+/**
+ * Configures the file paths of a named metric built with osrm-contract --metric.
+ *
+ * A metric only brings its own hierarchy, segment weights and datasources, everything else is
+ * shared with the dataset given by the base path.
+ *
+ * \see StorageConfig, EngineConfig
+ */
+struct MetricStorageConfig final
+{
+    /**
+     * Constructs a metric configuration setting paths based on a base path.
+     *
+     * \param base The base path (e.g. france.pbf.osrm) of the dataset the metric belongs to.
+     * \param name The name of the metric (e.g. night).
+     */
+    MetricStorageConfig(const boost::filesystem::path &base, std::string name);
+    bool IsValid() const;
+
+    std::string name;
+    boost::filesystem::path hsgr_data_path;
+    boost::filesystem::path core_data_path;
+    boost::filesystem::path landmarks_data_path;
+    boost::filesystem::path segment_weights_path;
+    boost::filesystem::path datasource_names_path;
+    boost::filesystem::path datasource_indexes_path;
+};
 }
 }
 
@@ -0,0 +1,68 @@
+#ifndef OSRM_UTIL_EXTERNAL_VECTOR_HPP
+#define OSRM_UTIL_EXTERNAL_VECTOR_HPP
+
+#ifdef ENABLE_STXXL
+#include <stxxl/sort>
+#include <stxxl/vector>
+#else
+#include "util/radix_sort.hpp"
+
+#include <tbb/parallel_sort.h>
+#endif
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/*
+ * Containers for the data sets of osrm-extract and osrm-contract that can outgrow the main
+ * memory. With ENABLE_STXXL these are stxxl::vectors that keep their data in external memory.
+ * Builds with -DENABLE_STXXL=OFF use plain std::vectors and sort them with tbb::parallel_sort,
+ * which is several times faster for extracts that fit into main memory.
+ */
+#ifdef ENABLE_STXXL
+template <typename T> using ExternalVector = stxxl::vector<T>;
+#else
+template <typename T> using ExternalVector = std::vector<T>;
+#endif
+
+// Sorts a range of an ExternalVector. The comparator needs min_value() and max_value() for
+// stxxl::sort.
+template <typename RandomAccessIterator, typename Compare>
+void sortExternal(RandomAccessIterator begin, RandomAccessIterator end, Compare compare)
+{
+#ifdef ENABLE_STXXL
+    const unsigned sort_memory = (sizeof(std::size_t) == 4) ? std::numeric_limits<int>::max()
+                                                            : std::numeric_limits<unsigned>::max();
+    stxxl::sort(begin, end, compare, sort_memory);
+#else
+    tbb::parallel_sort(begin, end, compare);
+#endif
+}
+
+// Sorts a range of an ExternalVector of small elements that are ordered by an unsigned integer
+// key. Without STXXL the range is radix sorted by the key, otherwise stxxl::sort uses the
+// comparator, which has to order the elements by the same key.
+template <typename RandomAccessIterator, typename Compare, typename KeyT>
+void sortExternal(RandomAccessIterator begin,
+                  RandomAccessIterator end,
+                  Compare compare,
+                  const KeyT &key)
+{
+#ifdef ENABLE_STXXL
+    static_cast<void>(key);
+    sortExternal(begin, end, compare);
+#else
+    static_cast<void>(compare);
+    radixSort(begin, end, key);
+#endif
+}
+}
+}
+
+#endif // OSRM_UTIL_EXTERNAL_VECTOR_HPP
@@ -0,0 +1,125 @@
+#ifndef OSRM_UTIL_LANDMARK_TABLE_HPP
+#define OSRM_UTIL_LANDMARK_TABLE_HPP
+
+#include "util/exception.hpp"
+#include "util/shared_memory_vector_wrapper.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <utility>
+
+namespace osrm
+{
+namespace util
+{
+
+/*
+ * Read-only view of the distances between the core nodes and the landmarks of a .landmarks
+ * file. The core nodes are found by a bit vector, and their row in the distance table by the
+ * number of core nodes before each 32 bit word plus a population count within the word.
+ */
+template <bool UseSharedMemory> class LandmarkTable
+{
+  public:
+    using BlockVector = typename ShM<std::uint32_t, UseSharedMemory>::vector;
+    using DistanceVector = typename ShM<EdgeWeight, UseSharedMemory>::vector;
+
+    LandmarkTable() : number_of_landmarks(0) {}
+
+    LandmarkTable(const unsigned number_of_landmarks,
+                  BlockVector core_bits_,
+                  BlockVector core_ranks_,
+                  DistanceVector distances_)
+        : number_of_landmarks(number_of_landmarks), core_bits(std::move(core_bits_)),
+          core_ranks(std::move(core_ranks_)), distances(std::move(distances_))
+    {
+        BOOST_ASSERT(core_bits.size() == core_ranks.size());
+    }
+
+    unsigned GetNumberOfLandmarks() const { return number_of_landmarks; }
+
+    // Returns the distances from all landmarks to the node followed by the distances from the
+    // node to all landmarks, or nullptr if the node is not part of the core
+    const EdgeWeight *GetDistances(const NodeID node) const
+    {
+        const std::size_t word = node / 32;
+        if (number_of_landmarks == 0 || word >= core_bits.size())
+        {
+            return nullptr;
+        }
+        const std::uint32_t bit = 1u << (node % 32);
+        if ((core_bits[word] & bit) == 0)
+        {
+            return nullptr;
+        }
+        const std::size_t rank =
+            core_ranks[word] + std::bitset<32>(core_bits[word] & (bit - 1)).count();
+        BOOST_ASSERT((rank + 1) * 2 * number_of_landmarks <= distances.size());
+        return &distances[rank * 2 * number_of_landmarks];
+    }
+
+  private:
+    unsigned number_of_landmarks;
+    BlockVector core_bits;
+    BlockVector core_ranks;
+    DistanceVector distances;
+};
+
+// Reads a .landmarks file written by osrm-contract. Datasets without a core or from before the
+// file existed give an empty table.
+inline LandmarkTable<false> readLandmarkTable(const boost::filesystem::path &landmarks_path,
+                                              const unsigned number_of_nodes)
+{
+    if (!boost::filesystem::exists(landmarks_path))
+    {
+        return {};
+    }
+
+    boost::filesystem::ifstream landmarks_stream(landmarks_path, std::ios::binary);
+    if (!landmarks_stream)
+    {
+        throw util::exception("Could not open " + landmarks_path.string() + " for reading.");
+    }
+
+    std::uint32_t number_of_landmarks = 0;
+    std::uint32_t number_of_nodes_in_file = 0;
+    landmarks_stream.read((char *)&number_of_landmarks, sizeof(std::uint32_t));
+    landmarks_stream.read((char *)&number_of_nodes_in_file, sizeof(std::uint32_t));
+    if (number_of_landmarks == 0)
+    {
+        return {};
+    }
+    if (number_of_nodes_in_file != number_of_nodes)
+    {
+        throw util::exception(landmarks_path.string() + " was built from a different dataset");
+    }
+    landmarks_stream.seekg(number_of_landmarks * sizeof(NodeID), std::ios::cur);
+
+    const std::size_t number_of_words = number_of_nodes / 32 + 1;
+    ShM<std::uint32_t, false>::vector core_bits(number_of_words);
+    ShM<std::uint32_t, false>::vector core_ranks(number_of_words);
+    landmarks_stream.read((char *)core_bits.data(), sizeof(std::uint32_t) * number_of_words);
+    landmarks_stream.read((char *)core_ranks.data(), sizeof(std::uint32_t) * number_of_words);
+
+    const std::size_t number_of_core_nodes =
+        core_ranks.back() + std::bitset<32>(core_bits.back()).count();
+    ShM<EdgeWeight, false>::vector distances(number_of_core_nodes * 2 * number_of_landmarks);
+    landmarks_stream.read((char *)distances.data(), sizeof(EdgeWeight) * distances.size());
+    if (!landmarks_stream)
+    {
+        throw util::exception("Unexpected end of " + landmarks_path.string());
+    }
+
+    return LandmarkTable<false>(number_of_landmarks, std::move(core_bits), std::move(core_ranks),
+                                std::move(distances));
+}
+}
+}
+
+#endif // OSRM_UTIL_LANDMARK_TABLE_HPP
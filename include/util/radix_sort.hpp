@@ -0,0 +1,181 @@
+#ifndef OSRM_UTIL_RADIX_SORT_HPP
+#define OSRM_UTIL_RADIX_SORT_HPP
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+namespace detail
+{
+// Every block of a pass has at least this many elements
+const constexpr std::size_t RADIX_SORT_MIN_BLOCK_SIZE = 64 * 1024;
+// Bits of the key that are sorted in one pass
+const constexpr unsigned RADIX_SORT_BITS = 11;
+const constexpr unsigned RADIX_SORT_DIGITS = 1u << RADIX_SORT_BITS;
+
+using RadixHistogram = std::array<std::size_t, RADIX_SORT_DIGITS>;
+
+template <typename KeyValueT> inline unsigned radixDigit(const KeyValueT key, const unsigned shift)
+{
+    return (static_cast<std::uint64_t>(key) >> shift) & (RADIX_SORT_DIGITS - 1);
+}
+
+// Moves all elements from the source to the destination range ordered by the RADIX_SORT_BITS bit
+// digit of their key at shift. Blocks of elements are counted and then scattered in parallel,
+// every block writes to its own part of each bucket, which keeps the pass stable.
+template <typename SourceIterator, typename DestinationIterator, typename KeyT>
+void radixSortPass(const SourceIterator source,
+                   const DestinationIterator destination,
+                   const std::size_t size,
+                   const std::size_t block_size,
+                   const unsigned shift,
+                   const KeyT &key)
+{
+    const std::size_t number_of_blocks = (size + block_size - 1) / block_size;
+    std::vector<RadixHistogram> offsets(number_of_blocks);
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_blocks, 1),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto block = range.begin(); block != range.end(); ++block)
+                          {
+                              auto &histogram = offsets[block];
+                              histogram.fill(0);
+                              const auto end = std::min(size, (block + 1) * block_size);
+                              for (auto index = block * block_size; index < end; ++index)
+                              {
+                                  ++histogram[radixDigit(key(source[index]), shift)];
+                              }
+                          }
+                      });
+
+    // turn the counts into the first position of every block in every bucket
+    std::size_t position = 0;
+    for (unsigned digit = 0; digit < RADIX_SORT_DIGITS; ++digit)
+    {
+        for (auto &histogram : offsets)
+        {
+            const auto count = histogram[digit];
+            histogram[digit] = position;
+            position += count;
+        }
+    }
+    BOOST_ASSERT(position == size);
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, number_of_blocks, 1),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto block = range.begin(); block != range.end(); ++block)
+                          {
+                              auto &histogram = offsets[block];
+                              const auto end = std::min(size, (block + 1) * block_size);
+                              for (auto index = block * block_size; index < end; ++index)
+                              {
+                                  const auto digit = radixDigit(key(source[index]), shift);
+                                  destination[histogram[digit]++] = std::move(source[index]);
+                              }
+                          }
+                      });
+}
+
+// Sorts the elements by all digits of their keys in which differing_bits has a bit set
+template <typename RandomAccessIterator, typename KeyT>
+void radixSortDigits(const RandomAccessIterator begin,
+                     const std::size_t size,
+                     const std::uint64_t differing_bits,
+                     const KeyT &key)
+{
+    using ValueT = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+    // a few blocks per thread balance the load without making the histograms too large
+    const std::size_t max_blocks = 4 * tbb::task_scheduler_init::default_num_threads();
+    const std::size_t block_size =
+        std::max(RADIX_SORT_MIN_BLOCK_SIZE, (size + max_blocks - 1) / max_blocks);
+
+    std::vector<ValueT> buffer;
+    bool sorted_in_buffer = false;
+    for (unsigned shift = 0; shift < 64; shift += RADIX_SORT_BITS)
+    {
+        if (radixDigit(differing_bits, shift) == 0)
+        {
+            continue;
+        }
+        if (buffer.empty())
+        {
+            buffer.resize(size);
+        }
+        if (sorted_in_buffer)
+        {
+            radixSortPass(buffer.begin(), begin, size, block_size, shift, key);
+        }
+        else
+        {
+            radixSortPass(begin, buffer.begin(), size, block_size, shift, key);
+        }
+        sorted_in_buffer = !sorted_in_buffer;
+    }
+
+    if (sorted_in_buffer)
+    {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size, RADIX_SORT_MIN_BLOCK_SIZE),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              std::move(buffer.begin() + range.begin(),
+                                        buffer.begin() + range.end(), begin + range.begin());
+                          });
+    }
+}
+}
+
+/*
+ * Parallel LSD radix sort for elements that are ordered by an unsigned integer key of at most 64
+ * bits, like OSM node ids or pairs of internal node ids. The key function maps an element to its
+ * key. The keys are sorted 11 bits at a time, starting with the least significant ones. Digits
+ * that are the same in all keys are skipped, so the 64 bit OSM node ids of an extract (which
+ * fit into about 33 bits) need three passes instead of six.
+ *
+ * The sort is stable and needs a buffer as large as the sorted range. Every pass moves all
+ * elements, so for elements of more than 32 bytes a comparison sort usually is faster (see
+ * radix-sort-bench).
+ */
+template <typename RandomAccessIterator, typename KeyT>
+void radixSort(const RandomAccessIterator begin, const RandomAccessIterator end, const KeyT &key)
+{
+    const std::size_t size = std::distance(begin, end);
+    if (size < 2)
+    {
+        return;
+    }
+
+    // bits in which at least one key differs from the first one
+    const auto first_key = static_cast<std::uint64_t>(key(*begin));
+    const auto differing_bits = tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, size, detail::RADIX_SORT_MIN_BLOCK_SIZE),
+        std::uint64_t{0},
+        [&](const tbb::blocked_range<std::size_t> &range, std::uint64_t bits) {
+            for (auto index = range.begin(); index != range.end(); ++index)
+            {
+                bits |= static_cast<std::uint64_t>(key(begin[index])) ^ first_key;
+            }
+            return bits;
+        },
+        [](const std::uint64_t lhs, const std::uint64_t rhs) { return lhs | rhs; });
+
+    detail::radixSortDigits(begin, size, differing_bits, key);
+}
+}
+}
+
+#endif // OSRM_UTIL_RADIX_SORT_HPP
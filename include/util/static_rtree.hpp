@@ -55,6 +55,8 @@ class StaticRTree
     static_assert(LEAF_PAGE_SIZE >= sizeof(uint32_t) + sizeof(EdgeDataT), "LEAF_PAGE_SIZE is too small");
     static_assert(((LEAF_PAGE_SIZE - 1) & LEAF_PAGE_SIZE) == 0, "LEAF_PAGE_SIZE is not a power of 2");
     static constexpr std::uint32_t LEAF_NODE_SIZE = (LEAF_PAGE_SIZE - sizeof(uint32_t)) / sizeof(EdgeDataT);
+    // number of leaf pages that are packed in parallel and written to disk at once
+    static constexpr std::uint64_t LEAF_WRITE_BATCH_SIZE = 4096;
 
     struct CandidateSegment
     {
@@ -170,39 +172,54 @@ class StaticRTree
 
         // sort the hilbert-value representatives
         tbb::parallel_sort(input_wrapper_vector.begin(), input_wrapper_vector.end());
-        std::vector<TreeNode> tree_nodes_in_level;
 
-        // pack M elements into leaf node and write to leaf file
-        uint64_t processed_objects_count = 0;
-        while (processed_objects_count < element_count)
+        // pack M elements into leaf node and write to leaf file. Leaves are independent of each
+        // other, so a batch of them is packed in parallel and then written with a single write.
+        const std::uint64_t number_of_leaves = (element_count + LEAF_NODE_SIZE - 1) / LEAF_NODE_SIZE;
+        std::vector<TreeNode> tree_nodes_in_level(number_of_leaves);
+        std::vector<LeafNode> leaf_buffer(
+            std::min(number_of_leaves, static_cast<std::uint64_t>(LEAF_WRITE_BATCH_SIZE)));
+        for (std::uint64_t batch_begin = 0; batch_begin < number_of_leaves;
+             batch_begin += leaf_buffer.size())
         {
-
-            LeafNode current_leaf;
-            TreeNode current_node;
-            for (std::uint32_t current_element_index = 0; LEAF_NODE_SIZE > current_element_index;
-                 ++current_element_index)
-            {
-                if (element_count > (processed_objects_count + current_element_index))
+            const std::uint64_t batch_end =
+                std::min<std::uint64_t>(number_of_leaves, batch_begin + leaf_buffer.size());
+            tbb::parallel_for(
+                tbb::blocked_range<std::uint64_t>(batch_begin, batch_end),
+                [&](const tbb::blocked_range<std::uint64_t> &range)
                 {
-                    std::uint32_t index_of_next_object =
-                        input_wrapper_vector[processed_objects_count + current_element_index]
-                            .m_array_index;
-                    current_leaf.objects[current_element_index] =
-                        input_data_vector[index_of_next_object];
-                    ++current_leaf.object_count;
-                }
-            }
-
-            // generate tree node that resemble the objects in leaf and store it for next level
-            InitializeMBRectangle(current_node.minimum_bounding_rectangle, current_leaf.objects,
-                                  current_leaf.object_count, m_coordinate_list);
-            current_node.child_is_on_disk = true;
-            current_node.children[0] = tree_nodes_in_level.size();
-            tree_nodes_in_level.emplace_back(current_node);
+                    for (std::uint64_t leaf_index = range.begin(), end = range.end();
+                         leaf_index != end; ++leaf_index)
+                    {
+                        LeafNode &current_leaf = leaf_buffer[leaf_index - batch_begin];
+                        current_leaf = LeafNode();
+
+                        const std::uint64_t first_object = leaf_index * LEAF_NODE_SIZE;
+                        const std::uint64_t last_object =
+                            std::min<std::uint64_t>(element_count, first_object + LEAF_NODE_SIZE);
+                        for (std::uint64_t object = first_object; object != last_object; ++object)
+                        {
+                            const std::uint32_t index_of_next_object =
+                                input_wrapper_vector[object].m_array_index;
+                            current_leaf.objects[current_leaf.object_count] =
+                                input_data_vector[index_of_next_object];
+                            ++current_leaf.object_count;
+                        }
+
+                        // generate tree node that resemble the objects in leaf and store it for
+                        // next level
+                        TreeNode &current_node = tree_nodes_in_level[leaf_index];
+                        InitializeMBRectangle(current_node.minimum_bounding_rectangle,
+                                              current_leaf.objects, current_leaf.object_count,
+                                              m_coordinate_list);
+                        current_node.child_is_on_disk = true;
+                        current_node.children[0] = leaf_index;
+                    }
+                });
 
-            // write leaf_node to leaf node file
-            leaf_node_file.write((char *)&current_leaf, sizeof(current_leaf));
-            processed_objects_count += current_leaf.object_count;
+            // write the whole batch of leaf nodes to leaf node file
+            leaf_node_file.write(reinterpret_cast<const char *>(leaf_buffer.data()),
+                                 sizeof(LeafNode) * (batch_end - batch_begin));
         }
         leaf_node_file.flush();
         leaf_node_file.close();
@@ -210,32 +227,38 @@ class StaticRTree
         std::uint32_t processing_level = 0;
         while (1 < tree_nodes_in_level.size())
         {
-            std::vector<TreeNode> tree_nodes_in_next_level;
-            std::uint32_t processed_tree_nodes_in_level = 0;
-            while (processed_tree_nodes_in_level < tree_nodes_in_level.size())
-            {
-                TreeNode parent_node;
-                // pack BRANCHING_FACTOR elements into tree_nodes each
-                for (std::uint32_t current_child_node_index = 0;
-                     BRANCHING_FACTOR > current_child_node_index; ++current_child_node_index)
+            // the nodes of this level are stored consecutively, parent nodes reference them by
+            // their position in the search tree
+            const std::uint32_t level_offset = m_search_tree.size();
+            m_search_tree.insert(m_search_tree.end(), tree_nodes_in_level.begin(),
+                                 tree_nodes_in_level.end());
+
+            // pack BRANCHING_FACTOR elements into tree_nodes each
+            std::vector<TreeNode> tree_nodes_in_next_level(
+                (tree_nodes_in_level.size() + BRANCHING_FACTOR - 1) / BRANCHING_FACTOR);
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, tree_nodes_in_next_level.size()),
+                [&](const tbb::blocked_range<std::size_t> &range)
                 {
-                    if (processed_tree_nodes_in_level < tree_nodes_in_level.size())
+                    for (std::size_t parent_index = range.begin(), end = range.end();
+                         parent_index != end; ++parent_index)
                     {
-                        TreeNode &current_child_node =
-                            tree_nodes_in_level[processed_tree_nodes_in_level];
-                        // add tree node to parent entry
-                        parent_node.children[current_child_node_index] = m_search_tree.size();
-                        m_search_tree.emplace_back(current_child_node);
-                        // merge MBRs
-                        parent_node.minimum_bounding_rectangle.MergeBoundingBoxes(
-                            current_child_node.minimum_bounding_rectangle);
-                        // increase counters
-                        ++parent_node.child_count;
-                        ++processed_tree_nodes_in_level;
+                        TreeNode &parent_node = tree_nodes_in_next_level[parent_index];
+                        const std::size_t first_child = parent_index * BRANCHING_FACTOR;
+                        const std::size_t last_child = std::min<std::size_t>(
+                            tree_nodes_in_level.size(), first_child + BRANCHING_FACTOR);
+                        for (std::size_t child = first_child; child != last_child; ++child)
+                        {
+                            const TreeNode &current_child_node = tree_nodes_in_level[child];
+                            // add tree node to parent entry
+                            parent_node.children[parent_node.child_count] = level_offset + child;
+                            // merge MBRs
+                            parent_node.minimum_bounding_rectangle.MergeBoundingBoxes(
+                                current_child_node.minimum_bounding_rectangle);
+                            ++parent_node.child_count;
+                        }
                     }
-                }
-                tree_nodes_in_next_level.emplace_back(parent_node);
-            }
+                });
             tree_nodes_in_level.swap(tree_nodes_in_next_level);
             ++processing_level;
         }
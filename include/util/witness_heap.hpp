@@ -0,0 +1,266 @@
+#ifndef OSRM_UTIL_WITNESS_HEAP_HPP
+#define OSRM_UTIL_WITNESS_HEAP_HPP
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/*
+ * Priority queue for the many small searches of the contractor.
+ *
+ * All data of a node lives in one array entry that is found with a single probe into an open
+ * addressing table. The table is cleared by bumping a time stamp and only grows when a search
+ * visits more nodes than before, so a heap that is reused per thread stays in cache. The heap
+ * itself is 4-ary, which halves the depth of the sift paths compared to a binary heap.
+ */
+template <typename NodeID, typename Weight, typename Data> class WitnessHeap
+{
+    static const constexpr unsigned ARITY = 4;
+    static const constexpr unsigned INITIAL_TABLE_BITS = 12;
+    static const constexpr unsigned REMOVED = std::numeric_limits<unsigned>::max();
+
+  public:
+    struct Entry
+    {
+        NodeID node;
+        Weight weight;
+        // position in the heap or REMOVED once the node was settled
+        unsigned heap_position;
+        Data data;
+    };
+
+    WitnessHeap() : table(1u << INITIAL_TABLE_BITS), table_bits(INITIAL_TABLE_BITS), timestamp(1)
+    {
+    }
+
+    WitnessHeap(const WitnessHeap &) = delete;
+    WitnessHeap &operator=(const WitnessHeap &) = delete;
+
+    void Clear()
+    {
+        heap.clear();
+        entries.clear();
+        if (++timestamp == 0)
+        {
+            table.assign(table.size(), Cell());
+            timestamp = 1;
+        }
+    }
+
+    std::size_t Size() const { return heap.size(); }
+
+    bool Empty() const { return heap.empty(); }
+
+    // The node must not have been inserted since the last Clear()
+    void Insert(const NodeID node, const Weight weight, const Data &data)
+    {
+        BOOST_ASSERT(!WasInserted(node));
+        if (2 * (entries.size() + 1) > table.size())
+        {
+            Grow();
+        }
+
+        const auto index = static_cast<unsigned>(entries.size());
+        Cell &cell = table[FindCell(node)];
+        cell.timestamp = timestamp;
+        cell.node = node;
+        cell.index = index;
+
+        entries.push_back(Entry{node, weight, static_cast<unsigned>(heap.size()), data});
+        heap.push_back(HeapElement{weight, index});
+        Upheap(entries.back().heap_position);
+    }
+
+    // Returns the entry of the node or nullptr if it was not inserted
+    Entry *Find(const NodeID node)
+    {
+        const Cell &cell = table[FindCell(node)];
+        return cell.timestamp == timestamp ? &entries[cell.index] : nullptr;
+    }
+
+    const Entry *Find(const NodeID node) const
+    {
+        const Cell &cell = table[FindCell(node)];
+        return cell.timestamp == timestamp ? &entries[cell.index] : nullptr;
+    }
+
+    bool WasInserted(const NodeID node) const { return Find(node) != nullptr; }
+
+    bool WasRemoved(const NodeID node) const
+    {
+        BOOST_ASSERT(WasInserted(node));
+        return Find(node)->heap_position == REMOVED;
+    }
+
+    Weight GetKey(const NodeID node) const
+    {
+        BOOST_ASSERT(WasInserted(node));
+        return Find(node)->weight;
+    }
+
+    Data &GetData(const NodeID node)
+    {
+        BOOST_ASSERT(WasInserted(node));
+        return Find(node)->data;
+    }
+
+    const Data &GetData(const NodeID node) const
+    {
+        BOOST_ASSERT(WasInserted(node));
+        return Find(node)->data;
+    }
+
+    NodeID Min() const
+    {
+        BOOST_ASSERT(!heap.empty());
+        return entries[heap.front().index].node;
+    }
+
+    Weight MinKey() const
+    {
+        BOOST_ASSERT(!heap.empty());
+        return heap.front().weight;
+    }
+
+    NodeID DeleteMin()
+    {
+        BOOST_ASSERT(!heap.empty());
+        const auto removed_index = heap.front().index;
+        heap.front() = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            entries[heap.front().index].heap_position = 0;
+            Downheap(0);
+        }
+        entries[removed_index].heap_position = REMOVED;
+        return entries[removed_index].node;
+    }
+
+    // The entry must still be in the heap and the weight must not be larger than before
+    void DecreaseKey(Entry &entry, const Weight weight)
+    {
+        BOOST_ASSERT(entry.heap_position != REMOVED);
+        BOOST_ASSERT(weight <= entry.weight);
+        entry.weight = weight;
+        heap[entry.heap_position].weight = weight;
+        Upheap(entry.heap_position);
+    }
+
+    void DecreaseKey(const NodeID node, const Weight weight)
+    {
+        BOOST_ASSERT(WasInserted(node));
+        DecreaseKey(*Find(node), weight);
+    }
+
+  private:
+    struct Cell
+    {
+        Cell() : timestamp(0), node(0), index(0) {}
+
+        unsigned timestamp;
+        NodeID node;
+        unsigned index;
+    };
+
+    struct HeapElement
+    {
+        Weight weight;
+        unsigned index;
+    };
+
+    std::size_t FindCell(const NodeID node) const
+    {
+        const std::size_t mask = table.size() - 1;
+        // multiplicative hashing, the table size is a power of two
+        const std::uint32_t hash = static_cast<std::uint32_t>(node) * 2654435769u;
+        std::size_t position = hash >> (32 - table_bits);
+        while (table[position].timestamp == timestamp && table[position].node != node)
+        {
+            position = (position + 1) & mask;
+        }
+        return position;
+    }
+
+    void Grow()
+    {
+        ++table_bits;
+        table.assign(std::size_t{1} << table_bits, Cell());
+        timestamp = 1;
+        for (std::size_t index = 0; index < entries.size(); ++index)
+        {
+            Cell &cell = table[FindCell(entries[index].node)];
+            cell.timestamp = timestamp;
+            cell.node = entries[index].node;
+            cell.index = static_cast<unsigned>(index);
+        }
+    }
+
+    void Upheap(unsigned position)
+    {
+        const HeapElement element = heap[position];
+        while (position > 0)
+        {
+            const unsigned parent = (position - 1) / ARITY;
+            if (heap[parent].weight <= element.weight)
+            {
+                break;
+            }
+            heap[position] = heap[parent];
+            entries[heap[position].index].heap_position = position;
+            position = parent;
+        }
+        heap[position] = element;
+        entries[element.index].heap_position = position;
+    }
+
+    void Downheap(unsigned position)
+    {
+        const HeapElement element = heap[position];
+        const auto size = static_cast<unsigned>(heap.size());
+        while (true)
+        {
+            const unsigned first_child = position * ARITY + 1;
+            if (first_child >= size)
+            {
+                break;
+            }
+            const unsigned last_child = std::min(first_child + ARITY, size);
+            unsigned min_child = first_child;
+            for (unsigned child = first_child + 1; child < last_child; ++child)
+            {
+                if (heap[child].weight < heap[min_child].weight)
+                {
+                    min_child = child;
+                }
+            }
+            if (element.weight <= heap[min_child].weight)
+            {
+                break;
+            }
+            heap[position] = heap[min_child];
+            entries[heap[position].index].heap_position = position;
+            position = min_child;
+        }
+        heap[position] = element;
+        entries[element.index].heap_position = position;
+    }
+
+    std::vector<Cell> table;
+    unsigned table_bits;
+    std::vector<Entry> entries;
+    std::vector<HeapElement> heap;
+    unsigned timestamp;
+};
+}
+}
+
+#endif // OSRM_UTIL_WITNESS_HEAP_HPP
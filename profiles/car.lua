@@ -137,6 +137,7 @@ properties.u_turn_penalty                  = 20
 properties.traffic_signal_penalty          = 2
 properties.use_turn_restrictions           = true
 properties.continue_straight_at_waypoint   = true
+properties.use_tag_tables                  = true
 
 local side_road_speed_multiplier = 0.8
 
@@ -166,6 +167,25 @@ function get_exceptions(vector)
   end
 end
 
+-- nodes and ways without any of these keys are not passed to node_function and way_function
+node_keys = { "barrier", "highway" }
+way_keys = { "highway", "route", "bridge" }
+
+function get_node_keys(vector)
+  for i,v in ipairs(access_tags_hierarchy) do
+    vector:Add(v)
+  end
+  for i,v in ipairs(node_keys) do
+    vector:Add(v)
+  end
+end
+
+function get_way_keys(vector)
+  for i,v in ipairs(way_keys) do
+    vector:Add(v)
+  end
+end
+
 local function parse_maxspeed(source)
   if not source then
     return 0
@@ -190,18 +210,18 @@ local function parse_maxspeed(source)
   return n
 end
 
-function node_function (node, result)
+function node_function (node, result, tags)
   -- parse access and barrier tags
-  local access = find_access_tag(node, access_tags_hierarchy)
+  local access = find_access_tag(node, access_tags_hierarchy, tags)
   if access and access ~= "" then
     if access_tag_blacklist[access] then
       result.barrier = true
     end
   else
-    local barrier = node:get_value_by_key("barrier")
+    local barrier = tags["barrier"]
     if barrier and "" ~= barrier then
       --  make an exception for rising bollard barriers
-      local bollard = node:get_value_by_key("bollard")
+      local bollard = tags["bollard"]
       local rising_bollard = bollard and "rising" == bollard
 
       if not barrier_whitelist[barrier] and not rising_bollard then
@@ -211,45 +231,45 @@ function node_function (node, result)
   end
 
   -- check if node is a traffic light
-  local tag = node:get_value_by_key("highway")
+  local tag = tags["highway"]
   if tag and "traffic_signals" == tag then
     result.traffic_lights = true
   end
 end
 
-function way_function (way, result)
-  local highway = way:get_value_by_key("highway")
-  local route = way:get_value_by_key("route")
-  local bridge = way:get_value_by_key("bridge")
+function way_function (way, result, tags)
+  local highway = tags["highway"]
+  local route = tags["route"]
+  local bridge = tags["bridge"]
 
   if not ((highway and highway ~= "") or (route and route ~= "") or (bridge and bridge ~= "")) then
     return
   end
 
   -- we dont route over areas
-  local area = way:get_value_by_key("area")
+  local area = tags["area"]
   if ignore_areas and area and "yes" == area then
     return
   end
 
   -- check if oneway tag is unsupported
-  local oneway = way:get_value_by_key("oneway")
+  local oneway = tags["oneway"]
   if oneway and "reversible" == oneway then
     return
   end
 
-  local impassable = way:get_value_by_key("impassable")
+  local impassable = tags["impassable"]
   if impassable and "yes" == impassable then
     return
   end
 
-  local status = way:get_value_by_key("status")
+  local status = tags["status"]
   if status and "impassable" == status then
     return
   end
 
   -- Check if we are allowed to access the way
-  local access = find_access_tag(way, access_tags_hierarchy)
+  local access = find_access_tag(way, access_tags_hierarchy, tags)
   if access_tag_blacklist[access] then
     return
   end
@@ -261,7 +281,7 @@ function way_function (way, result)
   local route_speed = speed_profile[route]
   if (route_speed and route_speed > 0) then
     highway = route
-    local duration  = way:get_value_by_key("duration")
+    local duration  = tags["duration"]
     if duration and durationIsValid(duration) then
       result.duration = max( parseDuration(duration), 1 )
     end
@@ -273,10 +293,10 @@ function way_function (way, result)
 
   -- handling movable bridges
   local bridge_speed = speed_profile[bridge]
-  local capacity_car = way:get_value_by_key("capacity:car")
+  local capacity_car = tags["capacity:car"]
   if (bridge_speed and bridge_speed > 0) and (capacity_car ~= 0) then
     highway = bridge
-    local duration  = way:get_value_by_key("duration")
+    local duration  = tags["duration"]
     if duration and durationIsValid(duration) then
       result.duration = max( parseDuration(duration), 1 )
     end
@@ -291,7 +311,7 @@ function way_function (way, result)
 
   if result.forward_speed == -1 then
     local highway_speed = speed_profile[highway]
-    local max_speed = parse_maxspeed( way:get_value_by_key("maxspeed") )
+    local max_speed = parse_maxspeed( tags["maxspeed"] )
     -- Set the avg speed on the way if it is accessible by road class
     if highway_speed then
       if max_speed and max_speed > highway_speed then
@@ -321,7 +341,7 @@ function way_function (way, result)
   end
 
   -- reduce speed on special side roads
-  local sideway = way:get_value_by_key("side_road")
+  local sideway = tags["side_road"]
   if "yes" == sideway or
   "rotary" == sideway then
     result.forward_speed = result.forward_speed * side_road_speed_multiplier
@@ -329,9 +349,9 @@ function way_function (way, result)
   end
 
   -- reduce speed on bad surfaces
-  local surface = way:get_value_by_key("surface")
-  local tracktype = way:get_value_by_key("tracktype")
-  local smoothness = way:get_value_by_key("smoothness")
+  local surface = tags["surface"]
+  local tracktype = tags["tracktype"]
+  local smoothness = tags["smoothness"]
 
   if surface and surface_speeds[surface] then
     result.forward_speed = math.min(surface_speeds[surface], result.forward_speed)
@@ -347,12 +367,12 @@ function way_function (way, result)
   end
 
   -- parse the remaining tags
-  local name = way:get_value_by_key("name")
-  local ref = way:get_value_by_key("ref")
-  local junction = way:get_value_by_key("junction")
-  -- local barrier = way:get_value_by_key("barrier", "")
-  -- local cycleway = way:get_value_by_key("cycleway", "")
-  local service = way:get_value_by_key("service")
+  local name = tags["name"]
+  local ref = tags["ref"]
+  local junction = tags["junction"]
+  -- local barrier = tags["barrier"]
+  -- local cycleway = tags["cycleway"]
+  local service = tags["service"]
 
   -- Set the name that will be used for instructions
   local has_ref = ref and "" ~= ref
@@ -395,7 +415,7 @@ function way_function (way, result)
       result.backward_mode = mode.inaccessible
 
       -- If we're on a oneway and there is no ref tag, re-use destination tag as ref.
-      local destination = get_destination(way)
+      local destination = get_destination(way, tags)
       local has_destination = destination and "" ~= destination
 
       if has_destination and has_name and not has_ref then
@@ -405,8 +425,8 @@ function way_function (way, result)
   end
 
   -- Override speed settings if explicit forward/backward maxspeeds are given
-  local maxspeed_forward = parse_maxspeed(way:get_value_by_key("maxspeed:forward"))
-  local maxspeed_backward = parse_maxspeed(way:get_value_by_key("maxspeed:backward"))
+  local maxspeed_forward = parse_maxspeed(tags["maxspeed:forward"])
+  local maxspeed_backward = parse_maxspeed(tags["maxspeed:backward"])
   if maxspeed_forward and maxspeed_forward > 0 then
     if mode.inaccessible ~= result.forward_mode and mode.inaccessible ~= result.backward_mode then
       result.backward_speed = result.forward_speed
@@ -418,9 +438,9 @@ function way_function (way, result)
   end
 
   -- Override speed settings if advisory forward/backward maxspeeds are given
-  local advisory_speed = parse_maxspeed(way:get_value_by_key("maxspeed:advisory"))
-  local advisory_forward = parse_maxspeed(way:get_value_by_key("maxspeed:advisory:forward"))
-  local advisory_backward = parse_maxspeed(way:get_value_by_key("maxspeed:advisory:backward"))
+  local advisory_speed = parse_maxspeed(tags["maxspeed:advisory"])
+  local advisory_forward = parse_maxspeed(tags["maxspeed:advisory:forward"])
+  local advisory_backward = parse_maxspeed(tags["maxspeed:advisory:backward"])
   -- apply bi-directional advisory speed first
   if advisory_speed and advisory_speed > 0 then
     if mode.inaccessible ~= result.forward_mode then
@@ -443,12 +463,12 @@ function way_function (way, result)
   local width = math.huge
   local lanes = math.huge
   if result.forward_speed > 0 or result.backward_speed > 0 then
-    local width_string = way:get_value_by_key("width")
+    local width_string = tags["width"]
     if width_string and tonumber(width_string:match("%d*")) then
       width = tonumber(width_string:match("%d*"))
     end
 
-    local lanes_string = way:get_value_by_key("lanes")
+    local lanes_string = tags["lanes"]
     if lanes_string and tonumber(lanes_string:match("%d*")) then
       lanes = tonumber(lanes_string:match("%d*"))
     end
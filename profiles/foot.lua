@@ -77,6 +77,25 @@ function get_exceptions(vector)
   end
 end
 
+-- nodes and ways without any of these keys are not passed to node_function and way_function
+node_keys = { "barrier", "highway" }
+way_keys = { "highway", "leisure", "route", "man_made", "railway", "amenity", "public_transport" }
+
+function get_node_keys(vector)
+  for i,v in ipairs(access_tags_hierarchy) do
+    vector:Add(v)
+  end
+  for i,v in ipairs(node_keys) do
+    vector:Add(v)
+  end
+end
+
+function get_way_keys(vector)
+  for i,v in ipairs(way_keys) do
+    vector:Add(v)
+  end
+end
+
 function node_function (node, result)
   local barrier = node:get_value_by_key("barrier")
   local access = find_access_tag(node, access_tags_hierarchy)
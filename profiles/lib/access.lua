@@ -2,9 +2,16 @@ local ipairs = ipairs
 
 local Access = {}
 
-function Access.find_access_tag(source,access_tags_hierarchy)
+-- Profiles with properties.use_tag_tables pass the tag table of the object, which avoids
+-- a call into luabind for every key.
+function Access.find_access_tag(source,access_tags_hierarchy,tags)
     for i,v in ipairs(access_tags_hierarchy) do
-        local tag = source:get_value_by_key(v)
+        local tag
+        if tags then
+            tag = tags[v]
+        else
+            tag = source:get_value_by_key(v)
+        end
         if tag and tag ~= '' then
             return tag
         end
@@ -1,8 +1,16 @@
 local Destination = {}
 
-function Destination.get_destination(way)
-  local destination = way:get_value_by_key("destination")
-  local destination_ref = way:get_value_by_key("destination:ref")
+-- tags is the optional tag table of the way, see Access.find_access_tag
+function Destination.get_destination(way, tags)
+  local destination
+  local destination_ref
+  if tags then
+    destination = tags["destination"]
+    destination_ref = tags["destination:ref"]
+  else
+    destination = way:get_value_by_key("destination")
+    destination_ref = way:get_value_by_key("destination:ref")
+  end
 
   -- Assemble destination as: "A59: Düsseldorf, Köln"
   --          destination:ref  ^    ^  destination
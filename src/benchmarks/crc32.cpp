@@ -0,0 +1,89 @@
+#include "contractor/crc32_processor.hpp"
+#include "util/timing_util.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+// Choosen by a fair W20 dice roll (this value is completely arbitrary)
+constexpr unsigned RANDOM_SEED = 13;
+
+template <typename ChecksumT>
+unsigned
+benchmarkChecksum(const std::vector<char> &data, const std::string &name, ChecksumT checksum)
+{
+    std::cout << "Running " << name << " over " << data.size() / (1024 * 1024)
+              << " MiB: " << std::flush;
+
+    TIMER_START(checksum);
+    const auto crc = checksum(data);
+    TIMER_STOP(checksum);
+
+    std::cout << "Took " << TIMER_MSEC(checksum) << "ms  ->  "
+              << data.size() / TIMER_SEC(checksum) / (1024 * 1024 * 1024) << " GiB/s "
+              << "(crc " << crc << ")" << std::endl;
+    return crc;
+}
+}
+}
+
+int main(int argc, char **argv)
+{
+    using namespace osrm;
+
+    if (argc > 2)
+    {
+        std::cout << "./crc32-bench [size in MiB]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::size_t size = (argc == 2 ? std::stoul(argv[1]) : 256) * 1024 * 1024;
+
+    std::vector<char> data(size);
+    std::mt19937 generator(benchmarks::RANDOM_SEED);
+    for (auto &byte : data)
+    {
+        byte = static_cast<char>(generator());
+    }
+
+    const auto software =
+        benchmarks::benchmarkChecksum(data, "slice-by-8", [](const std::vector<char> &data) {
+            return contractor::detail::ComputeInSoftware(0, data.data(), data.size());
+        });
+
+    auto result = EXIT_SUCCESS;
+    if (contractor::detail::UseHardware())
+    {
+        const auto hardware =
+            benchmarks::benchmarkChecksum(data, "SSE4.2", [](const std::vector<char> &data) {
+                return contractor::detail::ComputeInHardware(0, data.data(), data.size());
+            });
+        if (hardware != software)
+        {
+            std::cout << "SSE4.2 and slice-by-8 checksums differ" << std::endl;
+            result = EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        std::cout << "SSE4.2 not supported by this CPU" << std::endl;
+    }
+
+    const auto parallel =
+        benchmarks::benchmarkChecksum(data, "parallel chunks", [](const std::vector<char> &data) {
+            return contractor::ParallelCRC32(data);
+        });
+    if (parallel != software)
+    {
+        std::cout << "Parallel and serial checksums differ" << std::endl;
+        result = EXIT_FAILURE;
+    }
+
+    return result;
+}
@@ -0,0 +1,172 @@
+#include "extractor/extraction_node.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/profile_plugin_library.hpp"
+#include "extractor/scripting_environment.hpp"
+#include "util/timing_util.hpp"
+
+#include <osmium/io/any_input.hpp>
+#include <osmium/osm.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+using extractor::ExtractionNode;
+using extractor::ExtractionWay;
+
+struct ProfileResults
+{
+    std::vector<ExtractionNode> nodes;
+    std::vector<ExtractionWay> ways;
+};
+
+// Runs the profile on all nodes and ways of the input in one thread
+template <typename NodeFunctionT, typename WayFunctionT>
+ProfileResults benchmarkProfile(const std::string &name,
+                                const std::vector<const osmium::Node *> &nodes,
+                                const std::vector<const osmium::Way *> &ways,
+                                NodeFunctionT node_function,
+                                WayFunctionT way_function)
+{
+    ProfileResults results;
+    results.nodes.resize(nodes.size());
+    results.ways.resize(ways.size());
+
+    TIMER_START(nodes);
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        node_function(*nodes[index], results.nodes[index]);
+    }
+    TIMER_STOP(nodes);
+
+    TIMER_START(ways);
+    for (std::size_t index = 0; index < ways.size(); ++index)
+    {
+        way_function(*ways[index], results.ways[index]);
+    }
+    TIMER_STOP(ways);
+
+    std::cout << name << ": " << TIMER_MSEC(nodes) << "ms for " << nodes.size() << " nodes, "
+              << TIMER_MSEC(ways) << "ms for " << ways.size() << " ways" << std::endl;
+    return results;
+}
+
+bool sameSpeed(const double lhs, const double rhs)
+{
+    return lhs == rhs || std::abs(lhs - rhs) < 1e-6;
+}
+
+bool sameResult(const ExtractionWay &lhs, const ExtractionWay &rhs)
+{
+    return sameSpeed(lhs.forward_speed, rhs.forward_speed) &&
+           sameSpeed(lhs.backward_speed, rhs.backward_speed) &&
+           sameSpeed(lhs.duration, rhs.duration) && lhs.name == rhs.name &&
+           lhs.roundabout == rhs.roundabout &&
+           lhs.is_access_restricted == rhs.is_access_restricted &&
+           lhs.is_startpoint == rhs.is_startpoint &&
+           lhs.forward_travel_mode == rhs.forward_travel_mode &&
+           lhs.backward_travel_mode == rhs.backward_travel_mode;
+}
+
+bool sameResult(const ExtractionNode &lhs, const ExtractionNode &rhs)
+{
+    return lhs.traffic_lights == rhs.traffic_lights && lhs.barrier == rhs.barrier;
+}
+
+template <typename ObjectT, typename ResultT>
+void compareResults(const std::vector<const ObjectT *> &objects,
+                    const std::vector<ResultT> &lua_results,
+                    const std::vector<ResultT> &plugin_results)
+{
+    std::size_t differences = 0;
+    for (std::size_t index = 0; index < objects.size(); ++index)
+    {
+        if (!sameResult(lua_results[index], plugin_results[index]))
+        {
+            if (differences < 10)
+            {
+                std::cout << "  different result for " << objects[index]->id() << std::endl;
+            }
+            ++differences;
+        }
+    }
+    std::cout << "  " << differences << " of " << objects.size() << " results differ"
+              << std::endl;
+}
+}
+}
+
+int main(int argc, char **argv)
+{
+    using namespace osrm;
+
+    if (argc != 4)
+    {
+        std::cout << "./profile-bench <input.osm.pbf> <profile.lua> <profile plugin>"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // keep the whole input in memory, so only the profiles are timed
+    std::vector<osmium::memory::Buffer> buffers;
+    osmium::io::Reader reader(argv[1],
+                              osmium::osm_entity_bits::node | osmium::osm_entity_bits::way);
+    while (osmium::memory::Buffer buffer = reader.read())
+    {
+        buffers.push_back(std::move(buffer));
+    }
+    reader.close();
+
+    std::vector<const osmium::Node *> nodes;
+    std::vector<const osmium::Way *> ways;
+    for (const auto &buffer : buffers)
+    {
+        for (const auto &item : buffer)
+        {
+            if (item.type() == osmium::item_type::node)
+            {
+                nodes.push_back(&static_cast<const osmium::Node &>(item));
+            }
+            else if (item.type() == osmium::item_type::way)
+            {
+                ways.push_back(&static_cast<const osmium::Way &>(item));
+            }
+        }
+    }
+
+    extractor::ScriptingEnvironment scripting_environment(argv[2]);
+    auto &context = scripting_environment.GetContex();
+    const auto lua_results = benchmarks::benchmarkProfile(
+        "lua profile", nodes, ways,
+        [&context](const osmium::Node &node, extractor::ExtractionNode &result) {
+            extractor::ScriptingEnvironment::ProcessNode(context, node, result);
+        },
+        [&context](const osmium::Way &way, extractor::ExtractionWay &result) {
+            extractor::ScriptingEnvironment::ProcessWay(context, way, result);
+        });
+
+    const extractor::ProfilePluginLibrary plugin_library(argv[3]);
+    const auto &plugin = plugin_library.GetPlugin();
+    const auto plugin_results = benchmarks::benchmarkProfile(
+        "profile plugin", nodes, ways,
+        [&plugin](const osmium::Node &node, extractor::ExtractionNode &result) {
+            plugin.ProcessNode(node, result);
+        },
+        [&plugin](const osmium::Way &way, extractor::ExtractionWay &result) {
+            plugin.ProcessWay(way, result);
+        });
+
+    std::cout << "Nodes:" << std::endl;
+    benchmarks::compareResults(nodes, lua_results.nodes, plugin_results.nodes);
+    std::cout << "Ways:" << std::endl;
+    benchmarks::compareResults(ways, lua_results.ways, plugin_results.ways);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+#include "util/radix_sort.hpp"
+#include "util/timing_util.hpp"
+
+#ifdef ENABLE_STXXL
+#include <stxxl/sort>
+#include <stxxl/vector>
+#endif
+
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+// Choosen by a fair W20 dice roll (this value is completely arbitrary)
+constexpr unsigned RANDOM_SEED = 13;
+
+// Records with a 64 bit OSM node id key, Record<2> has the size of an ExternalMemoryNode and
+// Record<7> the size of an InternalExtractorEdge
+template <unsigned PayloadWords> struct Record
+{
+    std::uint64_t osm_node_id;
+    std::uint64_t payload[PayloadWords];
+};
+
+template <typename RecordT> struct RecordLess
+{
+    using value_type = RecordT;
+    bool operator()(const RecordT &lhs, const RecordT &rhs) const
+    {
+        return lhs.osm_node_id < rhs.osm_node_id;
+    }
+    value_type max_value() { return RecordT{std::numeric_limits<std::uint64_t>::max(), {}}; }
+    value_type min_value() { return RecordT{std::numeric_limits<std::uint64_t>::min(), {}}; }
+};
+
+template <typename RecordT, typename SortT>
+void benchmarkSort(const std::vector<RecordT> &input, const std::string &name, SortT sort)
+{
+    std::cout << "  " << name << ": " << std::flush;
+    auto records = input;
+
+    TIMER_START(sort);
+    sort(records);
+    TIMER_STOP(sort);
+
+    const auto sorted = std::is_sorted(records.begin(), records.end(), RecordLess<RecordT>());
+    std::cout << "Took " << TIMER_MSEC(sort) << "ms" << (sorted ? "" : " (NOT SORTED)")
+              << std::endl;
+}
+
+template <typename RecordT> void benchmarkRecords(const std::size_t size)
+{
+    std::cout << "Sorting " << size << " records of " << sizeof(RecordT) << " bytes"
+              << std::endl;
+
+    // OSM node ids of a planet extract need about 33 bits
+    std::mt19937_64 generator(RANDOM_SEED);
+    std::uniform_int_distribution<std::uint64_t> distribution(1, 5000000000ull);
+    std::vector<RecordT> records(size);
+    for (auto &record : records)
+    {
+        record.osm_node_id = distribution(generator);
+    }
+
+    benchmarkSort(records, "radix sort", [](std::vector<RecordT> &records) {
+        util::radixSort(records.begin(), records.end(),
+                        [](const RecordT &record) { return record.osm_node_id; });
+    });
+    benchmarkSort(records, "tbb::parallel_sort", [](std::vector<RecordT> &records) {
+        tbb::parallel_sort(records.begin(), records.end(), RecordLess<RecordT>());
+    });
+#ifdef ENABLE_STXXL
+    // includes copying the records into and out of the stxxl::vector
+    benchmarkSort(records, "stxxl::sort", [](std::vector<RecordT> &records) {
+        stxxl::vector<RecordT> external_records;
+        external_records.reserve(records.size());
+        for (const auto &record : records)
+        {
+            external_records.push_back(record);
+        }
+        stxxl::sort(external_records.begin(), external_records.end(), RecordLess<RecordT>(),
+                    std::numeric_limits<unsigned>::max());
+        std::copy(external_records.begin(), external_records.end(), records.begin());
+    });
+#else
+    std::cout << "  stxxl::sort: built without STXXL" << std::endl;
+#endif
+}
+}
+}
+
+int main(int argc, char **argv)
+{
+    using namespace osrm;
+
+    if (argc > 2)
+    {
+        std::cout << "./radix-sort-bench [number of records in millions]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::size_t size = (argc == 2 ? std::stoul(argv[1]) : 20) * 1000 * 1000;
+
+    benchmarks::benchmarkRecords<benchmarks::Record<1>>(size);
+    benchmarks::benchmarkRecords<benchmarks::Record<2>>(size);
+    benchmarks::benchmarkRecords<benchmarks::Record<7>>(size);
+
+    return EXIT_SUCCESS;
+}
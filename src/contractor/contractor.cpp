@@ -1,10 +1,16 @@
 #include "contractor/contractor.hpp"
+#include "contractor/core_landmarks.hpp"
 #include "contractor/crc32_processor.hpp"
 #include "contractor/graph_contractor.hpp"
+#include "contractor/graph_customizer.hpp"
+#include "contractor/segment_speed_file.hpp"
 
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/node_based_edge.hpp"
+#include "extractor/original_edge_data.hpp"
+#include "extractor/query_node.hpp"
 
+#include "util/coordinate_calculation.hpp"
 #include "util/exception.hpp"
 #include "util/graph_loader.hpp"
 #include "util/integer_range.hpp"
@@ -18,6 +24,7 @@
 
 #include <boost/assert.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
@@ -28,13 +35,19 @@
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 #include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
 #include <tbb/parallel_sort.h>
 
+#include <algorithm>
 #include <bitset>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iterator>
 #include <memory>
+#include <numeric>
+#include <string>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -84,8 +97,19 @@ int Contractor::Run()
         throw util::exception("Core factor must be between 0.0 to 1.0 (inclusive)");
     }
 
+    if (config.use_customization && config.core_factor < 1.0)
+    {
+        throw util::exception("Customization needs a fully contracted hierarchy, it cannot be "
+                              "combined with a core factor below 1.0");
+    }
+
     TIMER_START(preparing);
 
+    if (!config.segment_speed_delta_paths.empty())
+    {
+        ApplySegmentSpeedDeltas();
+    }
+
     util::SimpleLogger().Write() << "Loading edge-expanded graph representation";
 
     util::DeallocatingVector<extractor::EdgeBasedEdge> edge_based_edge_list;
@@ -94,40 +118,61 @@ int Contractor::Run()
         config.edge_based_graph_path, edge_based_edge_list, config.edge_segment_lookup_path,
         config.edge_penalty_path, config.segment_speed_lookup_paths,
         config.turn_penalty_lookup_paths, config.node_based_graph_path, config.geometry_path,
-        config.datasource_names_path, config.datasource_indexes_path, config.rtree_leaf_path);
+        config.datasource_names_path, config.datasource_indexes_path, config.segment_weights_path,
+        config.rtree_leaf_path);
 
     // Contracting the edge-expanded graph
 
     TIMER_START(contraction);
     std::vector<bool> is_core_node;
     std::vector<float> node_levels;
-    if (config.use_cached_priority)
+    if (config.use_cached_priority || config.use_customization)
     {
         ReadNodeLevels(node_levels);
     }
+    if (config.use_customization)
+    {
+        // the uncontracted core nodes of such a run all have level 0
+        std::vector<bool> was_core_node;
+        ReadCoreNodeMarker(was_core_node);
+        if (std::find(was_core_node.begin(), was_core_node.end(), true) != was_core_node.end())
+        {
+            throw util::exception(config.level_output_path +
+                                  " was written by a contraction with a core, customization "
+                                  "needs the levels of a full contraction");
+        }
+    }
 
-    util::SimpleLogger().Write() << "Reading node weights.";
-    std::vector<EdgeWeight> node_weights;
-    std::string node_file_name = config.osrm_input_path.string() + ".enw";
-    if (util::deserializeVector(node_file_name, node_weights))
+    util::DeallocatingVector<QueryEdge> contracted_edge_list;
+    if (config.use_customization)
     {
-        util::SimpleLogger().Write() << "Done reading node weights.";
+        CustomizeGraph(max_edge_id, edge_based_edge_list, contracted_edge_list, node_levels);
     }
     else
     {
-        throw util::exception("Failed reading node weights.");
-    }
+        util::SimpleLogger().Write() << "Reading node weights.";
+        std::vector<EdgeWeight> node_weights;
+        std::string node_file_name = config.osrm_input_path.string() + ".enw";
+        if (util::deserializeVector(node_file_name, node_weights))
+        {
+            util::SimpleLogger().Write() << "Done reading node weights.";
+        }
+        else
+        {
+            throw util::exception("Failed reading node weights.");
+        }
 
-    util::DeallocatingVector<QueryEdge> contracted_edge_list;
-    ContractGraph(max_edge_id, edge_based_edge_list, contracted_edge_list, std::move(node_weights),
-                  is_core_node, node_levels);
+        ContractGraph(max_edge_id, edge_based_edge_list, contracted_edge_list,
+                      std::move(node_weights), is_core_node, node_levels);
+    }
     TIMER_STOP(contraction);
 
     util::SimpleLogger().Write() << "Contraction took " << TIMER_SEC(contraction) << " sec";
 
     std::size_t number_of_used_edges = WriteContractedGraph(max_edge_id, contracted_edge_list);
+    WriteCoreLandmarks(is_core_node, contracted_edge_list);
     WriteCoreNodeMarker(std::move(is_core_node));
-    if (!config.use_cached_priority)
+    if (!config.use_cached_priority && !config.use_customization)
     {
         WriteNodeLevels(std::move(node_levels));
     }
@@ -172,31 +217,20 @@ parse_segment_lookup_from_csv_files(const std::vector<std::string> &segment_spee
         const auto file_id = idx + 1; // starts at one, zero means we assigned the weight
         const auto filename = segment_speed_filenames[idx];
 
-        std::ifstream segment_speed_file{filename, std::ios::binary};
-        if (!segment_speed_file)
-            throw util::exception{"Unable to open segment speed file " + filename};
-
-        std::uint64_t from_node_id{};
-        std::uint64_t to_node_id{};
-        unsigned speed{};
+        const auto insert_record = [&](const SegmentSpeedRecord &record) {
+            map[std::make_pair(record.from, record.to)] = std::make_pair(record.speed, file_id);
+        };
 
-        for (std::string line; std::getline(segment_speed_file, line);)
+        // binary files from osrm-convert-speeds are mapped, not parsed
+        if (isSegmentSpeedFile(filename))
         {
-            using namespace boost::spirit::qi;
-
-            auto it = begin(line);
-            const auto last = end(line);
-
-            // The ulong_long -> uint64_t will likely break on 32bit platforms
-            const auto ok = parse(it, last,                                          //
-                                  (ulong_long >> ',' >> ulong_long >> ',' >> uint_), //
-                                  from_node_id, to_node_id, speed);                  //
-
-            if (!ok || it != last)
-                throw util::exception{"Segment speed file " + filename + " malformed"};
-
-            map[std::make_pair(OSMNodeID(from_node_id), OSMNodeID(to_node_id))] =
-                std::make_pair(speed, file_id);
+            const SegmentSpeedFile speed_file(filename);
+            std::for_each(speed_file.begin(), speed_file.end(), insert_record);
+        }
+        else
+        {
+            const auto records = readSegmentSpeedsFromCSV(filename);
+            std::for_each(records.begin(), records.end(), insert_record);
         }
     };
 
@@ -249,6 +283,176 @@ parse_turn_penalty_lookup_from_csv_files(const std::vector<std::string> &turn_pe
 
     return map;
 }
+
+// Weight of a segment of the given length in meters at the given speed in km/h. This is the
+// formula of the EdgeBasedGraphFactory.
+int segment_weight_from_speed(const double segment_length, const unsigned speed)
+{
+    return std::max(1, static_cast<int>(std::floor((segment_length * 10.) / (speed / 3.6) + .5)));
+}
+
+// The .segment_index file maps every directed OSM segment to the position of its weight in the
+// packed geometries and every packed geometry to the edge-based edges that start with it.
+// Layout: header, entries sorted by segment, first edge of every geometry, edge ids.
+struct SegmentIndexHeader
+{
+    // Id of the extract the index was built from, osrm-extract writes a new one into the .ebg
+    // header on every run. Updates only patch weights and keep it.
+    std::uint64_t extract_id;
+    // sizes of the .geometry and .ebg files the index was built for
+    std::uint64_t number_of_indices;
+    std::uint64_t number_of_segments;
+    std::uint64_t number_of_edges;
+    std::uint64_t number_of_entries;
+};
+
+struct SegmentIndexEntry
+{
+    OSMNodeID from;
+    OSMNodeID to;
+    double length;
+    unsigned position;
+    unsigned geometry_id;
+};
+
+// The fingerprint does not change with the layout of the .ebg file, the header magic does
+void check_edge_based_graph_header(const extractor::EdgeBasedGraphHeader &header,
+                                   const std::string &edge_based_graph_filename)
+{
+    if (header.magic != extractor::EdgeBasedGraphHeader::CURRENT_MAGIC)
+    {
+        throw util::exception(edge_based_graph_filename +
+                              " was written by another version of osrm-extract, please "
+                              "re-run osrm-extract");
+    }
+}
+
+// .edge_penalties holds the fixed penalty and the from, via and to nodes of every edge
+const constexpr std::size_t EDGE_PENALTY_RECORD_SIZE = sizeof(unsigned) + 3 * sizeof(OSMNodeID);
+
+void build_segment_index(const std::string &segment_index_filename,
+                         const std::string &nodes_filename,
+                         const std::string &rtree_leaf_filename,
+                         const std::string &edge_data_filename,
+                         SegmentIndexHeader header,
+                         const unsigned *geometry_indices,
+                         const extractor::CompressedEdgeContainer::CompressedEdge *geometry_list)
+{
+    using boost::interprocess::file_mapping;
+    using boost::interprocess::mapped_region;
+    using boost::interprocess::read_only;
+
+    std::vector<extractor::QueryNode> internal_to_external_node_map;
+    {
+        boost::filesystem::ifstream nodes_input_stream(nodes_filename, std::ios::binary);
+        if (!nodes_input_stream)
+        {
+            throw util::exception("Failed to open " + nodes_filename);
+        }
+        unsigned number_of_nodes = 0;
+        nodes_input_stream.read((char *)&number_of_nodes, sizeof(unsigned));
+        internal_to_external_node_map.resize(number_of_nodes);
+        nodes_input_stream.read(reinterpret_cast<char *>(internal_to_external_node_map.data()),
+                                number_of_nodes * sizeof(extractor::QueryNode));
+    }
+
+    // Like the full update, we use the leaves of the StaticRTree to find every segment
+    std::vector<SegmentIndexEntry> entries;
+    {
+        using LeafNode = util::StaticRTree<extractor::EdgeBasedNode>::LeafNode;
+
+        const file_mapping mapping{rtree_leaf_filename.c_str(), read_only};
+        mapped_region region{mapping, read_only};
+        const auto first = static_cast<const LeafNode *>(region.get_address());
+        const auto last = first + (region.get_size() / sizeof(LeafNode));
+
+        const auto add_entry = [&](const NodeID first_node, const unsigned geometry_id,
+                                   const unsigned segment_position) {
+            const auto begin = geometry_indices[geometry_id];
+            const auto &u =
+                internal_to_external_node_map[segment_position == 0
+                                                  ? first_node
+                                                  : geometry_list[begin + segment_position - 1]
+                                                        .node_id];
+            const auto &v =
+                internal_to_external_node_map[geometry_list[begin + segment_position].node_id];
+            const double segment_length = util::coordinate_calculation::greatCircleDistance(
+                util::Coordinate{u.lon, u.lat}, util::Coordinate{v.lon, v.lat});
+            entries.push_back(SegmentIndexEntry{u.node_id, v.node_id, segment_length,
+                                                begin + segment_position, geometry_id});
+        };
+
+        std::for_each(first, last, [&](const LeafNode &current_node) {
+            for (size_t i = 0; i < current_node.object_count; i++)
+            {
+                const auto &leaf_object = current_node.objects[i];
+                if (leaf_object.forward_packed_geometry_id != SPECIAL_EDGEID)
+                {
+                    add_entry(leaf_object.u, leaf_object.forward_packed_geometry_id,
+                              leaf_object.fwd_segment_position);
+                }
+                if (leaf_object.reverse_packed_geometry_id != SPECIAL_EDGEID)
+                {
+                    const auto reverse_id = leaf_object.reverse_packed_geometry_id;
+                    const auto reverse_length =
+                        geometry_indices[reverse_id + 1] - geometry_indices[reverse_id];
+                    add_entry(leaf_object.v, reverse_id,
+                              reverse_length - leaf_object.fwd_segment_position - 1);
+                }
+            }
+        });
+    }
+    tbb::parallel_sort(entries.begin(), entries.end(),
+                       [](const SegmentIndexEntry &lhs, const SegmentIndexEntry &rhs) {
+                           return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+                       });
+    header.number_of_entries = entries.size();
+
+    // The weight of an edge-based edge depends on the geometry of the edge it starts with
+    std::vector<unsigned> first_edge(header.number_of_indices, 0);
+    std::vector<unsigned> edges(header.number_of_edges);
+    {
+        boost::filesystem::ifstream edge_data_stream(edge_data_filename, std::ios::binary);
+        if (!edge_data_stream)
+        {
+            throw util::exception("Failed to open " + edge_data_filename);
+        }
+        unsigned number_of_edges = 0;
+        edge_data_stream.read((char *)&number_of_edges, sizeof(unsigned));
+        if (number_of_edges != header.number_of_edges)
+        {
+            throw util::exception(edge_data_filename + " does not match the edge-based graph");
+        }
+        std::vector<extractor::OriginalEdgeData> edge_data(number_of_edges);
+        edge_data_stream.read(reinterpret_cast<char *>(edge_data.data()),
+                              number_of_edges * sizeof(extractor::OriginalEdgeData));
+
+        for (const auto &data : edge_data)
+        {
+            BOOST_ASSERT(data.via_node + 1 < first_edge.size());
+            ++first_edge[data.via_node + 1];
+        }
+        std::partial_sum(first_edge.begin(), first_edge.end(), first_edge.begin());
+        auto insert_position = first_edge;
+        for (const auto edge : util::irange<unsigned>(0, number_of_edges))
+        {
+            edges[insert_position[edge_data[edge].via_node]++] = edge;
+        }
+    }
+
+    std::ofstream index_stream(segment_index_filename, std::ios::binary);
+    if (!index_stream)
+    {
+        throw util::exception("Failed to open " + segment_index_filename + " for writing");
+    }
+    index_stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    index_stream.write(reinterpret_cast<const char *>(entries.data()),
+                       entries.size() * sizeof(SegmentIndexEntry));
+    index_stream.write(reinterpret_cast<const char *>(first_edge.data()),
+                       first_edge.size() * sizeof(unsigned));
+    index_stream.write(reinterpret_cast<const char *>(edges.data()),
+                       edges.size() * sizeof(unsigned));
+}
 } // anon ns
 
 std::size_t Contractor::LoadEdgeExpandedGraph(
@@ -262,6 +466,7 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
     const std::string &geometry_filename,
     const std::string &datasource_names_filename,
     const std::string &datasource_indexes_filename,
+    const std::string &segment_weights_filename,
     const std::string &rtree_leaf_filename)
 {
     if (segment_speed_filenames.size() > 255 || turn_penalty_filenames.size() > 255)
@@ -274,6 +479,8 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
 
     const bool update_edge_weights = !segment_speed_filenames.empty();
     const bool update_turn_penalties = !turn_penalty_filenames.empty();
+    // named metrics keep their segment weights apart from the shared geometry
+    const bool save_segment_weights = !segment_weights_filename.empty();
 
     boost::filesystem::ifstream edge_segment_input_stream;
     boost::filesystem::ifstream edge_fixed_penalties_input_stream;
@@ -294,12 +501,11 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
     input_stream.read((char *)&fingerprint_loaded, sizeof(util::FingerPrint));
     fingerprint_loaded.TestContractor(fingerprint_valid);
 
-    // TODO std::size_t can vary on systems. Our files are not transferable, but we might want to
-    // consider using a fixed size type for I/O
-    std::size_t number_of_edges = 0;
-    std::size_t max_edge_id = SPECIAL_EDGEID;
-    input_stream.read((char *)&number_of_edges, sizeof(std::size_t));
-    input_stream.read((char *)&max_edge_id, sizeof(std::size_t));
+    extractor::EdgeBasedGraphHeader graph_header;
+    input_stream.read((char *)&graph_header, sizeof(graph_header));
+    check_edge_based_graph_header(graph_header, edge_based_graph_filename);
+    std::size_t number_of_edges = graph_header.number_of_edges;
+    const std::size_t max_edge_id = graph_header.max_edge_id;
 
     edge_based_edge_list.resize(number_of_edges);
     util::SimpleLogger().Write() << "Reading " << number_of_edges
@@ -347,7 +553,7 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
     };
 
     const auto maybe_load_geometries = [&] {
-        if (!(update_edge_weights || update_turn_penalties))
+        if (!(update_edge_weights || update_turn_penalties || save_segment_weights))
             return;
 
         std::ifstream geometry_stream(geometry_filename, std::ios::binary);
@@ -507,9 +713,55 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
     }
 
     const auto maybe_save_geometries = [&] {
+        if (save_segment_weights)
+        {
+            // Same layout as the .geometry file, but only the weight of every segment
+            std::ofstream weights_stream(segment_weights_filename, std::ios::binary);
+            if (!weights_stream)
+            {
+                throw util::exception("Failed to open " + segment_weights_filename +
+                                      " for writing");
+            }
+            std::vector<EdgeWeight> segment_weights(m_geometry_list.size());
+            std::transform(m_geometry_list.begin(), m_geometry_list.end(),
+                           segment_weights.begin(),
+                           [](const extractor::CompressedEdgeContainer::CompressedEdge &edge) {
+                               return edge.weight;
+                           });
+            const unsigned number_of_indices = m_geometry_indices.size();
+            const unsigned number_of_segments = segment_weights.size();
+            weights_stream.write(reinterpret_cast<const char *>(&number_of_indices),
+                                 sizeof(unsigned));
+            weights_stream.write(reinterpret_cast<char *>(&(m_geometry_indices[0])),
+                                 number_of_indices * sizeof(unsigned));
+            weights_stream.write(reinterpret_cast<const char *>(&number_of_segments),
+                                 sizeof(unsigned));
+            weights_stream.write(reinterpret_cast<char *>(&(segment_weights[0])),
+                                 number_of_segments * sizeof(EdgeWeight));
+            return;
+        }
+
         if (!(update_edge_weights || update_turn_penalties))
             return;
 
+        // The edges in the .ebg file keep their profile weights, so segment speed deltas can not
+        // patch this dataset consistently anymore
+        if (update_edge_weights && !graph_header.stale_edge_weights)
+        {
+            boost::filesystem::fstream graph_stream(edge_based_graph_filename,
+                                                    std::ios::in | std::ios::out |
+                                                        std::ios::binary);
+            const std::uint64_t stale_edge_weights = 1;
+            graph_stream.seekp(sizeof(util::FingerPrint) +
+                               offsetof(extractor::EdgeBasedGraphHeader, stale_edge_weights));
+            graph_stream.write(reinterpret_cast<const char *>(&stale_edge_weights),
+                               sizeof(stale_edge_weights));
+            if (!graph_stream)
+            {
+                throw util::exception("Failed to update " + edge_based_graph_filename);
+            }
+        }
+
         // Now save out the updated compressed geometries
         std::ofstream geometry_stream(geometry_filename, std::ios::binary);
         if (!geometry_stream)
@@ -557,7 +809,11 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
         }
     };
 
-    tbb::parallel_invoke(maybe_save_geometries, save_datasource_indexes, save_datastore_names);
+    // Segment speed deltas have already patched the dataset in place
+    if (config.segment_speed_delta_paths.empty())
+    {
+        tbb::parallel_invoke(maybe_save_geometries, save_datasource_indexes, save_datastore_names);
+    }
 
     // TODO: can we read this in bulk?  util::DeallocatingVector isn't necessarily
     // all stored contiguously
@@ -653,11 +909,262 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
     return max_edge_id;
 }
 
+void Contractor::ApplySegmentSpeedDeltas() const
+{
+    using boost::interprocess::file_mapping;
+    using boost::interprocess::mapped_region;
+    using boost::interprocess::read_only;
+    using boost::interprocess::read_write;
+
+    if (!config.segment_speed_lookup_paths.empty() || !config.turn_penalty_lookup_paths.empty())
+    {
+        throw util::exception("Segment speed delta files can not be combined with segment speed "
+                              "or turn penalty files");
+    }
+    if (!config.metric_name.empty())
+    {
+        throw util::exception(
+            "Segment speed delta files can only be applied to the default metric");
+    }
+    if (!boost::filesystem::exists(config.edge_penalty_path))
+    {
+        throw util::exception("Could not load .edge_penalties, did you run osrm-extract with "
+                              "'--generate-edge-lookup'?");
+    }
+
+    TIMER_START(apply_deltas);
+
+    // All files are patched in place: only the pages that hold a changed weight are touched
+    const file_mapping geometry_mapping{config.geometry_path.c_str(), read_write};
+    mapped_region geometry_region{geometry_mapping, read_write};
+    const auto geometry_data = static_cast<char *>(geometry_region.get_address());
+    unsigned number_of_indices = 0;
+    std::memcpy(&number_of_indices, geometry_data, sizeof(unsigned));
+    const auto geometry_indices =
+        reinterpret_cast<const unsigned *>(geometry_data + sizeof(unsigned));
+    unsigned number_of_segments = 0;
+    std::memcpy(&number_of_segments, geometry_data + (number_of_indices + 1) * sizeof(unsigned),
+                sizeof(unsigned));
+    using CompressedEdge = extractor::CompressedEdgeContainer::CompressedEdge;
+    const auto geometry_list = reinterpret_cast<CompressedEdge *>(
+        geometry_data + (number_of_indices + 2) * sizeof(unsigned));
+
+    const file_mapping graph_mapping{config.edge_based_graph_path.c_str(), read_write};
+    mapped_region graph_region{graph_mapping, read_write};
+    const auto graph_data =
+        static_cast<char *>(graph_region.get_address()) + sizeof(util::FingerPrint);
+    extractor::EdgeBasedGraphHeader graph_header;
+    std::memcpy(&graph_header, graph_data, sizeof(graph_header));
+    check_edge_based_graph_header(graph_header, config.edge_based_graph_path);
+    if (graph_header.stale_edge_weights)
+    {
+        throw util::exception("Segment speed delta files can not be applied after a "
+                              "--segment-speed-file update, please re-run osrm-extract");
+    }
+    const std::size_t number_of_edges = graph_header.number_of_edges;
+    const auto graph_edges = graph_data + sizeof(graph_header);
+
+    const file_mapping penalty_mapping{config.edge_penalty_path.c_str(), read_only};
+    mapped_region penalty_region{penalty_mapping, read_only};
+    const auto penalty_data = static_cast<const char *>(penalty_region.get_address());
+    if (penalty_region.get_size() < number_of_edges * EDGE_PENALTY_RECORD_SIZE)
+    {
+        throw util::exception(config.edge_penalty_path + " does not match the edge-based graph");
+    }
+
+    // The index only depends on the extracted data, so it is built once and reused by every
+    // update until osrm-extract runs again. A new extract can have the same counts, so the index
+    // is also keyed to the id of the extract. Checking it is O(1), unlike checksumming the files.
+    const SegmentIndexHeader header{graph_header.extract_id, number_of_indices, number_of_segments,
+                                    number_of_edges, 0};
+    const auto index_is_current = [&] {
+        boost::filesystem::ifstream index_stream(config.segment_index_path, std::ios::binary);
+        SegmentIndexHeader index_header;
+        return index_stream.read(reinterpret_cast<char *>(&index_header), sizeof(index_header)) &&
+               index_header.extract_id == header.extract_id &&
+               index_header.number_of_indices == header.number_of_indices &&
+               index_header.number_of_segments == header.number_of_segments &&
+               index_header.number_of_edges == header.number_of_edges;
+    };
+    if (!index_is_current())
+    {
+        util::SimpleLogger().Write() << "Building segment index " << config.segment_index_path;
+        build_segment_index(config.segment_index_path, config.node_based_graph_path,
+                            config.rtree_leaf_path, config.edge_data_path, header,
+                            geometry_indices, geometry_list);
+    }
+
+    const file_mapping index_mapping{config.segment_index_path.c_str(), read_only};
+    mapped_region index_region{index_mapping, read_only};
+    const auto index_data = static_cast<const char *>(index_region.get_address());
+    SegmentIndexHeader index_header;
+    std::memcpy(&index_header, index_data, sizeof(index_header));
+    const auto entries_begin =
+        reinterpret_cast<const SegmentIndexEntry *>(index_data + sizeof(SegmentIndexHeader));
+    const auto entries_end = entries_begin + index_header.number_of_entries;
+    const auto first_edge = reinterpret_cast<const unsigned *>(entries_end);
+    const auto geometry_edges = first_edge + number_of_indices;
+
+    // The delta files are added to the data sources of earlier updates
+    std::vector<std::string> datasource_names;
+    {
+        boost::filesystem::ifstream names_stream(config.datasource_names_path);
+        for (std::string name; std::getline(names_stream, name);)
+        {
+            datasource_names.push_back(name);
+        }
+    }
+    if (datasource_names.empty())
+    {
+        datasource_names.push_back("lua profile");
+    }
+    // data source of every delta file, behind the profile
+    std::vector<std::uint8_t> datasource_of_file(1, 0);
+    for (const auto &path : config.segment_speed_delta_paths)
+    {
+        // a file that is updated over and over again keeps its data source
+        const auto name = std::find(datasource_names.begin(), datasource_names.end(), path);
+        datasource_of_file.push_back(std::distance(datasource_names.begin(), name));
+        if (name == datasource_names.end())
+        {
+            datasource_names.push_back(path);
+        }
+    }
+    if (datasource_names.size() > 256)
+    {
+        throw util::exception("Limit of 255 data sources reached");
+    }
+
+    const auto datasource_entries_size = sizeof(std::size_t) + number_of_segments;
+    if (!boost::filesystem::exists(config.datasource_indexes_path) ||
+        boost::filesystem::file_size(config.datasource_indexes_path) != datasource_entries_size)
+    {
+        std::ofstream datasource_stream(config.datasource_indexes_path, std::ios::binary);
+        if (!datasource_stream)
+        {
+            throw util::exception("Failed to open " + config.datasource_indexes_path +
+                                  " for writing");
+        }
+        const std::size_t number_of_datasource_entries = number_of_segments;
+        const std::vector<std::uint8_t> datasources(number_of_datasource_entries, 0);
+        datasource_stream.write(reinterpret_cast<const char *>(&number_of_datasource_entries),
+                                sizeof(number_of_datasource_entries));
+        datasource_stream.write(reinterpret_cast<const char *>(datasources.data()),
+                                datasources.size());
+    }
+    const file_mapping datasource_mapping{config.datasource_indexes_path.c_str(), read_write};
+    mapped_region datasource_region{datasource_mapping, read_write};
+    const auto datasources =
+        static_cast<std::uint8_t *>(datasource_region.get_address()) + sizeof(std::size_t);
+
+    // Patch the weight of every changed segment and remember the geometries that contain them
+    std::vector<unsigned> changed_geometries;
+    std::size_t number_of_speeds = 0;
+    std::size_t number_of_changed_segments = 0;
+    const auto apply_speeds = [&](const SegmentSpeedRecord *record,
+                                  const SegmentSpeedRecord *const last,
+                                  const std::uint8_t datasource) {
+        number_of_speeds += last - record;
+        mergeSegmentSpeeds(
+            entries_begin, entries_end, record, last,
+            [&](const SegmentIndexEntry &entry, const SegmentSpeedRecord &speed_record) {
+                geometry_list[entry.position].weight =
+                    segment_weight_from_speed(entry.length, speed_record.speed);
+                datasources[entry.position] = datasource;
+                changed_geometries.push_back(entry.geometry_id);
+                ++number_of_changed_segments;
+            });
+    };
+
+    // later files override earlier ones
+    for (const auto file_index :
+         util::irange<std::size_t>(0, config.segment_speed_delta_paths.size()))
+    {
+        const auto &filename = config.segment_speed_delta_paths[file_index];
+        const auto datasource = datasource_of_file[file_index + 1];
+        if (isSegmentSpeedFile(filename))
+        {
+            const SegmentSpeedFile speed_file(filename);
+            if (!std::is_sorted(speed_file.begin(), speed_file.end()))
+            {
+                throw util::exception("Segment speed file " + filename + " is not sorted");
+            }
+            apply_speeds(speed_file.begin(), speed_file.end(), datasource);
+        }
+        else
+        {
+            auto records = readSegmentSpeedsFromCSV(filename);
+            sortSegmentSpeeds(records);
+            apply_speeds(records.data(), records.data() + records.size(), datasource);
+        }
+    }
+    std::sort(changed_geometries.begin(), changed_geometries.end());
+    changed_geometries.erase(std::unique(changed_geometries.begin(), changed_geometries.end()),
+                             changed_geometries.end());
+
+    // Only the edge-based edges that start with a changed geometry get a new weight
+    std::size_t number_of_changed_edges = 0;
+    for (const auto geometry_id : changed_geometries)
+    {
+        EdgeWeight geometry_weight = 0;
+        for (auto position = geometry_indices[geometry_id];
+             position < geometry_indices[geometry_id + 1]; ++position)
+        {
+            geometry_weight += geometry_list[position].weight;
+        }
+
+        for (auto edge = first_edge[geometry_id]; edge < first_edge[geometry_id + 1]; ++edge)
+        {
+            const auto edge_id = geometry_edges[edge];
+
+            unsigned fixed_penalty = 0;
+            std::memcpy(&fixed_penalty, penalty_data + edge_id * EDGE_PENALTY_RECORD_SIZE,
+                        sizeof(fixed_penalty));
+
+            const auto record = graph_edges + edge_id * sizeof(extractor::EdgeBasedEdge);
+            extractor::EdgeBasedEdge graph_edge;
+            std::memcpy(&graph_edge, record, sizeof(graph_edge));
+            if (graph_edge.edge_id != edge_id)
+            {
+                throw util::exception(config.edge_based_graph_path +
+                                      " does not store the edges in the order of their ids");
+            }
+            graph_edge.weight = fixed_penalty + geometry_weight;
+            std::memcpy(record, &graph_edge, sizeof(graph_edge));
+            ++number_of_changed_edges;
+        }
+    }
+
+    geometry_region.flush();
+    graph_region.flush();
+    datasource_region.flush();
+
+    std::ofstream names_stream(config.datasource_names_path);
+    if (!names_stream)
+    {
+        throw util::exception("Failed to open " + config.datasource_names_path + " for writing");
+    }
+    for (const auto &name : datasource_names)
+    {
+        names_stream << name << std::endl;
+    }
+
+    TIMER_STOP(apply_deltas);
+    util::SimpleLogger().Write() << "Applied " << number_of_speeds
+                                 << " segment speeds to " << number_of_changed_segments
+                                 << " segments and " << number_of_changed_edges << " edges in "
+                                 << TIMER_SEC(apply_deltas) << "s";
+}
+
 void Contractor::ReadNodeLevels(std::vector<float> &node_levels) const
 {
     boost::filesystem::ifstream order_input_stream(config.level_output_path, std::ios::binary);
+    if (!order_input_stream)
+    {
+        throw util::exception("Could not open " + config.level_output_path + " for reading");
+    }
 
-    unsigned level_size;
+    unsigned level_size = 0;
     order_input_stream.read((char *)&level_size, sizeof(unsigned));
     node_levels.resize(level_size);
     order_input_stream.read((char *)node_levels.data(), sizeof(float) * node_levels.size());
@@ -691,12 +1198,65 @@ void Contractor::WriteCoreNodeMarker(std::vector<bool> &&in_is_core_node) const
                                     sizeof(char) * unpacked_bool_flags.size());
 }
 
+void Contractor::ReadCoreNodeMarker(std::vector<bool> &is_core_node) const
+{
+    boost::filesystem::ifstream core_marker_input_stream(config.core_output_path,
+                                                         std::ios::binary);
+    if (!core_marker_input_stream)
+    {
+        throw util::exception("Could not open " + config.core_output_path + " for reading");
+    }
+
+    unsigned size = 0;
+    core_marker_input_stream.read((char *)&size, sizeof(unsigned));
+    std::vector<char> unpacked_bool_flags(size);
+    core_marker_input_stream.read((char *)unpacked_bool_flags.data(),
+                                  sizeof(char) * unpacked_bool_flags.size());
+    is_core_node.resize(size);
+    for (auto i = 0u; i < size; ++i)
+    {
+        is_core_node[i] = unpacked_bool_flags[i] != 0;
+    }
+}
+
+void Contractor::WriteCoreLandmarks(
+    const std::vector<bool> &is_core_node,
+    const util::DeallocatingVector<QueryEdge> &contracted_edge_list) const
+{
+    // Always write the file, so that landmarks of an earlier run with a core are not used
+    const bool use_landmarks = config.core_factor < 1.0 && config.core_landmarks > 0;
+    const std::vector<bool> no_core;
+    CoreLandmarks landmarks(use_landmarks ? is_core_node : no_core, contracted_edge_list);
+
+    TIMER_START(landmarks);
+    landmarks.Compute(config.core_landmarks);
+    landmarks.Write(config.landmarks_output_path);
+    TIMER_STOP(landmarks);
+
+    if (landmarks.GetNumberOfCoreNodes() > 0)
+    {
+        util::SimpleLogger().Write() << "Computed core landmarks for "
+                                     << landmarks.GetNumberOfCoreNodes() << " core nodes in "
+                                     << TIMER_SEC(landmarks) << " sec";
+    }
+}
+
 std::size_t
 Contractor::WriteContractedGraph(unsigned max_node_id,
                                  const util::DeallocatingVector<QueryEdge> &contracted_edge_list)
 {
     // Sorting contracted edges in a way that the static query graph can read some in in-place.
-    tbb::parallel_sort(contracted_edge_list.begin(), contracted_edge_list.end());
+    // Parallel edges are ordered by their data, so that the file does not depend on the order
+    // in which the threads produced them.
+    tbb::parallel_sort(contracted_edge_list.begin(), contracted_edge_list.end(),
+                       [](const QueryEdge &lhs, const QueryEdge &rhs) {
+                           return std::make_tuple(lhs.source, lhs.target, lhs.data.distance,
+                                                  lhs.data.id, lhs.data.shortcut,
+                                                  lhs.data.forward, lhs.data.backward) <
+                                  std::make_tuple(rhs.source, rhs.target, rhs.data.distance,
+                                                  rhs.data.id, rhs.data.shortcut,
+                                                  rhs.data.forward, rhs.data.backward);
+                       });
     const unsigned contracted_edge_count = contracted_edge_list.size();
     util::SimpleLogger().Write() << "Serializing compacted graph of " << contracted_edge_count
                                  << " edges";
@@ -704,17 +1264,19 @@ Contractor::WriteContractedGraph(unsigned max_node_id,
     const util::FingerPrint fingerprint = util::FingerPrint::GetValid();
     boost::filesystem::ofstream hsgr_output_stream(config.graph_output_path, std::ios::binary);
     hsgr_output_stream.write((char *)&fingerprint, sizeof(util::FingerPrint));
-    const unsigned max_used_node_id = [&contracted_edge_list] {
-        unsigned tmp_max = 0;
-        for (const QueryEdge &edge : contracted_edge_list)
-        {
-            BOOST_ASSERT(SPECIAL_NODEID != edge.source);
-            BOOST_ASSERT(SPECIAL_NODEID != edge.target);
-            tmp_max = std::max(tmp_max, edge.source);
-            tmp_max = std::max(tmp_max, edge.target);
-        }
-        return tmp_max;
-    }();
+    const unsigned max_used_node_id = tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, contracted_edge_count), 0u,
+        [&contracted_edge_list](const tbb::blocked_range<std::size_t> &range, unsigned tmp_max) {
+            for (auto edge = range.begin(); edge != range.end(); ++edge)
+            {
+                BOOST_ASSERT(SPECIAL_NODEID != contracted_edge_list[edge].source);
+                BOOST_ASSERT(SPECIAL_NODEID != contracted_edge_list[edge].target);
+                tmp_max = std::max(tmp_max, contracted_edge_list[edge].source);
+                tmp_max = std::max(tmp_max, contracted_edge_list[edge].target);
+            }
+            return tmp_max;
+        },
+        [](const unsigned lhs, const unsigned rhs) { return std::max(lhs, rhs); });
 
     util::SimpleLogger().Write(logDEBUG) << "input graph has " << (max_node_id + 1) << " nodes";
     util::SimpleLogger().Write(logDEBUG) << "contracted graph has " << (max_used_node_id + 1)
@@ -725,33 +1287,63 @@ Contractor::WriteContractedGraph(unsigned max_node_id,
     node_array.resize(max_node_id + 2);
 
     util::SimpleLogger().Write() << "Building node array";
-    util::StaticGraph<EdgeData>::EdgeIterator edge = 0;
-    util::StaticGraph<EdgeData>::EdgeIterator position = 0;
-    util::StaticGraph<EdgeData>::EdgeIterator last_edge;
 
-    // initializing 'first_edge'-field of nodes:
-    for (const auto node : util::irange(0u, max_used_node_id + 1))
+    // initializing 'first_edge'-field of nodes, the sentinels point past the last edge
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, node_array.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          const auto node_less = [](const QueryEdge &edge, const std::size_t node) {
+                              return edge.source < node;
+                          };
+                          // the edges of a block of nodes are adjacent, so one search per block
+                          // is enough
+                          auto edge = std::lower_bound(contracted_edge_list.begin(),
+                                                       contracted_edge_list.end(), range.begin(),
+                                                       node_less);
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                          {
+                              while (edge != contracted_edge_list.end() && edge->source < node)
+                              {
+                                  ++edge;
+                              }
+                              node_array[node].first_edge =
+                                  std::distance(contracted_edge_list.begin(), edge);
+                          }
+                      });
+
+    util::SimpleLogger().Write() << "Building edge array";
+    std::vector<util::StaticGraph<EdgeData>::EdgeArrayEntry> edge_array(contracted_edge_count);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, contracted_edge_count),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (auto edge = range.begin(); edge != range.end(); ++edge)
+                          {
+                              edge_array[edge].target = contracted_edge_list[edge].target;
+                              edge_array[edge].data = contracted_edge_list[edge].data;
+                              // every target needs to be valid
+                              BOOST_ASSERT(edge_array[edge].target <= max_used_node_id);
+                          }
+                      });
+
+#ifndef NDEBUG
+    for (const auto edge : util::irange<std::size_t>(0UL, edge_array.size()))
     {
-        last_edge = edge;
-        while ((edge < contracted_edge_count) && (contracted_edge_list[edge].source == node))
+        // some self-loops are required for oneway handling. Need to assertthat we only keep these
+        // (TODO)
+        if (edge_array[edge].data.distance <= 0)
         {
-            ++edge;
-        }
-        node_array[node].first_edge = position; //=edge
-        position += edge - last_edge;           // remove
-    }
+            util::SimpleLogger().Write(logWARNING)
+                << "Edge: " << edge << ",source: " << contracted_edge_list[edge].source
+                << ", target: " << contracted_edge_list[edge].target
+                << ", dist: " << edge_array[edge].data.distance;
 
-    for (const auto sentinel_counter :
-         util::irange<unsigned>(max_used_node_id + 1, node_array.size()))
-    {
-        // sentinel element, guarded against underflow
-        node_array[sentinel_counter].first_edge = contracted_edge_count;
+            util::SimpleLogger().Write(logWARNING) << "Failed at adjacency list of node "
+                                                   << contracted_edge_list[edge].source << "/"
+                                                   << node_array.size() - 1;
+            return 1;
+        }
     }
+#endif
 
-    util::SimpleLogger().Write() << "Serializing node array";
-
-    RangebasedCRC32 crc32_calculator;
-    const unsigned edges_crc32 = crc32_calculator(contracted_edge_list);
+    const unsigned edges_crc32 = ParallelCRC32(edge_array);
     util::SimpleLogger().Write() << "Writing CRC32: " << edges_crc32;
 
     const unsigned node_array_size = node_array.size();
@@ -762,51 +1354,24 @@ Contractor::WriteContractedGraph(unsigned max_node_id,
     // serialize number of edges
     hsgr_output_stream.write((char *)&contracted_edge_count, sizeof(unsigned));
     // serialize all nodes
+    util::SimpleLogger().Write() << "Serializing node array";
     if (node_array_size > 0)
     {
-        hsgr_output_stream.write((char *)&node_array[0],
+        hsgr_output_stream.write((char *)node_array.data(),
                                  sizeof(util::StaticGraph<EdgeData>::NodeArrayEntry) *
                                      node_array_size);
     }
 
     // serialize all edges
-    util::SimpleLogger().Write() << "Building edge array";
-    int number_of_used_edges = 0;
-
-    util::StaticGraph<EdgeData>::EdgeArrayEntry current_edge;
-    for (const auto edge : util::irange<std::size_t>(0UL, contracted_edge_list.size()))
+    util::SimpleLogger().Write() << "Serializing edge array";
+    if (contracted_edge_count > 0)
     {
-        // some self-loops are required for oneway handling. Need to assertthat we only keep these
-        // (TODO)
-        // no eigen loops
-        // BOOST_ASSERT(contracted_edge_list[edge].source != contracted_edge_list[edge].target ||
-        // node_represents_oneway[contracted_edge_list[edge].source]);
-        current_edge.target = contracted_edge_list[edge].target;
-        current_edge.data = contracted_edge_list[edge].data;
-
-        // every target needs to be valid
-        BOOST_ASSERT(current_edge.target <= max_used_node_id);
-#ifndef NDEBUG
-        if (current_edge.data.distance <= 0)
-        {
-            util::SimpleLogger().Write(logWARNING)
-                << "Edge: " << edge << ",source: " << contracted_edge_list[edge].source
-                << ", target: " << contracted_edge_list[edge].target
-                << ", dist: " << current_edge.data.distance;
-
-            util::SimpleLogger().Write(logWARNING) << "Failed at adjacency list of node "
-                                                   << contracted_edge_list[edge].source << "/"
-                                                   << node_array.size() - 1;
-            return 1;
-        }
-#endif
-        hsgr_output_stream.write((char *)&current_edge,
-                                 sizeof(util::StaticGraph<EdgeData>::EdgeArrayEntry));
-
-        ++number_of_used_edges;
+        hsgr_output_stream.write((char *)edge_array.data(),
+                                 sizeof(util::StaticGraph<EdgeData>::EdgeArrayEntry) *
+                                     contracted_edge_count);
     }
 
-    return number_of_used_edges;
+    return contracted_edge_count;
 }
 
 /**
@@ -825,10 +1390,43 @@ void Contractor::ContractGraph(
 
     GraphContractor graph_contractor(max_edge_id + 1, edge_based_edge_list, std::move(node_levels),
                                      std::move(node_weights));
-    graph_contractor.Run(config.core_factor);
+    graph_contractor.Run(config.core_factor, config.use_lazy_priority_updates,
+                         config.flush_stages);
+
+    std::vector<ContractionRoundStats> round_stats;
+    graph_contractor.GetRoundStats(round_stats);
+    std::size_t number_of_shortcut_edges = 0;
+    std::size_t number_of_priority_updates = 0;
+    for (const auto &round : round_stats)
+    {
+        util::SimpleLogger().Write(logDEBUG)
+            << "round " << round.level << ": " << round.contracted_nodes << " of "
+            << round.remaining_nodes << " nodes, " << round.shortcut_edges << " shortcut edges, "
+            << round.priority_updates << " priority updates in " << round.seconds << "s";
+        number_of_shortcut_edges += round.shortcut_edges;
+        number_of_priority_updates += round.priority_updates;
+    }
+    util::SimpleLogger().Write() << "Contracted in " << round_stats.size() << " rounds, added "
+                                 << number_of_shortcut_edges << " shortcut edges and updated "
+                                 << number_of_priority_updates << " priorities";
+
     graph_contractor.GetEdges(contracted_edge_list);
     graph_contractor.GetCoreMarker(is_core_node);
     graph_contractor.GetNodeLevels(inout_node_levels);
 }
+
+/**
+ \brief Build a customizable hierarchy in the cached contraction order and compute its weights.
+ */
+void Contractor::CustomizeGraph(
+    const unsigned max_edge_id,
+    const util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+    util::DeallocatingVector<QueryEdge> &contracted_edge_list,
+    const std::vector<float> &node_levels) const
+{
+    GraphCustomizer graph_customizer(max_edge_id + 1, node_levels, edge_based_edge_list);
+    graph_customizer.Customize(edge_based_edge_list);
+    graph_customizer.GetEdges(contracted_edge_list);
+}
 }
 }
@@ -9,9 +9,11 @@
 #include "engine/plugins/viaroute.hpp"
 #include "engine/plugins/tile.hpp"
 #include "engine/plugins/match.hpp"
+#include "engine/plugins/isochrone.hpp"
 
 #include "engine/datafacade/datafacade_base.hpp"
 #include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/datafacade/metric_datafacade.hpp"
 #include "engine/datafacade/shared_datafacade.hpp"
 
 #include "storage/shared_barriers.hpp"
@@ -25,6 +27,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -117,6 +120,13 @@ std::unique_ptr<Plugin> create(Facade &facade, Args... args)
     return osrm::util::make_unique<Plugin>(facade, std::forward<Args>(args)...);
 }
 
+osrm::engine::Status UnknownMetric(const std::string &metric, osrm::util::json::Object &result)
+{
+    result.values["code"] = "InvalidOptions";
+    result.values["message"] = "Unknown metric " + metric;
+    return osrm::engine::Status::Error;
+}
+
 } // anon. ns
 
 namespace osrm
@@ -124,10 +134,38 @@ namespace osrm
 namespace engine
 {
 
+struct Engine::MetricPlugins
+{
+    MetricPlugins(datafacade::BaseDataFacade &facade, const EngineConfig &config)
+    {
+        using namespace plugins;
+
+        route_plugin = create<ViaRoutePlugin>(facade, config.max_locations_viaroute);
+        table_plugin = create<TablePlugin>(facade, config.max_locations_distance_table);
+        nearest_plugin = create<NearestPlugin>(facade);
+        trip_plugin = create<TripPlugin>(facade, config.max_locations_trip);
+        match_plugin = create<MatchPlugin>(facade, config.max_locations_map_matching);
+        tile_plugin = create<TilePlugin>(facade);
+        isochrone_plugin = create<IsochronePlugin>(facade);
+    }
+
+    std::unique_ptr<plugins::ViaRoutePlugin> route_plugin;
+    std::unique_ptr<plugins::TablePlugin> table_plugin;
+    std::unique_ptr<plugins::NearestPlugin> nearest_plugin;
+    std::unique_ptr<plugins::TripPlugin> trip_plugin;
+    std::unique_ptr<plugins::MatchPlugin> match_plugin;
+    std::unique_ptr<plugins::TilePlugin> tile_plugin;
+    std::unique_ptr<plugins::IsochronePlugin> isochrone_plugin;
+};
+
 Engine::Engine(EngineConfig &config)
 {
     if (config.use_shared_memory)
     {
+        if (!config.metric_configs.empty())
+        {
+            throw util::exception("Named metrics are not supported with shared memory!");
+        }
         lock = util::make_unique<EngineLock>();
         query_data_facade = util::make_unique<datafacade::SharedDataFacade>();
     }
@@ -137,18 +175,27 @@ Engine::Engine(EngineConfig &config)
         {
             throw util::exception("Invalid file paths given!");
         }
-        query_data_facade = util::make_unique<datafacade::InternalDataFacade>(config.storage_config);
-    }
+        auto internal_data_facade =
+            util::make_unique<datafacade::InternalDataFacade>(config.storage_config);
+
+        for (const auto &metric_config : config.metric_configs)
+        {
+            if (!metric_config.IsValid())
+            {
+                throw util::exception("Invalid file paths given for metric " + metric_config.name +
+                                      "!");
+            }
+            metric_data_facades.push_back(util::make_unique<datafacade::MetricDataFacade>(
+                *internal_data_facade, metric_config));
+            metric_plugins[metric_config.name] =
+                util::make_unique<MetricPlugins>(*metric_data_facades.back(), config);
+        }
 
-    // Register plugins
-    using namespace plugins;
+        query_data_facade = std::move(internal_data_facade);
+    }
 
-    route_plugin = create<ViaRoutePlugin>(*query_data_facade, config.max_locations_viaroute);
-    table_plugin = create<TablePlugin>(*query_data_facade, config.max_locations_distance_table);
-    nearest_plugin = create<NearestPlugin>(*query_data_facade);
-    trip_plugin = create<TripPlugin>(*query_data_facade, config.max_locations_trip);
-    match_plugin = create<MatchPlugin>(*query_data_facade, config.max_locations_map_matching);
-    tile_plugin = create<TilePlugin>(*query_data_facade);
+    // Register plugins of the default metric
+    metric_plugins[""] = util::make_unique<MetricPlugins>(*query_data_facade, config);
 }
 
 // make sure we deallocate the unique ptr at a position where we know the size of the plugins
@@ -156,34 +203,64 @@ Engine::~Engine() = default;
 Engine::Engine(Engine &&) noexcept = default;
 Engine &Engine::operator=(Engine &&) noexcept = default;
 
+Engine::MetricPlugins *Engine::GetMetricPlugins(const std::string &metric) const
+{
+    const auto plugins = metric_plugins.find(metric);
+    return plugins == metric_plugins.end() ? nullptr : plugins->second.get();
+}
+
 Status Engine::Route(const api::RouteParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *route_plugin, result);
+    const auto plugins = GetMetricPlugins(params.metric);
+    if (!plugins)
+        return UnknownMetric(params.metric, result);
+    return RunQuery(lock, *query_data_facade, params, *plugins->route_plugin, result);
 }
 
 Status Engine::Table(const api::TableParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *table_plugin, result);
+    const auto plugins = GetMetricPlugins(params.metric);
+    if (!plugins)
+        return UnknownMetric(params.metric, result);
+    return RunQuery(lock, *query_data_facade, params, *plugins->table_plugin, result);
 }
 
 Status Engine::Nearest(const api::NearestParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *nearest_plugin, result);
+    const auto plugins = GetMetricPlugins(params.metric);
+    if (!plugins)
+        return UnknownMetric(params.metric, result);
+    return RunQuery(lock, *query_data_facade, params, *plugins->nearest_plugin, result);
 }
 
 Status Engine::Trip(const api::TripParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *trip_plugin, result);
+    const auto plugins = GetMetricPlugins(params.metric);
+    if (!plugins)
+        return UnknownMetric(params.metric, result);
+    return RunQuery(lock, *query_data_facade, params, *plugins->trip_plugin, result);
 }
 
 Status Engine::Match(const api::MatchParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *match_plugin, result);
+    const auto plugins = GetMetricPlugins(params.metric);
+    if (!plugins)
+        return UnknownMetric(params.metric, result);
+    return RunQuery(lock, *query_data_facade, params, *plugins->match_plugin, result);
 }
 
+// tiles show the default metric
 Status Engine::Tile(const api::TileParameters &params, std::string &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *tile_plugin, result);
+    return RunQuery(lock, *query_data_facade, params, *GetMetricPlugins("")->tile_plugin, result);
+}
+
+Status Engine::Isochrone(const api::IsochroneParameters &params, util::json::Object &result)
+{
+    const auto plugins = GetMetricPlugins(params.metric);
+    if (!plugins)
+        return UnknownMetric(params.metric, result);
+    return RunQuery(lock, *query_data_facade, params, *plugins->isochrone_plugin, result);
 }
 
 } // engine ns
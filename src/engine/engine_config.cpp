@@ -1,5 +1,7 @@
 #include "engine/engine_config.hpp"
 
+#include <algorithm>
+
 namespace osrm
 {
 namespace engine
@@ -21,7 +23,13 @@ bool EngineConfig::IsValid() const
         (max_locations_trip == -1 || max_locations_trip > 2) &&
         (max_locations_viaroute == -1 || max_locations_viaroute > 2);
 
-    return ((use_shared_memory && all_path_are_empty) || storage_config.IsValid()) && limits_valid;
+    const bool metrics_valid =
+        std::all_of(metric_configs.begin(), metric_configs.end(),
+                    [](const storage::MetricStorageConfig &metric) { return metric.IsValid(); });
+
+    return ((use_shared_memory && all_path_are_empty && metric_configs.empty()) ||
+            (storage_config.IsValid() && metrics_valid)) &&
+           limits_valid;
 }
 }
 }
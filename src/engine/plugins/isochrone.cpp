@@ -0,0 +1,171 @@
+#include "engine/plugins/isochrone.hpp"
+
+#include "engine/api/isochrone_api.hpp"
+#include "engine/api/isochrone_parameters.hpp"
+#include "engine/routing_algorithms/one_to_many.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/integer_range.hpp"
+#include "util/json_container.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+IsochronePlugin::IsochronePlugin(datafacade::BaseDataFacade &facade)
+    : BasePlugin{facade}, one_to_many(&facade, heaps)
+{
+}
+
+// Every original edge-based edge is a turn from the segment whose geometry it references. Since
+// the edges are stored at the lower of their two nodes, the turn either starts at the node the
+// edge is stored at (forward) or at its target (backward).
+std::shared_ptr<const IsochronePlugin::NodeGeometries> IsochronePlugin::GetNodeGeometries()
+{
+    const auto checksum = facade.GetCheckSum();
+    const auto number_of_nodes = facade.GetNumberOfNodes();
+
+    std::lock_guard<std::mutex> lock(node_geometries_mutex);
+    if (node_geometries && node_geometries->checksum == checksum &&
+        node_geometries->geometry_ids.size() == number_of_nodes)
+    {
+        return node_geometries;
+    }
+
+    auto geometries = std::make_shared<NodeGeometries>();
+    geometries->checksum = checksum;
+    geometries->geometry_ids.resize(number_of_nodes, std::numeric_limits<unsigned>::max());
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        for (const auto edge : facade.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = facade.GetEdgeData(edge);
+            if (data.shortcut)
+            {
+                continue;
+            }
+            if (data.forward)
+            {
+                geometries->geometry_ids[node] = facade.GetGeometryIndexForEdgeID(data.id);
+            }
+            if (data.backward)
+            {
+                geometries->geometry_ids[facade.GetTarget(edge)] =
+                    facade.GetGeometryIndexForEdgeID(data.id);
+            }
+        }
+    }
+
+    node_geometries = std::move(geometries);
+    return node_geometries;
+}
+
+Status IsochronePlugin::HandleRequest(const api::IsochroneParameters &params,
+                                      util::json::Object &result)
+{
+    BOOST_ASSERT(params.IsValid());
+
+    if (!CheckAllCoordinates(params.coordinates))
+    {
+        return Error("InvalidOptions", "Coordinates are invalid", result);
+    }
+
+    if (params.coordinates.size() != 1)
+    {
+        return Error("InvalidOptions", "Only one input coordinate is supported", result);
+    }
+
+    if (facade.GetCoreSize() > 0)
+    {
+        return Error("NotImplemented", "Isochrones need a fully contracted graph", result);
+    }
+
+    const auto phantom_nodes = SnapPhantomNodes(GetPhantomNodes(params));
+    BOOST_ASSERT(phantom_nodes.size() == 1);
+    const auto &source = phantom_nodes.front();
+
+    const auto max_duration = static_cast<EdgeWeight>(std::round(params.duration * 10.));
+    const auto distances = one_to_many(source);
+    const auto geometries = GetNodeGeometries();
+
+    // Walk along the geometry of every reached segment. Locations in front of the source on its
+    // own segment have negative durations, as do segments reached by a u-turn on it.
+    std::unordered_map<NodeID, EdgeWeight> reached_nodes;
+    std::vector<NodeID> geometry;
+    std::vector<EdgeWeight> weights;
+    for (const auto node : util::irange<NodeID>(0, distances.size()))
+    {
+        const auto geometry_id = geometries->geometry_ids[node];
+        if (distances[node] > max_duration ||
+            geometry_id == std::numeric_limits<unsigned>::max())
+        {
+            continue;
+        }
+
+        facade.GetUncompressedGeometry(geometry_id, geometry);
+        facade.GetUncompressedWeights(geometry_id, weights);
+        BOOST_ASSERT(geometry.size() == weights.size());
+
+        EdgeWeight duration = distances[node];
+        for (const auto index : util::irange<std::size_t>(0UL, geometry.size()))
+        {
+            duration += weights[index];
+            if (duration > max_duration)
+            {
+                break;
+            }
+            if (duration < 0)
+            {
+                continue;
+            }
+            const auto iter = reached_nodes.find(geometry[index]);
+            if (iter == reached_nodes.end())
+            {
+                reached_nodes.emplace(geometry[index], duration);
+            }
+            else
+            {
+                iter->second = std::min(iter->second, duration);
+            }
+        }
+    }
+
+    std::vector<std::pair<EdgeWeight, NodeID>> sorted_nodes;
+    sorted_nodes.reserve(reached_nodes.size());
+    for (const auto &reached_node : reached_nodes)
+    {
+        sorted_nodes.emplace_back(reached_node.second, reached_node.first);
+    }
+    std::sort(sorted_nodes.begin(), sorted_nodes.end());
+
+    std::vector<util::Coordinate> locations;
+    std::vector<EdgeWeight> durations;
+    locations.reserve(sorted_nodes.size());
+    durations.reserve(sorted_nodes.size());
+    for (const auto &duration_and_node : sorted_nodes)
+    {
+        durations.push_back(duration_and_node.first);
+        locations.push_back(facade.GetCoordinateOfNode(duration_and_node.second));
+    }
+
+    api::IsochroneAPI isochrone_api{facade, params};
+    isochrone_api.MakeResponse(source, locations, durations, result);
+
+    return Status::Ok;
+}
+}
+}
+}
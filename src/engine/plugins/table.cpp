@@ -24,7 +24,7 @@ namespace plugins
 {
 
 TablePlugin::TablePlugin(datafacade::BaseDataFacade &facade, const int max_locations_distance_table)
-    : BasePlugin{facade}, distance_table(&facade, heaps),
+    : BasePlugin{facade}, distance_table(&facade, heaps), one_to_many_table(&facade, heaps),
       max_locations_distance_table(max_locations_distance_table)
 {
 }
@@ -59,7 +59,26 @@ Status TablePlugin::HandleRequest(const api::TableParameters &params, util::json
     }
 
     auto snapped_phantoms = SnapPhantomNodes(GetPhantomNodes(params));
-    auto result_table = distance_table(snapped_phantoms, params.sources, params.destinations);
+
+    // For few sources and many destinations a sweep over the part of the hierarchy above the
+    // destinations is cheaper than storing and scanning the buckets of every destination.
+    // The sweep needs a fully contracted graph.
+    const constexpr std::size_t MIN_SWEEP_DESTINATIONS = 256;
+    const constexpr std::size_t MIN_DESTINATIONS_PER_SOURCE = 16;
+    // Distances need the paths of the table, only the bucket search keeps them.
+    const bool need_distances =
+        params.annotations & api::TableParameters::AnnotationsType::Distance;
+    const bool use_sweep = !need_distances && facade.GetCoreSize() == 0 &&
+                           num_destinations >= MIN_SWEEP_DESTINATIONS &&
+                           num_sources * MIN_DESTINATIONS_PER_SOURCE <= num_destinations;
+
+    std::vector<double> distances;
+    auto result_table =
+        need_distances
+            ? distance_table(snapped_phantoms, params.sources, params.destinations, distances)
+            : use_sweep
+                  ? one_to_many_table(snapped_phantoms, params.sources, params.destinations)
+                  : distance_table(snapped_phantoms, params.sources, params.destinations);
 
     if (result_table.empty())
     {
@@ -67,7 +86,7 @@ Status TablePlugin::HandleRequest(const api::TableParameters &params, util::json
     }
 
     api::TableAPI table_api{facade, params};
-    table_api.MakeResponse(result_table, snapped_phantoms, result);
+    table_api.MakeResponse(result_table, distances, snapped_phantoms, result);
 
     return Status::Ok;
 }
@@ -1,5 +1,6 @@
 #include "extractor/edge_based_edge.hpp"
 #include "extractor/edge_based_graph_factory.hpp"
+#include "extractor/profile_plugin.hpp"
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
 #include "util/exception.hpp"
@@ -176,6 +177,7 @@ void EdgeBasedGraphFactory::FlushVectorToStream(
 
 void EdgeBasedGraphFactory::Run(const std::string &original_edge_data_filename,
                                 lua_State *lua_state,
+                                const ProfilePlugin *profile_plugin,
                                 const std::string &edge_segment_lookup_filename,
                                 const std::string &edge_penalty_filename,
                                 const bool generate_edge_lookup)
@@ -190,8 +192,9 @@ void EdgeBasedGraphFactory::Run(const std::string &original_edge_data_filename,
     TIMER_STOP(generate_nodes);
 
     TIMER_START(generate_edges);
-    GenerateEdgeExpandedEdges(original_edge_data_filename, lua_state, edge_segment_lookup_filename,
-                              edge_penalty_filename, generate_edge_lookup);
+    GenerateEdgeExpandedEdges(original_edge_data_filename, lua_state, profile_plugin,
+                              edge_segment_lookup_filename, edge_penalty_filename,
+                              generate_edge_lookup);
 
     TIMER_STOP(generate_edges);
 
@@ -287,14 +290,17 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedNodes()
 void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
     const std::string &original_edge_data_filename,
     lua_State *lua_state,
+    const ProfilePlugin *profile_plugin,
     const std::string &edge_segment_lookup_filename,
     const std::string &edge_fixed_penalties_filename,
     const bool generate_edge_lookup)
 {
     util::SimpleLogger().Write() << "generating edge-expanded edges";
 
-    BOOST_ASSERT(lua_state != nullptr);
-    const bool use_turn_function = util::luaFunctionExists(lua_state, "turn_function");
+    BOOST_ASSERT(lua_state != nullptr || profile_plugin != nullptr);
+    const bool use_turn_function = profile_plugin
+                                       ? profile_plugin->HasTurnFunction()
+                                       : util::luaFunctionExists(lua_state, "turn_function");
 
     std::size_t node_based_edge_counter = 0;
     std::size_t original_edges_counter = 0;
@@ -324,7 +330,8 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
     // Three nested loop look super-linear, but we are dealing with a (kind of)
     // linear number of turns only.
     util::Percent progress(m_node_based_graph->GetNumberOfNodes());
-    SuffixTable street_name_suffix_table(lua_state);
+    const SuffixTable street_name_suffix_table =
+        profile_plugin ? SuffixTable(profile_plugin->GetNameSuffixList()) : SuffixTable(lua_state);
     guidance::TurnAnalysis turn_analysis(*m_node_based_graph, m_node_info_list, *m_restriction_map,
                                          m_barrier_nodes, m_compressed_edge_container, name_table,
                                          street_name_suffix_table);
@@ -400,7 +407,7 @@ void EdgeBasedGraphFactory::GenerateEdgeExpandedEdges(
                 }
 
                 const int turn_penalty =
-                    use_turn_function ? GetTurnPenalty(turn_angle, lua_state) : 0;
+                    use_turn_function ? GetTurnPenalty(turn_angle, lua_state, profile_plugin) : 0;
                 const auto turn_instruction = turn.instruction;
 
                 if (guidance::isUturn(turn_instruction))
@@ -568,8 +575,18 @@ std::vector<util::guidance::EntryClass> EdgeBasedGraphFactory::GetEntryClasses()
     return result;
 }
 
-int EdgeBasedGraphFactory::GetTurnPenalty(double angle, lua_State *lua_state) const
+int EdgeBasedGraphFactory::GetTurnPenalty(double angle,
+                                          lua_State *lua_state,
+                                          const ProfilePlugin *profile_plugin) const
 {
+    if (profile_plugin)
+    {
+        const double penalty = profile_plugin->GetTurnPenalty(180. - angle);
+        BOOST_ASSERT(penalty < std::numeric_limits<int>::max());
+        BOOST_ASSERT(penalty > std::numeric_limits<int>::min());
+        return boost::numeric_cast<int>(penalty);
+    }
+
     BOOST_ASSERT(lua_state != nullptr);
     try
     {
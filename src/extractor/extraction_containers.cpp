@@ -18,9 +18,13 @@
 
 #include <luabind/luabind.hpp>
 
-#include <stxxl/sort>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 
 namespace
@@ -42,11 +46,51 @@ namespace extractor
 {
 
 static const int WRITE_BLOCK_BUFFER_SIZE = 8000;
+// Number of edges a block of the parallel passes over the edges has at least
+static const std::size_t EDGE_BLOCK_SIZE = 64 * 1024;
+
+namespace
+{
+// Returns the first node with an id that is not less than the given one, the merge join of a
+// block of edges starts there.
+template <typename NodeVector>
+typename NodeVector::const_iterator findFirstNode(const NodeVector &nodes, const OSMNodeID id)
+{
+    return std::lower_bound(nodes.cbegin(), nodes.cend(), id,
+                            [](const ExternalMemoryNode &node, const OSMNodeID value)
+                            {
+                                return node.node_id < value;
+                            });
+}
+
+// Runs a function on blocks of edges in parallel, like a merge join of the sorted edges with the
+// nodes. STXXL vectors do not support concurrent access, so they are always one block.
+template <typename EdgeVector, typename BlockFunction>
+void forEachEdgeBlock(const EdgeVector &edges, const bool parallel, const BlockFunction &function)
+{
+#ifndef ENABLE_STXXL
+    if (parallel)
+    {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, edges.size(), EDGE_BLOCK_SIZE),
+                          [&function](const tbb::blocked_range<std::size_t> &range)
+                          {
+                              function(range.begin(), range.end());
+                          });
+        return;
+    }
+#else
+    static_cast<void>(parallel);
+#endif
+    function(0, edges.size());
+}
+}
 
 ExtractionContainers::ExtractionContainers()
 {
+#ifdef ENABLE_STXXL
     // Check if stxxl can be instantiated
     stxxl::vector<unsigned> dummy_vector;
+#endif
     // Insert the empty string, it has no data and is zero length
     name_lengths.push_back(0);
 }
@@ -76,7 +120,8 @@ ExtractionContainers::~ExtractionContainers()
 void ExtractionContainers::PrepareData(const std::string &output_file_name,
                                        const std::string &restrictions_file_name,
                                        const std::string &name_file_name,
-                                       lua_State *segment_state)
+                                       lua_State *segment_state,
+                                       const ProfilePlugin *profile_plugin)
 {
     try
     {
@@ -87,7 +132,7 @@ void ExtractionContainers::PrepareData(const std::string &output_file_name,
 
         PrepareNodes();
         WriteNodes(file_out_stream);
-        PrepareEdges(segment_state);
+        PrepareEdges(segment_state, profile_plugin);
         WriteEdges(file_out_stream);
 
         PrepareRestrictions();
@@ -145,8 +190,8 @@ void ExtractionContainers::PrepareNodes()
 {
     std::cout << "[extractor] Sorting used nodes        ... " << std::flush;
     TIMER_START(sorting_used_nodes);
-    stxxl::sort(used_node_id_list.begin(), used_node_id_list.end(), OSMNodeIDSTXXLLess(),
-                stxxl_memory);
+    util::sortExternal(used_node_id_list.begin(), used_node_id_list.end(), OSMNodeIDSTXXLLess(),
+                       [](const OSMNodeID id) { return static_cast<std::uint64_t>(id); });
     TIMER_STOP(sorting_used_nodes);
     std::cout << "ok, after " << TIMER_SEC(sorting_used_nodes) << "s" << std::endl;
 
@@ -157,43 +202,80 @@ void ExtractionContainers::PrepareNodes()
     TIMER_STOP(erasing_dups);
     std::cout << "ok, after " << TIMER_SEC(erasing_dups) << "s" << std::endl;
 
-    std::cout << "[extractor] Sorting all nodes         ... " << std::flush;
-    TIMER_START(sorting_nodes);
-    stxxl::sort(all_nodes_list.begin(), all_nodes_list.end(), ExternalMemoryNodeSTXXLCompare(),
-                stxxl_memory);
-    TIMER_STOP(sorting_nodes);
-    std::cout << "ok, after " << TIMER_SEC(sorting_nodes) << "s" << std::endl;
-
-    std::cout << "[extractor] Building node id map      ... " << std::flush;
-    TIMER_START(id_map);
-    external_to_internal_node_id_map.reserve(used_node_id_list.size());
-    auto node_iter = all_nodes_list.begin();
-    auto ref_iter = used_node_id_list.begin();
-    const auto all_nodes_list_end = all_nodes_list.end();
-    const auto used_node_id_list_end = used_node_id_list.end();
     // Note: despite being able to handle 64 bit OSM node ids, we can't
     // handle > uint32_t actual usable nodes.  This should be OK for a while
     // because we usually route on a *lot* less than 2^32 of the OSM
     // graph nodes.
     std::size_t internal_id = 0;
 
-    // compute the intersection of nodes that were referenced and nodes we actually have
-    while (node_iter != all_nodes_list_end && ref_iter != used_node_id_list_end)
+    if (node_index)
     {
-        if (node_iter->node_id < *ref_iter)
-        {
-            node_iter++;
-            continue;
+        std::cout << "[extractor] Building node index       ... " << std::flush;
+        TIMER_START(build_node_index);
+        // Like the merge joins on the sorted nodes, an id that occurs more than once refers to its
+        // first node. Dense indexes keep the last position that was set for an id, so the nodes
+        // are added backwards. Sparse indexes return the smallest position anyway.
+        for (std::size_t position = all_nodes_list.size(); position > 0; --position)
+        {
+            node_index->set(static_cast<std::uint64_t>(all_nodes_list[position - 1].node_id),
+                            position);
         }
-        if (node_iter->node_id > *ref_iter)
+        node_index->sort();
+        TIMER_STOP(build_node_index);
+        std::cout << "ok, after " << TIMER_SEC(build_node_index) << "s" << std::endl;
+
+        std::cout << "[extractor] Building node id map      ... " << std::flush;
+        TIMER_START(id_map);
+        external_to_internal_node_id_map.reserve(used_node_id_list.size());
+        for (const auto node_id : used_node_id_list)
         {
+            if (FindNode(node_id))
+            {
+                external_to_internal_node_id_map[node_id] = static_cast<NodeID>(internal_id++);
+            }
+        }
+        TIMER_STOP(id_map);
+        std::cout << "ok, after " << TIMER_SEC(id_map) << "s" << std::endl;
+    }
+    else
+    {
+        std::cout << "[extractor] Sorting all nodes         ... " << std::flush;
+        TIMER_START(sorting_nodes);
+        util::sortExternal(all_nodes_list.begin(), all_nodes_list.end(),
+                           ExternalMemoryNodeSTXXLCompare(), [](const ExternalMemoryNode &node) {
+                               return static_cast<std::uint64_t>(node.node_id);
+                           });
+        TIMER_STOP(sorting_nodes);
+        std::cout << "ok, after " << TIMER_SEC(sorting_nodes) << "s" << std::endl;
+
+        std::cout << "[extractor] Building node id map      ... " << std::flush;
+        TIMER_START(id_map);
+        external_to_internal_node_id_map.reserve(used_node_id_list.size());
+        auto node_iter = all_nodes_list.begin();
+        auto ref_iter = used_node_id_list.begin();
+        const auto all_nodes_list_end = all_nodes_list.end();
+        const auto used_node_id_list_end = used_node_id_list.end();
+
+        // compute the intersection of nodes that were referenced and nodes we actually have
+        while (node_iter != all_nodes_list_end && ref_iter != used_node_id_list_end)
+        {
+            if (node_iter->node_id < *ref_iter)
+            {
+                node_iter++;
+                continue;
+            }
+            if (node_iter->node_id > *ref_iter)
+            {
+                ref_iter++;
+                continue;
+            }
+            BOOST_ASSERT(node_iter->node_id == *ref_iter);
+            external_to_internal_node_id_map[*ref_iter] = static_cast<NodeID>(internal_id++);
+            node_iter++;
             ref_iter++;
-            continue;
         }
-        BOOST_ASSERT(node_iter->node_id == *ref_iter);
-        external_to_internal_node_id_map[*ref_iter] = static_cast<NodeID>(internal_id++);
-        node_iter++;
-        ref_iter++;
+        TIMER_STOP(id_map);
+        std::cout << "ok, after " << TIMER_SEC(id_map) << "s" << std::endl;
     }
     if (internal_id > std::numeric_limits<NodeID>::max())
     {
@@ -201,135 +283,71 @@ void ExtractionContainers::PrepareNodes()
                               "supports 2^32 unique nodes");
     }
     max_internal_node_id = boost::numeric_cast<NodeID>(internal_id);
-    TIMER_STOP(id_map);
-    std::cout << "ok, after " << TIMER_SEC(id_map) << "s" << std::endl;
 }
 
-void ExtractionContainers::PrepareEdges(lua_State *segment_state)
+boost::optional<ExternalMemoryNode> ExtractionContainers::FindNode(const OSMNodeID node_id) const
 {
-    // Sort edges by start.
-    std::cout << "[extractor] Sorting edges by start    ... " << std::flush;
-    TIMER_START(sort_edges_by_start);
-    stxxl::sort(all_edges_list.begin(), all_edges_list.end(), CmpEdgeByOSMStartID(), stxxl_memory);
-    TIMER_STOP(sort_edges_by_start);
-    std::cout << "ok, after " << TIMER_SEC(sort_edges_by_start) << "s" << std::endl;
-
-    std::cout << "[extractor] Setting start coords      ... " << std::flush;
-    TIMER_START(set_start_coords);
-    // Traverse list of edges and nodes in parallel and set start coord
-    auto node_iterator = all_nodes_list.begin();
-    auto edge_iterator = all_edges_list.begin();
-
-    const auto all_edges_list_end = all_edges_list.end();
-    const auto all_nodes_list_end = all_nodes_list.end();
-
-    while (edge_iterator != all_edges_list_end && node_iterator != all_nodes_list_end)
+    BOOST_ASSERT(node_index);
+    std::size_t position = 0;
+    try
     {
-        if (edge_iterator->result.osm_source_id < node_iterator->node_id)
-        {
-            util::SimpleLogger().Write(LogLevel::logWARNING) << "Found invalid node reference "
-                                                             << edge_iterator->result.source;
-            edge_iterator->result.source = SPECIAL_NODEID;
-            ++edge_iterator;
-            continue;
-        }
-        if (edge_iterator->result.osm_source_id > node_iterator->node_id)
-        {
-            node_iterator++;
-            continue;
-        }
-
-        // remove loops
-        if (edge_iterator->result.osm_source_id == edge_iterator->result.osm_target_id)
-        {
-            edge_iterator->result.source = SPECIAL_NODEID;
-            edge_iterator->result.target = SPECIAL_NODEID;
-            ++edge_iterator;
-            continue;
-        }
-
-        BOOST_ASSERT(edge_iterator->result.osm_source_id == node_iterator->node_id);
-
-        // assign new node id
-        auto id_iter = external_to_internal_node_id_map.find(node_iterator->node_id);
-        BOOST_ASSERT(id_iter != external_to_internal_node_id_map.end());
-        edge_iterator->result.source = id_iter->second;
-
-        edge_iterator->source_coordinate.lat = node_iterator->lat;
-        edge_iterator->source_coordinate.lon = node_iterator->lon;
-        ++edge_iterator;
+        position = node_index->get(static_cast<std::uint64_t>(node_id));
     }
-
-    // Remove all remaining edges. They are invalid because there are no corresponding nodes for
-    // them. This happens when using osmosis with bbox or polygon to extract smaller areas.
-    auto markSourcesInvalid = [](InternalExtractorEdge &edge)
+    catch (const osmium::not_found &)
     {
-        util::SimpleLogger().Write(LogLevel::logWARNING) << "Found invalid node reference "
-                                                         << edge.result.source;
-        edge.result.source = SPECIAL_NODEID;
-        edge.result.osm_source_id = SPECIAL_OSM_NODEID;
-    };
-    std::for_each(edge_iterator, all_edges_list_end, markSourcesInvalid);
-    TIMER_STOP(set_start_coords);
-    std::cout << "ok, after " << TIMER_SEC(set_start_coords) << "s" << std::endl;
-
-    // Sort Edges by target
-    std::cout << "[extractor] Sorting edges by target   ... " << std::flush;
-    TIMER_START(sort_edges_by_target);
-    stxxl::sort(all_edges_list.begin(), all_edges_list.end(), CmpEdgeByOSMTargetID(), stxxl_memory);
-    TIMER_STOP(sort_edges_by_target);
-    std::cout << "ok, after " << TIMER_SEC(sort_edges_by_target) << "s" << std::endl;
-
-    // Compute edge weights
-    std::cout << "[extractor] Computing edge weights    ... " << std::flush;
-    TIMER_START(compute_weights);
-    node_iterator = all_nodes_list.begin();
-    edge_iterator = all_edges_list.begin();
-    const auto all_edges_list_end_ = all_edges_list.end();
-    const auto all_nodes_list_end_ = all_nodes_list.end();
-
-    const auto has_segment_function = util::luaFunctionExists(segment_state, "segment_function");
-
-    while (edge_iterator != all_edges_list_end_ && node_iterator != all_nodes_list_end_)
+    }
+    if (position == 0)
     {
-        // skip all invalid edges
-        if (edge_iterator->result.source == SPECIAL_NODEID)
-        {
-            ++edge_iterator;
-            continue;
-        }
+        return boost::none;
+    }
+    return all_nodes_list[position - 1];
+}
 
-        if (edge_iterator->result.osm_target_id < node_iterator->node_id)
-        {
-            util::SimpleLogger().Write(LogLevel::logWARNING)
-                << "Found invalid node reference "
-                << static_cast<uint64_t>(edge_iterator->result.osm_target_id);
-            edge_iterator->result.target = SPECIAL_NODEID;
-            ++edge_iterator;
-            continue;
-        }
-        if (edge_iterator->result.osm_target_id > node_iterator->node_id)
-        {
-            ++node_iterator;
-            continue;
-        }
+void ExtractionContainers::PrepareEdges(lua_State *segment_state,
+                                        const ProfilePlugin *profile_plugin)
+{
+    const auto has_segment_function =
+        profile_plugin ? profile_plugin->HasSegmentFunction()
+                       : util::luaFunctionExists(segment_state, "segment_function");
+    // plugins can compute the segment weights concurrently
+    const auto parallel_weights = !has_segment_function || profile_plugin != nullptr;
+
+    // assign new node id and start coord
+    const auto setSource = [this](InternalExtractorEdge &edge, const ExternalMemoryNode &node)
+    {
+        BOOST_ASSERT(edge.result.osm_source_id == node.node_id);
+        auto id_iter = external_to_internal_node_id_map.find(node.node_id);
+        BOOST_ASSERT(id_iter != external_to_internal_node_id_map.end());
+        edge.result.source = id_iter->second;
+
+        edge.source_coordinate.lat = node.lat;
+        edge.source_coordinate.lon = node.lon;
+    };
 
-        BOOST_ASSERT(edge_iterator->result.osm_target_id == node_iterator->node_id);
-        BOOST_ASSERT(edge_iterator->weight_data.speed >= 0);
-        BOOST_ASSERT(edge_iterator->source_coordinate.lat !=
+    // compute the edge weight and assign new node id of the target
+    const auto setTarget = [&](InternalExtractorEdge &internal_edge, const ExternalMemoryNode &node)
+    {
+        BOOST_ASSERT(internal_edge.result.osm_target_id == node.node_id);
+        BOOST_ASSERT(internal_edge.weight_data.speed >= 0);
+        BOOST_ASSERT(internal_edge.source_coordinate.lat !=
                      util::FixedLatitude(std::numeric_limits<int>::min()));
-        BOOST_ASSERT(edge_iterator->source_coordinate.lon !=
+        BOOST_ASSERT(internal_edge.source_coordinate.lon !=
                      util::FixedLongitude(std::numeric_limits<int>::min()));
 
         const double distance = util::coordinate_calculation::greatCircleDistance(
-            edge_iterator->source_coordinate,
-            util::Coordinate(node_iterator->lon, node_iterator->lat));
+            internal_edge.source_coordinate, util::Coordinate(node.lon, node.lat));
 
-        if (has_segment_function)
+        if (has_segment_function && profile_plugin)
+        {
+            profile_plugin->ProcessSegment(internal_edge.source_coordinate,
+                                           util::Coordinate(node.lon, node.lat), distance,
+                                           internal_edge.weight_data);
+        }
+        else if (has_segment_function)
         {
             luabind::call_function<void>(
-                segment_state, "segment_function", boost::cref(edge_iterator->source_coordinate),
-                boost::cref(*node_iterator), distance, boost::ref(edge_iterator->weight_data));
+                segment_state, "segment_function", boost::cref(internal_edge.source_coordinate),
+                boost::cref(node), distance, boost::ref(internal_edge.weight_data));
         }
 
         const double weight = [distance](const InternalExtractorEdge::WeightData &data)
@@ -347,13 +365,12 @@ void ExtractionContainers::PrepareEdges(lua_State *segment_state)
                 util::exception("invalid weight type");
             }
             return -1.0;
-        }(edge_iterator->weight_data);
+        }(internal_edge.weight_data);
 
-        auto &edge = edge_iterator->result;
+        auto &edge = internal_edge.result;
         edge.weight = std::max(1, static_cast<int>(std::floor(weight + .5)));
 
-        // assign new node id
-        auto id_iter = external_to_internal_node_id_map.find(node_iterator->node_id);
+        auto id_iter = external_to_internal_node_id_map.find(node.node_id);
         BOOST_ASSERT(id_iter != external_to_internal_node_id_map.end());
         edge.target = id_iter->second;
 
@@ -368,26 +385,195 @@ void ExtractionContainers::PrepareEdges(lua_State *segment_state)
             edge.forward = edge.backward;
             edge.backward = temp;
         }
-        ++edge_iterator;
-    }
+    };
 
-    // Remove all remaining edges. They are invalid because there are no corresponding nodes for
-    // them. This happens when using osmosis with bbox or polygon to extract smaller areas.
-    auto markTargetsInvalid = [](InternalExtractorEdge &edge)
+    if (node_index)
     {
-        util::SimpleLogger().Write(LogLevel::logWARNING) << "Found invalid node reference "
-                                                         << edge.result.target;
-        edge.result.target = SPECIAL_NODEID;
-    };
-    std::for_each(edge_iterator, all_edges_list_end_, markTargetsInvalid);
-    TIMER_STOP(compute_weights);
-    std::cout << "ok, after " << TIMER_SEC(compute_weights) << "s" << std::endl;
+        // Edges can be processed in any order, no need to sort them by start and target
+        std::cout << "[extractor] Computing edge weights    ... " << std::flush;
+        TIMER_START(compute_weights);
+        const auto lookUpNodes = [&](const std::size_t begin_index, const std::size_t end_index)
+        {
+            const auto edge_end = all_edges_list.begin() + end_index;
+            for (auto edge_iterator = all_edges_list.begin() + begin_index;
+                 edge_iterator != edge_end; ++edge_iterator)
+            {
+                auto &edge = *edge_iterator;
+                const auto source = FindNode(edge.result.osm_source_id);
+                if (!source)
+                {
+                    util::SimpleLogger().Write(LogLevel::logWARNING)
+                        << "Found invalid node reference "
+                        << static_cast<uint64_t>(edge.result.osm_source_id);
+                    edge.result.source = SPECIAL_NODEID;
+                    continue;
+                }
+
+                // remove loops
+                if (edge.result.osm_source_id == edge.result.osm_target_id)
+                {
+                    edge.result.source = SPECIAL_NODEID;
+                    edge.result.target = SPECIAL_NODEID;
+                    continue;
+                }
+                setSource(edge, *source);
+
+                const auto target = FindNode(edge.result.osm_target_id);
+                if (!target)
+                {
+                    util::SimpleLogger().Write(LogLevel::logWARNING)
+                        << "Found invalid node reference "
+                        << static_cast<uint64_t>(edge.result.osm_target_id);
+                    edge.result.target = SPECIAL_NODEID;
+                    continue;
+                }
+                setTarget(edge, *target);
+            }
+        };
+        // A lua segment function shares one lua state, so it needs a single block
+        forEachEdgeBlock(all_edges_list, parallel_weights, lookUpNodes);
+        TIMER_STOP(compute_weights);
+        std::cout << "ok, after " << TIMER_SEC(compute_weights) << "s" << std::endl;
+    }
+    else
+    {
+        // Sort edges by start.
+        std::cout << "[extractor] Sorting edges by start    ... " << std::flush;
+        TIMER_START(sort_edges_by_start);
+        util::sortExternal(all_edges_list.begin(), all_edges_list.end(), CmpEdgeByOSMStartID());
+        TIMER_STOP(sort_edges_by_start);
+        std::cout << "ok, after " << TIMER_SEC(sort_edges_by_start) << "s" << std::endl;
+
+        std::cout << "[extractor] Setting start coords      ... " << std::flush;
+        TIMER_START(set_start_coords);
+        // Remove all remaining edges. They are invalid because there are no corresponding nodes
+        // for them. This happens when using osmosis with bbox or polygon to extract smaller areas.
+        auto markSourcesInvalid = [](InternalExtractorEdge &edge)
+        {
+            util::SimpleLogger().Write(LogLevel::logWARNING) << "Found invalid node reference "
+                                                             << edge.result.source;
+            edge.result.source = SPECIAL_NODEID;
+            edge.result.osm_source_id = SPECIAL_OSM_NODEID;
+        };
+        // Traverse list of edges and nodes in parallel and set start coord
+        const auto setStartCoordinates = [&](const std::size_t begin_index,
+                                             const std::size_t end_index)
+        {
+            auto edge_iterator = all_edges_list.begin() + begin_index;
+            const auto edge_end = all_edges_list.begin() + end_index;
+            if (edge_iterator == edge_end)
+            {
+                return;
+            }
+            auto node_iterator =
+                findFirstNode(all_nodes_list, edge_iterator->result.osm_source_id);
+            const auto all_nodes_list_end = all_nodes_list.cend();
+
+            while (edge_iterator != edge_end && node_iterator != all_nodes_list_end)
+            {
+                if (edge_iterator->result.osm_source_id < node_iterator->node_id)
+                {
+                    util::SimpleLogger().Write(LogLevel::logWARNING)
+                        << "Found invalid node reference " << edge_iterator->result.source;
+                    edge_iterator->result.source = SPECIAL_NODEID;
+                    ++edge_iterator;
+                    continue;
+                }
+                if (edge_iterator->result.osm_source_id > node_iterator->node_id)
+                {
+                    node_iterator++;
+                    continue;
+                }
+
+                // remove loops
+                if (edge_iterator->result.osm_source_id == edge_iterator->result.osm_target_id)
+                {
+                    edge_iterator->result.source = SPECIAL_NODEID;
+                    edge_iterator->result.target = SPECIAL_NODEID;
+                    ++edge_iterator;
+                    continue;
+                }
+
+                setSource(*edge_iterator, *node_iterator);
+                ++edge_iterator;
+            }
+            std::for_each(edge_iterator, edge_end, markSourcesInvalid);
+        };
+        forEachEdgeBlock(all_edges_list, true, setStartCoordinates);
+        TIMER_STOP(set_start_coords);
+        std::cout << "ok, after " << TIMER_SEC(set_start_coords) << "s" << std::endl;
+
+        // Sort Edges by target
+        std::cout << "[extractor] Sorting edges by target   ... " << std::flush;
+        TIMER_START(sort_edges_by_target);
+        util::sortExternal(all_edges_list.begin(), all_edges_list.end(), CmpEdgeByOSMTargetID());
+        TIMER_STOP(sort_edges_by_target);
+        std::cout << "ok, after " << TIMER_SEC(sort_edges_by_target) << "s" << std::endl;
+
+        // Compute edge weights
+        std::cout << "[extractor] Computing edge weights    ... " << std::flush;
+        TIMER_START(compute_weights);
+        // Remove all remaining edges. They are invalid because there are no corresponding nodes
+        // for them. This happens when using osmosis with bbox or polygon to extract smaller areas.
+        auto markTargetsInvalid = [](InternalExtractorEdge &edge)
+        {
+            util::SimpleLogger().Write(LogLevel::logWARNING) << "Found invalid node reference "
+                                                             << edge.result.target;
+            edge.result.target = SPECIAL_NODEID;
+        };
+        const auto computeWeights = [&](const std::size_t begin_index,
+                                        const std::size_t end_index)
+        {
+            auto edge_iterator = all_edges_list.begin() + begin_index;
+            const auto edge_end = all_edges_list.begin() + end_index;
+            if (edge_iterator == edge_end)
+            {
+                return;
+            }
+            auto node_iterator =
+                findFirstNode(all_nodes_list, edge_iterator->result.osm_target_id);
+            const auto all_nodes_list_end = all_nodes_list.cend();
+
+            while (edge_iterator != edge_end && node_iterator != all_nodes_list_end)
+            {
+                // skip all invalid edges
+                if (edge_iterator->result.source == SPECIAL_NODEID)
+                {
+                    ++edge_iterator;
+                    continue;
+                }
+
+                if (edge_iterator->result.osm_target_id < node_iterator->node_id)
+                {
+                    util::SimpleLogger().Write(LogLevel::logWARNING)
+                        << "Found invalid node reference "
+                        << static_cast<uint64_t>(edge_iterator->result.osm_target_id);
+                    edge_iterator->result.target = SPECIAL_NODEID;
+                    ++edge_iterator;
+                    continue;
+                }
+                if (edge_iterator->result.osm_target_id > node_iterator->node_id)
+                {
+                    ++node_iterator;
+                    continue;
+                }
+
+                setTarget(*edge_iterator, *node_iterator);
+                ++edge_iterator;
+            }
+            std::for_each(edge_iterator, edge_end, markTargetsInvalid);
+        };
+        // A lua segment function shares one lua state, so it needs a single merge
+        forEachEdgeBlock(all_edges_list, parallel_weights, computeWeights);
+        TIMER_STOP(compute_weights);
+        std::cout << "ok, after " << TIMER_SEC(compute_weights) << "s" << std::endl;
+    }
 
     // Sort edges by start.
     std::cout << "[extractor] Sorting edges by renumbered start ... " << std::flush;
     TIMER_START(sort_edges_by_renumbered_start);
-    stxxl::sort(all_edges_list.begin(), all_edges_list.end(),
-                CmpEdgeByInternalStartThenInternalTargetID(), stxxl_memory);
+    util::sortExternal(all_edges_list.begin(), all_edges_list.end(),
+                       CmpEdgeByInternalStartThenInternalTargetID());
     TIMER_STOP(sort_edges_by_renumbered_start);
     std::cout << "ok, after " << TIMER_SEC(sort_edges_by_renumbered_start) << "s" << std::endl;
 
@@ -532,30 +718,44 @@ void ExtractionContainers::WriteNodes(std::ofstream &file_out_stream) const
 
     std::cout << "[extractor] Confirming/Writing used nodes     ... " << std::flush;
     TIMER_START(write_nodes);
-    // identify all used nodes by a merging step of two sorted lists
-    auto node_iterator = all_nodes_list.begin();
-    auto node_id_iterator = used_node_id_list.begin();
-    const auto used_node_id_list_end = used_node_id_list.end();
-    const auto all_nodes_list_end = all_nodes_list.end();
-
-    while (node_id_iterator != used_node_id_list_end && node_iterator != all_nodes_list_end)
+    if (node_index)
     {
-        if (*node_id_iterator < node_iterator->node_id)
+        for (const auto node_id : used_node_id_list)
         {
-            ++node_id_iterator;
-            continue;
+            const auto node = FindNode(node_id);
+            if (node)
+            {
+                file_out_stream.write((char *)&(*node), sizeof(ExternalMemoryNode));
+            }
         }
-        if (*node_id_iterator > node_iterator->node_id)
+    }
+    else
+    {
+        // identify all used nodes by a merging step of two sorted lists
+        auto node_iterator = all_nodes_list.begin();
+        auto node_id_iterator = used_node_id_list.begin();
+        const auto used_node_id_list_end = used_node_id_list.end();
+        const auto all_nodes_list_end = all_nodes_list.end();
+
+        while (node_id_iterator != used_node_id_list_end && node_iterator != all_nodes_list_end)
         {
-            ++node_iterator;
-            continue;
-        }
-        BOOST_ASSERT(*node_id_iterator == node_iterator->node_id);
+            if (*node_id_iterator < node_iterator->node_id)
+            {
+                ++node_id_iterator;
+                continue;
+            }
+            if (*node_id_iterator > node_iterator->node_id)
+            {
+                ++node_iterator;
+                continue;
+            }
+            BOOST_ASSERT(*node_id_iterator == node_iterator->node_id);
 
-        file_out_stream.write((char *)&(*node_iterator), sizeof(ExternalMemoryNode));
+            file_out_stream.write((char *)&(*node_iterator), sizeof(ExternalMemoryNode));
 
-        ++node_id_iterator;
-        ++node_iterator;
+            ++node_id_iterator;
+            ++node_iterator;
+        }
     }
     TIMER_STOP(write_nodes);
     std::cout << "ok, after " << TIMER_SEC(write_nodes) << "s" << std::endl;
@@ -594,16 +794,16 @@ void ExtractionContainers::PrepareRestrictions()
 {
     std::cout << "[extractor] Sorting used ways         ... " << std::flush;
     TIMER_START(sort_ways);
-    stxxl::sort(way_start_end_id_list.begin(), way_start_end_id_list.end(),
-                FirstAndLastSegmentOfWayStxxlCompare(), stxxl_memory);
+    util::sortExternal(way_start_end_id_list.begin(), way_start_end_id_list.end(),
+                       FirstAndLastSegmentOfWayStxxlCompare());
     TIMER_STOP(sort_ways);
     std::cout << "ok, after " << TIMER_SEC(sort_ways) << "s" << std::endl;
 
     std::cout << "[extractor] Sorting " << restrictions_list.size() << " restriction. by from... "
               << std::flush;
     TIMER_START(sort_restrictions);
-    stxxl::sort(restrictions_list.begin(), restrictions_list.end(), CmpRestrictionContainerByFrom(),
-                stxxl_memory);
+    util::sortExternal(restrictions_list.begin(), restrictions_list.end(),
+                       CmpRestrictionContainerByFrom());
     TIMER_STOP(sort_restrictions);
     std::cout << "ok, after " << TIMER_SEC(sort_restrictions) << "s" << std::endl;
 
@@ -694,8 +894,8 @@ void ExtractionContainers::PrepareRestrictions()
 
     std::cout << "[extractor] Sorting restrictions. by to  ... " << std::flush;
     TIMER_START(sort_restrictions_to);
-    stxxl::sort(restrictions_list.begin(), restrictions_list.end(), CmpRestrictionContainerByTo(),
-                stxxl_memory);
+    util::sortExternal(restrictions_list.begin(), restrictions_list.end(),
+                       CmpRestrictionContainerByTo());
     TIMER_STOP(sort_restrictions_to);
     std::cout << "ok, after " << TIMER_SEC(sort_restrictions_to) << "s" << std::endl;
 
@@ -0,0 +1,330 @@
+#include "extractor/extraction_state.hpp"
+#include "extractor/external_memory_node.hpp"
+#include "extractor/extractor_callbacks.hpp"
+#include "extractor/profile_plugin_library.hpp"
+
+#include "util/exception.hpp"
+#include "util/fingerprint.hpp"
+
+#include <boost/crc.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <osmium/osm.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+namespace
+{
+enum class StateRecord : std::uint8_t
+{
+    node,
+    way,
+    restriction
+};
+
+template <typename T> void writeValue(boost::filesystem::ofstream &stream, const T &value)
+{
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> bool readValue(boost::filesystem::ifstream &stream, T &value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+void processFile(boost::crc_32_type &crc, const boost::filesystem::path &path)
+{
+    boost::filesystem::ifstream profile_stream(path, std::ios::binary);
+    if (!profile_stream)
+    {
+        throw util::exception("Could not open profile " + path.string() + " for reading.");
+    }
+    char buffer[64 * 1024];
+    while (profile_stream.read(buffer, sizeof(buffer)) || profile_stream.gcount() > 0)
+    {
+        crc.process_bytes(buffer, profile_stream.gcount());
+    }
+}
+
+// The profile results in the state are only valid for the profile that computed them. A lua
+// profile can require() every script in its folder and the subfolders (see
+// luaAddScriptFolderToLoadPath), so all of them are checksummed with their relative paths.
+std::uint32_t profileChecksum(const std::string &profile_path)
+{
+    boost::crc_32_type crc;
+    processFile(crc, profile_path);
+    if (ProfilePluginLibrary::IsPluginPath(profile_path))
+    {
+        return crc.checksum();
+    }
+
+    const auto profile = boost::filesystem::canonical(profile_path);
+    const auto folder = profile.parent_path().generic_string();
+    std::vector<std::string> modules;
+    for (boost::filesystem::recursive_directory_iterator entry(profile.parent_path()), end;
+         entry != end; ++entry)
+    {
+        if (entry->path().extension() == ".lua" && entry->path() != profile &&
+            boost::filesystem::is_regular_file(entry->status()))
+        {
+            modules.push_back(entry->path().generic_string().substr(folder.size()));
+        }
+    }
+    // the order of directory iteration is unspecified
+    std::sort(modules.begin(), modules.end());
+    for (const auto &module : modules)
+    {
+        crc.process_bytes(module.data(), module.size());
+        processFile(crc, folder + module);
+    }
+    return crc.checksum();
+}
+}
+
+ExtractionStateWriter::ExtractionStateWriter(const std::string &path,
+                                             const std::string &profile_path)
+    : state_stream(path, std::ios::binary)
+{
+    if (!state_stream)
+    {
+        throw util::exception("Could not open " + path + " for writing.");
+    }
+    writeValue(state_stream, util::FingerPrint::GetValid());
+    writeValue(state_stream, profileChecksum(profile_path));
+}
+
+void ExtractionStateWriter::WriteNode(const ExternalMemoryNode &node)
+{
+    writeValue(state_stream, StateRecord::node);
+    writeValue(state_stream, node);
+}
+
+void ExtractionStateWriter::WriteWay(const OSMWayID way_id,
+                                     const std::vector<OSMNodeID> &node_ids,
+                                     const guidance::RoadClassificationData &road_classification,
+                                     const ExtractionWay &parsed_way)
+{
+    writeValue(state_stream, StateRecord::way);
+    writeValue(state_stream, way_id);
+    writeValue(state_stream, road_classification);
+    writeValue(state_stream, parsed_way.forward_speed);
+    writeValue(state_stream, parsed_way.backward_speed);
+    writeValue(state_stream, parsed_way.duration);
+    writeValue(state_stream, static_cast<std::uint8_t>(parsed_way.roundabout));
+    writeValue(state_stream, static_cast<std::uint8_t>(parsed_way.is_access_restricted));
+    writeValue(state_stream, static_cast<std::uint8_t>(parsed_way.is_startpoint));
+    writeValue(state_stream, static_cast<std::uint8_t>(parsed_way.forward_travel_mode));
+    writeValue(state_stream, static_cast<std::uint8_t>(parsed_way.backward_travel_mode));
+
+    const std::uint32_t name_length = parsed_way.name.size();
+    writeValue(state_stream, name_length);
+    state_stream.write(parsed_way.name.data(), name_length);
+
+    const std::uint32_t number_of_nodes = node_ids.size();
+    writeValue(state_stream, number_of_nodes);
+    state_stream.write(reinterpret_cast<const char *>(node_ids.data()),
+                       sizeof(OSMNodeID) * number_of_nodes);
+}
+
+void ExtractionStateWriter::WriteRestriction(const std::uint64_t relation_id,
+                                             const InputRestrictionContainer &restriction)
+{
+    writeValue(state_stream, StateRecord::restriction);
+    writeValue(state_stream, relation_id);
+    writeValue(state_stream, restriction);
+}
+
+ExtractionChanges::ExtractionChanges()
+    : buffer(1024 * 1024, osmium::memory::Buffer::auto_grow::yes)
+{
+}
+
+void ExtractionChanges::AddNode(const osmium::Node &node, const ExtractionNode &result_node)
+{
+    auto &change = nodes[OSMNodeID(node.id())];
+    change.offset = DELETED;
+    change.result = result_node;
+    if (node.visible())
+    {
+        buffer.add_item(node);
+        change.offset = buffer.commit();
+    }
+}
+
+void ExtractionChanges::AddWay(const osmium::Way &way, const ExtractionWay &result_way)
+{
+    auto &change = ways[OSMWayID(way.id())];
+    change.offset = DELETED;
+    change.result = result_way;
+    if (way.visible())
+    {
+        buffer.add_item(way);
+        change.offset = buffer.commit();
+    }
+}
+
+void ExtractionChanges::AddRelation(const osmium::Relation &relation,
+                                    const boost::optional<InputRestrictionContainer> &restriction)
+{
+    // a relation that is no restriction (anymore) removes the old version just like a deletion
+    restrictions[static_cast<std::uint64_t>(relation.id())] =
+        relation.visible() ? restriction : boost::none;
+}
+
+void ExtractionChanges::Apply(const std::string &state_path,
+                              const std::string &profile_path,
+                              ExtractorCallbacks &callbacks) const
+{
+    boost::filesystem::ifstream state_stream(state_path, std::ios::binary);
+    if (!state_stream)
+    {
+        throw util::exception("Could not open " + state_path + " for reading.");
+    }
+
+    util::FingerPrint fingerprint;
+    std::uint32_t profile_checksum;
+    if (!readValue(state_stream, fingerprint) || !readValue(state_stream, profile_checksum))
+    {
+        throw util::exception("Unexpected end of " + state_path);
+    }
+    const auto valid_fingerprint = util::FingerPrint::GetValid();
+    if (!valid_fingerprint.IsMagicNumberOK(fingerprint) ||
+        fingerprint.GetFingerPrint() != valid_fingerprint.GetFingerPrint())
+    {
+        throw util::exception(state_path + " was written by another version of osrm-extract. "
+                                           "Run osrm-extract --keep-state on the input file again.");
+    }
+    if (profile_checksum != profileChecksum(profile_path))
+    {
+        throw util::exception(state_path + " was written with another profile than " +
+                              profile_path + " or other scripts next to it. Use the same " +
+                              "profile or run osrm-extract --keep-state again.");
+    }
+
+    // The changed objects are passed in between the objects of the state by their ids, so the
+    // callbacks see them in the same order as in an input file that already contains them.
+    auto next_node = nodes.begin();
+    auto next_way = ways.begin();
+    auto next_restriction = restrictions.begin();
+    const auto add_nodes_up_to = [&](const OSMNodeID node_id) {
+        for (; next_node != nodes.end() && next_node->first <= node_id; ++next_node)
+        {
+            if (next_node->second.offset != DELETED)
+            {
+                callbacks.ProcessNode(buffer.get<const osmium::Node>(next_node->second.offset),
+                                      next_node->second.result);
+            }
+        }
+    };
+    const auto add_ways_up_to = [&](const OSMWayID way_id) {
+        for (; next_way != ways.end() && next_way->first <= way_id; ++next_way)
+        {
+            if (next_way->second.offset != DELETED)
+            {
+                callbacks.ProcessWay(buffer.get<const osmium::Way>(next_way->second.offset),
+                                     next_way->second.result);
+            }
+        }
+    };
+    const auto add_restrictions_up_to = [&](const std::uint64_t relation_id) {
+        for (; next_restriction != restrictions.end() && next_restriction->first <= relation_id;
+             ++next_restriction)
+        {
+            callbacks.ProcessRestriction(next_restriction->first, next_restriction->second);
+        }
+    };
+    const auto max_relation_id = std::numeric_limits<std::uint64_t>::max();
+
+    ExternalMemoryNode node;
+    OSMWayID way_id;
+    std::vector<OSMNodeID> node_ids;
+    guidance::RoadClassificationData road_classification;
+    ExtractionWay parsed_way;
+    std::uint64_t relation_id;
+    InputRestrictionContainer restriction;
+
+    StateRecord record;
+    while (readValue(state_stream, record))
+    {
+        switch (record)
+        {
+        case StateRecord::node:
+            readValue(state_stream, node);
+            add_nodes_up_to(node.node_id);
+            if (nodes.count(node.node_id) == 0)
+            {
+                callbacks.ProcessNode(node);
+            }
+            break;
+        case StateRecord::way:
+        {
+            std::uint8_t roundabout, is_access_restricted, is_startpoint;
+            std::uint8_t forward_travel_mode, backward_travel_mode;
+            std::uint32_t name_length, number_of_nodes;
+
+            readValue(state_stream, way_id);
+            readValue(state_stream, road_classification);
+            readValue(state_stream, parsed_way.forward_speed);
+            readValue(state_stream, parsed_way.backward_speed);
+            readValue(state_stream, parsed_way.duration);
+            readValue(state_stream, roundabout);
+            readValue(state_stream, is_access_restricted);
+            readValue(state_stream, is_startpoint);
+            readValue(state_stream, forward_travel_mode);
+            readValue(state_stream, backward_travel_mode);
+            parsed_way.roundabout = roundabout;
+            parsed_way.is_access_restricted = is_access_restricted;
+            parsed_way.is_startpoint = is_startpoint;
+            parsed_way.forward_travel_mode = forward_travel_mode;
+            parsed_way.backward_travel_mode = backward_travel_mode;
+
+            readValue(state_stream, name_length);
+            parsed_way.name.resize(name_length);
+            state_stream.read(&parsed_way.name[0], name_length);
+
+            readValue(state_stream, number_of_nodes);
+            node_ids.resize(number_of_nodes);
+            state_stream.read(reinterpret_cast<char *>(node_ids.data()),
+                              sizeof(OSMNodeID) * number_of_nodes);
+
+            add_nodes_up_to(MAX_OSM_NODEID);
+            add_ways_up_to(way_id);
+            if (ways.count(way_id) == 0)
+            {
+                callbacks.ProcessWay(way_id, node_ids, road_classification, parsed_way);
+            }
+            break;
+        }
+        case StateRecord::restriction:
+            readValue(state_stream, relation_id);
+            readValue(state_stream, restriction);
+            add_nodes_up_to(MAX_OSM_NODEID);
+            add_ways_up_to(MAX_OSM_WAYID);
+            add_restrictions_up_to(relation_id);
+            if (restrictions.count(relation_id) == 0)
+            {
+                callbacks.ProcessRestriction(relation_id, restriction);
+            }
+            break;
+        default:
+            throw util::exception(state_path + " is corrupted");
+        }
+        if (!state_stream)
+        {
+            throw util::exception("Unexpected end of " + state_path);
+        }
+    }
+
+    add_nodes_up_to(MAX_OSM_NODEID);
+    add_ways_up_to(MAX_OSM_WAYID);
+    add_restrictions_up_to(max_relation_id);
+}
+}
+}
@@ -3,13 +3,17 @@
 #include "extractor/edge_based_edge.hpp"
 #include "extractor/extraction_containers.hpp"
 #include "extractor/extraction_node.hpp"
+#include "extractor/extraction_state.hpp"
 #include "extractor/extraction_way.hpp"
 #include "extractor/extractor_callbacks.hpp"
+#include "extractor/profile_plugin_library.hpp"
+#include "extractor/profile_tag_filter.hpp"
 #include "extractor/restriction_parser.hpp"
 #include "extractor/scripting_environment.hpp"
 
 #include "extractor/raster_source.hpp"
 #include "util/graph_loader.hpp"
+#include "util/integer_range.hpp"
 #include "util/io.hpp"
 #include "util/lua_util.hpp"
 #include "util/make_unique.hpp"
@@ -33,7 +37,9 @@
 
 #include <osmium/io/any_input.hpp>
 
+#include <tbb/concurrent_queue.h>
 #include <tbb/parallel_for.h>
+#include <tbb/pipeline.h>
 #include <tbb/task_scheduler_init.h>
 
 #include <cstdlib>
@@ -42,9 +48,10 @@
 #include <atomic>
 #include <bitset>
 #include <chrono>
-#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -55,6 +62,45 @@ namespace osrm
 namespace extractor
 {
 
+namespace
+{
+// A buffer of OSM objects and the profile results of its objects, in flight in the pipeline.
+// The objects are reused for later buffers, so the result entries keep the memory of their
+// strings and the profile writes into them directly.
+struct ParsedBuffer
+{
+    void Reset(osmium::memory::Buffer new_buffer)
+    {
+        buffer = std::move(new_buffer);
+
+        // create a vector of iterators into the buffer
+        osm_elements.clear();
+        for (auto iter = buffer.cbegin(), end = buffer.cend(); iter != end; ++iter)
+        {
+            osm_elements.push_back(iter);
+        }
+
+        // never shrink, so no result entry is freed
+        if (result_nodes.size() < osm_elements.size())
+        {
+            result_nodes.resize(osm_elements.size());
+            result_ways.resize(osm_elements.size());
+            result_restrictions.resize(osm_elements.size());
+            name_ids.resize(osm_elements.size());
+        }
+    }
+
+    osmium::memory::Buffer buffer;
+    std::vector<osmium::memory::Buffer::const_iterator> osm_elements;
+    // profile results, indexed like osm_elements
+    std::vector<ExtractionNode> result_nodes;
+    std::vector<ExtractionWay> result_ways;
+    std::vector<boost::optional<InputRestrictionContainer>> result_restrictions;
+    // ids of way names that were known when the profile ran, or INVALID_NAMEID
+    std::vector<unsigned> name_ids;
+};
+}
+
 /**
  * TODO: Refactor this function into smaller functions for better readability.
  *
@@ -72,12 +118,20 @@ namespace extractor
  *  .osrm  : Nodes and edges in a intermediate format that easy to digest for osrm-contract
  *  .restrictions : Turn restrictions that are used by osrm-contract to construct the edge-expanded
  * graph
+ *  .state : With --keep-state, all nodes and the routable ways and restrictions. With
+ * --apply-changes the objects of the change files replace the ones in this file instead of
+ * reading the input file.
  *
  */
 int Extractor::run()
 {
-    // setup scripting environment
-    ScriptingEnvironment scripting_environment(config.profile_path.string().c_str());
+    // Profiles that are shared libraries are loaded as plugins, all others are lua scripts
+    std::unique_ptr<ProfilePluginLibrary> profile_plugin_library;
+    std::unique_ptr<ScriptingEnvironment> scripting_environment;
+    const ProfilePlugin *profile_plugin = nullptr;
+    // the lua state for the profile functions that are not called per object
+    lua_State *main_state = nullptr;
+    ProfileProperties profile_properties;
 
     try
     {
@@ -90,15 +144,33 @@ int Extractor::run()
         tbb::task_scheduler_init init(number_of_threads);
 
         util::SimpleLogger().Write() << "Input file: " << config.input_path.filename().string();
+        for (const auto &change_path : config.change_paths)
+        {
+            util::SimpleLogger().Write() << "Change file: " << change_path.filename().string();
+        }
         util::SimpleLogger().Write() << "Profile: " << config.profile_path.filename().string();
         util::SimpleLogger().Write() << "Threads: " << number_of_threads;
 
         ExtractionContainers extraction_containers;
-        auto extractor_callbacks = util::make_unique<ExtractorCallbacks>(extraction_containers);
+        if (isNodeIndexType(config.node_index))
+        {
+            util::SimpleLogger().Write() << "Node index: " << config.node_index;
+            extraction_containers.node_index = makeNodeIndex(config.node_index);
+        }
 
-        const osmium::io::File input_file(config.input_path.string());
-        osmium::io::Reader reader(input_file);
-        const osmium::io::Header header = reader.header();
+        // When applying changes the old state is read while the new one is written
+        const bool apply_changes = !config.change_paths.empty();
+        const std::string new_state_file_name =
+            apply_changes ? config.state_file_name + ".tmp" : config.state_file_name;
+        std::unique_ptr<ExtractionStateWriter> state_writer;
+        if (config.keep_state || apply_changes)
+        {
+            state_writer = util::make_unique<ExtractionStateWriter>(
+                new_state_file_name, config.profile_path.string());
+        }
+        auto extractor_callbacks =
+            util::make_unique<ExtractorCallbacks>(extraction_containers, state_writer.get());
+        ExtractionChanges extraction_changes;
 
         std::atomic<unsigned> number_of_nodes{0};
         std::atomic<unsigned> number_of_ways{0};
@@ -108,114 +180,246 @@ int Extractor::run()
         util::SimpleLogger().Write() << "Parsing in progress..";
         TIMER_START(parsing);
 
-        auto &main_context = scripting_environment.GetContex();
-
-        // setup raster sources
-        if (util::luaFunctionExists(main_context.state, "source_function"))
+        if (ProfilePluginLibrary::IsPluginPath(config.profile_path))
         {
-            luabind::call_function<void>(main_context.state, "source_function");
+            profile_plugin_library = util::make_unique<ProfilePluginLibrary>(config.profile_path);
+            profile_plugin = &profile_plugin_library->GetPlugin();
+            profile_properties = profile_plugin->GetProperties();
         }
-
-        std::string generator = header.get("generator");
-        if (generator.empty())
+        else
         {
-            generator = "unknown tool";
-        }
-        util::SimpleLogger().Write() << "input file generated by " << generator;
-
-        // write .timestamp data file
-        std::string timestamp = header.get("osmosis_replication_timestamp");
-        if (timestamp.empty())
-        {
-            timestamp = "n/a";
+            scripting_environment =
+                util::make_unique<ScriptingEnvironment>(config.profile_path.string());
+            auto &main_context = scripting_environment->GetContex();
+            main_state = main_context.state;
+            profile_properties = main_context.properties;
+
+            // setup raster sources
+            if (util::luaFunctionExists(main_state, "source_function"))
+            {
+                luabind::call_function<void>(main_state, "source_function");
+            }
         }
-        util::SimpleLogger().Write() << "timestamp: " << timestamp;
-
-        boost::filesystem::ofstream timestamp_out(config.timestamp_file_name);
-        timestamp_out.write(timestamp.c_str(), timestamp.length());
-
-        // initialize vectors holding parsed objects
-        tbb::concurrent_vector<std::pair<std::size_t, ExtractionNode>> resulting_nodes;
-        tbb::concurrent_vector<std::pair<std::size_t, ExtractionWay>> resulting_ways;
-        tbb::concurrent_vector<boost::optional<InputRestrictionContainer>> resulting_restrictions;
 
         // setup restriction parser
-        const RestrictionParser restriction_parser(main_context.state, main_context.properties);
-
-        while (const osmium::memory::Buffer buffer = reader.read())
+        const RestrictionParser restriction_parser =
+            profile_plugin ? RestrictionParser(profile_properties,
+                                               profile_plugin->GetRestrictionExceptions())
+                           : RestrictionParser(main_state, profile_properties);
+
+        // setup the tag keys that decide which objects are passed to the profile
+        const ProfileTagFilter tag_filter =
+            profile_plugin
+                ? ProfileTagFilter(profile_plugin->GetNodeKeys(), profile_plugin->GetWayKeys())
+                : ProfileTagFilter(main_state);
+
+        const auto max_buffers_in_flight = 2 * number_of_threads;
+        std::vector<std::unique_ptr<ParsedBuffer>> buffer_pool;
+        tbb::concurrent_queue<ParsedBuffer *> free_buffers;
+        std::string timestamp;
+        const std::vector<boost::filesystem::path> input_paths =
+            apply_changes ? config.change_paths
+                          : std::vector<boost::filesystem::path>{config.input_path};
+        for (const auto &input_path : input_paths)
         {
-            // create a vector of iterators into the buffer
-            std::vector<osmium::memory::Buffer::const_iterator> osm_elements;
-            for (auto iter = std::begin(buffer), end = std::end(buffer); iter != end; ++iter)
+            const osmium::io::File input_file(input_path.string());
+            osmium::io::Reader reader(input_file);
+            const osmium::io::Header header = reader.header();
+
+            std::string generator = header.get("generator");
+            if (generator.empty())
             {
-                osm_elements.push_back(iter);
+                generator = "unknown tool";
             }
+            util::SimpleLogger().Write() << input_path.filename().string() << " generated by "
+                                         << generator;
 
-            // clear resulting vectors
-            resulting_nodes.clear();
-            resulting_ways.clear();
-            resulting_restrictions.clear();
-
-            // parse OSM entities in parallel, store in resulting vectors
-            tbb::parallel_for(
-                tbb::blocked_range<std::size_t>(0, osm_elements.size()),
-                [&](const tbb::blocked_range<std::size_t> &range) {
-                    ExtractionNode result_node;
-                    ExtractionWay result_way;
-                    auto &local_context = scripting_environment.GetContex();
+            // the last change file that has one determines the timestamp
+            const std::string input_timestamp = header.get("osmosis_replication_timestamp");
+            if (!input_timestamp.empty())
+            {
+                timestamp = input_timestamp;
+            }
 
-                    for (auto x = range.begin(), end = range.end(); x != end; ++x)
+            // Reading a buffer, running the profile on it and passing the results to the
+            // callbacks overlap for consecutive buffers. The first and the last stage keep the
+            // order of the input, the number of buffers in flight is bounded.
+            const auto read_buffer = [&](tbb::flow_control &flow_control) -> ParsedBuffer * {
+                osmium::memory::Buffer buffer = reader.read();
+                if (!buffer)
+                {
+                    flow_control.stop();
+                    return nullptr;
+                }
+
+                ParsedBuffer *parsed_buffer = nullptr;
+                if (!free_buffers.try_pop(parsed_buffer))
+                {
+                    buffer_pool.push_back(util::make_unique<ParsedBuffer>());
+                    parsed_buffer = buffer_pool.back().get();
+                }
+                parsed_buffer->Reset(std::move(buffer));
+                return parsed_buffer;
+            };
+
+            // parse OSM entities in parallel, the profile writes into the result entries of the
+            // buffer. Objects that are deleted by a change file or have none of the keys of the
+            // profile are not passed to the profile.
+            const auto process_buffer = [&](ParsedBuffer *parsed_buffer) {
+                const auto &osm_elements = parsed_buffer->osm_elements;
+                tbb::parallel_for(
+                    tbb::blocked_range<std::size_t>(0, osm_elements.size()),
+                    [&](const tbb::blocked_range<std::size_t> &range) {
+                        auto *local_context =
+                            scripting_environment ? &scripting_environment->GetContex() : nullptr;
+
+                        for (auto x = range.begin(), end = range.end(); x != end; ++x)
+                        {
+                            const auto entity = osm_elements[x];
+
+                            switch (entity->type())
+                            {
+                            case osmium::item_type::node:
+                            {
+                                const auto &node = static_cast<const osmium::Node &>(*entity);
+                                auto &result_node = parsed_buffer->result_nodes[x];
+                                result_node.clear();
+                                ++number_of_nodes;
+                                if (!node.visible() || !tag_filter.IsRelevant(node))
+                                {
+                                    break;
+                                }
+                                if (profile_plugin)
+                                {
+                                    profile_plugin->ProcessNode(node, result_node);
+                                }
+                                else
+                                {
+                                    ScriptingEnvironment::ProcessNode(*local_context, node,
+                                                                      result_node);
+                                }
+                                break;
+                            }
+                            case osmium::item_type::way:
+                            {
+                                const auto &way = static_cast<const osmium::Way &>(*entity);
+                                auto &result_way = parsed_buffer->result_ways[x];
+                                auto &name_id = parsed_buffer->name_ids[x];
+                                result_way.clear();
+                                name_id = INVALID_NAMEID;
+                                ++number_of_ways;
+                                if (!way.visible() || !tag_filter.IsRelevant(way))
+                                {
+                                    break;
+                                }
+                                if (profile_plugin)
+                                {
+                                    profile_plugin->ProcessWay(way, result_way);
+                                }
+                                else
+                                {
+                                    ScriptingEnvironment::ProcessWay(*local_context, way,
+                                                                     result_way);
+                                }
+                                // Most names are known already, looking them up here
+                                // takes the hashing off the serial store stage
+                                if (!apply_changes)
+                                {
+                                    name_id = extractor_callbacks->GetNameID(result_way.name);
+                                }
+                                break;
+                            }
+                            case osmium::item_type::relation:
+                                ++number_of_relations;
+                                parsed_buffer->result_restrictions[x] = restriction_parser.TryParse(
+                                    static_cast<const osmium::Relation &>(*entity));
+                                break;
+                            default:
+                                ++number_of_others;
+                                break;
+                            }
+                        }
+                    });
+                return parsed_buffer;
+            };
+
+            // put parsed objects thru extractor callbacks in input order, or keep them until
+            // the state is read if they are changes
+            const auto store_buffer = [&](ParsedBuffer *parsed_buffer) {
+                const auto &osm_elements = parsed_buffer->osm_elements;
+                for (const auto x : util::irange<std::size_t>(0UL, osm_elements.size()))
+                {
+                    const auto entity = osm_elements[x];
+                    switch (entity->type())
                     {
-                        const auto entity = osm_elements[x];
-
-                        switch (entity->type())
+                    case osmium::item_type::node:
+                    {
+                        const auto &node = static_cast<const osmium::Node &>(*entity);
+                        if (apply_changes)
+                        {
+                            extraction_changes.AddNode(node, parsed_buffer->result_nodes[x]);
+                        }
+                        else
+                        {
+                            extractor_callbacks->ProcessNode(node,
+                                                             parsed_buffer->result_nodes[x]);
+                        }
+                        break;
+                    }
+                    case osmium::item_type::way:
+                    {
+                        const auto &way = static_cast<const osmium::Way &>(*entity);
+                        if (apply_changes)
                         {
-                        case osmium::item_type::node:
-                            result_node.clear();
-                            ++number_of_nodes;
-                            luabind::call_function<void>(
-                                local_context.state, "node_function",
-                                boost::cref(static_cast<const osmium::Node &>(*entity)),
-                                boost::ref(result_node));
-                            resulting_nodes.push_back(std::make_pair(x, result_node));
-                            break;
-                        case osmium::item_type::way:
-                            result_way.clear();
-                            ++number_of_ways;
-                            luabind::call_function<void>(
-                                local_context.state, "way_function",
-                                boost::cref(static_cast<const osmium::Way &>(*entity)),
-                                boost::ref(result_way));
-                            resulting_ways.push_back(std::make_pair(x, result_way));
-                            break;
-                        case osmium::item_type::relation:
-                            ++number_of_relations;
-                            resulting_restrictions.push_back(restriction_parser.TryParse(
-                                static_cast<const osmium::Relation &>(*entity)));
-                            break;
-                        default:
-                            ++number_of_others;
-                            break;
+                            extraction_changes.AddWay(way, parsed_buffer->result_ways[x]);
                         }
+                        else
+                        {
+                            extractor_callbacks->ProcessWay(way, parsed_buffer->result_ways[x],
+                                                            parsed_buffer->name_ids[x]);
+                        }
+                        break;
+                    }
+                    case osmium::item_type::relation:
+                    {
+                        const auto &relation = static_cast<const osmium::Relation &>(*entity);
+                        if (apply_changes)
+                        {
+                            extraction_changes.AddRelation(
+                                relation, parsed_buffer->result_restrictions[x]);
+                        }
+                        else
+                        {
+                            extractor_callbacks->ProcessRestriction(
+                                static_cast<std::uint64_t>(relation.id()),
+                                parsed_buffer->result_restrictions[x]);
+                        }
+                        break;
+                    }
+                    default:
+                        break;
                     }
-                });
+                }
+                free_buffers.push(parsed_buffer);
+            };
+
+            tbb::parallel_pipeline(
+                max_buffers_in_flight,
+                tbb::make_filter<void, ParsedBuffer *>(tbb::filter::serial_in_order,
+                                                       read_buffer) &
+                    tbb::make_filter<ParsedBuffer *, ParsedBuffer *>(tbb::filter::parallel,
+                                                                     process_buffer) &
+                    tbb::make_filter<ParsedBuffer *, void>(tbb::filter::serial_in_order,
+                                                           store_buffer));
+        }
+        free_buffers.clear();
+        buffer_pool.clear();
 
-            // put parsed objects thru extractor callbacks
-            for (const auto &result : resulting_nodes)
-            {
-                extractor_callbacks->ProcessNode(
-                    static_cast<const osmium::Node &>(*(osm_elements[result.first])),
-                    result.second);
-            }
-            for (const auto &result : resulting_ways)
-            {
-                extractor_callbacks->ProcessWay(
-                    static_cast<const osmium::Way &>(*(osm_elements[result.first])), result.second);
-            }
-            for (const auto &result : resulting_restrictions)
-            {
-                extractor_callbacks->ProcessRestriction(result);
-            }
+        if (apply_changes)
+        {
+            util::SimpleLogger().Write() << "Applying changes to " << config.state_file_name;
+            extraction_changes.Apply(config.state_file_name, config.profile_path.string(),
+                                     *extractor_callbacks);
         }
         TIMER_STOP(parsing);
         util::SimpleLogger().Write() << "Parsing finished after " << TIMER_SEC(parsing)
@@ -226,7 +430,25 @@ int Extractor::run()
                                      << number_of_relations.load() << " relations, and "
                                      << number_of_others.load() << " unknown entities";
 
+        // write .timestamp data file, change files without a timestamp keep the old one
+        if (!apply_changes || !timestamp.empty())
+        {
+            if (timestamp.empty())
+            {
+                timestamp = "n/a";
+            }
+            util::SimpleLogger().Write() << "timestamp: " << timestamp;
+
+            boost::filesystem::ofstream timestamp_out(config.timestamp_file_name);
+            timestamp_out.write(timestamp.c_str(), timestamp.length());
+        }
+
         extractor_callbacks.reset();
+        state_writer.reset();
+        if (apply_changes)
+        {
+            boost::filesystem::rename(new_state_file_name, config.state_file_name);
+        }
 
         if (extraction_containers.all_edges_list.empty())
         {
@@ -235,9 +457,9 @@ int Extractor::run()
         }
 
         extraction_containers.PrepareData(config.output_file_name, config.restriction_file_name,
-                                          config.names_file_name, main_context.state);
+                                          config.names_file_name, main_state, profile_plugin);
 
-        WriteProfileProperties(config.profile_properties_output_path, main_context.properties);
+        WriteProfileProperties(config.profile_properties_output_path, profile_properties);
 
         TIMER_STOP(extracting);
         util::SimpleLogger().Write() << "extraction finished after " << TIMER_SEC(extracting)
@@ -257,8 +479,6 @@ int Extractor::run()
         // movement (e.g. turn from A->B, and B->A) becomes an edge
         //
 
-        auto &main_context = scripting_environment.GetContex();
-
         util::SimpleLogger().Write() << "Generating edge-expanded graph representation";
 
         TIMER_START(expansion);
@@ -269,7 +489,7 @@ int Extractor::run()
         std::vector<EdgeWeight> edge_based_node_weights;
         std::vector<QueryNode> internal_to_external_node_map;
         auto graph_size = BuildEdgeExpandedGraph(
-            main_context.state, main_context.properties, internal_to_external_node_map,
+            main_state, profile_plugin, profile_properties, internal_to_external_node_map,
             edge_based_node_list, node_is_startpoint, edge_based_node_weights, edge_based_edge_list,
             config.intersection_class_data_output_path);
 
@@ -468,6 +688,7 @@ Extractor::LoadNodeBasedGraph(std::unordered_set<NodeID> &barrier_nodes,
 */
 std::pair<std::size_t, std::size_t>
 Extractor::BuildEdgeExpandedGraph(lua_State *lua_state,
+                                  const ProfilePlugin *profile_plugin,
                                   const ProfileProperties &profile_properties,
                                   std::vector<QueryNode> &internal_to_external_node_map,
                                   std::vector<EdgeBasedNode> &node_based_edge_list,
@@ -497,7 +718,7 @@ Extractor::BuildEdgeExpandedGraph(lua_State *lua_state,
         std::const_pointer_cast<RestrictionMap const>(restriction_map),
         internal_to_external_node_map, profile_properties, name_table);
 
-    edge_based_graph_factory.Run(config.edge_output_path, lua_state,
+    edge_based_graph_factory.Run(config.edge_output_path, lua_state, profile_plugin,
                                  config.edge_segment_lookup_path, config.edge_penalty_path,
                                  config.generate_edge_lookup);
 
@@ -593,8 +814,16 @@ void Extractor::WriteEdgeBasedGraph(
     TIMER_START(write_edges);
 
     size_t number_of_used_edges = edge_based_edge_list.size();
-    file_out_stream.write((char *)&number_of_used_edges, sizeof(size_t));
-    file_out_stream.write((char *)&max_edge_id, sizeof(size_t));
+    EdgeBasedGraphHeader header;
+    header.magic = EdgeBasedGraphHeader::CURRENT_MAGIC;
+    header.number_of_edges = number_of_used_edges;
+    header.max_edge_id = max_edge_id;
+    // osrm-contract keys its segment index to the extract id
+    header.extract_id =
+        (static_cast<std::uint64_t>(std::random_device{}()) << 32) ^
+        static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    header.stale_edge_weights = 0;
+    file_out_stream.write((char *)&header, sizeof(header));
 
     for (const auto &edge : edge_based_edge_list)
     {
@@ -1,19 +1,23 @@
 #include "extractor/extractor_callbacks.hpp"
 #include "extractor/extraction_containers.hpp"
 #include "extractor/extraction_node.hpp"
+#include "extractor/extraction_state.hpp"
 #include "extractor/extraction_way.hpp"
 
 #include "extractor/external_memory_node.hpp"
 #include "extractor/restriction.hpp"
+#include "util/exception.hpp"
 #include "util/simple_logger.hpp"
 #include "util/for_each_pair.hpp"
 
+#include <boost/iterator/transform_iterator.hpp>
 #include <boost/optional/optional.hpp>
 
 #include <osmium/osm.hpp>
 
 #include "osrm/coordinate.hpp"
 
+#include <cstdint>
 #include <iterator>
 #include <limits>
 #include <string>
@@ -24,8 +28,27 @@ namespace osrm
 namespace extractor
 {
 
-ExtractorCallbacks::ExtractorCallbacks(ExtractionContainers &extraction_containers)
-    : external_memory(extraction_containers)
+namespace
+{
+// Only true if the way is specified by the speed profile
+bool isInaccessible(const ExtractionWay &parsed_way)
+{
+    return ((0 >= parsed_way.forward_speed) ||
+            (TRAVEL_MODE_INACCESSIBLE == parsed_way.forward_travel_mode)) &&
+           ((0 >= parsed_way.backward_speed) ||
+            (TRAVEL_MODE_INACCESSIBLE == parsed_way.backward_travel_mode)) &&
+           (0 >= parsed_way.duration);
+}
+
+struct NodeRefToID
+{
+    OSMNodeID operator()(const osmium::NodeRef &ref) const { return OSMNodeID(ref.ref()); }
+};
+}
+
+ExtractorCallbacks::ExtractorCallbacks(ExtractionContainers &extraction_containers,
+                                       ExtractionStateWriter *state_writer)
+    : external_memory(extraction_containers), state_writer(state_writer)
 {
     string_map[""] = 0;
 }
@@ -39,17 +62,38 @@ ExtractorCallbacks::ExtractorCallbacks(ExtractionContainers &extraction_containe
 void ExtractorCallbacks::ProcessNode(const osmium::Node &input_node,
                                      const ExtractionNode &result_node)
 {
-    external_memory.all_nodes_list.push_back(
-        {util::toFixed(util::FloatLongitude(input_node.location().lon())),
-         util::toFixed(util::FloatLatitude(input_node.location().lat())),
-         OSMNodeID(input_node.id()), result_node.barrier, result_node.traffic_lights});
+    ProcessNode({util::toFixed(util::FloatLongitude(input_node.location().lon())),
+                 util::toFixed(util::FloatLatitude(input_node.location().lat())),
+                 OSMNodeID(input_node.id()), result_node.barrier, result_node.traffic_lights});
+}
+
+void ExtractorCallbacks::ProcessNode(const ExternalMemoryNode &node)
+{
+    // Node indexes are keyed by unsigned ids. A dense index would grow to 2^64 entries for a
+    // negative id, so these are only supported by the sort mode.
+    const auto node_id = static_cast<std::int64_t>(static_cast<std::uint64_t>(node.node_id));
+    if (external_memory.node_index && node_id < 0)
+    {
+        throw util::exception("Negative node id " + std::to_string(node_id) +
+                              " is not supported with a node index, use --node-index sort");
+    }
+
+    if (state_writer)
+    {
+        state_writer->WriteNode(node);
+    }
+    external_memory.all_nodes_list.push_back(node);
 }
 
 void ExtractorCallbacks::ProcessRestriction(
-    const boost::optional<InputRestrictionContainer> &restriction)
+    const std::uint64_t relation_id, const boost::optional<InputRestrictionContainer> &restriction)
 {
     if (restriction)
     {
+        if (state_writer)
+        {
+            state_writer->WriteRestriction(relation_id, restriction.get());
+        }
         external_memory.restrictions_list.push_back(restriction.get());
         // util::SimpleLogger().Write() << "from: " << restriction.get().restriction.from.node <<
         //                           ",via: " << restriction.get().restriction.via.node <<
@@ -58,28 +102,26 @@ void ExtractorCallbacks::ProcessRestriction(
         //                           "y" : "n");
     }
 }
+
+// Thread-safe, can run concurrently with ProcessWay inserting new names
+unsigned ExtractorCallbacks::GetNameID(const std::string &name) const
+{
+    const auto iter = string_map.find(name);
+    return iter == string_map.end() ? INVALID_NAMEID : iter->second;
+}
+
 /**
  * Takes the geometry contained in the ```input_way``` and the tags computed
  * by the lua profile inside ```parsed_way``` and computes all edge segments.
  *
- * Depending on the forward/backwards weights the edges are split into forward
- * and backward edges.
- *
  * warning: caller needs to take care of synchronization!
  */
-void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const ExtractionWay &parsed_way)
+void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way,
+                                    const ExtractionWay &parsed_way,
+                                    const unsigned name_id)
 {
-    if (((0 >= parsed_way.forward_speed) ||
-         (TRAVEL_MODE_INACCESSIBLE == parsed_way.forward_travel_mode)) &&
-        ((0 >= parsed_way.backward_speed) ||
-         (TRAVEL_MODE_INACCESSIBLE == parsed_way.backward_travel_mode)) &&
-        (0 >= parsed_way.duration))
-    { // Only true if the way is specified by the speed profile
-        return;
-    }
-
-    if (input_way.nodes().size() <= 1)
-    { // safe-guard against broken data
+    if (isInaccessible(parsed_way))
+    {
         return;
     }
 
@@ -90,12 +132,68 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
         return;
     }
 
+    // FIXME this need to be moved into the profiles
+    const char *data = input_way.get_value_by_key("highway");
+    guidance::RoadClassificationData road_classification;
+    if (data)
+    {
+        road_classification.road_class = guidance::functionalRoadClassFromTag(data);
+    }
+
+    // the node ids are read from the way node list in place, without copying them
+    const auto &nodes = input_way.nodes();
+    ProcessWayNodes(OSMWayID(input_way.id()),
+                    boost::make_transform_iterator(nodes.cbegin(), NodeRefToID()),
+                    boost::make_transform_iterator(nodes.cend(), NodeRefToID()),
+                    road_classification, parsed_way, name_id);
+}
+
+void ExtractorCallbacks::ProcessWay(const OSMWayID way_id,
+                                    const std::vector<OSMNodeID> &node_ids,
+                                    const guidance::RoadClassificationData &road_classification,
+                                    const ExtractionWay &parsed_way,
+                                    const unsigned name_id)
+{
+    ProcessWayNodes(way_id, node_ids.cbegin(), node_ids.cend(), road_classification, parsed_way,
+                    name_id);
+}
+
+/**
+ * Splits the way given by its node ids into edge segments.
+ *
+ * Depending on the forward/backwards weights the edges are split into forward
+ * and backward edges.
+ *
+ * warning: caller needs to take care of synchronization!
+ */
+template <typename NodeIDIterator>
+void ExtractorCallbacks::ProcessWayNodes(
+    const OSMWayID way_id,
+    const NodeIDIterator first_node_id,
+    const NodeIDIterator last_node_id,
+    const guidance::RoadClassificationData &road_classification,
+    const ExtractionWay &parsed_way,
+    unsigned name_id)
+{
+    if (isInaccessible(parsed_way))
+    {
+        return;
+    }
+
+    const std::size_t number_of_nodes = last_node_id - first_node_id;
+    if (number_of_nodes <= 1)
+    { // safe-guard against broken data
+        return;
+    }
+    const std::reverse_iterator<NodeIDIterator> rfirst_node_id(last_node_id);
+    const std::reverse_iterator<NodeIDIterator> rlast_node_id(first_node_id);
+
     InternalExtractorEdge::WeightData forward_weight_data;
     InternalExtractorEdge::WeightData backward_weight_data;
 
     if (0 < parsed_way.duration)
     {
-        const unsigned num_edges = (input_way.nodes().size() - 1);
+        const unsigned num_edges = (number_of_nodes - 1);
         // FIXME We devide by the numer of nodes here, but should rather consider
         // the length of each segment. We would eigther have to compute the length
         // of the whole way here (we can't: no node coordinates) or push that back
@@ -124,33 +222,35 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
     if (forward_weight_data.type == InternalExtractorEdge::WeightType::INVALID &&
         backward_weight_data.type == InternalExtractorEdge::WeightType::INVALID)
     {
-        util::SimpleLogger().Write(logDEBUG) << "found way with bogus speed, id: "
-                                             << input_way.id();
+        util::SimpleLogger().Write(logDEBUG) << "found way with bogus speed, id: " << way_id;
         return;
     }
 
-    // FIXME this need to be moved into the profiles
-    const char *data = input_way.get_value_by_key("highway");
-    guidance::RoadClassificationData road_classification;
-    if (data)
+    if (state_writer)
     {
-        road_classification.road_class = guidance::functionalRoadClassFromTag(data);
+        state_writer->WriteWay(way_id, std::vector<OSMNodeID>(first_node_id, last_node_id),
+                               road_classification, parsed_way);
     }
 
-    // Get the unique identifier for the street name
-    const auto &string_map_iterator = string_map.find(parsed_way.name);
-    unsigned name_id = external_memory.name_lengths.size();
-    if (string_map.end() == string_map_iterator)
-    {
-        auto name_length = std::min<unsigned>(255u, parsed_way.name.size());
-        std::copy(parsed_way.name.c_str(), parsed_way.name.c_str() + name_length,
-                  std::back_inserter(external_memory.name_char_data));
-        external_memory.name_lengths.push_back(name_length);
-        string_map.insert(std::make_pair(parsed_way.name, name_id));
-    }
-    else
+    // Get the unique identifier for the street name, unless the caller already looked it up.
+    // Names get their ids in the order of the ways, so the .names file does not depend on
+    // which lookups were done in parallel before.
+    if (INVALID_NAMEID == name_id)
     {
-        name_id = string_map_iterator->second;
+        const auto &string_map_iterator = string_map.find(parsed_way.name);
+        if (string_map.end() == string_map_iterator)
+        {
+            name_id = external_memory.name_lengths.size();
+            auto name_length = std::min<unsigned>(255u, parsed_way.name.size());
+            std::copy(parsed_way.name.c_str(), parsed_way.name.c_str() + name_length,
+                      std::back_inserter(external_memory.name_char_data));
+            external_memory.name_lengths.push_back(name_length);
+            string_map.insert(std::make_pair(parsed_way.name, name_id));
+        }
+        else
+        {
+            name_id = string_map_iterator->second;
+        }
     }
 
     const bool split_edge = (parsed_way.forward_speed > 0) &&
@@ -160,12 +260,8 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
                             ((parsed_way.forward_speed != parsed_way.backward_speed) ||
                              (parsed_way.forward_travel_mode != parsed_way.backward_travel_mode));
 
-    std::transform(input_way.nodes().begin(), input_way.nodes().end(),
-                   std::back_inserter(external_memory.used_node_id_list),
-                   [](const osmium::NodeRef &ref)
-                   {
-                       return OSMNodeID(ref.ref());
-                   });
+    std::copy(first_node_id, last_node_id,
+              std::back_inserter(external_memory.used_node_id_list));
 
     const bool is_opposite_way = TRAVEL_MODE_INACCESSIBLE == parsed_way.forward_travel_mode;
 
@@ -174,32 +270,30 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
     {
         BOOST_ASSERT(split_edge == false);
         BOOST_ASSERT(parsed_way.backward_travel_mode != TRAVEL_MODE_INACCESSIBLE);
-        util::for_each_pair(input_way.nodes().crbegin(), input_way.nodes().crend(),
-                            [&](const osmium::NodeRef &first_node, const osmium::NodeRef &last_node)
+        util::for_each_pair(rfirst_node_id, rlast_node_id,
+                            [&](const OSMNodeID first_node, const OSMNodeID last_node)
                             {
                                 external_memory.all_edges_list.push_back(InternalExtractorEdge(
-                                    OSMNodeID(first_node.ref()), OSMNodeID(last_node.ref()),
-                                    name_id, backward_weight_data, true, false,
+                                    first_node, last_node, name_id, backward_weight_data, true,
+                                    false,
                                     parsed_way.roundabout, parsed_way.is_access_restricted,
                                     parsed_way.is_startpoint, parsed_way.backward_travel_mode,
                                     false, road_classification));
                             });
 
         external_memory.way_start_end_id_list.push_back(
-            {OSMWayID(input_way.id()), OSMNodeID(input_way.nodes().back().ref()),
-             OSMNodeID(input_way.nodes()[input_way.nodes().size() - 2].ref()),
-             OSMNodeID(input_way.nodes()[1].ref()), OSMNodeID(input_way.nodes()[0].ref())});
+            {way_id, rfirst_node_id[0], rfirst_node_id[1], first_node_id[1], first_node_id[0]});
     }
     else
     {
         const bool forward_only =
             split_edge || TRAVEL_MODE_INACCESSIBLE == parsed_way.backward_travel_mode;
-        util::for_each_pair(input_way.nodes().cbegin(), input_way.nodes().cend(),
-                            [&](const osmium::NodeRef &first_node, const osmium::NodeRef &last_node)
+        util::for_each_pair(first_node_id, last_node_id,
+                            [&](const OSMNodeID first_node, const OSMNodeID last_node)
                             {
                                 external_memory.all_edges_list.push_back(InternalExtractorEdge(
-                                    OSMNodeID(first_node.ref()), OSMNodeID(last_node.ref()),
-                                    name_id, forward_weight_data, true, !forward_only,
+                                    first_node, last_node, name_id, forward_weight_data, true,
+                                    !forward_only,
                                     parsed_way.roundabout, parsed_way.is_access_restricted,
                                     parsed_way.is_startpoint, parsed_way.forward_travel_mode,
                                     split_edge, road_classification));
@@ -208,11 +302,11 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
         {
             BOOST_ASSERT(parsed_way.backward_travel_mode != TRAVEL_MODE_INACCESSIBLE);
             util::for_each_pair(
-                input_way.nodes().cbegin(), input_way.nodes().cend(),
-                [&](const osmium::NodeRef &first_node, const osmium::NodeRef &last_node)
+                first_node_id, last_node_id,
+                [&](const OSMNodeID first_node, const OSMNodeID last_node)
                 {
                     external_memory.all_edges_list.push_back(InternalExtractorEdge(
-                        OSMNodeID(first_node.ref()), OSMNodeID(last_node.ref()), name_id,
+                        first_node, last_node, name_id,
                         backward_weight_data, false, true, parsed_way.roundabout,
                         parsed_way.is_access_restricted, parsed_way.is_startpoint,
                         parsed_way.backward_travel_mode, true, road_classification));
@@ -220,9 +314,7 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
         }
 
         external_memory.way_start_end_id_list.push_back(
-            {OSMWayID(input_way.id()), OSMNodeID(input_way.nodes().back().ref()),
-             OSMNodeID(input_way.nodes()[input_way.nodes().size() - 2].ref()),
-             OSMNodeID(input_way.nodes()[1].ref()), OSMNodeID(input_way.nodes()[0].ref())});
+            {way_id, rfirst_node_id[0], rfirst_node_id[1], first_node_id[1], first_node_id[0]});
     }
 }
 }
@@ -0,0 +1,114 @@
+#include "extractor/profile_plugin_library.hpp"
+
+#include "util/exception.hpp"
+#include "util/simple_logger.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include <string>
+
+namespace osrm
+{
+namespace extractor
+{
+
+namespace
+{
+using APIVersionFunction = unsigned (*)();
+using CreateFunction = ProfilePlugin *(*)();
+using DestroyFunction = void (*)(ProfilePlugin *);
+
+void *openLibrary(const boost::filesystem::path &library_path)
+{
+#ifdef _WIN32
+    void *handle = ::LoadLibraryA(library_path.string().c_str());
+    if (handle == nullptr)
+    {
+        throw util::exception("Could not load profile plugin " + library_path.string());
+    }
+#else
+    void *handle = ::dlopen(library_path.string().c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+    {
+        throw util::exception("Could not load profile plugin " + library_path.string() + ": " +
+                              ::dlerror());
+    }
+#endif
+    return handle;
+}
+
+void closeLibrary(void *handle)
+{
+#ifdef _WIN32
+    ::FreeLibrary(static_cast<HMODULE>(handle));
+#else
+    ::dlclose(handle);
+#endif
+}
+
+void noDestroy(ProfilePlugin *) {}
+}
+
+ProfilePluginLibrary::ProfilePluginLibrary(const boost::filesystem::path &library_path_)
+    : library_path(library_path_), handle(openLibrary(library_path)), plugin(nullptr, noDestroy)
+{
+    try
+    {
+        const auto api_version =
+            reinterpret_cast<APIVersionFunction>(LoadSymbol("osrm_profile_plugin_api_version"));
+        if (api_version() != PROFILE_PLUGIN_API_VERSION)
+        {
+            throw util::exception("Profile plugin " + library_path.string() +
+                                  " was built for plugin API version " +
+                                  std::to_string(api_version()) + ", this osrm-extract needs " +
+                                  std::to_string(PROFILE_PLUGIN_API_VERSION));
+        }
+
+        const auto create =
+            reinterpret_cast<CreateFunction>(LoadSymbol("osrm_create_profile_plugin"));
+        const auto destroy =
+            reinterpret_cast<DestroyFunction>(LoadSymbol("osrm_destroy_profile_plugin"));
+        plugin = std::unique_ptr<ProfilePlugin, DestroyFunction>(create(), destroy);
+    }
+    catch (...)
+    {
+        closeLibrary(handle);
+        throw;
+    }
+
+    util::SimpleLogger().Write() << "Using profile plugin " << library_path.string();
+}
+
+ProfilePluginLibrary::~ProfilePluginLibrary()
+{
+    // the destructor of the plugin is code of the library
+    plugin.reset();
+    closeLibrary(handle);
+}
+
+void *ProfilePluginLibrary::LoadSymbol(const char *name) const
+{
+#ifdef _WIN32
+    void *symbol = reinterpret_cast<void *>(::GetProcAddress(static_cast<HMODULE>(handle), name));
+#else
+    void *symbol = ::dlsym(handle, name);
+#endif
+    if (symbol == nullptr)
+    {
+        throw util::exception("Profile plugin " + library_path.string() + " has no " + name +
+                              ", is it registered with OSRM_REGISTER_PROFILE_PLUGIN?");
+    }
+    return symbol;
+}
+
+bool ProfilePluginLibrary::IsPluginPath(const boost::filesystem::path &profile_path)
+{
+    const auto extension = profile_path.extension();
+    return extension == ".so" || extension == ".dylib" || extension == ".dll";
+}
+}
+}
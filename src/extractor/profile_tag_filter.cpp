@@ -0,0 +1,89 @@
+#include "extractor/profile_tag_filter.hpp"
+
+#include "util/exception.hpp"
+#include "util/lua_util.hpp"
+#include "util/simple_logger.hpp"
+
+#include <boost/ref.hpp>
+
+#include <osmium/osm.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace osrm
+{
+namespace extractor
+{
+
+namespace
+{
+int luaErrorCallback(lua_State *lua_state)
+{
+    std::string error_msg = lua_tostring(lua_state, -1);
+    throw util::exception("ERROR occurred in profile script:\n" + error_msg);
+}
+}
+
+ProfileTagFilter::ProfileTagFilter(lua_State *lua_state)
+    : filter_nodes(ReadKeys(lua_state, "get_node_keys", node_keys)),
+      filter_ways(ReadKeys(lua_state, "get_way_keys", way_keys))
+{
+}
+
+ProfileTagFilter::ProfileTagFilter(std::vector<std::string> node_keys_,
+                                   std::vector<std::string> way_keys_)
+    : node_keys(std::move(node_keys_)), way_keys(std::move(way_keys_)),
+      filter_nodes(!node_keys.empty()), filter_ways(!way_keys.empty())
+{
+}
+
+bool ProfileTagFilter::ReadKeys(lua_State *lua_state,
+                                const char *function_name,
+                                std::vector<std::string> &keys)
+{
+    if (!util::luaFunctionExists(lua_state, function_name))
+    {
+        util::SimpleLogger().Write() << "Profile has no " << function_name
+                                     << ", all objects are passed to it";
+        return false;
+    }
+
+    luabind::set_pcall_callback(&luaErrorCallback);
+    luabind::call_function<void>(lua_state, function_name, boost::ref(keys));
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::string key_list;
+    for (const auto &key : keys)
+    {
+        key_list += (key_list.empty() ? "" : ", ") + key;
+    }
+    util::SimpleLogger().Write() << "Found " << keys.size() << " keys in " << function_name
+                                 << ": " << key_list;
+    return true;
+}
+
+bool ProfileTagFilter::HasAnyKey(const osmium::TagList &tags,
+                                 const std::vector<std::string> &keys)
+{
+    return std::any_of(tags.begin(), tags.end(), [&keys](const osmium::Tag &tag) {
+        return std::any_of(keys.begin(), keys.end(), [&tag](const std::string &key) {
+            return std::strcmp(tag.key(), key.c_str()) == 0;
+        });
+    });
+}
+
+bool ProfileTagFilter::IsRelevant(const osmium::Node &node) const
+{
+    return !filter_nodes || HasAnyKey(node.tags(), node_keys);
+}
+
+bool ProfileTagFilter::IsRelevant(const osmium::Way &way) const
+{
+    return !filter_ways || HasAnyKey(way.tags(), way_keys);
+}
+}
+}
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <utility>
 
 namespace osrm
 {
@@ -42,6 +43,23 @@ RestrictionParser::RestrictionParser(lua_State *lua_state, const ProfileProperti
     }
 }
 
+RestrictionParser::RestrictionParser(const ProfileProperties &properties,
+                                     std::vector<std::string> restriction_exceptions_)
+    : restriction_exceptions(std::move(restriction_exceptions_)),
+      use_turn_restrictions(properties.use_turn_restrictions)
+{
+    if (!use_turn_restrictions)
+    {
+        restriction_exceptions.clear();
+    }
+    util::SimpleLogger().Write() << "Found " << restriction_exceptions.size()
+                                 << " exceptions to turn restrictions:";
+    for (const std::string &str : restriction_exceptions)
+    {
+        util::SimpleLogger().Write() << "  " << str;
+    }
+}
+
 void RestrictionParser::ReadRestrictionExceptions(lua_State *lua_state)
 {
     if (util::luaFunctionExists(lua_state, "get_exceptions"))
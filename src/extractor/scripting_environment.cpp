@@ -13,6 +13,8 @@
 #include "util/simple_logger.hpp"
 #include "util/typedefs.hpp"
 
+#include <boost/ref.hpp>
+
 #include <luabind/tag_function.hpp>
 #include <luabind/iterator_policy.hpp>
 #include <luabind/operator.hpp>
@@ -49,6 +51,9 @@ auto get_nodes_for_way(const osmium::Way& way) -> decltype(way.nodes()) {
   return way.nodes();
 }
 
+// Registry name of the metatable of the tag tables
+const constexpr char *TAG_TABLE_METATABLE = "osrm.tag_table";
+
 // Error handler
 int luaErrorCallback(lua_State *state)
 {
@@ -106,7 +111,8 @@ void ScriptingEnvironment::InitContext(ScriptingEnvironment::Context &context)
              .property("u_turn_penalty", &ProfileProperties::GetUturnPenalty,
                        &ProfileProperties::SetUturnPenalty)
              .def_readwrite("use_turn_restrictions", &ProfileProperties::use_turn_restrictions)
-             .def_readwrite("continue_straight_at_waypoint", &ProfileProperties::continue_straight_at_waypoint),
+             .def_readwrite("continue_straight_at_waypoint", &ProfileProperties::continue_straight_at_waypoint)
+             .def_readwrite("use_tag_tables", &ProfileProperties::use_tag_tables),
 
          luabind::class_<std::vector<std::string>>("vector")
              .def("Add", static_cast<void (std::vector<std::string>::*)(const std::string &)>(
@@ -168,6 +174,17 @@ void ScriptingEnvironment::InitContext(ScriptingEnvironment::Context &context)
              .def_readonly("datum", &RasterDatum::datum)
              .def("invalid_data", &RasterDatum::get_invalid)];
 
+    // Missing keys of tag tables read as "". The __index handler is a lua chunk instead of a C
+    // function, LuaJIT can compile lookups through it into the traces of the profile.
+    luaL_newmetatable(context.state, TAG_TABLE_METATABLE);
+    if (0 != luaL_loadstring(context.state, "return ''"))
+    {
+        const std::string error_msg = lua_tostring(context.state, -1);
+        throw util::exception("Failed to create the tag table metatable: " + error_msg);
+    }
+    lua_setfield(context.state, -2, "__index");
+    lua_pop(context.state, 1);
+
     luabind::globals(context.state)["properties"] = &context.properties;
     luabind::globals(context.state)["sources"] = &context.sources;
 
@@ -194,5 +211,56 @@ ScriptingEnvironment::Context &ScriptingEnvironment::GetContex()
 
     return *ref;
 }
+
+void ScriptingEnvironment::ProcessNode(Context &context,
+                                       const osmium::Node &node,
+                                       ExtractionNode &result)
+{
+    if (context.properties.use_tag_tables)
+    {
+        luabind::call_function<void>(context.state, "node_function", boost::cref(node),
+                                     boost::ref(result), GetTagTable(context.state, node.tags()));
+    }
+    else
+    {
+        luabind::call_function<void>(context.state, "node_function", boost::cref(node),
+                                     boost::ref(result));
+    }
+}
+
+void ScriptingEnvironment::ProcessWay(Context &context,
+                                      const osmium::Way &way,
+                                      ExtractionWay &result)
+{
+    if (context.properties.use_tag_tables)
+    {
+        luabind::call_function<void>(context.state, "way_function", boost::cref(way),
+                                     boost::ref(result), GetTagTable(context.state, way.tags()));
+    }
+    else
+    {
+        luabind::call_function<void>(context.state, "way_function", boost::cref(way),
+                                     boost::ref(result));
+    }
+}
+
+luabind::object ScriptingEnvironment::GetTagTable(lua_State *state, const osmium::TagList &tags)
+{
+    // built with the plain lua api, every key and value is pushed once instead of crossing
+    // luabind for each get_value_by_key of the profile
+    lua_createtable(state, 0, tags.size());
+    for (const auto &tag : tags)
+    {
+        lua_pushstring(state, tag.key());
+        lua_pushstring(state, tag.value());
+        lua_rawset(state, -3);
+    }
+    luaL_getmetatable(state, TAG_TABLE_METATABLE);
+    lua_setmetatable(state, -2);
+
+    luabind::object table(luabind::from_stack(state, -1));
+    lua_pop(state, 1);
+    return table;
+}
 }
 }
@@ -39,6 +39,13 @@ SuffixTable::SuffixTable(lua_State *lua_state)
     suffix_set.insert(std::begin(suffixes_vector), std::end(suffixes_vector));
 }
 
+SuffixTable::SuffixTable(std::vector<std::string> suffixes)
+{
+    for (auto &suffix : suffixes)
+        boost::algorithm::to_lower(suffix);
+    suffix_set.insert(std::begin(suffixes), std::end(suffixes));
+}
+
 bool SuffixTable::isSuffix(const std::string &possible_suffix) const
 {
     return suffix_set.count(possible_suffix) > 0;
@@ -0,0 +1,618 @@
+// Port of profiles/car.lua to a profile plugin, see include/extractor/profile_plugin.hpp.
+// Changes to car.lua have to be made here as well, the car_profile suite of extractor-tests
+// fails if both give different results.
+
+#include "extractor/extraction_helper_functions.hpp"
+#include "extractor/profile_plugin.hpp"
+
+#include <osmium/osm.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace osrm
+{
+namespace profiles
+{
+
+namespace
+{
+using extractor::ExtractionNode;
+using extractor::ExtractionWay;
+
+using SpeedTable = std::unordered_map<std::string, double>;
+using TagSet = std::unordered_set<std::string>;
+
+const constexpr double INF = std::numeric_limits<double>::infinity();
+
+const TagSet barrier_whitelist = {"cattle_grid", "border_control", "checkpoint",
+                                  "toll_booth",  "sally_port",     "gate",
+                                  "lift_gate",   "no",             "entrance"};
+const TagSet access_tag_whitelist = {"yes",        "motorcar",   "motor_vehicle", "vehicle",
+                                     "permissive", "designated", "destination"};
+const TagSet access_tag_blacklist = {"no",       "private", "agricultural", "forestry",
+                                     "emergency", "psv",    "delivery"};
+const TagSet access_tag_restricted = {"destination", "delivery"};
+const std::vector<std::string> access_tags_hierarchy = {"motorcar", "motor_vehicle", "vehicle",
+                                                        "access"};
+const TagSet service_tag_restricted = {"parking_aisle"};
+const std::vector<std::string> restriction_exception_tags = {"motorcar", "motor_vehicle",
+                                                             "vehicle"};
+
+const std::vector<std::string> suffix_list = {"N",     "NE",    "E",    "SE",  "S",    "SW",
+                                              "W",     "NW",    "North", "South", "West", "East"};
+
+const SpeedTable speed_profile = {{"motorway", 90},
+                                  {"motorway_link", 45},
+                                  {"trunk", 85},
+                                  {"trunk_link", 40},
+                                  {"primary", 65},
+                                  {"primary_link", 30},
+                                  {"secondary", 55},
+                                  {"secondary_link", 25},
+                                  {"tertiary", 40},
+                                  {"tertiary_link", 20},
+                                  {"unclassified", 25},
+                                  {"residential", 25},
+                                  {"living_street", 10},
+                                  {"service", 15},
+                                  {"ferry", 5},
+                                  {"movable", 5},
+                                  {"shuttle_train", 10},
+                                  {"default", 10}};
+
+// max speed for surfaces, surfaces without a limit are not listed
+const SpeedTable surface_speeds = {{"cement", 80},
+                                   {"compacted", 80},
+                                   {"fine_gravel", 80},
+                                   {"paving_stones", 60},
+                                   {"metal", 60},
+                                   {"bricks", 60},
+                                   {"grass", 40},
+                                   {"wood", 40},
+                                   {"sett", 40},
+                                   {"grass_paver", 40},
+                                   {"gravel", 40},
+                                   {"unpaved", 40},
+                                   {"ground", 40},
+                                   {"dirt", 40},
+                                   {"pebblestone", 40},
+                                   {"tartan", 40},
+                                   {"cobblestone", 30},
+                                   {"clay", 30},
+                                   {"earth", 20},
+                                   {"stone", 20},
+                                   {"rocky", 20},
+                                   {"sand", 20},
+                                   {"mud", 10}};
+
+const SpeedTable tracktype_speeds = {
+    {"grade1", 60}, {"grade2", 40}, {"grade3", 30}, {"grade4", 25}, {"grade5", 20}};
+
+const SpeedTable smoothness_speeds = {{"intermediate", 80},
+                                      {"bad", 40},
+                                      {"very_bad", 20},
+                                      {"horrible", 10},
+                                      {"very_horrible", 5},
+                                      {"impassable", 0}};
+
+// http://wiki.openstreetmap.org/wiki/Speed_limits
+const SpeedTable maxspeed_table_default = {
+    {"urban", 50}, {"rural", 90}, {"trunk", 110}, {"motorway", 130}};
+
+// List only exceptions
+const SpeedTable maxspeed_table = {{"ch:rural", 80},
+                                   {"ch:trunk", 100},
+                                   {"ch:motorway", 120},
+                                   {"de:living_street", 7},
+                                   {"ru:living_street", 20},
+                                   {"ru:urban", 60},
+                                   {"ua:urban", 60},
+                                   {"at:rural", 100},
+                                   {"de:rural", 100},
+                                   {"at:trunk", 100},
+                                   {"cz:trunk", 0},
+                                   {"ro:trunk", 100},
+                                   {"cz:motorway", 0},
+                                   {"de:motorway", 0},
+                                   {"ru:motorway", 110},
+                                   {"gb:nsl_single", (60 * 1609) / 1000.},
+                                   {"gb:nsl_dual", (70 * 1609) / 1000.},
+                                   {"gb:motorway", (70 * 1609) / 1000.},
+                                   {"uk:nsl_single", (60 * 1609) / 1000.},
+                                   {"uk:nsl_dual", (70 * 1609) / 1000.},
+                                   {"uk:motorway", (70 * 1609) / 1000.},
+                                   {"none", 140}};
+
+const constexpr double side_road_speed_multiplier = 0.8;
+const constexpr double turn_penalty = 10;
+// Note: this biases right-side driving. Should be inverted for left-driving countries.
+const constexpr double turn_bias = 1.2;
+const constexpr bool obey_oneway = true;
+const constexpr bool ignore_areas = true;
+const constexpr double speed_reduction = 0.8;
+
+// Missing tags are empty, like get_value_by_key(key) in lua
+template <typename ObjectT> std::string getTag(const ObjectT &object, const char *key)
+{
+    return object.get_value_by_key(key, "");
+}
+
+bool contains(const TagSet &set, const std::string &value) { return set.count(value) > 0; }
+
+// Returns the speed of the value or nothing if it is not in the table
+bool lookUp(const SpeedTable &table, const std::string &value, double &speed)
+{
+    const auto iter = table.find(value);
+    if (iter == table.end())
+    {
+        return false;
+    }
+    speed = iter->second;
+    return true;
+}
+
+// The leading digits of the value as a number, like tonumber(value:match("%d*")) in lua
+bool parseLeadingNumber(const std::string &value, double &number)
+{
+    const auto end = std::find_if(value.begin(), value.end(), [](const char c) {
+        return !std::isdigit(static_cast<unsigned char>(c));
+    });
+    if (end == value.begin())
+    {
+        return false;
+    }
+    number = std::stod(std::string(value.begin(), end));
+    return true;
+}
+
+// The first word after two letters and a colon, like value:match("%a%a:(%a+)") in lua
+std::string countryHighwayType(const std::string &value)
+{
+    const auto is_alpha = [](const char c) { return std::isalpha(static_cast<unsigned char>(c)); };
+    for (std::size_t index = 0; index + 3 < value.size(); ++index)
+    {
+        if (is_alpha(value[index]) && is_alpha(value[index + 1]) && value[index + 2] == ':' &&
+            is_alpha(value[index + 3]))
+        {
+            const auto begin = value.begin() + index + 3;
+            return std::string(begin, std::find_if_not(begin, value.end(), is_alpha));
+        }
+    }
+    return "";
+}
+
+double parseMaxspeed(std::string source)
+{
+    double speed = 0;
+    if (parseLeadingNumber(source, speed))
+    {
+        if (source.find("mph") != std::string::npos || source.find("mp/h") != std::string::npos)
+        {
+            speed = (speed * 1609) / 1000;
+        }
+        return speed;
+    }
+
+    // parse maxspeed like FR:urban
+    std::transform(source.begin(), source.end(), source.begin(),
+                   [](const char c) { return std::tolower(static_cast<unsigned char>(c)); });
+    if (lookUp(maxspeed_table, source, speed) ||
+        lookUp(maxspeed_table_default, countryHighwayType(source), speed))
+    {
+        return speed;
+    }
+    return 0;
+}
+
+template <typename ObjectT> std::string findAccessTag(const ObjectT &object)
+{
+    for (const auto &key : access_tags_hierarchy)
+    {
+        const char *tag = object.get_value_by_key(key.c_str(), "");
+        if (*tag != '\0')
+        {
+            return tag;
+        }
+    }
+    return "";
+}
+
+// Assemble destination as: "A59: Düsseldorf, Köln"
+std::string getDestination(const osmium::Way &way)
+{
+    const auto separate = [](std::string list) {
+        std::string result;
+        for (const char c : list)
+        {
+            result += (c == ';' ? std::string(", ") : std::string(1, c));
+        }
+        return result;
+    };
+
+    const auto destination = getTag(way, "destination");
+    const auto destination_ref = getTag(way, "destination:ref");
+
+    std::string result;
+    if (!destination_ref.empty())
+    {
+        result += separate(destination_ref);
+    }
+    if (!destination.empty())
+    {
+        if (!result.empty())
+        {
+            result += ": ";
+        }
+        result += separate(destination);
+    }
+    return result;
+}
+
+void setDuration(const osmium::Way &way, ExtractionWay &result)
+{
+    const auto duration = getTag(way, "duration");
+    if (extractor::durationIsValid(duration))
+    {
+        result.duration = std::max(extractor::parseDuration(duration), 1u);
+    }
+}
+
+// Scale speeds to get better average driving times
+double scaleSpeed(const double speed, const double width, const double lanes, bool bidirectional)
+{
+    const double scaled_speed = speed * speed_reduction + 11;
+    double penalized_speed = INF;
+    if (width <= 3 || (lanes <= 1 && bidirectional))
+    {
+        penalized_speed = speed / 2;
+    }
+    return std::min(penalized_speed, scaled_speed);
+}
+}
+
+class CarProfile final : public extractor::ProfilePlugin
+{
+  public:
+    extractor::ProfileProperties GetProperties() const override
+    {
+        extractor::ProfileProperties properties;
+        properties.SetUturnPenalty(20);
+        properties.SetTrafficSignalPenalty(2);
+        properties.use_turn_restrictions = true;
+        properties.continue_straight_at_waypoint = true;
+        return properties;
+    }
+
+    std::vector<std::string> GetNameSuffixList() const override { return suffix_list; }
+
+    std::vector<std::string> GetRestrictionExceptions() const override
+    {
+        return restriction_exception_tags;
+    }
+
+    std::vector<std::string> GetNodeKeys() const override
+    {
+        auto keys = access_tags_hierarchy;
+        keys.push_back("barrier");
+        keys.push_back("highway");
+        return keys;
+    }
+
+    std::vector<std::string> GetWayKeys() const override { return {"highway", "route", "bridge"}; }
+
+    void ProcessNode(const osmium::Node &node, ExtractionNode &result) const override
+    {
+        // parse access and barrier tags
+        const auto access = findAccessTag(node);
+        if (!access.empty())
+        {
+            if (contains(access_tag_blacklist, access))
+            {
+                result.barrier = true;
+            }
+        }
+        else
+        {
+            const auto barrier = getTag(node, "barrier");
+            if (!barrier.empty())
+            {
+                // make an exception for rising bollard barriers
+                const bool rising_bollard = getTag(node, "bollard") == "rising";
+                if (!contains(barrier_whitelist, barrier) && !rising_bollard)
+                {
+                    result.barrier = true;
+                }
+            }
+        }
+
+        // check if node is a traffic light
+        if (getTag(node, "highway") == "traffic_signals")
+        {
+            result.traffic_lights = true;
+        }
+    }
+
+    void ProcessWay(const osmium::Way &way, ExtractionWay &result) const override
+    {
+        auto highway = getTag(way, "highway");
+        const auto route = getTag(way, "route");
+        const auto bridge = getTag(way, "bridge");
+
+        if (highway.empty() && route.empty() && bridge.empty())
+        {
+            return;
+        }
+
+        // we dont route over areas
+        if (ignore_areas && getTag(way, "area") == "yes")
+        {
+            return;
+        }
+
+        // check if oneway tag is unsupported
+        const auto oneway = getTag(way, "oneway");
+        if (oneway == "reversible")
+        {
+            return;
+        }
+
+        if (getTag(way, "impassable") == "yes" || getTag(way, "status") == "impassable")
+        {
+            return;
+        }
+
+        // Check if we are allowed to access the way
+        const auto access = findAccessTag(way);
+        if (contains(access_tag_blacklist, access))
+        {
+            return;
+        }
+
+        result.forward_travel_mode = TRAVEL_MODE_DRIVING;
+        result.backward_travel_mode = TRAVEL_MODE_DRIVING;
+
+        // handling ferries and piers
+        double route_speed = 0;
+        if (lookUp(speed_profile, route, route_speed) && route_speed > 0)
+        {
+            highway = route;
+            setDuration(way, result);
+            result.forward_travel_mode = TRAVEL_MODE_FERRY;
+            result.backward_travel_mode = TRAVEL_MODE_FERRY;
+            result.forward_speed = route_speed;
+            result.backward_speed = route_speed;
+        }
+
+        // handling movable bridges
+        double bridge_speed = 0;
+        if (lookUp(speed_profile, bridge, bridge_speed) && bridge_speed > 0)
+        {
+            highway = bridge;
+            setDuration(way, result);
+            result.forward_speed = bridge_speed;
+            result.backward_speed = bridge_speed;
+        }
+
+        // leave early of this way is not accessible
+        if (highway.empty())
+        {
+            return;
+        }
+
+        if (result.forward_speed == -1)
+        {
+            double highway_speed = 0;
+            double max_speed = parseMaxspeed(getTag(way, "maxspeed"));
+            // Set the avg speed on the way if it is accessible by road class
+            if (lookUp(speed_profile, highway, highway_speed))
+            {
+                const auto speed = max_speed > highway_speed ? max_speed : highway_speed;
+                result.forward_speed = speed;
+                result.backward_speed = speed;
+            }
+            // Set the avg speed on ways that are marked accessible
+            else if (contains(access_tag_whitelist, access))
+            {
+                result.forward_speed = speed_profile.at("default");
+                result.backward_speed = speed_profile.at("default");
+            }
+            if (max_speed == 0)
+            {
+                max_speed = INF;
+            }
+            result.forward_speed = std::min(result.forward_speed, max_speed);
+            result.backward_speed = std::min(result.backward_speed, max_speed);
+        }
+
+        if (result.forward_speed == -1 && result.backward_speed == -1)
+        {
+            return;
+        }
+
+        // reduce speed on special side roads
+        const auto sideway = getTag(way, "side_road");
+        if (sideway == "yes" || sideway == "rotary")
+        {
+            result.forward_speed *= side_road_speed_multiplier;
+            result.backward_speed *= side_road_speed_multiplier;
+        }
+
+        // reduce speed on bad surfaces
+        double surface_speed = 0;
+        if (lookUp(surface_speeds, getTag(way, "surface"), surface_speed))
+        {
+            result.forward_speed = std::min(surface_speed, result.forward_speed);
+            result.backward_speed = std::min(surface_speed, result.backward_speed);
+        }
+        if (lookUp(tracktype_speeds, getTag(way, "tracktype"), surface_speed))
+        {
+            result.forward_speed = std::min(surface_speed, result.forward_speed);
+            result.backward_speed = std::min(surface_speed, result.backward_speed);
+        }
+        if (lookUp(smoothness_speeds, getTag(way, "smoothness"), surface_speed))
+        {
+            result.forward_speed = std::min(surface_speed, result.forward_speed);
+            result.backward_speed = std::min(surface_speed, result.backward_speed);
+        }
+
+        // parse the remaining tags
+        const auto name = getTag(way, "name");
+        const auto ref = getTag(way, "ref");
+        const auto junction = getTag(way, "junction");
+        const auto service = getTag(way, "service");
+
+        // Set the name that will be used for instructions
+        const bool has_ref = !ref.empty();
+        const bool has_name = !name.empty();
+
+        if (has_name && has_ref)
+        {
+            result.name = name + " (" + ref + ")";
+        }
+        else if (has_ref)
+        {
+            result.name = ref;
+        }
+        else if (has_name)
+        {
+            result.name = name;
+        }
+
+        if (junction == "roundabout")
+        {
+            result.roundabout = true;
+        }
+
+        // Set access restriction flag if access is allowed under certain restrictions only
+        if (!access.empty() && contains(access_tag_restricted, access))
+        {
+            result.is_access_restricted = true;
+        }
+
+        // Set access restriction flag if service is allowed under certain restrictions only
+        if (!service.empty() && contains(service_tag_restricted, service))
+        {
+            result.is_access_restricted = true;
+        }
+
+        // Set direction according to tags on way
+        if (obey_oneway)
+        {
+            if (oneway == "-1")
+            {
+                result.forward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+            }
+            else if (oneway == "yes" || oneway == "1" || oneway == "true" ||
+                     junction == "roundabout" ||
+                     (highway == "motorway_link" && oneway != "no") ||
+                     (highway == "motorway" && oneway != "no"))
+            {
+                result.backward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+
+                // If we're on a oneway and there is no ref tag, re-use destination tag as ref.
+                const auto destination = getDestination(way);
+                if (!destination.empty() && has_name && !has_ref)
+                {
+                    result.name = name + " (" + destination + ")";
+                }
+            }
+        }
+
+        const auto bidirectional_modes = [&result]() {
+            return result.forward_travel_mode != TRAVEL_MODE_INACCESSIBLE &&
+                   result.backward_travel_mode != TRAVEL_MODE_INACCESSIBLE;
+        };
+
+        // Override speed settings if explicit forward/backward maxspeeds are given
+        const auto maxspeed_forward = parseMaxspeed(getTag(way, "maxspeed:forward"));
+        const auto maxspeed_backward = parseMaxspeed(getTag(way, "maxspeed:backward"));
+        if (maxspeed_forward > 0)
+        {
+            if (bidirectional_modes())
+            {
+                result.backward_speed = result.forward_speed;
+            }
+            result.forward_speed = maxspeed_forward;
+        }
+        if (maxspeed_backward > 0)
+        {
+            result.backward_speed = maxspeed_backward;
+        }
+
+        // Override speed settings if advisory forward/backward maxspeeds are given
+        const auto advisory_speed = parseMaxspeed(getTag(way, "maxspeed:advisory"));
+        const auto advisory_forward = parseMaxspeed(getTag(way, "maxspeed:advisory:forward"));
+        const auto advisory_backward = parseMaxspeed(getTag(way, "maxspeed:advisory:backward"));
+        // apply bi-directional advisory speed first
+        if (advisory_speed > 0)
+        {
+            if (result.forward_travel_mode != TRAVEL_MODE_INACCESSIBLE)
+            {
+                result.forward_speed = advisory_speed;
+            }
+            if (result.backward_travel_mode != TRAVEL_MODE_INACCESSIBLE)
+            {
+                result.backward_speed = advisory_speed;
+            }
+        }
+        if (advisory_forward > 0)
+        {
+            if (bidirectional_modes())
+            {
+                result.backward_speed = result.forward_speed;
+            }
+            result.forward_speed = advisory_forward;
+        }
+        if (advisory_backward > 0)
+        {
+            result.backward_speed = advisory_backward;
+        }
+
+        double width = INF;
+        double lanes = INF;
+        if (result.forward_speed > 0 || result.backward_speed > 0)
+        {
+            parseLeadingNumber(getTag(way, "width"), width);
+            parseLeadingNumber(getTag(way, "lanes"), lanes);
+        }
+
+        const bool is_bidirectional = bidirectional_modes();
+        if (result.forward_speed > 0)
+        {
+            result.forward_speed = scaleSpeed(result.forward_speed, width, lanes, is_bidirectional);
+        }
+        if (result.backward_speed > 0)
+        {
+            result.backward_speed =
+                scaleSpeed(result.backward_speed, width, lanes, is_bidirectional);
+        }
+
+        // only allow this road as start point if it not a ferry
+        result.is_startpoint = result.forward_travel_mode == TRAVEL_MODE_DRIVING ||
+                               result.backward_travel_mode == TRAVEL_MODE_DRIVING;
+    }
+
+    bool HasTurnFunction() const override { return true; }
+
+    // compute turn penalty as angle^2, with a left/right bias
+    double GetTurnPenalty(const double angle) const override
+    {
+        const double k = turn_penalty / (90.0 * 90.0);
+        if (angle >= 0)
+        {
+            return angle * angle * k / turn_bias;
+        }
+        return angle * angle * k * turn_bias;
+    }
+};
+}
+}
+
+OSRM_REGISTER_PROFILE_PLUGIN(osrm::profiles::CarProfile)
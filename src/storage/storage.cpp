@@ -26,8 +26,10 @@
 #endif
 
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/iostreams/seek.hpp>
 
+#include <bitset>
 #include <cstdint>
 
 #include <fstream>
@@ -234,6 +236,52 @@ int Storage::Run()
     shared_layout_ptr->SetBlockSize<unsigned>(SharedDataLayout::CORE_MARKER,
                                               number_of_core_markers);
 
+    // load landmark sizes, hierarchies without a core or from older versions have no landmarks
+    boost::filesystem::ifstream landmarks_file;
+    uint32_t number_of_landmarks = 0;
+    uint32_t number_of_landmark_nodes = 0;
+    std::vector<NodeID> landmarks;
+    std::vector<uint32_t> landmark_core_bits;
+    std::vector<uint32_t> landmark_core_ranks;
+    std::size_t number_of_landmark_distances = 0;
+    if (boost::filesystem::exists(config.landmarks_data_path))
+    {
+        landmarks_file.open(config.landmarks_data_path, std::ios::binary);
+        if (!landmarks_file)
+        {
+            throw util::exception("Could not open " + config.landmarks_data_path.string() +
+                                  " for reading.");
+        }
+        landmarks_file.read((char *)&number_of_landmarks, sizeof(uint32_t));
+        landmarks_file.read((char *)&number_of_landmark_nodes, sizeof(uint32_t));
+    }
+    if (number_of_landmarks > 0)
+    {
+        if (number_of_landmark_nodes != number_of_graph_nodes)
+        {
+            throw util::exception(config.landmarks_data_path.string() +
+                                  " was built from a different dataset");
+        }
+        landmarks.resize(number_of_landmarks);
+        landmarks_file.read((char *)landmarks.data(), sizeof(NodeID) * number_of_landmarks);
+        landmark_core_bits.resize(number_of_landmark_nodes / 32 + 1);
+        landmark_core_ranks.resize(number_of_landmark_nodes / 32 + 1);
+        landmarks_file.read((char *)landmark_core_bits.data(),
+                            sizeof(uint32_t) * landmark_core_bits.size());
+        landmarks_file.read((char *)landmark_core_ranks.data(),
+                            sizeof(uint32_t) * landmark_core_ranks.size());
+        const std::size_t number_of_core_nodes =
+            landmark_core_ranks.back() + std::bitset<32>(landmark_core_bits.back()).count();
+        number_of_landmark_distances = number_of_core_nodes * 2 * number_of_landmarks;
+    }
+    shared_layout_ptr->SetBlockSize<NodeID>(SharedDataLayout::LANDMARK_LIST, landmarks.size());
+    shared_layout_ptr->SetBlockSize<uint32_t>(SharedDataLayout::LANDMARK_CORE_BITS,
+                                              landmark_core_bits.size());
+    shared_layout_ptr->SetBlockSize<uint32_t>(SharedDataLayout::LANDMARK_CORE_RANKS,
+                                              landmark_core_ranks.size());
+    shared_layout_ptr->SetBlockSize<EdgeWeight>(SharedDataLayout::LANDMARK_DISTANCES,
+                                                number_of_landmark_distances);
+
     // load coordinate size
     boost::filesystem::ifstream nodes_input_stream(config.nodes_data_path, std::ios::binary);
     if (!nodes_input_stream)
@@ -584,6 +632,28 @@ int Storage::Run()
         }
     }
 
+    // load landmarks
+    NodeID *landmark_list_ptr = shared_layout_ptr->GetBlockPtr<NodeID, true>(
+        shared_memory_ptr, SharedDataLayout::LANDMARK_LIST);
+    std::copy(landmarks.begin(), landmarks.end(), landmark_list_ptr);
+    uint32_t *landmark_core_bits_ptr = shared_layout_ptr->GetBlockPtr<uint32_t, true>(
+        shared_memory_ptr, SharedDataLayout::LANDMARK_CORE_BITS);
+    std::copy(landmark_core_bits.begin(), landmark_core_bits.end(), landmark_core_bits_ptr);
+    uint32_t *landmark_core_ranks_ptr = shared_layout_ptr->GetBlockPtr<uint32_t, true>(
+        shared_memory_ptr, SharedDataLayout::LANDMARK_CORE_RANKS);
+    std::copy(landmark_core_ranks.begin(), landmark_core_ranks.end(), landmark_core_ranks_ptr);
+    EdgeWeight *landmark_distances_ptr = shared_layout_ptr->GetBlockPtr<EdgeWeight, true>(
+        shared_memory_ptr, SharedDataLayout::LANDMARK_DISTANCES);
+    if (number_of_landmark_distances > 0)
+    {
+        landmarks_file.read((char *)landmark_distances_ptr,
+                            sizeof(EdgeWeight) * number_of_landmark_distances);
+        if (!landmarks_file)
+        {
+            throw util::exception("Unexpected end of " + config.landmarks_data_path.string());
+        }
+    }
+
     // load the nodes of the search graph
     QueryGraph::NodeArrayEntry *graph_node_list_ptr =
         shared_layout_ptr->GetBlockPtr<QueryGraph::NodeArrayEntry, true>(
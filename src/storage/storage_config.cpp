@@ -2,6 +2,8 @@
 
 #include <boost/filesystem/operations.hpp>
 
+#include <utility>
+
 namespace osrm
 {
 namespace storage
@@ -11,6 +13,7 @@ StorageConfig::StorageConfig(const boost::filesystem::path &base)
     : ram_index_path{base.string() + ".ramIndex"}, file_index_path{base.string() + ".fileIndex"},
       hsgr_data_path{base.string() + ".hsgr"}, nodes_data_path{base.string() + ".nodes"},
       edges_data_path{base.string() + ".edges"}, core_data_path{base.string() + ".core"},
+      landmarks_data_path{base.string() + ".landmarks"},
       geometries_path{base.string() + ".geometry"}, timestamp_path{base.string() + ".timestamp"},
       datasource_names_path{base.string() + ".datasource_names"},
       datasource_indexes_path{base.string() + ".datasource_indexes"},
@@ -35,5 +38,24 @@ bool StorageConfig::IsValid() const
            boost::filesystem::is_regular_file(properties_path) &&
            boost::filesystem::is_regular_file(intersection_class_path);
 }
+
+MetricStorageConfig::MetricStorageConfig(const boost::filesystem::path &base, std::string metric_name)
+    : name{std::move(metric_name)}, hsgr_data_path{base.string() + "." + name + ".hsgr"},
+      core_data_path{base.string() + "." + name + ".core"},
+      landmarks_data_path{base.string() + "." + name + ".landmarks"},
+      segment_weights_path{base.string() + "." + name + ".segment_weights"},
+      datasource_names_path{base.string() + "." + name + ".datasource_names"},
+      datasource_indexes_path{base.string() + "." + name + ".datasource_indexes"}
+{
+}
+
+bool MetricStorageConfig::IsValid() const
+{
+    return !name.empty() && boost::filesystem::is_regular_file(hsgr_data_path) &&
+           boost::filesystem::is_regular_file(core_data_path) &&
+           boost::filesystem::is_regular_file(segment_weights_path) &&
+           boost::filesystem::is_regular_file(datasource_names_path) &&
+           boost::filesystem::is_regular_file(datasource_indexes_path);
+}
 }
 }
@@ -13,6 +13,7 @@
 #include <exception>
 #include <new>
 #include <ostream>
+#include <string>
 
 using namespace osrm;
 
@@ -39,17 +40,44 @@ return_code parseArguments(int argc, char *argv[], contractor::ContractorConfig
         "core,k",
         boost::program_options::value<double>(&contractor_config.core_factor)->default_value(1.0),
         "Percentage of the graph (in vertices) to contract [0..1]")(
+        "core-landmarks",
+        boost::program_options::value<unsigned>(&contractor_config.core_landmarks)
+            ->default_value(16),
+        "Number of landmarks that speed up the search on the uncontracted core, 0 to disable")(
+        "flush-stages",
+        boost::program_options::value<unsigned>(&contractor_config.flush_stages)->default_value(1),
+        "Number of times the contracted nodes are moved to external memory and the remaining "
+        "graph is rebuilt. More stages use less memory.")(
         "segment-speed-file", boost::program_options::value<std::vector<std::string>>(
                                   &contractor_config.segment_speed_lookup_paths)
                                   ->composing(),
-        "Lookup files containing nodeA, nodeB, speed data to adjust edge weights")(
+        "Lookup files containing nodeA, nodeB, speed data to adjust edge weights, as CSV or as "
+        "written by osrm-convert-speeds")(
+        "segment-speed-delta-file", boost::program_options::value<std::vector<std::string>>(
+                                        &contractor_config.segment_speed_delta_paths)
+                                        ->composing(),
+        "Lookup files containing only the nodeA, nodeB, speed data that changed since the last "
+        "update. The weights are patched in place, combine with --customize.")(
         "turn-penalty-file", boost::program_options::value<std::vector<std::string>>(
                                  &contractor_config.turn_penalty_lookup_paths)
                                  ->composing(),
         "Lookup files containing from_, to_, via_nodes, and turn penalties to adjust turn weights")(
         "level-cache,o", boost::program_options::value<bool>(&contractor_config.use_cached_priority)
                              ->default_value(false),
-        "Use .level file to retain the contaction level for each node from the last run.");
+        "Use .level file to retain the contaction level for each node from the last run.")(
+        "customize", boost::program_options::value<bool>(&contractor_config.use_customization)
+                         ->implicit_value(true)
+                         ->default_value(false),
+        "Only recompute the weights of a hierarchy in the contraction order of the .level file "
+        "from the last full run. Cannot be combined with --core.")(
+        "lazy-priority-updates",
+        boost::program_options::value<bool>(&contractor_config.use_lazy_priority_updates)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Only recompute the priority of a node when it is about to be contracted. Faster, but "
+        "may add more shortcuts.")(
+        "metric,m", boost::program_options::value<std::string>(&contractor_config.metric_name),
+        "Build an additional named metric that shares the extracted data with the default one");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -135,6 +163,16 @@ int main(int argc, char *argv[]) try
             << "! This setting may have performance side-effects.";
     }
 
+    // metric names are used in file names and in the metric= request parameter
+    if (contractor_config.metric_name.find_first_not_of("abcdefghijklmnopqrstuvwxyz"
+                                                        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                                        "0123456789_-") != std::string::npos)
+    {
+        util::SimpleLogger().Write(logWARNING)
+            << "Metric names may only contain letters, digits, '_' and '-'";
+        return EXIT_FAILURE;
+    }
+
     if (!boost::filesystem::is_regular_file(contractor_config.osrm_input_path))
     {
         util::SimpleLogger().Write(logWARNING)
@@ -145,6 +183,10 @@ int main(int argc, char *argv[]) try
     util::SimpleLogger().Write() << "Input file: "
                                  << contractor_config.osrm_input_path.filename().string();
     util::SimpleLogger().Write() << "Threads: " << contractor_config.requested_num_threads;
+    if (!contractor_config.metric_name.empty())
+    {
+        util::SimpleLogger().Write() << "Metric: " << contractor_config.metric_name;
+    }
 
     tbb::task_scheduler_init init(contractor_config.requested_num_threads);
 
@@ -0,0 +1,134 @@
+#include "contractor/segment_speed_file.hpp"
+#include "util/simple_logger.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/program_options/errors.hpp>
+
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+return_code parseArguments(int argc,
+                           char *argv[],
+                           std::vector<std::string> &input_paths,
+                           std::string &output_path)
+{
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options()(
+        "output,o", boost::program_options::value<std::string>(&output_path),
+        "Binary segment speed file for osrm-contract --segment-speed-file and "
+        "--segment-speed-delta-file");
+
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "input,i", boost::program_options::value<std::vector<std::string>>(&input_paths),
+        "nodeA,nodeB,speed CSV files, later files override earlier ones");
+
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", -1);
+
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        "Usage: " + boost::filesystem::path(executable).filename().string() +
+        " <speeds.csv> [<speeds.csv> ...] -o <speeds.bin>");
+    visible_options.add(generic_options).add(config_options);
+
+    boost::program_options::variables_map option_variables;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                      .options(cmdline_options)
+                                      .positional(positional_options)
+                                      .run(),
+                                  option_variables);
+
+    if (option_variables.count("version"))
+    {
+        util::SimpleLogger().Write() << OSRM_VERSION;
+        return return_code::exit;
+    }
+
+    if (option_variables.count("help"))
+    {
+        util::SimpleLogger().Write() << visible_options;
+        return return_code::exit;
+    }
+
+    boost::program_options::notify(option_variables);
+
+    if (!option_variables.count("input") || !option_variables.count("output"))
+    {
+        util::SimpleLogger().Write() << visible_options;
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+    std::vector<std::string> input_paths;
+    std::string output_path;
+
+    const return_code result = parseArguments(argc, argv, input_paths, output_path);
+
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    TIMER_START(convert);
+
+    std::vector<contractor::SegmentSpeedRecord> records;
+    for (const auto &input_path : input_paths)
+    {
+        util::SimpleLogger().Write() << "Reading " << input_path;
+        const auto file_records = contractor::readSegmentSpeedsFromCSV(input_path);
+        records.insert(records.end(), file_records.begin(), file_records.end());
+    }
+
+    contractor::sortSegmentSpeeds(records);
+    contractor::writeSegmentSpeedFile(output_path, records);
+
+    TIMER_STOP(convert);
+    util::SimpleLogger().Write() << "Wrote " << records.size() << " segment speeds to "
+                                 << output_path << " in " << TIMER_SEC(convert) << "s";
+
+    return EXIT_SUCCESS;
+}
+catch (const std::bad_alloc &e)
+{
+    util::SimpleLogger().Write(logWARNING) << "[exception] " << e.what();
+    util::SimpleLogger().Write(logWARNING)
+        << "Please provide more memory or consider using a larger swapfile";
+    return EXIT_FAILURE;
+}
+catch (const std::exception &e)
+{
+    util::SimpleLogger().Write(logWARNING) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
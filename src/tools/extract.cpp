@@ -1,5 +1,6 @@
 #include "extractor/extractor.hpp"
 #include "extractor/extractor_config.hpp"
+#include "extractor/node_index.hpp"
 #include "util/simple_logger.hpp"
 #include "util/version.hpp"
 
@@ -11,6 +12,7 @@
 #include <cstdlib>
 #include <exception>
 #include <new>
+#include <vector>
 
 using namespace osrm;
 
@@ -33,7 +35,7 @@ return_code parseArguments(int argc, char *argv[], extractor::ExtractorConfig &e
         "profile,p",
         boost::program_options::value<boost::filesystem::path>(&extractor_config.profile_path)
             ->default_value("profile.lua"),
-        "Path to LUA routing profile")(
+        "Path to LUA routing profile or profile plugin (.so, .dylib or .dll)")(
         "threads,t",
         boost::program_options::value<unsigned int>(&extractor_config.requested_num_threads)
             ->default_value(tbb::task_scheduler_init::default_num_threads()),
@@ -47,7 +49,24 @@ return_code parseArguments(int argc, char *argv[], extractor::ExtractorConfig &e
         boost::program_options::value<unsigned int>(&extractor_config.small_component_size)
             ->default_value(1000),
         "Number of nodes required before a strongly-connected-componennt is considered big "
-        "(affects nearest neighbor snapping)");
+        "(affects nearest neighbor snapping)")(
+        "keep-state",
+        boost::program_options::value<bool>(&extractor_config.keep_state)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Write .osrm.state, which is needed to update the extract with --apply-changes")(
+        "apply-changes",
+        boost::program_options::value<std::vector<boost::filesystem::path>>(
+            &extractor_config.change_paths)
+            ->composing(),
+        "Update the extract of the input file with OSM change files (.osc) instead of reading "
+        "it again. Needs .osrm.state from an earlier run with --keep-state")(
+        "node-index",
+        boost::program_options::value<std::string>(&extractor_config.node_index)
+            ->default_value("sort"),
+        "How nodes are found by their OSM id: sort (sort nodes and edges), dense (array of all "
+        "OSM ids, for planet extracts) or sparse (sorted index, for smaller extracts). dense and "
+        "sparse need a build with -DENABLE_STXXL=OFF and non-negative node ids");
 
     // hidden options, will be allowed on command line, but will not be
     // shown to the user
@@ -132,7 +151,43 @@ int main(int argc, char *argv[]) try
         return EXIT_FAILURE;
     }
 
-    if (!boost::filesystem::is_regular_file(extractor_config.input_path))
+    if (extractor_config.node_index != "sort" &&
+        !extractor::isNodeIndexType(extractor_config.node_index))
+    {
+        util::SimpleLogger().Write(logWARNING) << "Unknown node index "
+                                               << extractor_config.node_index;
+        return EXIT_FAILURE;
+    }
+
+#ifdef ENABLE_STXXL
+    if (extractor_config.node_index != "sort")
+    {
+        util::SimpleLogger().Write(logWARNING) << "Node index " << extractor_config.node_index
+                                               << " needs a build with -DENABLE_STXXL=OFF";
+        return EXIT_FAILURE;
+    }
+#endif
+
+    if (!extractor_config.change_paths.empty())
+    {
+        if (!boost::filesystem::is_regular_file(extractor_config.state_file_name))
+        {
+            util::SimpleLogger().Write(logWARNING)
+                << "State file " << extractor_config.state_file_name
+                << " not found! Run osrm-extract with --keep-state first.";
+            return EXIT_FAILURE;
+        }
+        for (const auto &change_path : extractor_config.change_paths)
+        {
+            if (!boost::filesystem::is_regular_file(change_path))
+            {
+                util::SimpleLogger().Write(logWARNING) << "Change file " << change_path.string()
+                                                       << " not found!";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    else if (!boost::filesystem::is_regular_file(extractor_config.input_path))
     {
         util::SimpleLogger().Write(logWARNING)
             << "Input file " << extractor_config.input_path.string() << " not found!";
@@ -25,6 +25,7 @@
 #include <new>
 #include <thread>
 #include <string>
+#include <vector>
 
 #ifdef _WIN32
 boost::function0<void> console_ctrl_function;
@@ -56,6 +57,7 @@ inline unsigned
 generateServerProgramOptions(const int argc,
                              const char *argv[],
                              boost::filesystem::path &base_path,
+                             std::vector<std::string> &metric_names,
                              std::string &ip_address,
                              int &ip_port,
                              int &requested_num_threads,
@@ -87,6 +89,8 @@ generateServerProgramOptions(const int argc,
         ("shared-memory,s",
          value<bool>(&use_shared_memory)->implicit_value(true)->default_value(false),
          "Load data from shared memory") //
+        ("metric,m", value<std::vector<std::string>>(&metric_names)->composing(),
+         "Named metric built with osrm-contract --metric to load next to the default one") //
         ("max-viaroute-size", value<int>(&max_locations_viaroute)->default_value(500),
          "Max. locations supported in viaroute query") //
         ("max-trip-size", value<int>(&max_locations_trip)->default_value(100),
@@ -163,8 +167,9 @@ int main(int argc, const char *argv[]) try
 
     EngineConfig config;
     boost::filesystem::path base_path;
+    std::vector<std::string> metric_names;
     const unsigned init_result = generateServerProgramOptions(
-        argc, argv, base_path, ip_address, ip_port, requested_thread_num,
+        argc, argv, base_path, metric_names, ip_address, ip_port, requested_thread_num,
         config.use_shared_memory, trial_run, config.max_locations_trip,
         config.max_locations_viaroute, config.max_locations_distance_table,
         config.max_locations_map_matching);
@@ -179,6 +184,15 @@ int main(int argc, const char *argv[]) try
     if (!base_path.empty())
     {
         config.storage_config = storage::StorageConfig(base_path);
+        for (const auto &metric_name : metric_names)
+        {
+            config.metric_configs.emplace_back(base_path, metric_name);
+        }
+    }
+    else if (!metric_names.empty())
+    {
+        util::SimpleLogger().Write(logWARNING) << "Named metrics are not supported with shared memory.";
+        return EXIT_FAILURE;
     }
     if(!config.IsValid())
     {
@@ -236,6 +250,13 @@ int main(int argc, const char *argv[]) try
             {
                 util::SimpleLogger().Write(logWARNING) << config.storage_config.properties_path << " is not found";
             }
+            for (const auto &metric_config : config.metric_configs)
+            {
+                if(!metric_config.IsValid())
+                {
+                    util::SimpleLogger().Write(logWARNING) << "files of metric " << metric_config.name << " are not found";
+                }
+            }
         }
         return EXIT_FAILURE;
     }
@@ -0,0 +1,90 @@
+#include "contractor/core_landmarks.hpp"
+#include "util/landmark_table.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+const static std::string LANDMARKS_TMP_FILE = "test_core_landmarks.tmp";
+
+BOOST_AUTO_TEST_SUITE(core_landmarks)
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+namespace
+{
+QueryEdge makeEdge(NodeID source, NodeID target, EdgeWeight distance, bool forward, bool backward)
+{
+    QueryEdge::EdgeData data;
+    data.distance = distance;
+    data.forward = forward;
+    data.backward = backward;
+    return QueryEdge(source, target, data);
+}
+}
+
+BOOST_AUTO_TEST_CASE(first_core_node_without_edges)
+{
+    // node 0 is part of the core, but not connected to the cycle 1 -> 2 -> 3 -> 4 -> 1
+    const std::vector<bool> is_core_node(5, true);
+    util::DeallocatingVector<QueryEdge> edges;
+    edges.push_back(makeEdge(1, 2, 10, true, false));
+    edges.push_back(makeEdge(2, 3, 10, true, false));
+    edges.push_back(makeEdge(3, 4, 10, true, false));
+    edges.push_back(makeEdge(1, 4, 10, false, true));
+
+    CoreLandmarks core_landmarks(is_core_node, edges);
+    core_landmarks.Compute(3);
+    core_landmarks.Write(LANDMARKS_TMP_FILE);
+
+    const auto table = util::readLandmarkTable(LANDMARKS_TMP_FILE, 5);
+    BOOST_REQUIRE_EQUAL(table.GetNumberOfLandmarks(), 3);
+
+    // every node of the cycle is reached from and reaches some landmark
+    for (const NodeID node : {1, 2, 3, 4})
+    {
+        const auto *distances = table.GetDistances(node);
+        BOOST_REQUIRE(distances != nullptr);
+        bool reached = false;
+        bool reaches = false;
+        for (const auto landmark : util::irange(0u, 3u))
+        {
+            reached = reached || distances[landmark] != INVALID_EDGE_WEIGHT;
+            reaches = reaches || distances[3 + landmark] != INVALID_EDGE_WEIGHT;
+        }
+        BOOST_CHECK(reached);
+        BOOST_CHECK(reaches);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(landmarks_in_every_component)
+{
+    // two components 0 - 1 - 2 and 3 - 4, node 5 is not part of the core
+    const std::vector<bool> is_core_node = {true, true, true, true, true, false};
+    util::DeallocatingVector<QueryEdge> edges;
+    edges.push_back(makeEdge(0, 1, 5, true, true));
+    edges.push_back(makeEdge(1, 2, 5, true, true));
+    edges.push_back(makeEdge(3, 4, 5, true, true));
+    edges.push_back(makeEdge(4, 5, 5, true, true));
+
+    CoreLandmarks core_landmarks(is_core_node, edges);
+    core_landmarks.Compute(2);
+    core_landmarks.Write(LANDMARKS_TMP_FILE);
+
+    const auto table = util::readLandmarkTable(LANDMARKS_TMP_FILE, 6);
+    BOOST_REQUIRE_EQUAL(table.GetNumberOfLandmarks(), 2);
+    BOOST_CHECK(table.GetDistances(5) == nullptr);
+
+    // one landmark in each component
+    for (const NodeID node : {0, 1, 2, 3, 4})
+    {
+        const auto *distances = table.GetDistances(node);
+        BOOST_REQUIRE(distances != nullptr);
+        BOOST_CHECK((distances[0] == INVALID_EDGE_WEIGHT) != (distances[1] == INVALID_EDGE_WEIGHT));
+        BOOST_CHECK_EQUAL(distances[0] == INVALID_EDGE_WEIGHT, distances[2] == INVALID_EDGE_WEIGHT);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+#include "contractor/crc32_processor.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(crc32)
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+namespace
+{
+// The checksums have no initial value and final xor, the standard CRC-32C has both
+unsigned standardCRC32C(const std::string &data)
+{
+    return ~ComputeCRC32(~0u, data.data(), data.size());
+}
+
+std::vector<char> randomBytes(const std::size_t size, std::mt19937 &generator)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<char> bytes(size);
+    for (auto &value : bytes)
+    {
+        value = static_cast<char>(byte(generator));
+    }
+    return bytes;
+}
+}
+
+BOOST_AUTO_TEST_CASE(known_vectors)
+{
+    BOOST_CHECK_EQUAL(standardCRC32C(""), 0x00000000u);
+    BOOST_CHECK_EQUAL(standardCRC32C("a"), 0xC1D04330u);
+    BOOST_CHECK_EQUAL(standardCRC32C("123456789"), 0xE3069283u);
+    BOOST_CHECK_EQUAL(standardCRC32C(std::string(32, '\0')), 0x8A9136AAu);
+    BOOST_CHECK_EQUAL(standardCRC32C(std::string(32, '\xff')), 0x62A8AB43u);
+
+    // without initial value the checksum of zero bytes stays zero
+    BOOST_CHECK_EQUAL(ComputeCRC32(0, std::string(32, '\0').data(), 32), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(software_matches_hardware)
+{
+    if (!detail::UseHardware())
+    {
+        BOOST_TEST_MESSAGE("The CPU has no crc32 instruction, only the software path is used");
+        return;
+    }
+
+    std::mt19937 generator(42);
+    const auto bytes = randomBytes(4096 + 8, generator);
+    std::uniform_int_distribution<std::size_t> length_distribution(0, 4096);
+    std::uniform_int_distribution<std::size_t> start_distribution(0, 7);
+    std::uniform_int_distribution<unsigned> crc_distribution;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        const auto start = bytes.data() + start_distribution(generator);
+        const auto length = length_distribution(generator);
+        const auto crc = crc_distribution(generator);
+        BOOST_CHECK_EQUAL(detail::ComputeInSoftware(crc, start, length),
+                          detail::ComputeInHardware(crc, start, length));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(combine)
+{
+    std::mt19937 generator(23);
+    std::uniform_int_distribution<std::size_t> length_distribution(0, 1000);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        const auto first = randomBytes(length_distribution(generator), generator);
+        const auto second = randomBytes(length_distribution(generator), generator);
+        auto both = first;
+        both.insert(both.end(), second.begin(), second.end());
+
+        const auto first_crc = ComputeCRC32(0, first.data(), first.size());
+        const auto second_crc = ComputeCRC32(0, second.data(), second.size());
+        BOOST_CHECK_EQUAL(CombineCRC32(first_crc, second_crc, second.size()),
+                          ComputeCRC32(0, both.data(), both.size()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_matches_serial)
+{
+    std::mt19937 generator(5);
+
+    // several chunks of 1 MiB and a partial one
+    const auto bytes = randomBytes((3 << 20) + 12345, generator);
+    BOOST_CHECK_EQUAL(ParallelCRC32(bytes), ComputeCRC32(0, bytes.data(), bytes.size()));
+    BOOST_CHECK_EQUAL(ParallelCRC32(bytes.data() + 3, bytes.size() - 3),
+                      ComputeCRC32(0, bytes.data() + 3, bytes.size() - 3));
+
+    // exactly two chunks
+    const std::vector<std::uint32_t> words(1 << 19, 0xDEADBEEF);
+    BOOST_CHECK_EQUAL(ParallelCRC32(words),
+                      ComputeCRC32(0, words.data(), words.size() * sizeof(std::uint32_t)));
+
+    BOOST_CHECK_EQUAL(ParallelCRC32(std::vector<char>{}), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+#include "contractor/graph_contractor.hpp"
+
+#include "helper.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(graph_contractor)
+
+using namespace osrm;
+using namespace osrm::contractor;
+using namespace osrm::unit_test;
+
+namespace
+{
+using QueryEdges = util::DeallocatingVector<QueryEdge>;
+
+QueryEdges contract(const NodeID number_of_nodes,
+                    const InputEdges &edges,
+                    const bool lazy_priority_updates,
+                    const unsigned flush_stages)
+{
+    auto edge_list = toDeallocatingVector(edges);
+    GraphContractor graph_contractor(number_of_nodes, edge_list, {},
+                                     std::vector<EdgeWeight>(number_of_nodes, 0));
+    graph_contractor.Run(1.0, lazy_priority_updates, flush_stages);
+    QueryEdges contracted_edges;
+    graph_contractor.GetEdges(contracted_edges);
+    return contracted_edges;
+}
+}
+
+BOOST_AUTO_TEST_CASE(lazy_priority_updates_match_dijkstra)
+{
+    std::mt19937 generator(42);
+    for (const NodeID number_of_nodes : {100u, 500u})
+    {
+        const auto edges = makeRandomGraph(number_of_nodes, 3 * number_of_nodes, generator);
+        const auto sources = pickRandomNodes(number_of_nodes, 20, generator);
+        const auto targets = pickRandomNodes(number_of_nodes, 50, generator);
+
+        const auto eager_edges = contract(number_of_nodes, edges, false, 1);
+        const auto lazy_edges = contract(number_of_nodes, edges, true, 1);
+
+        BOOST_CHECK_EQUAL(
+            countWrongDistances(number_of_nodes, edges, eager_edges, sources, targets), 0);
+        BOOST_CHECK_EQUAL(
+            countWrongDistances(number_of_nodes, edges, lazy_edges, sources, targets), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(flush_stages_give_same_distances)
+{
+    std::mt19937 generator(1337);
+    const NodeID number_of_nodes = 1000;
+    const auto edges = makeRandomGraph(number_of_nodes, 3 * number_of_nodes, generator);
+    const auto sources = pickRandomNodes(number_of_nodes, 20, generator);
+    const auto targets = pickRandomNodes(number_of_nodes, 50, generator);
+
+    const auto single_flush_edges = contract(number_of_nodes, edges, false, 1);
+    const auto staged_flush_edges = contract(number_of_nodes, edges, false, 3);
+    const auto lazy_staged_flush_edges = contract(number_of_nodes, edges, true, 3);
+
+    for (const auto &contracted_edges :
+         {&single_flush_edges, &staged_flush_edges, &lazy_staged_flush_edges})
+    {
+        BOOST_CHECK_EQUAL(
+            countWrongDistances(number_of_nodes, edges, *contracted_edges, sources, targets), 0);
+        // the middle nodes of the shortcuts are renumbered back by every flush
+        BOOST_CHECK_EQUAL(countInvalidShortcuts(*contracted_edges), 0);
+        for (const auto &edge : *contracted_edges)
+        {
+            BOOST_CHECK_LT(edge.source, number_of_nodes);
+            BOOST_CHECK_LT(edge.target, number_of_nodes);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(flush_stages_keep_all_node_levels)
+{
+    std::mt19937 generator(7);
+    const NodeID number_of_nodes = 1000;
+    const auto edges = makeRandomGraph(number_of_nodes, 3 * number_of_nodes, generator);
+
+    auto edge_list = toDeallocatingVector(edges);
+    GraphContractor graph_contractor(number_of_nodes, edge_list, {},
+                                     std::vector<EdgeWeight>(number_of_nodes, 0));
+    graph_contractor.Run(1.0, false, 3);
+    std::vector<float> node_levels;
+    graph_contractor.GetNodeLevels(node_levels);
+    std::vector<ContractionRoundStats> round_stats;
+    graph_contractor.GetRoundStats(round_stats);
+
+    // every round writes the level of the nodes it contracts, under their original ids
+    BOOST_REQUIRE_EQUAL(node_levels.size(), number_of_nodes);
+    std::vector<NodeID> nodes_per_level(round_stats.size() + 1, 0);
+    for (const auto level : node_levels)
+    {
+        BOOST_REQUIRE_LT(level, nodes_per_level.size());
+        ++nodes_per_level[static_cast<std::size_t>(level)];
+    }
+    for (const auto &round : round_stats)
+    {
+        BOOST_CHECK_EQUAL(nodes_per_level[round.level], round.contracted_nodes);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
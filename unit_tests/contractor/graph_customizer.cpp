@@ -0,0 +1,153 @@
+#include "contractor/graph_contractor.hpp"
+#include "contractor/graph_customizer.hpp"
+
+#include "helper.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <tuple>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(graph_customizer)
+
+using namespace osrm;
+using namespace osrm::contractor;
+using namespace osrm::unit_test;
+
+namespace
+{
+using QueryEdges = util::DeallocatingVector<QueryEdge>;
+
+std::vector<float> contractForLevels(const NodeID number_of_nodes, const InputEdges &edges)
+{
+    auto edge_list = toDeallocatingVector(edges);
+    GraphContractor graph_contractor(number_of_nodes, edge_list, {},
+                                     std::vector<EdgeWeight>(number_of_nodes, 0));
+    graph_contractor.Run();
+    std::vector<float> node_levels;
+    graph_contractor.GetNodeLevels(node_levels);
+    return node_levels;
+}
+
+std::vector<std::tuple<NodeID, NodeID, EdgeWeight, NodeID, bool, bool, bool>>
+sortedEdges(const QueryEdges &edges)
+{
+    std::vector<std::tuple<NodeID, NodeID, EdgeWeight, NodeID, bool, bool, bool>> result;
+    for (const auto &edge : edges)
+    {
+        result.emplace_back(edge.source, edge.target, edge.data.distance, edge.data.id,
+                            edge.data.shortcut, edge.data.forward, edge.data.backward);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(customized_hierarchy_matches_dijkstra)
+{
+    std::mt19937 generator(42);
+    const NodeID number_of_nodes = 200;
+    const auto edges = makeRandomGraph(number_of_nodes, 3 * number_of_nodes, generator);
+
+    // any order gives a correct hierarchy
+    std::vector<float> node_levels(number_of_nodes);
+    for (auto &level : node_levels)
+    {
+        level = generator() % 20;
+    }
+
+    const auto edge_list = toDeallocatingVector(edges);
+    GraphCustomizer graph_customizer(number_of_nodes, node_levels, edge_list);
+    graph_customizer.Customize(edge_list);
+    QueryEdges customized_edges;
+    graph_customizer.GetEdges(customized_edges);
+
+    const auto sources = pickRandomNodes(number_of_nodes, 20, generator);
+    const auto targets = pickRandomNodes(number_of_nodes, 50, generator);
+    BOOST_CHECK_EQUAL(
+        countWrongDistances(number_of_nodes, edges, customized_edges, sources, targets), 0);
+}
+
+BOOST_AUTO_TEST_CASE(customization_after_weight_change_matches_recontraction)
+{
+    std::mt19937 generator(1337);
+    const NodeID number_of_nodes = 300;
+    const auto edges = makeRandomGraph(number_of_nodes, 3 * number_of_nodes, generator);
+    const auto node_levels = contractForLevels(number_of_nodes, edges);
+    BOOST_REQUIRE_EQUAL(node_levels.size(), number_of_nodes);
+
+    const auto edge_list = toDeallocatingVector(edges);
+    GraphCustomizer graph_customizer(number_of_nodes, node_levels, edge_list);
+    graph_customizer.Customize(edge_list);
+
+    // a traffic update changes a third of the weights
+    auto changed_edges = edges;
+    for (auto &edge : changed_edges)
+    {
+        if (generator() % 3 == 0)
+        {
+            edge.weight = 1 + generator() % 500;
+        }
+    }
+    const auto changed_edge_list = toDeallocatingVector(changed_edges);
+
+    graph_customizer.Customize(changed_edge_list);
+    QueryEdges customized_edges;
+    graph_customizer.GetEdges(customized_edges);
+
+    // the same order built and customized from scratch
+    GraphCustomizer recontracted_customizer(number_of_nodes, node_levels, changed_edge_list);
+    recontracted_customizer.Customize(changed_edge_list);
+    QueryEdges recontracted_edges;
+    recontracted_customizer.GetEdges(recontracted_edges);
+
+    BOOST_CHECK_EQUAL(graph_customizer.GetNumberOfArcs(),
+                      recontracted_customizer.GetNumberOfArcs());
+    const auto customized = sortedEdges(customized_edges);
+    const auto recontracted = sortedEdges(recontracted_edges);
+    BOOST_CHECK(customized == recontracted);
+
+    // a full contraction with the cached order and the new weights
+    auto contractor_edge_list = toDeallocatingVector(changed_edges);
+    GraphContractor graph_contractor(number_of_nodes, contractor_edge_list,
+                                     std::vector<float>(node_levels),
+                                     std::vector<EdgeWeight>(number_of_nodes, 0));
+    graph_contractor.Run();
+    QueryEdges contracted_edges;
+    graph_contractor.GetEdges(contracted_edges);
+
+    const auto sources = pickRandomNodes(number_of_nodes, 20, generator);
+    const auto targets = pickRandomNodes(number_of_nodes, 50, generator);
+    const HierarchyQuery customized_query(number_of_nodes, customized_edges);
+    const HierarchyQuery contracted_query(number_of_nodes, contracted_edges);
+    for (const auto source : sources)
+    {
+        const auto reference = computeReferenceDistances(number_of_nodes, changed_edges, source);
+        const auto customized_forward = customized_query.ForwardSearch(source);
+        const auto contracted_forward = contracted_query.ForwardSearch(source);
+        for (const auto target : targets)
+        {
+            if (source == target)
+            {
+                continue;
+            }
+            const auto customized_distance = HierarchyQuery::Meet(
+                customized_forward, customized_query.BackwardSearch(target));
+            const auto contracted_distance = HierarchyQuery::Meet(
+                contracted_forward, contracted_query.BackwardSearch(target));
+            BOOST_CHECK_EQUAL(customized_distance, reference[target]);
+            BOOST_CHECK_EQUAL(customized_distance, contracted_distance);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(levels_of_other_graph_are_rejected)
+{
+    std::mt19937 generator(7);
+    const auto edges = toDeallocatingVector(makeRandomGraph(10, 20, generator));
+    const std::vector<float> node_levels(5, 0);
+    BOOST_CHECK_THROW(GraphCustomizer(10, node_levels, edges), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,263 @@
+#ifndef UNIT_TESTS_CONTRACTOR_HELPER_HPP
+#define UNIT_TESTS_CONTRACTOR_HELPER_HPP
+
+#include "contractor/query_edge.hpp"
+#include "extractor/edge_based_edge.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace unit_test
+{
+
+using InputEdges = std::vector<extractor::EdgeBasedEdge>;
+
+// Random graph with mostly short range edges, some of them oneway, with loops and parallel
+// edges. Every 50th edge is long range, so that the contraction adds a fair amount of
+// shortcuts.
+inline InputEdges makeRandomGraph(const NodeID number_of_nodes,
+                                  const std::size_t number_of_edges,
+                                  std::mt19937 &generator)
+{
+    InputEdges edges;
+    for (const auto edge_id : util::irange<NodeID>(0, number_of_edges))
+    {
+        const NodeID source = generator() % number_of_nodes;
+        const NodeID target = generator() % 50 == 0
+                                  ? generator() % number_of_nodes
+                                  : (source + generator() % 10) % number_of_nodes;
+        const EdgeWeight weight = 1 + generator() % 100;
+        const bool forward = generator() % 3 != 0;
+        const bool backward = !forward || generator() % 3 != 0;
+        edges.emplace_back(source, target, edge_id, weight, forward, backward);
+    }
+    return edges;
+}
+
+inline util::DeallocatingVector<extractor::EdgeBasedEdge>
+toDeallocatingVector(const InputEdges &edges)
+{
+    util::DeallocatingVector<extractor::EdgeBasedEdge> result;
+    for (const auto &edge : edges)
+    {
+        result.push_back(edge);
+    }
+    return result;
+}
+
+using Adjacency = std::vector<std::vector<std::pair<NodeID, EdgeWeight>>>;
+
+inline std::vector<EdgeWeight> runDijkstra(const Adjacency &adjacency, const NodeID source)
+{
+    std::vector<EdgeWeight> distances(adjacency.size(), INVALID_EDGE_WEIGHT);
+    using QueueEntry = std::pair<EdgeWeight, NodeID>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    distances[source] = 0;
+    queue.push({0, source});
+    while (!queue.empty())
+    {
+        const auto entry = queue.top();
+        queue.pop();
+        if (entry.first > distances[entry.second])
+        {
+            continue;
+        }
+        for (const auto &edge : adjacency[entry.second])
+        {
+            const auto distance = entry.first + edge.second;
+            if (distance < distances[edge.first])
+            {
+                distances[edge.first] = distance;
+                queue.push({distance, edge.first});
+            }
+        }
+    }
+    return distances;
+}
+
+// Distances on the uncontracted graph
+inline std::vector<EdgeWeight> computeReferenceDistances(const NodeID number_of_nodes,
+                                                         const InputEdges &edges,
+                                                         const NodeID source)
+{
+    Adjacency adjacency(number_of_nodes);
+    for (const auto &edge : edges)
+    {
+        if (edge.forward)
+        {
+            adjacency[edge.source].emplace_back(edge.target, std::max<EdgeWeight>(edge.weight, 1));
+        }
+        if (edge.backward)
+        {
+            adjacency[edge.target].emplace_back(edge.source, std::max<EdgeWeight>(edge.weight, 1));
+        }
+    }
+    return runDijkstra(adjacency, source);
+}
+
+// Answers queries on a contracted graph with a full upward search from the source and a full
+// upward search on the backward edges from the target
+class HierarchyQuery
+{
+  public:
+    template <class ContainerT>
+    HierarchyQuery(const NodeID number_of_nodes, const ContainerT &contracted_edges)
+        : forward_adjacency(number_of_nodes), backward_adjacency(number_of_nodes)
+    {
+        for (const auto &edge : contracted_edges)
+        {
+            if (edge.data.forward)
+            {
+                forward_adjacency[edge.source].emplace_back(edge.target, edge.data.distance);
+            }
+            if (edge.data.backward)
+            {
+                backward_adjacency[edge.source].emplace_back(edge.target, edge.data.distance);
+            }
+        }
+    }
+
+    std::vector<EdgeWeight> ForwardSearch(const NodeID source) const
+    {
+        return runDijkstra(forward_adjacency, source);
+    }
+
+    std::vector<EdgeWeight> BackwardSearch(const NodeID target) const
+    {
+        return runDijkstra(backward_adjacency, target);
+    }
+
+    static EdgeWeight Meet(const std::vector<EdgeWeight> &forward,
+                           const std::vector<EdgeWeight> &backward)
+    {
+        EdgeWeight distance = INVALID_EDGE_WEIGHT;
+        for (const auto node : util::irange<std::size_t>(0, forward.size()))
+        {
+            if (forward[node] != INVALID_EDGE_WEIGHT && backward[node] != INVALID_EDGE_WEIGHT)
+            {
+                distance = std::min(distance, forward[node] + backward[node]);
+            }
+        }
+        return distance;
+    }
+
+  private:
+    Adjacency forward_adjacency;
+    Adjacency backward_adjacency;
+};
+
+// Checks the hierarchy against Dijkstra on the input graph for all pairs of the given sources and
+// targets and returns the number of wrong distances
+template <class ContainerT>
+std::size_t countWrongDistances(const NodeID number_of_nodes,
+                                const InputEdges &edges,
+                                const ContainerT &contracted_edges,
+                                const std::vector<NodeID> &sources,
+                                const std::vector<NodeID> &targets)
+{
+    const HierarchyQuery query(number_of_nodes, contracted_edges);
+    std::vector<std::vector<EdgeWeight>> backward_searches;
+    for (const auto target : targets)
+    {
+        backward_searches.push_back(query.BackwardSearch(target));
+    }
+
+    std::size_t wrong_distances = 0;
+    for (const auto source : sources)
+    {
+        const auto reference = computeReferenceDistances(number_of_nodes, edges, source);
+        const auto forward_search = query.ForwardSearch(source);
+        for (const auto index : util::irange<std::size_t>(0, targets.size()))
+        {
+            const auto target = targets[index];
+            if (source != target &&
+                HierarchyQuery::Meet(forward_search, backward_searches[index]) != reference[target])
+            {
+                ++wrong_distances;
+            }
+        }
+    }
+    return wrong_distances;
+}
+
+// Counts the shortcuts that cannot be unpacked into two edges of the hierarchy via their middle
+// node with the same total weight
+template <class ContainerT> std::size_t countInvalidShortcuts(const ContainerT &contracted_edges)
+{
+    // weights of all parallel edges
+    std::map<std::pair<NodeID, NodeID>, std::vector<EdgeWeight>> weights;
+    for (const auto &edge : contracted_edges)
+    {
+        if (edge.data.forward)
+        {
+            weights[{edge.source, edge.target}].push_back(edge.data.distance);
+        }
+        if (edge.data.backward)
+        {
+            weights[{edge.target, edge.source}].push_back(edge.data.distance);
+        }
+    }
+
+    const auto unpacks = [&weights](const NodeID from, const NodeID middle, const NodeID to,
+                                    const EdgeWeight weight) {
+        const auto first = weights.find({from, middle});
+        const auto second = weights.find({middle, to});
+        if (first == weights.end() || second == weights.end())
+        {
+            return false;
+        }
+        for (const auto first_weight : first->second)
+        {
+            for (const auto second_weight : second->second)
+            {
+                if (first_weight + second_weight == weight)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    std::size_t invalid_shortcuts = 0;
+    for (const auto &edge : contracted_edges)
+    {
+        if (!edge.data.shortcut)
+        {
+            continue;
+        }
+        if ((edge.data.forward &&
+             !unpacks(edge.source, edge.data.id, edge.target, edge.data.distance)) ||
+            (edge.data.backward &&
+             !unpacks(edge.target, edge.data.id, edge.source, edge.data.distance)))
+        {
+            ++invalid_shortcuts;
+        }
+    }
+    return invalid_shortcuts;
+}
+
+inline std::vector<NodeID>
+pickRandomNodes(const NodeID number_of_nodes, const std::size_t count, std::mt19937 &generator)
+{
+    std::vector<NodeID> nodes;
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        nodes.push_back(generator() % number_of_nodes);
+    }
+    return nodes;
+}
+}
+}
+
+#endif // UNIT_TESTS_CONTRACTOR_HELPER_HPP
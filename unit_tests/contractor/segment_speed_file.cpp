@@ -0,0 +1,174 @@
+#include "contractor/segment_speed_file.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+const static std::string CSV_TMP_FILE = "test_segment_speeds.csv.tmp";
+const static std::string BINARY_TMP_FILE = "test_segment_speeds.bin.tmp";
+
+BOOST_AUTO_TEST_SUITE(segment_speed_file)
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+namespace
+{
+SegmentSpeedRecord makeRecord(std::uint64_t from, std::uint64_t to, std::uint32_t speed)
+{
+    return SegmentSpeedRecord{OSMNodeID(from), OSMNodeID(to), speed, 0};
+}
+
+void writeCSV(const std::string &filename, const std::string &content)
+{
+    std::ofstream csv_file(filename, std::ios::binary);
+    csv_file << content;
+}
+
+// Entry of the segment index of the contractor, a segment can have several entries
+struct IndexEntry
+{
+    OSMNodeID from;
+    OSMNodeID to;
+    unsigned position;
+};
+}
+
+BOOST_AUTO_TEST_CASE(csv_to_binary_round_trip)
+{
+    writeCSV(CSV_TMP_FILE, "5,6,30\n"
+                           "1,2,50\n"
+                           "18446744073709551615,1,10\n"
+                           "1,3,20\n");
+
+    BOOST_CHECK(!isSegmentSpeedFile(CSV_TMP_FILE));
+    auto records = readSegmentSpeedsFromCSV(CSV_TMP_FILE);
+    BOOST_REQUIRE_EQUAL(records.size(), 4);
+    // in the order of the lines
+    BOOST_CHECK_EQUAL(records[0].from, OSMNodeID(5));
+    BOOST_CHECK_EQUAL(records[2].from, OSMNodeID(18446744073709551615ULL));
+    BOOST_CHECK_EQUAL(records[3].speed, 20);
+
+    sortSegmentSpeeds(records);
+    writeSegmentSpeedFile(BINARY_TMP_FILE, records);
+    BOOST_CHECK(isSegmentSpeedFile(BINARY_TMP_FILE));
+
+    const SegmentSpeedFile speed_file(BINARY_TMP_FILE);
+    BOOST_REQUIRE_EQUAL(speed_file.size(), 4);
+    BOOST_CHECK(std::is_sorted(speed_file.begin(), speed_file.end()));
+
+    const std::vector<SegmentSpeedRecord> expected = {makeRecord(1, 2, 50), makeRecord(1, 3, 20),
+                                                      makeRecord(5, 6, 30),
+                                                      makeRecord(18446744073709551615ULL, 1, 10)};
+    auto record = speed_file.begin();
+    for (const auto &expected_record : expected)
+    {
+        BOOST_CHECK_EQUAL(record->from, expected_record.from);
+        BOOST_CHECK_EQUAL(record->to, expected_record.to);
+        BOOST_CHECK_EQUAL(record->speed, expected_record.speed);
+        ++record;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(malformed_files)
+{
+    writeCSV(CSV_TMP_FILE, "1,2,50\n1,2\n");
+    BOOST_CHECK_THROW(readSegmentSpeedsFromCSV(CSV_TMP_FILE), util::exception);
+
+    writeCSV(CSV_TMP_FILE, "1,2,50 km/h\n");
+    BOOST_CHECK_THROW(readSegmentSpeedsFromCSV(CSV_TMP_FILE), util::exception);
+
+    // the header promises more records than the file holds
+    writeSegmentSpeedFile(BINARY_TMP_FILE, {makeRecord(1, 2, 50), makeRecord(2, 3, 50)});
+    {
+        std::fstream binary_file(BINARY_TMP_FILE,
+                                 std::ios::binary | std::ios::in | std::ios::out);
+        const std::uint64_t number_of_records = 3;
+        binary_file.seekp(sizeof(SEGMENT_SPEED_FILE_MAGIC));
+        binary_file.write(reinterpret_cast<const char *>(&number_of_records),
+                          sizeof(number_of_records));
+    }
+    BOOST_CHECK_THROW(SegmentSpeedFile{BINARY_TMP_FILE}, util::exception);
+
+    // the size of the promised records overflows to the size of one record
+    static_assert(sizeof(SegmentSpeedRecord) % 8 == 0, "record size needs to wrap around");
+    {
+        std::fstream binary_file(BINARY_TMP_FILE,
+                                 std::ios::binary | std::ios::in | std::ios::out);
+        const std::uint64_t number_of_records =
+            (std::numeric_limits<std::uint64_t>::max() / 8) + 2;
+        binary_file.seekp(sizeof(SEGMENT_SPEED_FILE_MAGIC));
+        binary_file.write(reinterpret_cast<const char *>(&number_of_records),
+                          sizeof(number_of_records));
+    }
+    BOOST_CHECK_THROW(SegmentSpeedFile{BINARY_TMP_FILE}, util::exception);
+}
+
+BOOST_AUTO_TEST_CASE(sort_keeps_last_duplicate)
+{
+    std::vector<SegmentSpeedRecord> records = {makeRecord(3, 4, 10), makeRecord(1, 2, 10),
+                                               makeRecord(3, 4, 20), makeRecord(2, 1, 10),
+                                               makeRecord(1, 2, 30), makeRecord(3, 4, 40)};
+    sortSegmentSpeeds(records);
+
+    BOOST_REQUIRE_EQUAL(records.size(), 3);
+    BOOST_CHECK_EQUAL(records[0].from, OSMNodeID(1));
+    BOOST_CHECK_EQUAL(records[0].to, OSMNodeID(2));
+    BOOST_CHECK_EQUAL(records[0].speed, 30);
+    BOOST_CHECK_EQUAL(records[1].from, OSMNodeID(2));
+    BOOST_CHECK_EQUAL(records[1].to, OSMNodeID(1));
+    BOOST_CHECK_EQUAL(records[1].speed, 10);
+    BOOST_CHECK_EQUAL(records[2].from, OSMNodeID(3));
+    BOOST_CHECK_EQUAL(records[2].to, OSMNodeID(4));
+    BOOST_CHECK_EQUAL(records[2].speed, 40);
+}
+
+BOOST_AUTO_TEST_CASE(merge_with_segment_index)
+{
+    // segment 2 -> 3 is part of two geometries
+    const std::vector<IndexEntry> entries = {
+        {OSMNodeID(1), OSMNodeID(2), 0}, {OSMNodeID(2), OSMNodeID(1), 1},
+        {OSMNodeID(2), OSMNodeID(3), 2}, {OSMNodeID(2), OSMNodeID(3), 7},
+        {OSMNodeID(3), OSMNodeID(4), 3}, {OSMNodeID(5), OSMNodeID(6), 4}};
+    // 0 -> 1 and 4 -> 5 are not in the index
+    const std::vector<SegmentSpeedRecord> records = {makeRecord(0, 1, 10), makeRecord(1, 2, 20),
+                                                     makeRecord(2, 3, 30), makeRecord(4, 5, 40),
+                                                     makeRecord(5, 6, 50)};
+
+    std::vector<std::pair<unsigned, std::uint32_t>> applied;
+    mergeSegmentSpeeds(entries.begin(), entries.end(), records.data(),
+                       records.data() + records.size(),
+                       [&](const IndexEntry &entry, const SegmentSpeedRecord &record) {
+                           BOOST_CHECK_EQUAL(entry.from, record.from);
+                           BOOST_CHECK_EQUAL(entry.to, record.to);
+                           applied.emplace_back(entry.position, record.speed);
+                       });
+
+    const std::vector<std::pair<unsigned, std::uint32_t>> expected = {
+        {0, 20}, {2, 30}, {7, 30}, {4, 50}};
+    BOOST_REQUIRE_EQUAL(applied.size(), expected.size());
+    for (std::size_t index = 0; index < expected.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(applied[index].first, expected[index].first);
+        BOOST_CHECK_EQUAL(applied[index].second, expected[index].second);
+    }
+
+    // no records, and records behind the last entry
+    applied.clear();
+    const std::vector<SegmentSpeedRecord> late_records = {makeRecord(9, 9, 10)};
+    mergeSegmentSpeeds(entries.begin(), entries.end(), late_records.data(),
+                       late_records.data() + late_records.size(),
+                       [&](const IndexEntry &entry, const SegmentSpeedRecord &record) {
+                           applied.emplace_back(entry.position, record.speed);
+                       });
+    mergeSegmentSpeeds(entries.begin(), entries.end(), records.data(), records.data(),
+                       [&](const IndexEntry &entry, const SegmentSpeedRecord &record) {
+                           applied.emplace_back(entry.position, record.speed);
+                       });
+    BOOST_CHECK(applied.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,458 @@
+#include "engine/routing_algorithms/routing_base.hpp"
+#include "contractor/core_landmarks.hpp"
+#include "contractor/graph_contractor.hpp"
+#include "engine/search_engine_data.hpp"
+#include "extractor/edge_based_edge.hpp"
+#include "util/integer_range.hpp"
+#include "util/landmark_table.hpp"
+#include "util/static_graph.hpp"
+
+#include "mocks/mock_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+const static std::string LANDMARKS_TMP_FILE = "test_core_search.landmarks.tmp";
+
+BOOST_AUTO_TEST_SUITE(core_search)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+using EdgeData = contractor::QueryEdge::EdgeData;
+using QueryGraph = util::StaticGraph<EdgeData>;
+using InputEdges = std::vector<extractor::EdgeBasedEdge>;
+using EntryPoints = std::vector<std::pair<NodeID, EdgeWeight>>;
+
+// Contracted graph with a core, the landmarks can be switched off to get the plain core search
+class CoreFacade final : public test::MockDataFacade
+{
+  public:
+    CoreFacade(const NodeID number_of_nodes,
+               const std::vector<QueryGraph::InputEdge> &edges,
+               std::vector<bool> is_core_node_,
+               util::LandmarkTable<false> landmarks_)
+        : graph(number_of_nodes, edges), is_core_node(std::move(is_core_node_)),
+          landmarks(std::move(landmarks_)), use_landmarks(true)
+    {
+    }
+
+    unsigned GetNumberOfNodes() const override { return graph.GetNumberOfNodes(); }
+    unsigned GetNumberOfEdges() const override { return graph.GetNumberOfEdges(); }
+    unsigned GetOutDegree(const NodeID n) const override { return graph.GetOutDegree(n); }
+    NodeID GetTarget(const EdgeID e) const override { return graph.GetTarget(e); }
+    const EdgeData &GetEdgeData(const EdgeID e) const override { return graph.GetEdgeData(e); }
+    EdgeID BeginEdges(const NodeID n) const override { return graph.BeginEdges(n); }
+    EdgeID EndEdges(const NodeID n) const override { return graph.EndEdges(n); }
+    datafacade::EdgeRange GetAdjacentEdgeRange(const NodeID node) const override
+    {
+        return graph.GetAdjacentEdgeRange(node);
+    }
+
+    bool IsCoreNode(const NodeID id) const override { return is_core_node[id]; }
+    std::size_t GetCoreSize() const override
+    {
+        return std::count(is_core_node.begin(), is_core_node.end(), true);
+    }
+    unsigned GetNumberOfLandmarks() const override
+    {
+        return use_landmarks ? landmarks.GetNumberOfLandmarks() : 0;
+    }
+    const EdgeWeight *GetLandmarkDistances(const NodeID id) const override
+    {
+        return landmarks.GetDistances(id);
+    }
+
+    void UseLandmarks(const bool use_landmarks_) { use_landmarks = use_landmarks_; }
+
+  private:
+    QueryGraph graph;
+    std::vector<bool> is_core_node;
+    util::LandmarkTable<false> landmarks;
+    bool use_landmarks;
+};
+
+struct CoreRouter final
+    : public routing_algorithms::BasicRoutingInterface<datafacade::BaseDataFacade, CoreRouter>
+{
+    explicit CoreRouter(datafacade::BaseDataFacade *facade) : BasicRoutingInterface(facade) {}
+};
+
+// Grid of side x side nodes with some missing and some oneway edges, and a separate ring of
+// ring_size nodes behind it that can not be reached from the grid
+InputEdges makeInput(const NodeID side, const NodeID ring_size, std::mt19937 &generator)
+{
+    InputEdges edges;
+    const NodeID grid_size = side * side;
+    for (const auto node : util::irange<NodeID>(0, grid_size))
+    {
+        for (const auto neighbour : {node + 1, node + side})
+        {
+            if ((neighbour == node + 1 && neighbour % side == 0) || neighbour >= grid_size ||
+                generator() % 10 == 0)
+            {
+                continue;
+            }
+            const bool forward = generator() % 3 != 0;
+            const bool backward = !forward || generator() % 3 != 0;
+            edges.emplace_back(node, neighbour, edges.size(), 1 + generator() % 100, forward,
+                               backward);
+        }
+    }
+    for (const auto index : util::irange<NodeID>(0, ring_size))
+    {
+        edges.emplace_back(grid_size + index, grid_size + (index + 1) % ring_size, edges.size(),
+                           1 + generator() % 100, true, false);
+    }
+    return edges;
+}
+
+std::vector<EdgeWeight>
+runDijkstra(const NodeID number_of_nodes, const InputEdges &edges, const NodeID source)
+{
+    std::vector<std::vector<std::pair<NodeID, EdgeWeight>>> adjacency(number_of_nodes);
+    for (const auto &edge : edges)
+    {
+        if (edge.forward)
+        {
+            adjacency[edge.source].emplace_back(edge.target, edge.weight);
+        }
+        if (edge.backward)
+        {
+            adjacency[edge.target].emplace_back(edge.source, edge.weight);
+        }
+    }
+
+    using QueueEntry = std::pair<EdgeWeight, NodeID>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    std::vector<EdgeWeight> distances(number_of_nodes, INVALID_EDGE_WEIGHT);
+    distances[source] = 0;
+    queue.emplace(0, source);
+    while (!queue.empty())
+    {
+        const auto entry = queue.top();
+        queue.pop();
+        if (entry.first > distances[entry.second])
+        {
+            continue;
+        }
+        for (const auto &arc : adjacency[entry.second])
+        {
+            if (entry.first + arc.second < distances[arc.first])
+            {
+                distances[arc.first] = entry.first + arc.second;
+                queue.emplace(distances[arc.first], arc.first);
+            }
+        }
+    }
+    return distances;
+}
+
+// Length of the shortest loop through the node
+EdgeWeight getShortestLoop(const NodeID number_of_nodes, const InputEdges &edges, const NodeID node)
+{
+    EdgeWeight loop = INVALID_EDGE_WEIGHT;
+    for (const auto &edge : edges)
+    {
+        if ((edge.forward && edge.source == node) || (edge.backward && edge.target == node))
+        {
+            const auto neighbour = edge.source == node ? edge.target : edge.source;
+            const auto distance = runDijkstra(number_of_nodes, edges, neighbour)[node];
+            if (distance != INVALID_EDGE_WEIGHT)
+            {
+                loop = std::min(loop, edge.weight + distance);
+            }
+        }
+    }
+    return loop;
+}
+
+// Weight of the packed path including the offsets of its first and last node, or
+// INVALID_EDGE_WEIGHT if two consecutive nodes are not connected
+EdgeWeight getPackedPathWeight(const CoreFacade &facade,
+                               const std::vector<NodeID> &packed_leg,
+                               const EntryPoints &sources,
+                               const EntryPoints &targets)
+{
+    const auto offset = [](const EntryPoints &entry_points, const NodeID node) {
+        const auto entry_point =
+            std::find_if(entry_points.begin(), entry_points.end(),
+                         [node](const std::pair<NodeID, EdgeWeight> &p) { return p.first == node; });
+        return entry_point == entry_points.end() ? INVALID_EDGE_WEIGHT : entry_point->second;
+    };
+    const auto source_offset = offset(sources, packed_leg.front());
+    const auto target_offset = offset(targets, packed_leg.back());
+    if (source_offset == INVALID_EDGE_WEIGHT || target_offset == INVALID_EDGE_WEIGHT)
+    {
+        return INVALID_EDGE_WEIGHT;
+    }
+
+    EdgeWeight weight = source_offset + target_offset;
+    for (const auto index : util::irange<std::size_t>(1, packed_leg.size()))
+    {
+        const auto from = packed_leg[index - 1];
+        const auto to = packed_leg[index];
+        EdgeWeight edge_weight = INVALID_EDGE_WEIGHT;
+        for (const auto edge : facade.GetAdjacentEdgeRange(from))
+        {
+            if (facade.GetTarget(edge) == to && facade.GetEdgeData(edge).forward)
+            {
+                edge_weight = std::min(edge_weight, facade.GetEdgeData(edge).distance);
+            }
+        }
+        for (const auto edge : facade.GetAdjacentEdgeRange(to))
+        {
+            if (facade.GetTarget(edge) == from && facade.GetEdgeData(edge).backward)
+            {
+                edge_weight = std::min(edge_weight, facade.GetEdgeData(edge).distance);
+            }
+        }
+        if (edge_weight == INVALID_EDGE_WEIGHT)
+        {
+            return INVALID_EDGE_WEIGHT;
+        }
+        weight += edge_weight;
+    }
+    return weight;
+}
+
+struct CoreSearchFixture
+{
+    CoreSearchFixture()
+        : generator(23), side(20), number_of_nodes(side * side + 10),
+          edges(makeInput(side, 10, generator)), forward_heap(number_of_nodes),
+          reverse_heap(number_of_nodes), forward_core_heap(number_of_nodes),
+          reverse_core_heap(number_of_nodes)
+    {
+        util::DeallocatingVector<extractor::EdgeBasedEdge> edge_list;
+        for (const auto &edge : edges)
+        {
+            edge_list.push_back(edge);
+        }
+        contractor::GraphContractor graph_contractor(number_of_nodes, edge_list, {},
+                                                     std::vector<EdgeWeight>(number_of_nodes, 0));
+        graph_contractor.Run(0.5);
+        util::DeallocatingVector<contractor::QueryEdge> contracted_edges;
+        graph_contractor.GetEdges(contracted_edges);
+        std::vector<bool> is_core_node;
+        graph_contractor.GetCoreMarker(is_core_node);
+
+        contractor::CoreLandmarks core_landmarks(is_core_node, contracted_edges);
+        core_landmarks.Compute(8);
+        core_landmarks.Write(LANDMARKS_TMP_FILE);
+
+        std::vector<QueryGraph::InputEdge> graph_edges;
+        for (const auto &edge : contracted_edges)
+        {
+            graph_edges.push_back(QueryGraph::InputEdge{edge.source, edge.target, edge.data});
+        }
+        std::sort(graph_edges.begin(), graph_edges.end());
+        facade.reset(new CoreFacade(number_of_nodes, graph_edges, std::move(is_core_node),
+                                    util::readLandmarkTable(LANDMARKS_TMP_FILE, number_of_nodes)));
+        router.reset(new CoreRouter(facade.get()));
+    }
+
+    // Returns the distance found with the landmarks and checks it against the plain search
+    EdgeWeight Search(const EntryPoints &sources,
+                      const EntryPoints &targets,
+                      const bool force_loop_forward,
+                      const bool force_loop_reverse)
+    {
+        EdgeWeight distances[2];
+        for (const bool use_landmarks : {true, false})
+        {
+            facade->UseLandmarks(use_landmarks);
+            forward_heap.Clear();
+            reverse_heap.Clear();
+            for (const auto &source : sources)
+            {
+                forward_heap.Insert(source.first, source.second, source.first);
+            }
+            for (const auto &target : targets)
+            {
+                reverse_heap.Insert(target.first, target.second, target.first);
+            }
+
+            EdgeWeight distance = INVALID_EDGE_WEIGHT;
+            std::vector<NodeID> packed_leg;
+            router->SearchWithCore(forward_heap, reverse_heap, forward_core_heap,
+                                   reverse_core_heap, distance, packed_leg, force_loop_forward,
+                                   force_loop_reverse);
+            if (distance != INVALID_EDGE_WEIGHT)
+            {
+                BOOST_REQUIRE(!packed_leg.empty());
+                BOOST_CHECK_EQUAL(getPackedPathWeight(*facade, packed_leg, sources, targets),
+                                  distance);
+            }
+            distances[use_landmarks ? 0 : 1] = distance;
+        }
+        BOOST_CHECK_EQUAL(distances[0], distances[1]);
+        return distances[0];
+    }
+
+    std::mt19937 generator;
+    const NodeID side;
+    const NodeID number_of_nodes;
+    const InputEdges edges;
+    SearchEngineData::QueryHeap forward_heap;
+    SearchEngineData::QueryHeap reverse_heap;
+    SearchEngineData::QueryHeap forward_core_heap;
+    SearchEngineData::QueryHeap reverse_core_heap;
+    std::unique_ptr<CoreFacade> facade;
+    std::unique_ptr<CoreRouter> router;
+};
+}
+
+BOOST_FIXTURE_TEST_CASE(landmarks_are_used, CoreSearchFixture)
+{
+    BOOST_CHECK_GT(facade->GetCoreSize(), 0);
+    BOOST_CHECK_EQUAL(util::readLandmarkTable(LANDMARKS_TMP_FILE, number_of_nodes)
+                          .GetNumberOfLandmarks(),
+                      8);
+}
+
+BOOST_FIXTURE_TEST_CASE(single_pairs_match_dijkstra, CoreSearchFixture)
+{
+    std::size_t unreachable_pairs = 0;
+    for (std::size_t query = 0; query < 200; ++query)
+    {
+        const NodeID source = generator() % number_of_nodes;
+        const NodeID target = generator() % number_of_nodes;
+        if (source == target)
+        {
+            continue;
+        }
+        const auto reference = runDijkstra(number_of_nodes, edges, source)[target];
+        BOOST_CHECK_EQUAL(Search({{source, 0}}, {{target, 0}}, false, false), reference);
+        unreachable_pairs += reference == INVALID_EDGE_WEIGHT;
+    }
+    // the ring can not be reached from the grid
+    BOOST_CHECK_GT(unreachable_pairs, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(phantom_offsets_match_dijkstra, CoreSearchFixture)
+{
+    for (std::size_t query = 0; query < 200; ++query)
+    {
+        // like the two directions of the segments of phantom nodes, the forward offsets of the
+        // source are negative
+        const EntryPoints sources = {{generator() % number_of_nodes, -(generator() % 50)},
+                                     {generator() % number_of_nodes, -(generator() % 50)}};
+        const EntryPoints targets = {{generator() % number_of_nodes, generator() % 50},
+                                     {generator() % number_of_nodes, generator() % 50}};
+        if (sources[0].first == sources[1].first || targets[0].first == targets[1].first)
+        {
+            continue;
+        }
+
+        EdgeWeight reference = INVALID_EDGE_WEIGHT;
+        bool negative_path = false;
+        for (const auto &source : sources)
+        {
+            const auto distances = runDijkstra(number_of_nodes, edges, source.first);
+            for (const auto &target : targets)
+            {
+                if (distances[target.first] != INVALID_EDGE_WEIGHT)
+                {
+                    const auto length = source.second + distances[target.first] + target.second;
+                    negative_path = negative_path || length < 0;
+                    reference = std::min(reference, length);
+                }
+            }
+        }
+
+        const auto distance = Search(sources, targets, false, false);
+        // the search only takes paths of a negative length if they form a loop
+        if (!negative_path)
+        {
+            BOOST_CHECK_EQUAL(distance, reference);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(negative_offsets_on_the_core_match_dijkstra, CoreSearchFixture)
+{
+    std::vector<NodeID> core_nodes;
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        if (facade->IsCoreNode(node))
+        {
+            core_nodes.push_back(node);
+        }
+    }
+    BOOST_REQUIRE_GT(core_nodes.size(), 2);
+
+    for (std::size_t query = 0; query < 200; ++query)
+    {
+        // the entry points are the phantom nodes themselves, so the core search starts with
+        // negative source offsets that are larger than the edge weights. The target offsets
+        // keep every path at a non-negative length.
+        const EntryPoints sources = {
+            {core_nodes[generator() % core_nodes.size()], -(generator() % 500)},
+            {core_nodes[generator() % core_nodes.size()], -(generator() % 500)}};
+        const EntryPoints targets = {
+            {core_nodes[generator() % core_nodes.size()], 500 + generator() % 500},
+            {core_nodes[generator() % core_nodes.size()], 500 + generator() % 500}};
+        if (sources[0].first == sources[1].first || targets[0].first == targets[1].first)
+        {
+            continue;
+        }
+
+        EdgeWeight reference = INVALID_EDGE_WEIGHT;
+        for (const auto &source : sources)
+        {
+            const auto distances = runDijkstra(number_of_nodes, edges, source.first);
+            for (const auto &target : targets)
+            {
+                if (distances[target.first] != INVALID_EDGE_WEIGHT)
+                {
+                    reference = std::min(reference,
+                                         source.second + distances[target.first] + target.second);
+                }
+            }
+        }
+
+        BOOST_CHECK_EQUAL(Search(sources, targets, false, false), reference);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(forced_loops, CoreSearchFixture)
+{
+    std::size_t loops = 0;
+    for (std::size_t query = 0; query < 200; ++query)
+    {
+        // source and target on the same segment, the target before the source
+        const NodeID node = generator() % number_of_nodes;
+        const EdgeWeight source_offset = generator() % 50;
+        const EdgeWeight target_offset = generator() % 50;
+        const bool force_loop_forward = generator() % 2 == 0;
+        const bool force_loop_reverse = !force_loop_forward || generator() % 2 == 0;
+
+        const auto distance = Search({{node, -source_offset}}, {{node, target_offset}},
+                                     force_loop_forward, force_loop_reverse);
+        const auto shortest_loop = getShortestLoop(number_of_nodes, edges, node);
+        if (shortest_loop == INVALID_EDGE_WEIGHT)
+        {
+            BOOST_CHECK_EQUAL(distance, INVALID_EDGE_WEIGHT);
+        }
+        else if (distance != INVALID_EDGE_WEIGHT)
+        {
+            // the hierarchy can miss the shortest loop, but never finds a shorter one
+            BOOST_CHECK_GE(distance, shortest_loop - source_offset + target_offset);
+            ++loops;
+        }
+    }
+    BOOST_CHECK_GT(loops, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,123 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "contractor/query_edge.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/coordinate.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/integer_range.hpp"
+#include "util/static_graph.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(many_to_many)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+using EdgeData = contractor::QueryEdge::EdgeData;
+
+// Straight road N0 - N1 - N2 - N3 along the equator, split into the one way segments
+// A = (N0, N1), B = (N1, N2) and C = (N2, N3). The geometry of segment X has id X.
+// Contracted in the order B, A, C, which adds the shortcut A -> C.
+const NodeID A = 0, B = 1, C = 2;
+
+struct TestFacade : public util::StaticGraph<EdgeData>
+{
+    using util::StaticGraph<EdgeData>::StaticGraph;
+
+    // original edges get the id of the segment they leave
+    unsigned GetGeometryIndexForEdgeID(const unsigned id) const { return id; }
+
+    void GetUncompressedGeometry(const EdgeID id, std::vector<NodeID> &result_nodes) const
+    {
+        result_nodes = {id + 1};
+    }
+
+    util::Coordinate GetCoordinateOfNode(const unsigned id) const { return makeCoordinate(id); }
+
+    static util::Coordinate makeCoordinate(const double node_position)
+    {
+        return {util::FloatLongitude(0.01 * node_position), util::FloatLatitude(0)};
+    }
+};
+
+TestFacade makeFacade()
+{
+    const auto make_edge = [](NodeID source, NodeID target, EdgeWeight distance, unsigned id,
+                              bool forward, bool backward, bool shortcut) {
+        EdgeData data;
+        data.id = id;
+        data.distance = distance;
+        data.forward = forward;
+        data.backward = backward;
+        data.shortcut = shortcut;
+        return TestFacade::InputEdge{source, target, data};
+    };
+    std::vector<TestFacade::InputEdge> edges = {make_edge(A, C, 20, B, true, false, true),
+                                                make_edge(B, A, 10, A, false, true, false),
+                                                make_edge(B, C, 10, B, true, false, false)};
+    return TestFacade(3, edges);
+}
+
+// Phantom node at the fraction of the segment
+PhantomNode makePhantom(const NodeID segment, const double fraction)
+{
+    PhantomNode phantom;
+    phantom.forward_segment_id = {segment, true};
+    phantom.forward_weight = static_cast<int>(10 * fraction);
+    phantom.forward_offset = 0;
+    phantom.forward_packed_geometry_id = segment;
+    phantom.fwd_segment_position = 0;
+    phantom.location = TestFacade::makeCoordinate(segment + fraction);
+    return phantom;
+}
+}
+
+BOOST_AUTO_TEST_CASE(distances_follow_unpacked_geometry)
+{
+    auto facade = makeFacade();
+    SearchEngineData heaps;
+    routing_algorithms::ManyToManyRouting<TestFacade> many_to_many(&facade, heaps);
+
+    const std::vector<PhantomNode> phantoms = {makePhantom(A, 0.5), makePhantom(B, 0.2),
+                                               makePhantom(B, 0.8), makePhantom(C, 0.5)};
+    std::vector<double> distances;
+    const auto durations = many_to_many(phantoms, {0, 1}, {2, 3}, distances);
+
+    BOOST_REQUIRE_EQUAL(distances.size(), 4);
+    const std::vector<EdgeWeight> reference_durations = {13, 20, 6, 13};
+    BOOST_CHECK_EQUAL_COLLECTIONS(durations.begin(), durations.end(),
+                                  reference_durations.begin(), reference_durations.end());
+
+    // all locations are on one straight line, so the path length is the direct distance
+    const std::vector<std::pair<std::size_t, std::size_t>> entries = {{0, 2}, {0, 3}, {1, 2},
+                                                                      {1, 3}};
+    for (const auto index : util::irange<std::size_t>(0UL, entries.size()))
+    {
+        const auto direct_distance = util::coordinate_calculation::haversineDistance(
+            phantoms[entries[index].first].location, phantoms[entries[index].second].location);
+        BOOST_CHECK_CLOSE(distances[index], direct_distance, 0.01);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(distances_of_unreachable_entries)
+{
+    auto facade = makeFacade();
+    SearchEngineData heaps;
+    routing_algorithms::ManyToManyRouting<TestFacade> many_to_many(&facade, heaps);
+
+    const std::vector<PhantomNode> phantoms = {makePhantom(C, 0.5), makePhantom(A, 0.5)};
+    std::vector<double> distances;
+    const auto durations = many_to_many(phantoms, {0}, {1}, distances);
+
+    BOOST_REQUIRE_EQUAL(durations.size(), 1);
+    BOOST_CHECK_EQUAL(durations.front(), INVALID_EDGE_WEIGHT);
+    BOOST_CHECK_EQUAL(distances.front(), 0.);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,244 @@
+#include "engine/routing_algorithms/one_to_many.hpp"
+#include "contractor/query_edge.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/integer_range.hpp"
+#include "util/static_graph.hpp"
+
+#include "mocks/mock_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(one_to_many)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+using EdgeData = contractor::QueryEdge::EdgeData;
+
+using QueryGraph = util::StaticGraph<EdgeData>;
+
+// Contracted graph behind the data facade interface, the tables fall back to ManyToManyRouting
+class TestFacade final : public test::MockDataFacade
+{
+  public:
+    using InputEdge = QueryGraph::InputEdge;
+
+    TestFacade(const NodeID number_of_nodes, const std::vector<InputEdge> &edges)
+        : graph(number_of_nodes, edges)
+    {
+    }
+
+    unsigned GetNumberOfNodes() const override { return graph.GetNumberOfNodes(); }
+    unsigned GetNumberOfEdges() const override { return graph.GetNumberOfEdges(); }
+    unsigned GetOutDegree(const NodeID n) const override { return graph.GetOutDegree(n); }
+    NodeID GetTarget(const EdgeID e) const override { return graph.GetTarget(e); }
+    const EdgeData &GetEdgeData(const EdgeID e) const override { return graph.GetEdgeData(e); }
+    EdgeID BeginEdges(const NodeID n) const override { return graph.BeginEdges(n); }
+    EdgeID EndEdges(const NodeID n) const override { return graph.EndEdges(n); }
+    datafacade::EdgeRange GetAdjacentEdgeRange(const NodeID node) const override
+    {
+        return graph.GetAdjacentEdgeRange(node);
+    }
+
+  private:
+    QueryGraph graph;
+};
+
+TestFacade::InputEdge makeEdge(NodeID source,
+                               NodeID target,
+                               EdgeWeight distance,
+                               bool forward,
+                               bool backward,
+                               bool shortcut = false)
+{
+    EdgeData data;
+    data.id = 0;
+    data.distance = distance;
+    data.forward = forward;
+    data.backward = backward;
+    data.shortcut = shortcut;
+    return {source, target, data};
+}
+
+PhantomNode makeSource(NodeID node)
+{
+    PhantomNode phantom;
+    phantom.forward_segment_id = {node, true};
+    phantom.forward_weight = 0;
+    phantom.forward_offset = 0;
+    return phantom;
+}
+
+// Phantom node on the segment of forward_node in one and of reverse_node in the other direction
+PhantomNode makePhantom(NodeID forward_node,
+                        EdgeWeight forward_weight,
+                        EdgeWeight forward_offset,
+                        NodeID reverse_node,
+                        EdgeWeight reverse_weight,
+                        EdgeWeight reverse_offset)
+{
+    PhantomNode phantom;
+    phantom.forward_segment_id = {forward_node, true};
+    phantom.forward_weight = forward_weight;
+    phantom.forward_offset = forward_offset;
+    phantom.reverse_segment_id = {reverse_node, reverse_node != SPECIAL_NODEID};
+    phantom.reverse_weight = reverse_weight;
+    phantom.reverse_offset = reverse_offset;
+    return phantom;
+}
+
+// Block s -> x -> y -> s, contracted in the order x, s, y. Contracting x adds the shortcut s -> y.
+const NodeID x = 0, s = 1, y = 2;
+std::vector<TestFacade::InputEdge> makeBlock()
+{
+    return {makeEdge(x, s, 10, false, true), makeEdge(x, y, 10, true, false),
+            makeEdge(s, y, 20, true, false, true), makeEdge(s, y, 10, false, true)};
+}
+}
+
+BOOST_AUTO_TEST_CASE(phast_sweep_on_contracted_line)
+{
+    // Line a - b - c - d with weights 10, 20 and 30, contracted in the order b, d, a, c.
+    // Contracting b adds the shortcut a - c, every edge is stored at its lower node.
+    const NodeID a = 0, b = 1, c = 2, d = 3;
+    std::vector<TestFacade::InputEdge> edges = {
+        makeEdge(a, c, 30, true, true, true), makeEdge(b, a, 10, true, true),
+        makeEdge(b, c, 20, true, true), makeEdge(d, c, 30, true, true)};
+    TestFacade facade(4, edges);
+
+    SearchEngineData heaps;
+    routing_algorithms::OneToManyRouting<TestFacade> one_to_many(&facade, heaps);
+
+    const auto distances_from_d = one_to_many(makeSource(d));
+    BOOST_CHECK_EQUAL(distances_from_d[a], 60);
+    BOOST_CHECK_EQUAL(distances_from_d[b], 50);
+    BOOST_CHECK_EQUAL(distances_from_d[c], 30);
+    BOOST_CHECK_EQUAL(distances_from_d[d], 0);
+
+    const auto distances_from_b = one_to_many(makeSource(b));
+    BOOST_CHECK_EQUAL(distances_from_b[a], 10);
+    BOOST_CHECK_EQUAL(distances_from_b[b], 0);
+    BOOST_CHECK_EQUAL(distances_from_b[c], 20);
+    BOOST_CHECK_EQUAL(distances_from_b[d], 50);
+}
+
+BOOST_AUTO_TEST_CASE(phast_sweep_respects_oneways)
+{
+    // a -> b -> c, contracted in the order b, a, c
+    const NodeID a = 0, b = 1, c = 2;
+    std::vector<TestFacade::InputEdge> edges = {makeEdge(a, c, 3, true, false, true),
+                                                makeEdge(b, a, 1, false, true),
+                                                makeEdge(b, c, 2, true, false)};
+    TestFacade facade(3, edges);
+
+    SearchEngineData heaps;
+    routing_algorithms::OneToManyRouting<TestFacade> one_to_many(&facade, heaps);
+
+    const auto distances_from_a = one_to_many(makeSource(a));
+    BOOST_CHECK_EQUAL(distances_from_a[a], 0);
+    BOOST_CHECK_EQUAL(distances_from_a[b], 1);
+    BOOST_CHECK_EQUAL(distances_from_a[c], 3);
+
+    const auto distances_from_c = one_to_many(makeSource(c));
+    BOOST_CHECK_EQUAL(distances_from_c[a], INVALID_EDGE_WEIGHT);
+    BOOST_CHECK_EQUAL(distances_from_c[b], INVALID_EDGE_WEIGHT);
+    BOOST_CHECK_EQUAL(distances_from_c[c], 0);
+}
+
+BOOST_AUTO_TEST_CASE(rphast_table_matches_sweep)
+{
+    // Same hierarchy as above, more sources than fit into one sweep
+    const NodeID a = 0, b = 1, c = 2, d = 3;
+    std::vector<TestFacade::InputEdge> edges = {
+        makeEdge(a, c, 30, true, true, true), makeEdge(b, a, 10, true, true),
+        makeEdge(b, c, 20, true, true), makeEdge(d, c, 30, true, true)};
+    TestFacade facade(4, edges);
+
+    SearchEngineData heaps;
+    routing_algorithms::OneToManyRouting<TestFacade> one_to_many(&facade, heaps);
+
+    const std::vector<PhantomNode> phantoms = {makeSource(a), makeSource(b), makeSource(c),
+                                               makeSource(d)};
+    const std::vector<std::size_t> sources = {0, 1, 2, 3, 3, 2, 1, 0, 1};
+    const std::vector<std::size_t> targets = {3, 0};
+    const auto table = one_to_many(phantoms, sources, targets);
+    BOOST_REQUIRE_EQUAL(table.size(), sources.size() * targets.size());
+
+    for (const auto row : util::irange<std::size_t>(0UL, sources.size()))
+    {
+        const auto distances = one_to_many(phantoms[sources[row]]);
+        for (const auto column : util::irange<std::size_t>(0UL, targets.size()))
+        {
+            BOOST_CHECK_EQUAL(table[row * targets.size() + column], distances[targets[column]]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rphast_table_respects_oneways)
+{
+    // a -> b -> c, contracted in the order b, a, c
+    const NodeID a = 0, b = 1, c = 2;
+    std::vector<TestFacade::InputEdge> edges = {makeEdge(a, c, 3, true, false, true),
+                                                makeEdge(b, a, 1, false, true),
+                                                makeEdge(b, c, 2, true, false)};
+    TestFacade facade(3, edges);
+
+    SearchEngineData heaps;
+    routing_algorithms::OneToManyRouting<TestFacade> one_to_many(&facade, heaps);
+
+    const std::vector<PhantomNode> phantoms = {makeSource(a), makeSource(b), makeSource(c)};
+    const auto table = one_to_many(phantoms, {}, {});
+    const std::vector<EdgeWeight> reference = {
+        0, 1, 3, INVALID_EDGE_WEIGHT, 0, 2, INVALID_EDGE_WEIGHT, INVALID_EDGE_WEIGHT, 0};
+    BOOST_CHECK_EQUAL_COLLECTIONS(table.begin(), table.end(), reference.begin(), reference.end());
+}
+
+BOOST_AUTO_TEST_CASE(rphast_table_goes_around_the_block)
+{
+    TestFacade facade(3, makeBlock());
+    SearchEngineData heaps;
+    routing_algorithms::OneToManyRouting<TestFacade> one_to_many(&facade, heaps);
+    routing_algorithms::ManyToManyRouting<TestFacade> many_to_many(&facade, heaps);
+
+    // The source lies behind the target on the segment of s and there is no loop at s, so the
+    // path leaves s and comes back over x and y: -(5 + 3) + 10 + 10 + 10 + 3
+    const std::vector<PhantomNode> phantoms = {makePhantom(s, 5, 3, SPECIAL_NODEID, 0, 0),
+                                               makePhantom(s, 0, 3, SPECIAL_NODEID, 0, 0)};
+    const auto table = one_to_many(phantoms, {0}, {1});
+    BOOST_REQUIRE_EQUAL(table.size(), 1);
+    BOOST_CHECK_EQUAL(table.front(), 25);
+    BOOST_CHECK_EQUAL(table.front(), many_to_many(phantoms, {0}, {1}).front());
+}
+
+BOOST_AUTO_TEST_CASE(rphast_table_matches_many_to_many_with_offsets)
+{
+    TestFacade facade(3, makeBlock());
+    SearchEngineData heaps;
+    routing_algorithms::OneToManyRouting<TestFacade> one_to_many(&facade, heaps);
+    routing_algorithms::ManyToManyRouting<TestFacade> many_to_many(&facade, heaps);
+
+    // phantoms on the segment of s in forward and the segment of y in reverse direction, with
+    // every order of their offsets in both directions
+    std::vector<PhantomNode> phantoms;
+    for (const EdgeWeight forward_offset : {0, 2, 4, 6})
+    {
+        for (const EdgeWeight reverse_offset : {1, 3, 5})
+        {
+            phantoms.push_back(makePhantom(s, 2, forward_offset, y, 1, reverse_offset));
+        }
+    }
+    phantoms.push_back(makePhantom(x, 4, 1, SPECIAL_NODEID, 0, 0));
+
+    const auto table = one_to_many(phantoms, {}, {});
+    const auto reference = many_to_many(phantoms, {}, {});
+    BOOST_CHECK_EQUAL_COLLECTIONS(table.begin(), table.end(), reference.begin(), reference.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,372 @@
+#include "extractor/extraction_node.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/profile_plugin_library.hpp"
+#include "extractor/scripting_environment.hpp"
+#include "util/integer_range.hpp"
+#include "util/lua_util.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/osm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// src/profiles/car.cpp is a port of profiles/car.lua, both have to give the same results
+BOOST_AUTO_TEST_SUITE(car_profile)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+using Tags = std::map<std::string, std::string>;
+
+const constexpr char CAR_PROFILE_SCRIPT[] = "../profiles/car.lua";
+
+// Tags that the car profile reads, each variant on its own and in random combinations with
+// others on top of every highway type
+const std::vector<Tags> way_variants = {
+    {},
+    {{"maxspeed", "30"}},
+    {{"maxspeed", "120"}},
+    {{"maxspeed", "50 mph"}},
+    {{"maxspeed", "60mp/h"}},
+    {{"maxspeed", "DE:urban"}},
+    {{"maxspeed", "FR:rural"}},
+    {{"maxspeed", "ch:motorway"}},
+    {{"maxspeed", "GB:nsl_dual"}},
+    {{"maxspeed", "RU:living_street"}},
+    {{"maxspeed", "xx:trunk"}},
+    {{"maxspeed", "none"}},
+    {{"maxspeed", "signals"}},
+    {{"maxspeed", "0"}},
+    {{"oneway", "yes"}},
+    {{"oneway", "1"}},
+    {{"oneway", "true"}},
+    {{"oneway", "-1"}},
+    {{"oneway", "no"}},
+    {{"oneway", "reversible"}},
+    {{"access", "no"}},
+    {{"access", "private"}},
+    {{"access", "yes"}},
+    {{"access", "permissive"}},
+    {{"access", "destination"}},
+    {{"access", "delivery"}},
+    {{"access", "agricultural"}},
+    {{"access", "no"}, {"motorcar", "yes"}},
+    {{"motor_vehicle", "no"}},
+    {{"motor_vehicle", "designated"}},
+    {{"vehicle", "destination"}, {"motorcar", "private"}},
+    {{"name", "Main Street"}},
+    {{"ref", "A 1"}},
+    {{"name", "Main Street"}, {"ref", "A 1"}},
+    {{"name", "Main Street"}, {"destination", "Berlin;Hamburg"}},
+    {{"name", "Main Street"}, {"destination:ref", "A 7"}, {"destination", "Kiel"}},
+    {{"junction", "roundabout"}},
+    {{"service", "parking_aisle"}},
+    {{"service", "driveway"}},
+    {{"surface", "gravel"}},
+    {{"surface", "asphalt"}},
+    {{"surface", "mud"}},
+    {{"tracktype", "grade3"}},
+    {{"smoothness", "horrible"}},
+    {{"side_road", "yes"}},
+    {{"side_road", "rotary"}},
+    {{"area", "yes"}},
+    {{"impassable", "yes"}},
+    {{"status", "impassable"}},
+    {{"route", "ferry"}},
+    {{"route", "ferry"}, {"duration", "00:30"}},
+    {{"route", "ferry"}, {"duration", "1:15:00"}},
+    {{"route", "ferry"}, {"duration", "PT1H30M"}},
+    {{"route", "ferry"}, {"duration", "soon"}},
+    {{"route", "shuttle_train"}, {"duration", "00:40"}},
+    {{"route", "hiking"}},
+    {{"bridge", "movable"}},
+    {{"bridge", "movable"}, {"duration", "00:05"}},
+    {{"bridge", "movable"}, {"capacity:car", "0"}},
+    {{"bridge", "yes"}},
+    {{"maxspeed:forward", "80"}},
+    {{"maxspeed:backward", "30"}},
+    {{"maxspeed:forward", "70"}, {"maxspeed:backward", "40 mph"}},
+    {{"maxspeed:advisory", "40"}},
+    {{"maxspeed:advisory:forward", "25"}},
+    {{"maxspeed:advisory:backward", "35"}},
+    {{"width", "2.5"}},
+    {{"width", "5 m"}},
+    {{"lanes", "1"}},
+    {{"lanes", "2"}},
+    {{"lanes", "many"}}};
+
+const std::vector<std::string> highway_types = {
+    "", "motorway", "motorway_link", "trunk", "trunk_link", "primary", "primary_link",
+    "secondary", "tertiary", "unclassified", "residential", "living_street", "service", "track",
+    "ferry", "footway", "cycleway", "construction", "proposed", "road"};
+
+void addTags(osmium::memory::Buffer &buffer, osmium::builder::Builder &parent, const Tags &tags)
+{
+    osmium::builder::TagListBuilder tag_builder(buffer, &parent);
+    for (const auto &tag : tags)
+    {
+        tag_builder.add_tag(tag.first, tag.second);
+    }
+}
+
+void addNode(osmium::memory::Buffer &buffer, const osmium::object_id_type id, const Tags &tags)
+{
+    {
+        osmium::builder::NodeBuilder builder(buffer);
+        builder.object().set_id(id);
+        builder.object().set_location(osmium::Location(7.4, 43.7));
+        builder.add_user("");
+        addTags(buffer, builder, tags);
+    }
+    buffer.commit();
+}
+
+void addWay(osmium::memory::Buffer &buffer, const osmium::object_id_type id, const Tags &tags)
+{
+    {
+        osmium::builder::WayBuilder builder(buffer);
+        builder.object().set_id(id);
+        builder.add_user("");
+        addTags(buffer, builder, tags);
+        osmium::builder::WayNodeListBuilder node_builder(buffer, &builder);
+        node_builder.add_node_ref(osmium::NodeRef(1));
+        node_builder.add_node_ref(osmium::NodeRef(2));
+    }
+    buffer.commit();
+}
+
+// Every highway type with every variant, and with random combinations of three variants
+osmium::memory::Buffer makeWays()
+{
+    osmium::memory::Buffer buffer(1024 * 1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::object_id_type id = 1;
+    for (const auto &highway : highway_types)
+    {
+        const auto addVariant = [&](Tags tags) {
+            if (!highway.empty())
+            {
+                tags["highway"] = highway;
+            }
+            addWay(buffer, id++, tags);
+        };
+
+        for (const auto &variant : way_variants)
+        {
+            addVariant(variant);
+        }
+
+        std::mt19937 generator(id);
+        std::uniform_int_distribution<std::size_t> distribution(0, way_variants.size() - 1);
+        for (int combination = 0; combination < 200; ++combination)
+        {
+            Tags tags;
+            for (int variant = 0; variant < 3; ++variant)
+            {
+                const auto &tags_of_variant = way_variants[distribution(generator)];
+                tags.insert(tags_of_variant.begin(), tags_of_variant.end());
+            }
+            addVariant(tags);
+        }
+    }
+    return buffer;
+}
+
+// All combinations of the barrier, access and traffic signal tags
+osmium::memory::Buffer makeNodes()
+{
+    const std::vector<std::string> barriers = {"",     "gate",      "bollard", "wall",
+                                               "block", "lift_gate", "no",      "toll_booth"};
+    const std::vector<Tags> accesses = {{},
+                                        {{"access", "no"}},
+                                        {{"access", "yes"}},
+                                        {{"access", "private"}},
+                                        {{"access", "destination"}},
+                                        {{"access", "no"}, {"motorcar", "yes"}},
+                                        {{"motor_vehicle", "delivery"}},
+                                        {{"vehicle", "forestry"}}};
+    const std::vector<std::string> highways = {"", "traffic_signals", "crossing"};
+    const std::vector<std::string> bollards = {"", "rising"};
+
+    osmium::memory::Buffer buffer(1024 * 1024, osmium::memory::Buffer::auto_grow::yes);
+    osmium::object_id_type id = 1;
+    for (const auto &barrier : barriers)
+    {
+        for (const auto &access : accesses)
+        {
+            for (const auto &highway : highways)
+            {
+                for (const auto &bollard : bollards)
+                {
+                    auto tags = access;
+                    if (!barrier.empty())
+                    {
+                        tags["barrier"] = barrier;
+                    }
+                    if (!highway.empty())
+                    {
+                        tags["highway"] = highway;
+                    }
+                    if (!bollard.empty())
+                    {
+                        tags["bollard"] = bollard;
+                    }
+                    addNode(buffer, id++, tags);
+                }
+            }
+        }
+    }
+    return buffer;
+}
+
+std::string describe(const osmium::OSMObject &object)
+{
+    std::string description = std::to_string(object.id()) + " with";
+    for (const auto &tag : object.tags())
+    {
+        description += std::string(" ") + tag.key() + "=" + tag.value();
+    }
+    return description;
+}
+
+void checkSameSpeed(const double lhs, const double rhs)
+{
+    BOOST_CHECK_MESSAGE(lhs == rhs || std::abs(lhs - rhs) < 1e-6, lhs << " != " << rhs);
+}
+
+std::vector<std::string> sorted(std::vector<std::string> list)
+{
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+std::vector<std::string> callListFunction(lua_State *state, const char *name)
+{
+    std::vector<std::string> list;
+    luabind::call_function<void>(state, name, boost::ref(list));
+    return list;
+}
+}
+
+BOOST_AUTO_TEST_CASE(same_settings)
+{
+    const ProfilePluginLibrary library(OSRM_CAR_PROFILE_PLUGIN);
+    const auto &plugin = library.GetPlugin();
+    ScriptingEnvironment scripting_environment(CAR_PROFILE_SCRIPT);
+    auto &context = scripting_environment.GetContex();
+
+    const auto properties = plugin.GetProperties();
+    BOOST_CHECK_EQUAL(properties.traffic_signal_penalty,
+                      context.properties.traffic_signal_penalty);
+    BOOST_CHECK_EQUAL(properties.u_turn_penalty, context.properties.u_turn_penalty);
+    BOOST_CHECK_EQUAL(properties.continue_straight_at_waypoint,
+                      context.properties.continue_straight_at_waypoint);
+    BOOST_CHECK_EQUAL(properties.use_turn_restrictions,
+                      context.properties.use_turn_restrictions);
+
+    const auto checkSameList = [&](const std::vector<std::string> &plugin_list,
+                                   const char *function_name) {
+        BOOST_TEST_CONTEXT(function_name)
+        {
+            const auto lua_list = sorted(callListFunction(context.state, function_name));
+            const auto sorted_plugin_list = sorted(plugin_list);
+            BOOST_CHECK_EQUAL_COLLECTIONS(lua_list.begin(), lua_list.end(),
+                                          sorted_plugin_list.begin(), sorted_plugin_list.end());
+        }
+    };
+    checkSameList(plugin.GetNameSuffixList(), "get_name_suffix_list");
+    checkSameList(plugin.GetRestrictionExceptions(), "get_exceptions");
+    checkSameList(plugin.GetNodeKeys(), "get_node_keys");
+    checkSameList(plugin.GetWayKeys(), "get_way_keys");
+
+    BOOST_CHECK_EQUAL(plugin.HasSegmentFunction(),
+                      util::luaFunctionExists(context.state, "segment_function"));
+    BOOST_REQUIRE_EQUAL(plugin.HasTurnFunction(),
+                        util::luaFunctionExists(context.state, "turn_function"));
+    for (const auto angle : util::irange(-180, 181))
+    {
+        BOOST_TEST_CONTEXT("turn angle " << angle)
+        {
+            checkSameSpeed(plugin.GetTurnPenalty(angle),
+                           luabind::call_function<double>(context.state, "turn_function",
+                                                          static_cast<double>(angle)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(same_node_results)
+{
+    const ProfilePluginLibrary library(OSRM_CAR_PROFILE_PLUGIN);
+    ScriptingEnvironment scripting_environment(CAR_PROFILE_SCRIPT);
+    auto &context = scripting_environment.GetContex();
+
+    const auto buffer = makeNodes();
+    std::size_t number_of_barriers = 0;
+    for (const auto &item : buffer)
+    {
+        const auto &node = static_cast<const osmium::Node &>(item);
+        ExtractionNode lua_result;
+        ScriptingEnvironment::ProcessNode(context, node, lua_result);
+        ExtractionNode plugin_result;
+        library.GetPlugin().ProcessNode(node, plugin_result);
+
+        BOOST_TEST_CONTEXT("node " << describe(node))
+        {
+            BOOST_CHECK_EQUAL(lua_result.barrier, plugin_result.barrier);
+            BOOST_CHECK_EQUAL(lua_result.traffic_lights, plugin_result.traffic_lights);
+        }
+        number_of_barriers += lua_result.barrier;
+    }
+    // the nodes cover both outcomes
+    BOOST_CHECK_GT(number_of_barriers, 0);
+}
+
+BOOST_AUTO_TEST_CASE(same_way_results)
+{
+    const ProfilePluginLibrary library(OSRM_CAR_PROFILE_PLUGIN);
+    ScriptingEnvironment scripting_environment(CAR_PROFILE_SCRIPT);
+    auto &context = scripting_environment.GetContex();
+
+    const auto buffer = makeWays();
+    std::size_t number_of_ways = 0;
+    std::size_t number_of_routable_ways = 0;
+    for (const auto &item : buffer)
+    {
+        const auto &way = static_cast<const osmium::Way &>(item);
+        ExtractionWay lua_result;
+        ScriptingEnvironment::ProcessWay(context, way, lua_result);
+        ExtractionWay plugin_result;
+        library.GetPlugin().ProcessWay(way, plugin_result);
+
+        BOOST_TEST_CONTEXT("way " << describe(way))
+        {
+            checkSameSpeed(lua_result.forward_speed, plugin_result.forward_speed);
+            checkSameSpeed(lua_result.backward_speed, plugin_result.backward_speed);
+            checkSameSpeed(lua_result.duration, plugin_result.duration);
+            BOOST_CHECK_EQUAL(lua_result.name, plugin_result.name);
+            BOOST_CHECK_EQUAL(lua_result.roundabout, plugin_result.roundabout);
+            BOOST_CHECK_EQUAL(lua_result.is_access_restricted,
+                              plugin_result.is_access_restricted);
+            BOOST_CHECK_EQUAL(lua_result.is_startpoint, plugin_result.is_startpoint);
+            BOOST_CHECK_EQUAL(static_cast<int>(lua_result.forward_travel_mode),
+                              static_cast<int>(plugin_result.forward_travel_mode));
+            BOOST_CHECK_EQUAL(static_cast<int>(lua_result.backward_travel_mode),
+                              static_cast<int>(plugin_result.backward_travel_mode));
+        }
+        ++number_of_ways;
+        number_of_routable_ways += lua_result.forward_speed > 0 || lua_result.backward_speed > 0;
+    }
+    // the ways cover both outcomes
+    BOOST_CHECK_GT(number_of_routable_ways, 0);
+    BOOST_CHECK_LT(number_of_routable_ways, number_of_ways);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,542 @@
+#include "extractor/extraction_state.hpp"
+#include "extractor/extraction_containers.hpp"
+#include "extractor/extractor_callbacks.hpp"
+#include "extractor/profile_plugin.hpp"
+#include "extractor/restriction_parser.hpp"
+#include "util/fingerprint.hpp"
+
+#include "helper.hpp"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/osm.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The state only keeps a checksum of the profile file, so any content stands in for TestProfile
+const static std::string PROFILE_TMP_FILE = "test_state_profile.lua.tmp";
+
+BOOST_AUTO_TEST_SUITE(extraction_state)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+using Tags = std::vector<std::pair<std::string, std::string>>;
+
+struct TestNode
+{
+    double lon;
+    double lat;
+    Tags tags;
+};
+
+struct TestWay
+{
+    std::vector<osmium::object_id_type> nodes;
+    Tags tags;
+};
+
+struct TestRestriction
+{
+    osmium::object_id_type from_way;
+    osmium::object_id_type via_node;
+    osmium::object_id_type to_way;
+    std::string restriction;
+};
+
+// The objects of an input file by type and id
+struct TestData
+{
+    std::map<osmium::object_id_type, TestNode> nodes;
+    std::map<osmium::object_id_type, TestWay> ways;
+    std::map<osmium::object_id_type, TestRestriction> restrictions;
+};
+
+// The objects of a change file: new versions of created and modified objects and the ids of
+// deleted ones
+struct TestChanges
+{
+    TestData modified;
+    std::set<osmium::object_id_type> deleted_nodes;
+    std::set<osmium::object_id_type> deleted_ways;
+    std::set<osmium::object_id_type> deleted_restrictions;
+};
+
+// Speeds by highway type, barriers and traffic signals on nodes, names and oneways on ways
+class TestProfile final : public ProfilePlugin
+{
+  public:
+    ProfileProperties GetProperties() const override
+    {
+        ProfileProperties properties;
+        properties.use_turn_restrictions = true;
+        return properties;
+    }
+
+    void ProcessNode(const osmium::Node &node, ExtractionNode &result) const override
+    {
+        result.barrier = node.tags().get_value_by_key("barrier") != nullptr;
+        result.traffic_lights =
+            std::string(node.tags().get_value_by_key("highway", "")) == "traffic_signals";
+    }
+
+    void ProcessWay(const osmium::Way &way, ExtractionWay &result) const override
+    {
+        const char *highway = way.tags().get_value_by_key("highway", "");
+        const double speed = std::string(highway) == "primary"
+                                 ? 50
+                                 : std::string(highway) == "residential" ? 25 : 0;
+        if (speed == 0)
+        {
+            return;
+        }
+        result.name = way.tags().get_value_by_key("name", "");
+        result.forward_speed = speed;
+        result.forward_travel_mode = TRAVEL_MODE_DRIVING;
+        if (std::string(way.tags().get_value_by_key("oneway", "")) != "yes")
+        {
+            result.backward_speed = speed;
+            result.backward_travel_mode = TRAVEL_MODE_DRIVING;
+        }
+    }
+};
+
+void addTags(osmium::memory::Buffer &buffer, osmium::builder::Builder &parent, const Tags &tags)
+{
+    osmium::builder::TagListBuilder tag_builder(buffer, &parent);
+    for (const auto &tag : tags)
+    {
+        tag_builder.add_tag(tag.first, tag.second);
+    }
+}
+
+void addNode(osmium::memory::Buffer &buffer,
+             const osmium::object_id_type id,
+             const TestNode &node,
+             const bool visible = true)
+{
+    {
+        osmium::builder::NodeBuilder builder(buffer);
+        builder.object().set_id(id).set_visible(visible);
+        builder.object().set_location(osmium::Location(node.lon, node.lat));
+        builder.add_user("");
+        addTags(buffer, builder, node.tags);
+    }
+    buffer.commit();
+}
+
+void addWay(osmium::memory::Buffer &buffer,
+            const osmium::object_id_type id,
+            const TestWay &way,
+            const bool visible = true)
+{
+    {
+        osmium::builder::WayBuilder builder(buffer);
+        builder.object().set_id(id).set_visible(visible);
+        builder.add_user("");
+        addTags(buffer, builder, way.tags);
+        osmium::builder::WayNodeListBuilder node_builder(buffer, &builder);
+        for (const auto node : way.nodes)
+        {
+            node_builder.add_node_ref(osmium::NodeRef(node));
+        }
+    }
+    buffer.commit();
+}
+
+void addRestriction(osmium::memory::Buffer &buffer,
+                    const osmium::object_id_type id,
+                    const TestRestriction &restriction,
+                    const bool visible = true)
+{
+    {
+        osmium::builder::RelationBuilder builder(buffer);
+        builder.object().set_id(id).set_visible(visible);
+        builder.add_user("");
+        if (visible)
+        {
+            addTags(buffer, builder,
+                    {{"type", "restriction"}, {"restriction", restriction.restriction}});
+            osmium::builder::RelationMemberListBuilder member_builder(buffer, &builder);
+            member_builder.add_member(osmium::item_type::way, restriction.from_way, "from");
+            member_builder.add_member(osmium::item_type::node, restriction.via_node, "via");
+            member_builder.add_member(osmium::item_type::way, restriction.to_way, "to");
+        }
+    }
+    buffer.commit();
+}
+
+// Like an input file, sorted by type and id
+osmium::memory::Buffer makeInput(const TestData &data)
+{
+    osmium::memory::Buffer buffer(1024 * 1024, osmium::memory::Buffer::auto_grow::yes);
+    for (const auto &node : data.nodes)
+    {
+        addNode(buffer, node.first, node.second);
+    }
+    for (const auto &way : data.ways)
+    {
+        addWay(buffer, way.first, way.second);
+    }
+    for (const auto &restriction : data.restrictions)
+    {
+        addRestriction(buffer, restriction.first, restriction.second);
+    }
+    return buffer;
+}
+
+// Like a change file, with the deletions first
+osmium::memory::Buffer makeChanges(const TestChanges &changes)
+{
+    osmium::memory::Buffer buffer(1024 * 1024, osmium::memory::Buffer::auto_grow::yes);
+    for (const auto id : changes.deleted_restrictions)
+    {
+        addRestriction(buffer, id, {}, false);
+    }
+    for (const auto id : changes.deleted_ways)
+    {
+        addWay(buffer, id, {}, false);
+    }
+    for (const auto id : changes.deleted_nodes)
+    {
+        addNode(buffer, id, {0, 0, {}}, false);
+    }
+    for (const auto &way : changes.modified.ways)
+    {
+        addWay(buffer, way.first, way.second);
+    }
+    for (const auto &node : changes.modified.nodes)
+    {
+        addNode(buffer, node.first, node.second);
+    }
+    for (const auto &restriction : changes.modified.restrictions)
+    {
+        addRestriction(buffer, restriction.first, restriction.second);
+    }
+    return buffer;
+}
+
+TestData applyChanges(TestData data, const TestChanges &changes)
+{
+    for (const auto &node : changes.modified.nodes)
+    {
+        data.nodes[node.first] = node.second;
+    }
+    for (const auto &way : changes.modified.ways)
+    {
+        data.ways[way.first] = way.second;
+    }
+    for (const auto &restriction : changes.modified.restrictions)
+    {
+        data.restrictions[restriction.first] = restriction.second;
+    }
+    for (const auto id : changes.deleted_nodes)
+    {
+        data.nodes.erase(id);
+    }
+    for (const auto id : changes.deleted_ways)
+    {
+        data.ways.erase(id);
+    }
+    for (const auto id : changes.deleted_restrictions)
+    {
+        data.restrictions.erase(id);
+    }
+    return data;
+}
+
+// Runs the profile on an object and passes the result to the handler like osrm-extract does
+template <typename NodeHandlerT, typename WayHandlerT, typename RelationHandlerT>
+void parse(const osmium::memory::Buffer &buffer,
+           NodeHandlerT node_handler,
+           WayHandlerT way_handler,
+           RelationHandlerT relation_handler)
+{
+    const TestProfile profile;
+    const RestrictionParser restriction_parser(profile.GetProperties(),
+                                               profile.GetRestrictionExceptions());
+    for (const auto &item : buffer)
+    {
+        if (item.type() == osmium::item_type::node)
+        {
+            const auto &node = static_cast<const osmium::Node &>(item);
+            ExtractionNode result_node;
+            if (node.visible())
+            {
+                profile.ProcessNode(node, result_node);
+            }
+            node_handler(node, result_node);
+        }
+        else if (item.type() == osmium::item_type::way)
+        {
+            const auto &way = static_cast<const osmium::Way &>(item);
+            ExtractionWay result_way;
+            if (way.visible())
+            {
+                profile.ProcessWay(way, result_way);
+            }
+            way_handler(way, result_way);
+        }
+        else if (item.type() == osmium::item_type::relation)
+        {
+            const auto &relation = static_cast<const osmium::Relation &>(item);
+            relation_handler(relation, restriction_parser.TryParse(relation));
+        }
+    }
+}
+
+void prepareData(ExtractionContainers &extraction_containers, const std::string &output_path)
+{
+    const TestProfile profile;
+    extraction_containers.PrepareData(output_path, output_path + ".restrictions",
+                                      output_path + ".names", nullptr, &profile);
+}
+
+void writeProfile(const std::string &path, const std::string &content)
+{
+    std::ofstream profile_file(path, std::ios::binary);
+    profile_file << content;
+}
+
+// osrm-extract --keep-state on the input
+void extract(const TestData &data,
+             const std::string &output_path,
+             const std::string &profile_path = PROFILE_TMP_FILE)
+{
+    const auto input = makeInput(data);
+    ExtractionContainers extraction_containers;
+    {
+        ExtractionStateWriter state_writer(output_path + ".state", profile_path);
+        ExtractorCallbacks callbacks(extraction_containers, &state_writer);
+        parse(input,
+              [&](const osmium::Node &node, const ExtractionNode &result_node) {
+                  callbacks.ProcessNode(node, result_node);
+              },
+              [&](const osmium::Way &way, const ExtractionWay &result_way) {
+                  callbacks.ProcessWay(way, result_way, callbacks.GetNameID(result_way.name));
+              },
+              [&](const osmium::Relation &relation,
+                  const boost::optional<InputRestrictionContainer> &restriction) {
+                  callbacks.ProcessRestriction(relation.id(), restriction);
+              });
+    }
+    prepareData(extraction_containers, output_path);
+}
+
+// osrm-extract --apply-changes with the state of an earlier run
+void update(const std::string &old_state_path,
+            const TestChanges &changes,
+            const std::string &output_path,
+            const std::string &profile_path = PROFILE_TMP_FILE)
+{
+    const auto change_input = makeChanges(changes);
+    ExtractionChanges extraction_changes;
+    parse(change_input,
+          [&](const osmium::Node &node, const ExtractionNode &result_node) {
+              extraction_changes.AddNode(node, result_node);
+          },
+          [&](const osmium::Way &way, const ExtractionWay &result_way) {
+              extraction_changes.AddWay(way, result_way);
+          },
+          [&](const osmium::Relation &relation,
+              const boost::optional<InputRestrictionContainer> &restriction) {
+              extraction_changes.AddRelation(relation, restriction);
+          });
+
+    ExtractionContainers extraction_containers;
+    {
+        ExtractionStateWriter state_writer(output_path + ".state", profile_path);
+        ExtractorCallbacks callbacks(extraction_containers, &state_writer);
+        extraction_changes.Apply(old_state_path, profile_path, callbacks);
+    }
+    prepareData(extraction_containers, output_path);
+}
+
+std::string readFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    BOOST_REQUIRE(file);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void checkSameOutput(const std::string &lhs_path, const std::string &rhs_path)
+{
+    unit_test::checkSameNodeBasedGraph(lhs_path, rhs_path);
+    for (const std::string suffix : {".restrictions", ".names"})
+    {
+        BOOST_TEST_CONTEXT("file " << lhs_path << suffix)
+        {
+            BOOST_CHECK(readFile(lhs_path + suffix) == readFile(rhs_path + suffix));
+        }
+    }
+}
+
+// A grid of 4 x 4 nodes with streets along the rows and columns
+TestData makeBaseData()
+{
+    TestData data;
+    for (osmium::object_id_type row = 0; row < 4; ++row)
+    {
+        for (osmium::object_id_type column = 0; column < 4; ++column)
+        {
+            data.nodes[1 + 4 * row + column] = {0.001 * column, 0.001 * row, {}};
+        }
+        data.ways[100 + row] = {{1 + 4 * row, 2 + 4 * row, 3 + 4 * row, 4 + 4 * row},
+                                {{"highway", "primary"}, {"name", "Row " + std::to_string(row)}}};
+        data.ways[200 + row] = {{1 + row, 5 + row, 9 + row, 13 + row},
+                                {{"highway", "residential"},
+                                 {"name", "Column " + std::to_string(row)}}};
+    }
+    data.nodes[6].tags = {{"highway", "traffic_signals"}};
+    data.nodes[11].tags = {{"barrier", "gate"}};
+    data.ways[200].tags.emplace_back("oneway", "yes");
+    // not routable
+    data.ways[300] = {{1, 6, 11, 16}, {{"highway", "footway"}, {"name", "Diagonal"}}};
+
+    data.restrictions[1000] = {100, 2, 201, "no_right_turn"};
+    data.restrictions[1001] = {101, 7, 202, "no_left_turn"};
+    data.restrictions[1002] = {202, 11, 102, "only_straight_on"};
+    return data;
+}
+
+TestChanges makeChanges()
+{
+    TestChanges changes;
+    // moved, tagged and new nodes
+    changes.modified.nodes[5] = {0.0, 0.0015, {}};
+    changes.modified.nodes[11] = {0.002, 0.002, {}};
+    changes.modified.nodes[7] = {0.002, 0.001, {{"barrier", "bollard"}}};
+    changes.modified.nodes[17] = {0.004, 0.004, {}};
+    changes.modified.nodes[18] = {-0.001, 0.0, {}};
+    // a way with a new name, a new node and a new way with a new name
+    changes.modified.ways[101] = {{5, 6, 7, 8, 17}, {{"highway", "primary"}, {"name", "Renamed"}}};
+    changes.modified.ways[199] = {{18, 1}, {{"highway", "residential"}, {"name", "New street"}}};
+    // a way that becomes routable and one that does not stay routable
+    changes.modified.ways[300] = {{1, 6, 11, 16}, {{"highway", "residential"}}};
+    changes.modified.ways[203] = {{4, 8, 12, 16}, {{"highway", "footway"}}};
+    changes.deleted_ways = {103};
+    changes.deleted_nodes = {13};
+    // modified, new and deleted restrictions
+    changes.modified.restrictions[1001] = {101, 7, 203, "no_right_turn"};
+    changes.modified.restrictions[1003] = {102, 10, 201, "no_u_turn"};
+    changes.deleted_restrictions = {1000};
+    return changes;
+}
+}
+
+BOOST_AUTO_TEST_CASE(changes_give_same_output_as_full_extract)
+{
+    const auto base_data = makeBaseData();
+    const auto changes = makeChanges();
+    const auto edited_data = applyChanges(base_data, changes);
+
+    writeProfile(PROFILE_TMP_FILE, "-- test profile");
+    extract(base_data, "test_state_base.tmp");
+    extract(edited_data, "test_state_edited.tmp");
+    update("test_state_base.tmp.state", changes, "test_state_updated.tmp");
+
+    checkSameOutput("test_state_edited.tmp", "test_state_updated.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(successive_changes_give_same_output_as_full_extract)
+{
+    const auto base_data = makeBaseData();
+    const auto changes = makeChanges();
+
+    TestChanges more_changes;
+    // undo some of the changes, and change objects of the first change again
+    more_changes.modified.ways[101] = base_data.ways.at(101);
+    more_changes.modified.ways[199] = {{18, 1, 2}, {{"highway", "primary"}, {"name", "Row 0"}}};
+    more_changes.modified.nodes[13] = base_data.nodes.at(13);
+    more_changes.modified.restrictions[1000] = base_data.restrictions.at(1000);
+    more_changes.deleted_ways = {300};
+    more_changes.deleted_nodes = {17};
+    more_changes.deleted_restrictions = {1003};
+
+    const auto edited_data = applyChanges(applyChanges(base_data, changes), more_changes);
+
+    writeProfile(PROFILE_TMP_FILE, "-- test profile");
+    extract(base_data, "test_state_base.tmp");
+    extract(edited_data, "test_state_edited.tmp");
+    update("test_state_base.tmp.state", changes, "test_state_first.tmp");
+    update("test_state_first.tmp.state", more_changes, "test_state_updated.tmp");
+
+    checkSameOutput("test_state_edited.tmp", "test_state_updated.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(missing_state)
+{
+    ExtractionContainers extraction_containers;
+    ExtractorCallbacks callbacks(extraction_containers);
+    const ExtractionChanges extraction_changes;
+    BOOST_CHECK_THROW(
+        extraction_changes.Apply("test_state_missing.tmp.state", PROFILE_TMP_FILE, callbacks),
+        util::exception);
+}
+
+BOOST_AUTO_TEST_CASE(other_profile)
+{
+    writeProfile(PROFILE_TMP_FILE, "-- test profile");
+    writeProfile("test_state_other_profile.lua.tmp", "-- other test profile");
+    extract(makeBaseData(), "test_state_base.tmp");
+
+    BOOST_CHECK_EXCEPTION(update("test_state_base.tmp.state", makeChanges(),
+                                 "test_state_updated.tmp", "test_state_other_profile.lua.tmp"),
+                          util::exception, [](const util::exception &error) {
+                              return std::string(error.what()).find("with another profile") !=
+                                     std::string::npos;
+                          });
+}
+
+BOOST_AUTO_TEST_CASE(other_profile_library)
+{
+    // like profiles/car.lua, the profile requires a script from a subfolder
+    boost::filesystem::create_directories("test_state_profile.tmp/lib");
+    writeProfile("test_state_profile.tmp/profile.lua", "require('lib/speeds')");
+    writeProfile("test_state_profile.tmp/lib/speeds.lua", "-- speeds");
+    extract(makeBaseData(), "test_state_base.tmp", "test_state_profile.tmp/profile.lua");
+
+    writeProfile("test_state_profile.tmp/lib/speeds.lua", "-- other speeds");
+    BOOST_CHECK_EXCEPTION(update("test_state_base.tmp.state", makeChanges(),
+                                 "test_state_updated.tmp", "test_state_profile.tmp/profile.lua"),
+                          util::exception, [](const util::exception &error) {
+                              return std::string(error.what()).find("with another profile") !=
+                                     std::string::npos;
+                          });
+}
+
+BOOST_AUTO_TEST_CASE(other_build)
+{
+    writeProfile(PROFILE_TMP_FILE, "-- test profile");
+    extract(makeBaseData(), "test_state_base.tmp");
+
+    // a state written by another build has another fingerprint
+    {
+        std::fstream state_file("test_state_base.tmp.state",
+                                std::ios::binary | std::ios::in | std::ios::out);
+        state_file.seekg(sizeof(util::FingerPrint) - 1);
+        const auto last_byte = static_cast<char>(state_file.get());
+        state_file.seekp(sizeof(util::FingerPrint) - 1);
+        state_file.put(~last_byte);
+    }
+
+    BOOST_CHECK_EXCEPTION(update("test_state_base.tmp.state", makeChanges(),
+                                 "test_state_updated.tmp"),
+                          util::exception, [](const util::exception &error) {
+                              return std::string(error.what()).find(
+                                         "written by another version of osrm-extract") !=
+                                     std::string::npos;
+                          });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
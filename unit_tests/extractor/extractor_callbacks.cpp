@@ -0,0 +1,144 @@
+#include "extractor/extraction_containers.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/extractor_callbacks.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(extractor_callbacks)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+// Routable ways with names that repeat, some of them longer than the 255 characters of the
+// .names file and some empty
+std::vector<ExtractionWay> makeWays(const std::size_t number_of_ways)
+{
+    std::mt19937 generator(42);
+    std::vector<ExtractionWay> ways(number_of_ways);
+    for (auto &way : ways)
+    {
+        const auto name_index = generator() % 100;
+        way.name = name_index == 0 ? "" : "Street " + std::to_string(name_index);
+        if (name_index % 10 == 1)
+        {
+            way.name += std::string(300, 'x');
+        }
+        way.forward_speed = 50;
+        way.backward_speed = 50;
+        way.forward_travel_mode = TRAVEL_MODE_DRIVING;
+        way.backward_travel_mode = TRAVEL_MODE_DRIVING;
+    }
+    return ways;
+}
+
+void processWay(ExtractorCallbacks &callbacks,
+                const std::size_t index,
+                const ExtractionWay &way,
+                const unsigned name_id)
+{
+    const std::vector<OSMNodeID> node_ids = {OSMNodeID(2 * index), OSMNodeID(2 * index + 1)};
+    callbacks.ProcessWay(OSMWayID(index), node_ids, {}, way, name_id);
+}
+
+std::vector<unsigned> getEdgeNameIDs(const ExtractionContainers &containers)
+{
+    std::vector<unsigned> name_ids;
+    for (const auto &edge : containers.all_edges_list)
+    {
+        name_ids.push_back(edge.result.name_id);
+    }
+    return name_ids;
+}
+}
+
+BOOST_AUTO_TEST_CASE(prefetched_name_ids_match_serial_lookup)
+{
+    const auto ways = makeWays(10000);
+
+    ExtractionContainers serial_containers;
+    {
+        ExtractorCallbacks callbacks(serial_containers);
+        for (const auto index : util::irange<std::size_t>(0, ways.size()))
+        {
+            processWay(callbacks, index, ways[index], INVALID_NAMEID);
+        }
+    }
+
+    // Like the extractor pipeline: the names of a buffer are looked up in parallel while the
+    // previous buffer is stored, so lookups miss the names that buffer adds
+    ExtractionContainers prefetched_containers;
+    std::size_t number_of_prefetched_ids = 0;
+    {
+        ExtractorCallbacks callbacks(prefetched_containers);
+        const std::size_t buffer_size = 500;
+        std::vector<unsigned> name_ids(ways.size(), INVALID_NAMEID);
+        const auto look_up = [&](const std::size_t begin) {
+            tbb::parallel_for(begin, std::min(begin + buffer_size, ways.size()),
+                              [&](const std::size_t index) {
+                                  name_ids[index] = callbacks.GetNameID(ways[index].name);
+                              });
+        };
+        const auto store = [&](const std::size_t begin) {
+            for (const auto index :
+                 util::irange<std::size_t>(begin, std::min(begin + buffer_size, ways.size())))
+            {
+                processWay(callbacks, index, ways[index], name_ids[index]);
+            }
+        };
+
+        look_up(0);
+        for (std::size_t begin = 0; begin < ways.size(); begin += buffer_size)
+        {
+            tbb::parallel_invoke([&] { store(begin); }, [&] { look_up(begin + buffer_size); });
+        }
+
+        for (const auto name_id : name_ids)
+        {
+            number_of_prefetched_ids += name_id != INVALID_NAMEID;
+        }
+    }
+    // most names are known before their ways are stored
+    BOOST_CHECK_GT(number_of_prefetched_ids, ways.size() / 2);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        serial_containers.name_lengths.begin(), serial_containers.name_lengths.end(),
+        prefetched_containers.name_lengths.begin(), prefetched_containers.name_lengths.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        serial_containers.name_char_data.begin(), serial_containers.name_char_data.end(),
+        prefetched_containers.name_char_data.begin(), prefetched_containers.name_char_data.end());
+
+    const auto serial_name_ids = getEdgeNameIDs(serial_containers);
+    const auto prefetched_name_ids = getEdgeNameIDs(prefetched_containers);
+    BOOST_CHECK_EQUAL(serial_name_ids.size(), ways.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(serial_name_ids.begin(), serial_name_ids.end(),
+                                  prefetched_name_ids.begin(), prefetched_name_ids.end());
+}
+
+BOOST_AUTO_TEST_CASE(unknown_name)
+{
+    ExtractionContainers containers;
+    ExtractorCallbacks callbacks(containers);
+    BOOST_CHECK_EQUAL(callbacks.GetNameID("Main Street"), INVALID_NAMEID);
+
+    ExtractionWay way;
+    way.name = "Main Street";
+    way.forward_speed = 50;
+    way.forward_travel_mode = TRAVEL_MODE_DRIVING;
+    processWay(callbacks, 0, way, INVALID_NAMEID);
+    BOOST_CHECK_EQUAL(callbacks.GetNameID("Main Street"), containers.name_lengths.size() - 1);
+    BOOST_CHECK_EQUAL(callbacks.GetNameID("Side Street"), INVALID_NAMEID);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+#ifndef UNIT_TESTS_EXTRACTOR_HELPER_HPP
+#define UNIT_TESTS_EXTRACTOR_HELPER_HPP
+
+#include "extractor/external_memory_node.hpp"
+#include "extractor/node_based_edge.hpp"
+#include "util/fingerprint.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace unit_test
+{
+
+// The nodes and edges of an .osrm file
+struct NodeBasedGraphFile
+{
+    std::vector<extractor::ExternalMemoryNode> nodes;
+    std::vector<extractor::NodeBasedEdge> edges;
+};
+
+inline NodeBasedGraphFile readNodeBasedGraph(const std::string &path)
+{
+    std::ifstream input_stream(path, std::ios::binary);
+    BOOST_REQUIRE(input_stream);
+
+    util::FingerPrint fingerprint;
+    input_stream.read(reinterpret_cast<char *>(&fingerprint), sizeof(util::FingerPrint));
+
+    NodeBasedGraphFile graph;
+    unsigned number_of_nodes = 0;
+    input_stream.read(reinterpret_cast<char *>(&number_of_nodes), sizeof(unsigned));
+    graph.nodes.resize(number_of_nodes);
+    input_stream.read(reinterpret_cast<char *>(graph.nodes.data()),
+                      number_of_nodes * sizeof(extractor::ExternalMemoryNode));
+
+    unsigned number_of_edges = 0;
+    input_stream.read(reinterpret_cast<char *>(&number_of_edges), sizeof(unsigned));
+    graph.edges.resize(number_of_edges);
+    input_stream.read(reinterpret_cast<char *>(graph.edges.data()),
+                      number_of_edges * sizeof(extractor::NodeBasedEdge));
+    BOOST_REQUIRE(input_stream);
+    return graph;
+}
+
+// The .osrm file holds structs with padding, so two files are compared by their fields
+inline void checkSameNodeBasedGraph(const std::string &lhs_path, const std::string &rhs_path)
+{
+    const auto lhs_graph = readNodeBasedGraph(lhs_path);
+    const auto rhs_graph = readNodeBasedGraph(rhs_path);
+
+    BOOST_REQUIRE_EQUAL(lhs_graph.nodes.size(), rhs_graph.nodes.size());
+    for (const auto index : util::irange<std::size_t>(0, lhs_graph.nodes.size()))
+    {
+        const auto &lhs = lhs_graph.nodes[index];
+        const auto &rhs = rhs_graph.nodes[index];
+        BOOST_CHECK_EQUAL(lhs.node_id, rhs.node_id);
+        BOOST_CHECK_EQUAL(lhs.lon, rhs.lon);
+        BOOST_CHECK_EQUAL(lhs.lat, rhs.lat);
+        BOOST_CHECK_EQUAL(lhs.barrier, rhs.barrier);
+        BOOST_CHECK_EQUAL(lhs.traffic_lights, rhs.traffic_lights);
+    }
+
+    BOOST_REQUIRE_EQUAL(lhs_graph.edges.size(), rhs_graph.edges.size());
+    for (const auto index : util::irange<std::size_t>(0, lhs_graph.edges.size()))
+    {
+        const auto &lhs = lhs_graph.edges[index];
+        const auto &rhs = rhs_graph.edges[index];
+        BOOST_CHECK_EQUAL(lhs.source, rhs.source);
+        BOOST_CHECK_EQUAL(lhs.target, rhs.target);
+        BOOST_CHECK_EQUAL(lhs.name_id, rhs.name_id);
+        BOOST_CHECK_EQUAL(lhs.weight, rhs.weight);
+        BOOST_CHECK_EQUAL(lhs.forward, rhs.forward);
+        BOOST_CHECK_EQUAL(lhs.backward, rhs.backward);
+        BOOST_CHECK_EQUAL(lhs.roundabout, rhs.roundabout);
+        BOOST_CHECK_EQUAL(lhs.access_restricted, rhs.access_restricted);
+        BOOST_CHECK_EQUAL(lhs.startpoint, rhs.startpoint);
+        BOOST_CHECK_EQUAL(lhs.is_split, rhs.is_split);
+        BOOST_CHECK_EQUAL(static_cast<int>(lhs.travel_mode), static_cast<int>(rhs.travel_mode));
+        BOOST_CHECK(lhs.road_classification == rhs.road_classification);
+    }
+}
+}
+}
+
+#endif // UNIT_TESTS_EXTRACTOR_HELPER_HPP
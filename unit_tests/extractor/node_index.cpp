@@ -0,0 +1,148 @@
+#include "extractor/node_index.hpp"
+#include "extractor/extraction_containers.hpp"
+#include "extractor/extractor_callbacks.hpp"
+#include "extractor/profile_plugin.hpp"
+#include "util/exception.hpp"
+
+#include "helper.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(node_index)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+#ifdef ENABLE_STXXL
+
+BOOST_AUTO_TEST_CASE(rejected_with_stxxl)
+{
+    BOOST_CHECK_THROW(makeNodeIndex("dense"), util::exception);
+    BOOST_CHECK_THROW(makeNodeIndex("sparse"), util::exception);
+}
+
+#else
+
+namespace
+{
+class NoSegmentFunctionProfile final : public ProfilePlugin
+{
+  public:
+    ProfileProperties GetProperties() const override { return {}; }
+    void ProcessNode(const osmium::Node &, ExtractionNode &) const override {}
+    void ProcessWay(const osmium::Way &, ExtractionWay &) const override {}
+};
+
+// Extracts a random graph with the given node index type. Some node ids are missing, some occur
+// twice with different coordinates, and some edges are loops.
+std::string extractRandomGraph(const std::string &index_type)
+{
+    ExtractionContainers containers;
+    if (index_type != "sort")
+    {
+        containers.node_index = makeNodeIndex(index_type);
+    }
+
+    std::mt19937 generator(5);
+    std::vector<std::uint64_t> ids;
+    for (const auto index : util::irange<std::uint64_t>(0, 3000))
+    {
+        ids.push_back(1000 + index * 7 + (index % 3) * 3000000);
+    }
+    auto shuffled_ids = ids;
+    std::shuffle(shuffled_ids.begin(), shuffled_ids.end(), generator);
+    for (const auto id : shuffled_ids)
+    {
+        if (id % 11 == 0)
+        {
+            continue;
+        }
+        const auto copies = id % 13 == 0 ? 2 : 1;
+        for (const auto copy : util::irange(0, copies))
+        {
+            containers.all_nodes_list.push_back(ExternalMemoryNode(
+                util::FixedLongitude(id % 100000 + copy), util::FixedLatitude(id % 50000),
+                OSMNodeID(id), id % 5 == copy, false));
+        }
+    }
+
+    std::uniform_int_distribution<std::size_t> distribution(0, ids.size() - 1);
+    std::set<std::pair<std::uint64_t, std::uint64_t>> seen;
+    for (const auto index : util::irange<unsigned>(0, 20000))
+    {
+        const auto source = ids[distribution(generator)];
+        const auto target = index % 100 == 0 ? source : ids[distribution(generator)];
+        if (!seen.insert({std::min(source, target), std::max(source, target)}).second)
+        {
+            continue;
+        }
+        InternalExtractorEdge::WeightData weight_data;
+        weight_data.type = InternalExtractorEdge::WeightType::SPEED;
+        weight_data.speed = 10 + index % 50;
+        containers.all_edges_list.push_back(InternalExtractorEdge(
+            OSMNodeID(source), OSMNodeID(target), index % 7, weight_data, true, index % 2, false,
+            false, true, TRAVEL_MODE_DRIVING, false, guidance::RoadClassificationData()));
+        containers.used_node_id_list.push_back(OSMNodeID(source));
+        containers.used_node_id_list.push_back(OSMNodeID(target));
+    }
+
+    const NoSegmentFunctionProfile profile;
+    const auto output_path = "test_node_index_" + index_type + ".tmp";
+    containers.PrepareData(output_path, output_path + ".restrictions", output_path + ".names",
+                           nullptr, &profile);
+    return output_path;
+}
+}
+
+BOOST_AUTO_TEST_CASE(indexes_match_sort)
+{
+    const auto sort_path = extractRandomGraph("sort");
+    const auto graph = unit_test::readNodeBasedGraph(sort_path);
+    BOOST_CHECK_GT(graph.nodes.size(), 2000);
+    BOOST_CHECK_GT(graph.edges.size(), 10000);
+
+    for (const std::string index_type : {"dense", "sparse"})
+    {
+        BOOST_TEST_CONTEXT("node index " << index_type)
+        {
+            unit_test::checkSameNodeBasedGraph(sort_path, extractRandomGraph(index_type));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(negative_node_ids)
+{
+    const ExternalMemoryNode node(util::FixedLongitude(0), util::FixedLatitude(0),
+                                  OSMNodeID(static_cast<std::uint64_t>(-5)), false, false);
+    for (const std::string index_type : {"dense", "sparse"})
+    {
+        ExtractionContainers containers;
+        containers.node_index = makeNodeIndex(index_type);
+        ExtractorCallbacks callbacks(containers);
+        BOOST_CHECK_THROW(callbacks.ProcessNode(node), util::exception);
+        BOOST_CHECK(containers.all_nodes_list.empty());
+    }
+
+    ExtractionContainers containers;
+    ExtractorCallbacks callbacks(containers);
+    callbacks.ProcessNode(node);
+    BOOST_CHECK_EQUAL(containers.all_nodes_list.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(unknown_type)
+{
+    BOOST_CHECK(!isNodeIndexType("sort"));
+    BOOST_CHECK_THROW(makeNodeIndex("sort"), util::exception);
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,9 @@
+// A profile plugin that only has the API version of the entry points of
+// OSRM_REGISTER_PROFILE_PLUGIN, loading it has to fail
+
+#include "extractor/profile_plugin.hpp"
+
+extern "C" OSRM_PROFILE_PLUGIN_EXPORT unsigned osrm_profile_plugin_api_version()
+{
+    return osrm::extractor::PROFILE_PLUGIN_API_VERSION;
+}
@@ -0,0 +1,30 @@
+// A profile plugin that was built for a newer plugin API, loading it has to fail
+
+#include "extractor/profile_plugin.hpp"
+
+namespace
+{
+class EmptyProfile final : public osrm::extractor::ProfilePlugin
+{
+  public:
+    osrm::extractor::ProfileProperties GetProperties() const override { return {}; }
+    void ProcessNode(const osmium::Node &, osrm::extractor::ExtractionNode &) const override {}
+    void ProcessWay(const osmium::Way &, osrm::extractor::ExtractionWay &) const override {}
+};
+}
+
+extern "C" OSRM_PROFILE_PLUGIN_EXPORT unsigned osrm_profile_plugin_api_version()
+{
+    return osrm::extractor::PROFILE_PLUGIN_API_VERSION + 1;
+}
+
+extern "C" OSRM_PROFILE_PLUGIN_EXPORT osrm::extractor::ProfilePlugin *osrm_create_profile_plugin()
+{
+    return new EmptyProfile();
+}
+
+extern "C" OSRM_PROFILE_PLUGIN_EXPORT void
+osrm_destroy_profile_plugin(osrm::extractor::ProfilePlugin *plugin)
+{
+    delete plugin;
+}
@@ -0,0 +1,90 @@
+#include "extractor/profile_plugin_library.hpp"
+#include "util/exception.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+// Paths of the car plugin and of the broken plugins in unit_tests/extractor/plugins, set by the
+// build
+#ifndef OSRM_CAR_PROFILE_PLUGIN
+#error "OSRM_CAR_PROFILE_PLUGIN has to be the path of the car profile plugin"
+#endif
+#ifndef OSRM_OLD_API_VERSION_PLUGIN
+#error "OSRM_OLD_API_VERSION_PLUGIN has to be the path of the old-api-version-plugin"
+#endif
+#ifndef OSRM_MISSING_SYMBOLS_PLUGIN
+#error "OSRM_MISSING_SYMBOLS_PLUGIN has to be the path of the missing-symbols-plugin"
+#endif
+
+BOOST_AUTO_TEST_SUITE(profile_plugin_library)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+// Checks that loading the library throws a util::exception that mentions the message
+void checkLoadFails(const std::string &library_path, const std::string &message)
+{
+    BOOST_CHECK_EXCEPTION(ProfilePluginLibrary library(library_path), util::exception,
+                          [&](const util::exception &error) {
+                              BOOST_TEST_MESSAGE(error.what());
+                              return std::string(error.what()).find(message) != std::string::npos;
+                          });
+}
+}
+
+BOOST_AUTO_TEST_CASE(load_car_plugin)
+{
+    const ProfilePluginLibrary library(OSRM_CAR_PROFILE_PLUGIN);
+    const auto &plugin = library.GetPlugin();
+
+    const auto properties = plugin.GetProperties();
+    BOOST_CHECK(properties.use_turn_restrictions);
+    BOOST_CHECK_EQUAL(properties.u_turn_penalty, 200);
+    BOOST_CHECK_EQUAL(properties.traffic_signal_penalty, 20);
+    BOOST_CHECK(plugin.HasTurnFunction());
+    BOOST_CHECK(!plugin.HasSegmentFunction());
+    BOOST_CHECK_EQUAL(plugin.GetTurnPenalty(0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(load_twice)
+{
+    // every library holds its own reference, unloading one keeps the other usable
+    const ProfilePluginLibrary first(OSRM_CAR_PROFILE_PLUGIN);
+    {
+        const ProfilePluginLibrary second(OSRM_CAR_PROFILE_PLUGIN);
+        BOOST_CHECK(second.GetPlugin().GetProperties().use_turn_restrictions);
+    }
+    BOOST_CHECK(first.GetPlugin().GetProperties().use_turn_restrictions);
+}
+
+BOOST_AUTO_TEST_CASE(missing_library)
+{
+    checkLoadFails("test_missing_plugin.so", "Could not load profile plugin");
+}
+
+BOOST_AUTO_TEST_CASE(other_api_version)
+{
+    checkLoadFails(OSRM_OLD_API_VERSION_PLUGIN,
+                   "was built for plugin API version " +
+                       std::to_string(PROFILE_PLUGIN_API_VERSION + 1));
+}
+
+BOOST_AUTO_TEST_CASE(missing_symbols)
+{
+    checkLoadFails(OSRM_MISSING_SYMBOLS_PLUGIN, "has no osrm_create_profile_plugin");
+}
+
+BOOST_AUTO_TEST_CASE(plugin_paths)
+{
+    BOOST_CHECK(ProfilePluginLibrary::IsPluginPath("build/libosrm_car_profile.so"));
+    BOOST_CHECK(ProfilePluginLibrary::IsPluginPath("libosrm_car_profile.dylib"));
+    BOOST_CHECK(ProfilePluginLibrary::IsPluginPath("C:\\osrm\\osrm_car_profile.dll"));
+    BOOST_CHECK(!ProfilePluginLibrary::IsPluginPath("profiles/car.lua"));
+    BOOST_CHECK(!ProfilePluginLibrary::IsPluginPath("profiles/car.so.lua"));
+    BOOST_CHECK(!ProfilePluginLibrary::IsPluginPath("so"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -15,7 +15,7 @@ namespace osrm
 namespace test
 {
 
-class MockDataFacade final : public engine::datafacade::BaseDataFacade
+class MockDataFacade : public engine::datafacade::BaseDataFacade
 {
   private:
     EdgeData foo;
@@ -172,6 +172,11 @@ class MockDataFacade final : public engine::datafacade::BaseDataFacade
     unsigned GetNameIndexFromEdgeID(const unsigned /* id */) const override { return 0; }
     std::string GetNameForID(const unsigned /* name_id */) const override { return ""; }
     std::size_t GetCoreSize() const override { return 0; }
+    unsigned GetNumberOfLandmarks() const override { return 0; }
+    const EdgeWeight *GetLandmarkDistances(const NodeID /* id */) const override
+    {
+        return nullptr;
+    }
     std::string GetTimestamp() const override { return ""; }
     bool GetContinueStraightDefault() const override { return true; }
     BearingClassID GetBearingClassID(const NodeID /*id*/) const override { return 0; };
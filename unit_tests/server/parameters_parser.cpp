@@ -3,6 +3,7 @@
 #include "parameters_io.hpp"
 
 #include "engine/api/base_parameters.hpp"
+#include "engine/api/isochrone_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
@@ -14,6 +15,8 @@
 #include <boost/test/test_tools.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <type_traits>
+
 #define CHECK_EQUAL_RANGE(R1, R2)                                                                  \
     BOOST_CHECK_EQUAL_COLLECTIONS(R1.begin(), R1.end(), R2.begin(), R2.end());
 
@@ -24,6 +27,11 @@ using namespace osrm::server;
 using namespace osrm::server::api;
 using namespace osrm::engine::api;
 
+// BaseParameters defaults all of its constructor arguments, a bare list of coordinates must not
+// convert to it
+static_assert(!std::is_convertible<std::vector<util::Coordinate>, BaseParameters>::value,
+              "BaseParameters should not be implicitly constructible from coordinates");
+
 // returns distance to front
 template <typename ParameterT> std::size_t testInvalidOptions(std::string options)
 {
@@ -46,6 +54,10 @@ BOOST_AUTO_TEST_CASE(invalid_route_urls)
                       29UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&hints=;;; ;"),
                       32UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&metric="),
+                      30UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&metric=a.b"),
+                      31UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&geometries=foo"),
                       34UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&overview=foo"),
@@ -71,6 +83,13 @@ BOOST_AUTO_TEST_CASE(invalid_table_urls)
         testInvalidOptions<TableParameters>("1,2;3,4?sources=1&destinations=1&bla=foo"), 32UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?sources=foo"), 16UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?destinations=foo"), 21UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?annotations=foo"), 20UL);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_isochrone_urls)
+{
+    BOOST_CHECK_EQUAL(testInvalidOptions<IsochroneParameters>("1,2?duration=foo"), 13UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<IsochroneParameters>("1,2?duration=60&bla=foo"), 15UL);
 }
 
 BOOST_AUTO_TEST_CASE(valid_route_urls)
@@ -281,6 +300,15 @@ BOOST_AUTO_TEST_CASE(valid_route_urls)
     CHECK_EQUAL_RANGE(reference_10.radiuses, result_10->radiuses);
     CHECK_EQUAL_RANGE(reference_10.coordinates, result_10->coordinates);
     CHECK_EQUAL_RANGE(reference_10.hints, result_10->hints);
+
+    auto result_11 = parseParameters<RouteParameters>("1,2;3,4?metric=rush_hour-2");
+    BOOST_CHECK(result_11);
+    BOOST_CHECK_EQUAL(result_11->metric, "rush_hour-2");
+    CHECK_EQUAL_RANGE(coords_1, result_11->coordinates);
+
+    auto result_12 = parseParameters<RouteParameters>("1,2;3,4");
+    BOOST_CHECK(result_12);
+    BOOST_CHECK(result_12->metric.empty());
 }
 
 BOOST_AUTO_TEST_CASE(valid_table_urls)
@@ -317,6 +345,17 @@ BOOST_AUTO_TEST_CASE(valid_table_urls)
     CHECK_EQUAL_RANGE(reference_1.bearings, result_3->bearings);
     CHECK_EQUAL_RANGE(reference_1.radiuses, result_3->radiuses);
     CHECK_EQUAL_RANGE(reference_1.coordinates, result_3->coordinates);
+    BOOST_CHECK(result_3->annotations == TableParameters::AnnotationsType::Duration);
+
+    auto result_4 = parseParameters<TableParameters>("1,2;3,4?annotations=distance,duration");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK(result_4->annotations == TableParameters::AnnotationsType::All);
+    CHECK_EQUAL_RANGE(reference_1.coordinates, result_4->coordinates);
+
+    auto result_5 = parseParameters<TableParameters>("1,2;3,4?annotations=distance&sources=1");
+    BOOST_CHECK(result_5);
+    BOOST_CHECK(result_5->annotations == TableParameters::AnnotationsType::Distance);
+    BOOST_CHECK_EQUAL(result_5->sources.size(), 1);
 }
 
 BOOST_AUTO_TEST_CASE(valid_match_urls)
@@ -368,6 +407,28 @@ BOOST_AUTO_TEST_CASE(valid_nearest_urls)
     CHECK_EQUAL_RANGE(reference_2.coordinates, result_2->coordinates);
 }
 
+BOOST_AUTO_TEST_CASE(valid_isochrone_urls)
+{
+    std::vector<util::Coordinate> coords_1 = {{util::FloatLongitude(1), util::FloatLatitude(2)}};
+
+    IsochroneParameters reference_1{};
+    reference_1.coordinates = coords_1;
+    reference_1.duration = 600.5;
+    auto result_1 = parseParameters<IsochroneParameters>("1,2?duration=600.5");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK_EQUAL(reference_1.duration, result_1->duration);
+    CHECK_EQUAL_RANGE(reference_1.bearings, result_1->bearings);
+    CHECK_EQUAL_RANGE(reference_1.radiuses, result_1->radiuses);
+    CHECK_EQUAL_RANGE(reference_1.coordinates, result_1->coordinates);
+
+    IsochroneParameters reference_2{};
+    reference_2.coordinates = coords_1;
+    auto result_2 = parseParameters<IsochroneParameters>("1,2");
+    BOOST_CHECK(result_2);
+    BOOST_CHECK_EQUAL(reference_2.duration, result_2->duration);
+    BOOST_CHECK(!result_2->IsValid());
+}
+
 BOOST_AUTO_TEST_CASE(valid_tile_urls)
 {
     TileParameters reference_1{1, 2, 3};
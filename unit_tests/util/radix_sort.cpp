@@ -0,0 +1,86 @@
+#include "util/radix_sort.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(radix_sort)
+
+using namespace osrm;
+using namespace osrm::util;
+
+using Element = std::pair<std::uint64_t, unsigned>;
+
+std::uint64_t ElementKey(const Element &element) { return element.first; }
+
+void CheckSorted(std::vector<Element> elements)
+{
+    auto expected = elements;
+    std::stable_sort(expected.begin(), expected.end(), [](const Element &lhs, const Element &rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    radixSort(elements.begin(), elements.end(), ElementKey);
+
+    BOOST_CHECK(elements == expected);
+}
+
+BOOST_AUTO_TEST_CASE(empty_and_single_element)
+{
+    CheckSorted({});
+    CheckSorted({{42, 0}});
+}
+
+BOOST_AUTO_TEST_CASE(osm_node_ids)
+{
+    // more elements than one block to cover the parallel passes
+    std::mt19937 generator(13);
+    std::uniform_int_distribution<std::uint64_t> distribution(1, 5000000000ull);
+    std::vector<Element> elements;
+    for (unsigned index = 0; index < 200000; ++index)
+    {
+        elements.emplace_back(distribution(generator), index);
+    }
+    CheckSorted(elements);
+}
+
+BOOST_AUTO_TEST_CASE(stable_for_equal_keys)
+{
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<std::uint64_t> distribution(0, 15);
+    std::vector<Element> elements;
+    for (unsigned index = 0; index < 1000; ++index)
+    {
+        elements.emplace_back(distribution(generator) << 40, index);
+    }
+    CheckSorted(elements);
+}
+
+BOOST_AUTO_TEST_CASE(full_width_keys)
+{
+    CheckSorted({{0xffffffffffffffffull, 0},
+                 {0, 1},
+                 {0x8000000000000000ull, 2},
+                 {0xff, 3},
+                 {0x0100000000000000ull, 4},
+                 {0xff, 5}});
+}
+
+BOOST_AUTO_TEST_CASE(node_id_pairs)
+{
+    std::vector<std::pair<NodeID, NodeID>> edges = {{3, 1}, {1, 7}, {3, 0}, {1, 2}, {0, 9}};
+    radixSort(edges.begin(), edges.end(), [](const std::pair<NodeID, NodeID> &edge) {
+        return (static_cast<std::uint64_t>(edge.first) << 32) | edge.second;
+    });
+
+    auto expected = edges;
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK(edges == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
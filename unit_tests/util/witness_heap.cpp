@@ -0,0 +1,145 @@
+#include "util/witness_heap.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(witness_heap)
+
+using namespace osrm;
+using namespace osrm::util;
+
+struct TestData
+{
+    unsigned value;
+};
+
+using TestHeap = WitnessHeap<NodeID, int, TestData>;
+
+template <unsigned NUM_ELEM> struct RandomDataFixture
+{
+    RandomDataFixture()
+    {
+        for (unsigned i = 0; i < NUM_ELEM; i++)
+        {
+            data.push_back(TestData{i * 3});
+            weights.push_back((i + 1) * 100);
+            // sparse ids like the nodes of one search in a large graph
+            ids.push_back(i * 7919);
+            order.push_back(i);
+        }
+
+        std::mt19937 g(15);
+        std::shuffle(order.begin(), order.end(), g);
+    }
+
+    std::vector<TestData> data;
+    std::vector<int> weights;
+    std::vector<NodeID> ids;
+    std::vector<unsigned> order;
+};
+
+// more nodes than fit into the initial table
+constexpr unsigned NUM_NODES = 10000;
+
+BOOST_FIXTURE_TEST_CASE(insert_test, RandomDataFixture<NUM_NODES>)
+{
+    TestHeap heap;
+
+    int min_weight = std::numeric_limits<int>::max();
+    NodeID min_id = SPECIAL_NODEID;
+
+    for (unsigned idx : order)
+    {
+        BOOST_CHECK(!heap.WasInserted(ids[idx]));
+
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+
+        BOOST_CHECK(heap.WasInserted(ids[idx]));
+
+        if (weights[idx] < min_weight)
+        {
+            min_weight = weights[idx];
+            min_id = ids[idx];
+        }
+        BOOST_CHECK_EQUAL(min_id, heap.Min());
+    }
+
+    for (auto idx : order)
+    {
+        BOOST_CHECK_EQUAL(heap.GetData(ids[idx]).value, data[idx].value);
+        BOOST_CHECK_EQUAL(heap.GetKey(ids[idx]), weights[idx]);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(delete_min_test, RandomDataFixture<NUM_NODES>)
+{
+    TestHeap heap;
+
+    for (unsigned idx : order)
+    {
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+    }
+
+    for (auto id : ids)
+    {
+        BOOST_CHECK(!heap.WasRemoved(id));
+        BOOST_CHECK_EQUAL(heap.Min(), id);
+        BOOST_CHECK_EQUAL(id, heap.DeleteMin());
+        BOOST_CHECK(heap.WasRemoved(id));
+    }
+    BOOST_CHECK(heap.Empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(decrease_key_test, RandomDataFixture<10>)
+{
+    TestHeap heap;
+
+    for (unsigned idx : order)
+    {
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+    }
+
+    for (auto idx = ids.size(); idx-- > 0;)
+    {
+        const auto id = ids[idx];
+        const NodeID min_id = heap.Min();
+        const int min_weight = heap.MinKey();
+
+        heap.DecreaseKey(id, min_weight + 1);
+        BOOST_CHECK_EQUAL(heap.Min(), min_id);
+
+        heap.DecreaseKey(*heap.Find(id), min_weight - 2);
+        BOOST_CHECK_EQUAL(heap.Min(), id);
+        BOOST_CHECK_EQUAL(heap.MinKey(), min_weight - 2);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(clear_test, RandomDataFixture<NUM_NODES>)
+{
+    TestHeap heap;
+
+    for (const auto round : {0, 1, 2})
+    {
+        for (unsigned idx : order)
+        {
+            heap.Insert(ids[idx], weights[idx] + round, data[idx]);
+        }
+        BOOST_CHECK_EQUAL(heap.Size(), NUM_NODES);
+        BOOST_CHECK_EQUAL(heap.MinKey(), weights.front() + round);
+
+        heap.Clear();
+
+        BOOST_CHECK(heap.Empty());
+        for (auto id : ids)
+        {
+            BOOST_CHECK(!heap.WasInserted(id));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()